@@ -5,6 +5,9 @@
 #include "util/Types.h"
 #include "drivers/Bmp390Driver.h"
 #include "core/SettingsService.h"
+#include "util/Decimator.h"
+#include "util/HampelFilter.h"
+#include "util/AltitudeHistory.h"
 
 //---------------------------------------------
 // Parámetros de altimetría (backend)
@@ -13,7 +16,7 @@ constexpr float ALT_DEADBAND_METERS      =8.0f;    // zona muerta (en metros) an
 constexpr float GROUND_ALT_THRESH_METERS = 1.0f;    // |altura_rel_suelo| < 1 m -> cerca del suelo
 constexpr float GROUND_VS_THRESH_MPS     = 0.3f;    // |velocidad vertical| < 0.3 m/s -> casi quieto
 constexpr uint32_t GROUND_STABLE_TIME_MS = 2'000;   // ms continuos para considerar suelo "estable"
-constexpr float ALT_FILTER_ALPHA         = 0.2f;    // filtro exponencial para suavizar altura/VS
+constexpr float ALT_FILTER_ALPHA         = 0.2f;    // filtro exponencial para suavizar altura/VS (util/EventTiming.h lo modela)
 constexpr float MIN_VS_DT_SECONDS        = 0.03f;   // ignora dt demasiado pequeños (ruido)
 
 // Ecuación barométrica (ISA) para convertir presión relativa en altitud.
@@ -22,7 +25,7 @@ constexpr float MIN_VS_DT_SECONDS        = 0.03f;   // ignora dt demasiado peque
 constexpr float BARO_COEFF    = 44330.0f;       // metros a nivel del mar ISA
 constexpr float BARO_EXP      = 0.190294957f;   // 1 / 5.2558797
 constexpr float BARO_INV_EXP  = 5.2558797f;
-constexpr float M_TO_FT       = 3.2808399f;
+constexpr float BARO_ISA_P0   = 101325.0f;      // Pa, nivel del mar ISA
 
 // Auto ground-zero (drift lento en suelo)
 constexpr float   GZ_DRIFT_STEP_M          = 0.5f;      // ajuste máximo por iteración (m)
@@ -42,19 +45,37 @@ constexpr uint32_t AIRBORNE_CLEAR_MS         = 60000;    // suelo estable para l
 constexpr uint32_t RELOCATION_STABLE_MS      = 120000;   // quietud prolongada antes de re-cero por traslado
 constexpr float   RELOCATION_MIN_DELTA_M     = 10.0f;    // diferencia mínima para re-cero por traslado
 
+// Rechazo de lecturas aisladas de presión (Hampel, ver util/HampelFilter.h)
+constexpr uint8_t PRESS_OUTLIER_WINDOW       = 5;        // muestras (retardo máx. 2 ante escalones)
+constexpr float   PRESS_OUTLIER_MIN_PA       = 30.0f;    // umbral mínimo (~2.5 m a nivel del mar)
+
+// Pipeline multi-tasa (flujos decimados tras el sensor)
+constexpr float   ALT_DISPLAY_RATE_HZ        = 20.0f;    // altToShow (CIC orden 2)
+constexpr float   ALT_SLOW_RATE_HZ           = 1.0f;     // lógica de suelo (CIC orden 1)
+
 //---------------------------------------------
 // Servicio de Altimetría
 //---------------------------------------------
 //
 // - Inicializa refPressurePa con la primera lectura válida.
-// - Entrega altura relativa (respecto a refPressurePa), convertida a m/ft.
-// - Aplica offset de usuario (alturaOffset) en la misma unidad de UI.
+// - Entrega altura relativa (respecto a refPressurePa) y VS, siempre en SI.
+// - Aplica offset de usuario (alturaOffset, en metros).
 // - Calcula velocidad vertical y estado de suelo estable.
+// - Multi-tasa: altura/VS a la tasa del sensor, altToShow decimada a
+//   ALT_DISPLAY_RATE_HZ y lógica de suelo/deriva/traslado a ALT_SLOW_RATE_HZ.
+// - Historial multi-resolución (util/AltitudeHistory.h) de la altura
+//   publicada: las condiciones "durante N s" (suelo estable, quietud,
+//   traslado) son consultas sobre ventanas, no temporizadores sueltos.
 // - **Nuevo**: Recalibra automáticamente a 0 una sola vez, al detectar
 //   suelo estable por primera vez tras el arranque.
 //
 class AltimetryService {
 public:
+    // Hook por muestra cruda (ver core/AltitudeAlertService.h). sampleUs es
+    // micros() al terminar la lectura del sensor.
+    typedef void (*SampleHook)(float pressurePa, float refPressurePa, float offsetMeters,
+                               uint32_t sampleUs, uint32_t nowMs, void* user);
+
     AltimetryService() = default;
 
     void begin(Bmp390Driver* drv) { begin(drv, nullptr); }
@@ -69,15 +90,11 @@ public:
         lastAltMeters        = 0.0f;
         lastFilteredAlt      = 0.0f;
         lastUpdateMs         = 0;
-        groundStableSinceMs  = 0;
         isGroundStableFlag   = false;
         didInitialGroundZero = false;
         driftAccumMeters     = 0.0f;
         lastDriftAdjustMs    = 0;
-        stationarySinceMs    = 0;
-        farFromZeroSinceMs   = 0;
         airborneArmed        = false;
-        vsHighAccumMs        = 0;
         movementActive       = false;
         movementStartMs      = 0;
         moveStartAltMeters   = 0.0f;
@@ -88,6 +105,20 @@ public:
         movementLastSampleMs = 0;
         relocationDone       = false;
         lockActive           = false;
+        pressureOutlier.reset();
+        displayDecim.reset();
+        slowDecim.reset();
+        history.reset();
+        displayAltMeters     = NAN;
+        slowLastAlt          = NAN;
+        slowLastMs           = 0;
+        rateLastUs           = 0;
+        inputPeriodS         = 0.04f;
+    }
+
+    void setSampleHook(SampleHook fn, void* user) {
+        sampleHook     = fn;
+        sampleHookUser = user;
     }
 
     // Permite deshabilitar recalibraciones automáticas mientras el lock está activo.
@@ -104,6 +135,24 @@ public:
         if (!bmp->read(pressurePa, tempC)) {
             return;
         }
+        processSample(pressurePa, tempC, nowMs, micros());
+    }
+
+    // Resto de la cadena para una muestra ya leída. sampleUs es micros() al
+    // terminar la lectura. Público para poder alimentar el filtro con
+    // presiones sintéticas (tests de host).
+    void processSample(float pressurePa, float tempC, uint32_t nowMs, uint32_t sampleUs) {
+        lastSampleUs = sampleUs;
+
+        // 1b) Rechazo de picos aislados antes de convertir a altitud: una
+        //     lectura I2C corrupta no debe llegar al EMA, a la VS ni a las alertas.
+        uint32_t c0 = ESP.getCycleCount();
+        float cleanPa;
+        pressureOutlier.filter(pressurePa, cleanPa);
+        pressurePa = cleanPa;
+        uint32_t cyc = ESP.getCycleCount() - c0;
+        if (cyc > outlierMaxCycles) outlierMaxCycles = cyc;
+        outlierAvgCycles += 0.05f * ((float)cyc - outlierAvgCycles);
 
         // 2) Primera referencia de presión (toma el 0 físico inicial).
         if (!isfinite(refPressurePa)) {
@@ -116,6 +165,11 @@ public:
             }
         }
 
+        // 2b) Alertas: directamente sobre la presión cruda, antes de filtrar.
+        if (sampleHook) {
+            sampleHook(pressurePa, refPressurePa, offsetMetersFromSettings(), sampleUs, nowMs, sampleHookUser);
+        }
+
         // 3) Altura relativa en metros respecto a refPressurePa (ecuación barométrica ISA).
         float pressureRatio = pressurePa / refPressurePa;
         currentAltMeters = BARO_COEFF * (1.0f - powf(pressureRatio, BARO_EXP));
@@ -130,7 +184,9 @@ public:
         filteredAltMeters = filteredAltMeters +
                             ALT_FILTER_ALPHA * (currentAltMeters - filteredAltMeters);
 
-        float verticalSpeedMps = 0.0f;
+        // Entre deltas se repite la última VS: a ODR altas (SensorTask lee
+        // una vez por muestra) la mayoría de muestras llegan con dt < mínimo.
+        float verticalSpeedMps = altData.verticalSpeed.v;
         if (lastUpdateMs != 0) {
             float dt = (nowMs - lastUpdateMs) / 1000.0f;
             // Solo consumimos el delta si el dt es suficientemente grande.
@@ -148,62 +204,206 @@ public:
         }
         lastAltMeters   = currentAltMeters;
 
-        // 5) Unidad y offset (desde Settings, si existen)
-        UnitType unit       = UnitType::METERS;
-        float    offsetUnit = 0.0f;
-        if (settings) {
-            unit       = settings->unidadMetros;
-            offsetUnit = settings->alturaOffset;
+        // 4b) Pipeline multi-tasa (ver util/Decimator.h). Cada consumidor
+        //     recibe el ancho de banda que necesita:
+        //     - tasa completa: altData.rawAlt / verticalSpeed (fases,
+        //       grabadores, detección de apertura, alertas);
+        //     - pantalla: CIC de orden 2 hasta ALT_DISPLAY_RATE_HZ (altToShow);
+        //     - ALT_SLOW_RATE_HZ: media por bloques (CIC de orden 1) para
+        //       suelo estable, deriva de cero, movimiento y traslado.
+        updateStreamRatios(sampleUs);
+        float decOut = 0.0f;
+        if (displayDecim.push(filteredAltMeters, decOut)) {
+            displayAltMeters = decOut;
         }
 
-        // 6) Offset en METROS para decisiones backend (suelo)
-        float offsetMeters = offsetUnit;
-        if (unit == UnitType::FEET) {
-            offsetMeters = offsetUnit / M_TO_FT;
-        }
+        // 5) Offset de usuario (metros)
+        float offsetMeters = offsetMetersFromSettings();
 
-        // 7) Detección de "suelo" en términos de metros (independiente de unidad UI)
-        //    Cerca de suelo => altitud_rel_metros ≈ offset_metros
-        float relToGroundMeters = filteredAltMeters - offsetMeters; // 0 cuando UI debería estar en 0
-        bool nearGround = fabsf(relToGroundMeters) < GROUND_ALT_THRESH_METERS;
-        bool lowVS      = fabsf(verticalSpeedMps)  < GROUND_VS_THRESH_MPS;
+        // 6) Historial a tasa completa, antes de la lógica de suelo para que
+        //    vea el segundo recién cerrado.
+        history.push(nowMs, filteredAltMeters - offsetMeters, verticalSpeedMps);
 
-        // Quietud genérica (no necesariamente cerca de cero)
-        bool isStationary = (fabsf(verticalSpeedMps) < STATIONARY_VS_THRESH_MPS);
-        if (isStationary) {
-            if (stationarySinceMs == 0) stationarySinceMs = nowMs;
-        } else {
-            stationarySinceMs = 0;
+        // 7) Lógica de suelo a ALT_SLOW_RATE_HZ (sobre la altitud sin EMA:
+        //    el promedio del bloque ya filtra).
+        if (slowDecim.push(currentAltMeters, decOut)) {
+            updateGroundLogic(nowMs, pressurePa, decOut, offsetMeters);
         }
 
-        if (nearGround && lowVS) {
-            if (groundStableSinceMs == 0) {
-                groundStableSinceMs = nowMs;
-            }
-            isGroundStableFlag = (nowMs - groundStableSinceMs) >= GROUND_STABLE_TIME_MS;
-        } else {
-            groundStableSinceMs = 0;
-            isGroundStableFlag  = false;
+        // 9) Altura relativa al cero de usuario (la unidad de UI se aplica
+        //    sólo al presentar)
+        float dispMeters = isfinite(displayAltMeters) ? displayAltMeters : filteredAltMeters;
+        float altRel     = filteredAltMeters - offsetMeters;
+        float dispRel    = dispMeters - offsetMeters;   // lo que mostramos
+        float altToShow  = (fabsf(dispRel) < ALT_DEADBAND_METERS) ? 0.0f : dispRel;
+
+        // 10) Publicar datos
+        altData.rawAlt         = Meters(altRel);
+        altData.altToShow      = Meters(altToShow);
+        altData.verticalSpeed  = MetersPerSecond(verticalSpeedMps);
+        altData.isGroundStable = isGroundStableFlag;
+        altData.temperatureC   = tempC;
+        altData.pressure       = Pascals(pressurePa);
+    }
+
+    // Recalibra el cero a partir de la presión actual, fijando que la UI muestre desiredAlt
+    // (por defecto 0). Respeta el offset actual.
+    void recalibrateGround(Meters desiredAlt = Meters(0.0f)) {
+        if (!bmp) return;
+
+        float pressurePa = 0.0f;
+        float tempC      = 0.0f;
+        if (!bmp->read(pressurePa, tempC)) return;
+
+        // Queremos que alt_rel_m = desiredAlt_m  =>  alt_m = desiredAlt_m + offset_m
+        float targetAltMeters = desiredAlt.v + offsetMetersFromSettings();
+        refPressurePa         = computeRefPressure(pressurePa, targetAltMeters);
+
+        // Ajustes auxiliares para evitar saltos
+        currentAltMeters = targetAltMeters;
+        lastAltMeters    = currentAltMeters;
+        filteredAltMeters = targetAltMeters;
+        lastFilteredAlt   = filteredAltMeters;
+        resetStreams(targetAltMeters);
+    }
+
+    // Cero conocido antes de arrancar (presión de suelo guardada al entrar
+    // en deep sleep). Sustituye a la primera lectura y al auto-cero inicial,
+    // que en el avión pondrían el 0 a la altura actual.
+    void seedReference(float groundPa) {
+        if (!(groundPa > 90'000.0f && groundPa < 110'000.0f)) return;
+        refPressurePa        = groundPa;
+        didInitialGroundZero = true;
+    }
+
+    // Estado lento que sobrevive a un deep sleep (core/WarmStartService.h).
+    // Los filtros y el historial se rehacen con las primeras muestras.
+    struct WarmState {
+        float    refPressurePa        = NAN;
+        float    driftAccumMeters     = 0.0f;
+        bool     didInitialGroundZero = false;
+        bool     airborneArmed        = false;
+        bool     relocationDone       = false;
+        bool     movementActive       = false;
+        uint32_t movementStartMs      = 0;
+        uint32_t movementLastSampleMs = 0;
+        uint32_t lastVehicleStopMs    = 0;
+        uint32_t timeVsHighMs         = 0;
+        float    moveStartAltMeters   = 0.0f;
+        float    peakAltGainMeters    = 0.0f;
+        float    peakVsUp             = 0.0f;
+    };
+
+    void saveWarm(WarmState& w) const {
+        w.refPressurePa        = refPressurePa;
+        w.driftAccumMeters     = driftAccumMeters;
+        w.didInitialGroundZero = didInitialGroundZero;
+        w.airborneArmed        = airborneArmed;
+        w.relocationDone       = relocationDone;
+        w.movementActive       = movementActive;
+        w.movementStartMs      = movementStartMs;
+        w.movementLastSampleMs = movementLastSampleMs;
+        w.lastVehicleStopMs    = lastVehicleStopMs;
+        w.timeVsHighMs         = timeVsHighMs;
+        w.moveStartAltMeters   = moveStartAltMeters;
+        w.peakAltGainMeters    = peakAltGainMeters;
+        w.peakVsUp             = peakVsUp;
+    }
+
+    // Tras begin(). shiftMs pasa los millis() guardados al reloj actual
+    // (0 = temporizador sin usar). La primera muestra da ya la altitud
+    // respecto al cero restaurado, sin esperar al auto-cero.
+    void restoreWarm(const WarmState& w, uint32_t shiftMs) {
+        if (!(w.refPressurePa > 90'000.0f && w.refPressurePa < 110'000.0f)) return;
+        refPressurePa        = w.refPressurePa;
+        driftAccumMeters     = w.driftAccumMeters;
+        didInitialGroundZero = w.didInitialGroundZero;
+        airborneArmed        = w.airborneArmed;
+        relocationDone       = w.relocationDone;
+        movementActive       = w.movementActive;
+        movementStartMs      = w.movementStartMs      ? w.movementStartMs + shiftMs      : 0;
+        movementLastSampleMs = w.movementLastSampleMs ? w.movementLastSampleMs + shiftMs : 0;
+        lastVehicleStopMs    = w.lastVehicleStopMs    ? w.lastVehicleStopMs + shiftMs    : 0;
+        timeVsHighMs         = w.timeVsHighMs;
+        moveStartAltMeters   = w.moveStartAltMeters;
+        peakAltGainMeters    = w.peakAltGainMeters;
+        peakVsUp             = w.peakVsUp;
+        // El EMA arranca en la primera muestra en vez de subir desde 0.
+        filteredAltMeters    = NAN;
+    }
+
+    // Acceso a datos de salida
+    AltitudeData getAltitudeData() const { return altData; }
+
+    // Getters útiles para debug
+    float getRefPressurePa() const { return refPressurePa; }
+
+    // Salud del bus/sensor: lecturas de presión rechazadas como picos y coste
+    // del filtro (ciclos de CPU por muestra).
+    uint32_t getRejectedSamples() const { return pressureOutlier.getRejected(); }
+    uint32_t getFilteredSamples() const { return pressureOutlier.getTotal(); }
+    uint32_t getOutlierMaxCycles() const { return outlierMaxCycles; }
+    float    getOutlierAvgCycles() const { return outlierAvgCycles; }
+
+    // micros() de la última lectura válida del sensor.
+    uint32_t getSampleUs() const { return lastSampleUs; }
+
+    // Altura (m sobre refPressurePa) de la última muestra, sin EMA.
+    float getSensorAltMeters() const { return currentAltMeters; }
+
+    // Altura de presión ISA (sobre BARO_ISA_P0) de la última muestra, sin EMA.
+    // No salta con los re-ceros de suelo (deriva, traslado): es la que usa
+    // SensorGovernor para medir ruido.
+    float getPressureAltMeters() const {
+        return BARO_COEFF * (1.0f - powf(altData.pressure.v / BARO_ISA_P0, BARO_EXP));
+    }
+
+    // Historial de altura (m sobre el cero de usuario) y VS, para consultas
+    // por ventana y gráficas.
+    const AltitudeHistory& getHistory() const { return history; }
+
+private:
+    Bmp390Driver*   bmp       = nullptr;
+    const Settings* settings  = nullptr;
+    SampleHook      sampleHook     = nullptr;
+    void*           sampleHookUser = nullptr;
+
+    float offsetMetersFromSettings() const {
+        return settings ? settings->alturaOffset.v : 0.0f;
+    }
+
+    AltitudeData altData{};
+
+    // Suelo estable, auto ground-zero, deriva, sesiones de movimiento y re-cero
+    // por traslado. Corre sólo con cada muestra del flujo lento (altM = media
+    // del bloque, en metros sobre refPressurePa).
+    void updateGroundLogic(uint32_t nowMs, float pressurePa, float altM, float offsetMeters) {
+        float    vsMps    = 0.0f;
+        uint32_t slowDtMs = (slowLastMs != 0) ? (nowMs - slowLastMs) : 0;
+        if (slowDtMs > 0 && isfinite(slowLastAlt)) {
+            vsMps = (altM - slowLastAlt) / (slowDtMs / 1000.0f);
         }
+        slowLastAlt = altM;
+        slowLastMs  = nowMs;
+
+        // Distancia al cero de usuario (0 cuando la UI debería marcar 0).
+        float relToGroundMeters = altM - offsetMeters;
+
+        // Quietud en el último segundo, para abrir sesiones de movimiento.
+        bool isStationary = stationaryFor(nowMs, 1000);
+
+        // Condiciones sostenidas: ventanas del historial.
+        isGroundStableFlag = groundStableFor(nowMs, GROUND_STABLE_TIME_MS);
 
         // Latch de “airborne” si estamos lejos del cero o con VS alta durante tiempo.
-        bool farFromZero = fabsf(relToGroundMeters) > FAR_FROM_ZERO_M;
-        if (farFromZero) {
-            if (farFromZeroSinceMs == 0) farFromZeroSinceMs = nowMs;
-            else if ((nowMs - farFromZeroSinceMs) >= FAR_FROM_ZERO_MIN_MS) {
-                airborneArmed = true;
-            }
-        } else {
-            farFromZeroSinceMs = 0;
+        AltitudeHistory::Window w;
+        if (fullWindow(nowMs, FAR_FROM_ZERO_MIN_MS, w) &&
+            (w.altMin > FAR_FROM_ZERO_M || w.altMax < -FAR_FROM_ZERO_M)) {
+            airborneArmed = true;
         }
-
-        if (verticalSpeedMps > MOVING_VS_HIGH_MPS) {
-            vsHighAccumMs += (lastUpdateMs != 0) ? (nowMs - lastUpdateMs) : 0;
-            if (vsHighAccumMs >= MOVING_HIGH_VS_TIME_MS) {
-                airborneArmed = true;
-            }
-        } else {
-            vsHighAccumMs = 0;
+        if (fullWindow(nowMs, MOVING_HIGH_VS_TIME_MS, w) &&
+            w.vsMeanMin > MOVING_VS_HIGH_MPS) {
+            airborneArmed = true;
         }
 
         // 8) **Recalibración automática una sola vez** cuando hay suelo estable.
@@ -214,10 +414,11 @@ public:
             filteredAltMeters    = offsetMeters;
             lastAltMeters        = currentAltMeters;  // evita pico de VS
             lastFilteredAlt      = filteredAltMeters;
-            groundStableSinceMs  = nowMs;             // mantenemos estado
             didInitialGroundZero = true;
             driftAccumMeters     = 0.0f;
             lastDriftAdjustMs    = nowMs;
+            resetStreams(offsetMeters);
+            altM                 = offsetMeters;
             // No return: continuamos para proyectar a unidad/ui y publicar altData
         }
 
@@ -244,6 +445,7 @@ public:
                     lastAltMeters      = currentAltMeters;
                     lastFilteredAlt    = filteredAltMeters;
                     driftAccumMeters   = newAccum;
+                    resetStreams(altM - step);
                 }
                 lastDriftAdjustMs = nowMs;
             }
@@ -253,26 +455,25 @@ public:
         }
 
         // Gestión de movimiento (sesiones para clasificar avión vs vehículo).
-        bool longStationary = (stationarySinceMs != 0) &&
-                              ((nowMs - stationarySinceMs) >= MOVEMENT_END_STATIONARY_MS);
+        bool longStationary = stationaryFor(nowMs, MOVEMENT_END_STATIONARY_MS);
 
         if (!movementActive && !isStationary) {
             movementActive     = true;
             movementStartMs    = nowMs;
-            moveStartAltMeters = filteredAltMeters;
+            moveStartAltMeters = altM;
             peakAltGainMeters  = 0.0f;
-            peakVsUp           = verticalSpeedMps;
+            peakVsUp           = vsMps;
             timeVsHighMs       = 0;
             movementLastSampleMs = nowMs;
             relocationDone     = false; // permitir nuevo re-cero tras este traslado
         }
 
         if (movementActive) {
-            float gain = filteredAltMeters - moveStartAltMeters;
+            float gain = altM - moveStartAltMeters;
             if (gain > peakAltGainMeters) peakAltGainMeters = gain;
-            if (verticalSpeedMps > peakVsUp) peakVsUp = verticalSpeedMps;
+            if (vsMps > peakVsUp) peakVsUp = vsMps;
 
-            if (verticalSpeedMps > MOVING_VS_HIGH_MPS && movementLastSampleMs != 0) {
+            if (vsMps > MOVING_VS_HIGH_MPS && movementLastSampleMs != 0) {
                 timeVsHighMs += (nowMs - movementLastSampleMs);
             }
 
@@ -300,7 +501,7 @@ public:
         if (airborneArmed &&
             isGroundStableFlag &&
             !lockActive &&
-            (nowMs - groundStableSinceMs) >= AIRBORNE_CLEAR_MS) {
+            groundStableFor(nowMs, AIRBORNE_CLEAR_MS)) {
             airborneArmed = false;
         }
 
@@ -309,9 +510,8 @@ public:
         bool relocationEligible =
             !airborneArmed &&
             !lockActive &&
-            (stationarySinceMs != 0) &&
-            ((nowMs - stationarySinceMs) >= RELOCATION_STABLE_MS) &&
             (fabsf(relToGroundMeters) > RELOCATION_MIN_DELTA_M) &&
+            stationaryFor(nowMs, RELOCATION_STABLE_MS) &&
             !relocationDone;
 
         if (relocationEligible) {
@@ -324,74 +524,67 @@ public:
             lastDriftAdjustMs    = nowMs;
             didInitialGroundZero = true;
             relocationDone       = true;
+            resetStreams(offsetMeters);
         }
+    }
 
-        // 9) Proyección a unidad del usuario y aplicación de offset
-        float altInUnit = filteredAltMeters;
-        float vsUnit    = verticalSpeedMps;
-        if (unit == UnitType::FEET) {
-            altInUnit *= M_TO_FT;
-            vsUnit    *= M_TO_FT;
-        }
-
-        float altRel    = altInUnit - offsetUnit;  // lo que mostramos
-        float deadbandU = ALT_DEADBAND_METERS * ((unit == UnitType::FEET) ? M_TO_FT : 1.0f);
-        float altToShow = (fabsf(altRel) < deadbandU) ? 0.0f : altRel;
-
-        // 10) Publicar datos
-        altData.rawAlt         = altRel;
-        altData.altToShow      = altToShow;
-        altData.verticalSpeed  = vsUnit;
-        altData.isGroundStable = isGroundStableFlag;
-        altData.temperatureC   = tempC;
+    // Ventana de los últimos ms (redondeado a segundos) con todos sus segundos
+    // presentes en el historial.
+    bool fullWindow(uint32_t nowMs, uint32_t ms, AltitudeHistory::Window& w) const {
+        uint32_t secs = (ms + 999u) / 1000u;
+        return history.window(nowMs, secs, w) && w.seconds >= secs;
     }
 
-    // Recalibra el cero a partir de la presión actual, fijando que la UI muestre desiredAltUnit
-    // (por defecto 0). Respeta unidades y offset actual.
-    void recalibrateGround(float desiredAltUnit = 0.0f) {
-        if (!bmp) return;
+    // Quieto (|VS media por segundo| baja) durante los últimos ms.
+    bool stationaryFor(uint32_t nowMs, uint32_t ms) const {
+        AltitudeHistory::Window w;
+        return fullWindow(nowMs, ms, w) && w.vsMeanAbsMax() < STATIONARY_VS_THRESH_MPS;
+    }
 
-        float pressurePa = 0.0f;
-        float tempC      = 0.0f;
-        if (!bmp->read(pressurePa, tempC)) return;
+    // Cerca del cero y quieto durante los últimos ms.
+    bool groundStableFor(uint32_t nowMs, uint32_t ms) const {
+        AltitudeHistory::Window w;
+        return fullWindow(nowMs, ms, w) &&
+               w.altMin > -GROUND_ALT_THRESH_METERS &&
+               w.altMax <  GROUND_ALT_THRESH_METERS &&
+               w.vsMeanAbsMax() < GROUND_VS_THRESH_MPS;
+    }
 
-        UnitType unit = UnitType::METERS;
-        if (settings) unit = settings->unidadMetros;
+    // Tras mover refPressurePa: los bloques en curso de los decimadores
+    // mezclarían dos referencias, y el historial se desplaza lo mismo que
+    // el cero. altNowM = altitud (m) en la nueva referencia.
+    void resetStreams(float altNowM) {
+        if (isfinite(slowLastAlt)) history.rebase(altNowM - slowLastAlt);
+        displayDecim.reset();
+        slowDecim.reset();
+        displayAltMeters = filteredAltMeters;
+        slowLastAlt      = altNowM;
+    }
 
-        float desiredAltMeters = desiredAltUnit;
-        if (unit == UnitType::FEET) {
-            desiredAltMeters = desiredAltUnit / M_TO_FT;
+    // Razones de decimación a partir de la tasa real de muestras (cambia con
+    // el modo del sensor). Histéresis del 25% para no reiniciar por jitter.
+    void updateStreamRatios(uint32_t sampleUs) {
+        if (rateLastUs != 0) {
+            float dt = (sampleUs - rateLastUs) * 1e-6f;
+            if (dt > 0.0f && dt < 2.0f) {
+                inputPeriodS += 0.05f * (dt - inputPeriodS);
+            }
         }
+        rateLastUs = sampleUs;
+        float rateHz = 1.0f / inputPeriodS;
+        retune(displayDecim, rateHz / ALT_DISPLAY_RATE_HZ);
+        retune(slowDecim,    rateHz / ALT_SLOW_RATE_HZ);
+    }
 
-        // Queremos que alt_rel_m = desiredAlt_m  =>  alt_m = desiredAlt_m + offset_m
-        float offsetMeters = 0.0f;
-        if (settings) {
-            float offU = settings->alturaOffset;
-            offsetMeters = (unit == UnitType::FEET) ? (offU / M_TO_FT) : offU;
+    template <typename D>
+    static void retune(D& dec, float target) {
+        if (target < 1.0f) target = 1.0f;
+        float cur = (float)dec.getRatio();
+        if (fabsf(target - cur) > 0.25f * cur + 0.5f) {
+            dec.setRatio((uint16_t)lroundf(target));
         }
-
-        float targetAltMeters = desiredAltMeters + offsetMeters;
-        refPressurePa         = computeRefPressure(pressurePa, targetAltMeters);
-
-        // Ajustes auxiliares para evitar saltos
-        currentAltMeters = targetAltMeters;
-        lastAltMeters    = currentAltMeters;
-        filteredAltMeters = targetAltMeters;
-        lastFilteredAlt   = filteredAltMeters;
     }
 
-    // Acceso a datos de salida
-    AltitudeData getAltitudeData() const { return altData; }
-
-    // Getters útiles para debug
-    float getRefPressurePa() const { return refPressurePa; }
-
-private:
-    Bmp390Driver*   bmp       = nullptr;
-    const Settings* settings  = nullptr;
-
-    AltitudeData altData{};
-
     // Conversión inversa de la ecuación barométrica: devuelve la presión de referencia
     // necesaria para que la altitud calculada sea targetAltMeters cuando medimos pressurePa.
     float computeRefPressure(float pressurePa, float targetAltMeters) const {
@@ -409,12 +602,23 @@ private:
     float    lastAltMeters        = 0.0f;
     float    lastFilteredAlt      = 0.0f;
     uint32_t lastUpdateMs         = 0;
+    uint32_t lastSampleUs         = 0;
+
+    HampelFilter<PRESS_OUTLIER_WINDOW> pressureOutlier{PRESS_OUTLIER_MIN_PA};
+    uint32_t outlierMaxCycles     = 0;
+    float    outlierAvgCycles     = 0.0f;
+
+    // Flujos decimados
+    CicDecimator<2> displayDecim;
+    CicDecimator<1> slowDecim;
+    AltitudeHistory history;
+    float    displayAltMeters     = NAN;
+    float    slowLastAlt          = NAN;
+    uint32_t slowLastMs           = 0;
+    uint32_t rateLastUs           = 0;
+    float    inputPeriodS         = 0.04f;
 
-    uint32_t groundStableSinceMs  = 0;
     bool     isGroundStableFlag   = false;
-    uint32_t stationarySinceMs    = 0;
-    uint32_t farFromZeroSinceMs   = 0;
-    uint32_t vsHighAccumMs        = 0;
     bool     airborneArmed        = false;
 
     // Nuevo: bandera para hacer la recalibración inicial sólo una vez
@@ -0,0 +1,315 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+
+#include "util/Types.h"
+#include "core/SettingsService.h"
+#include "core/AltimetryService.h"
+#include "drivers/LcdDriver.h"
+
+// Motor de alertas de altitud.
+//
+// - Se evalúa en cada muestra del sensor, desde el propio AltimetryService
+//   (setSampleHook), no por frame de UI: el aviso sale en la misma vuelta en
+//   que se lee la presión, antes del filtrado y del resto del loop.
+// - Los umbrales (AlertConfig, en metros sobre el cero de UI) se precalculan
+//   a presión con la inversa de la ecuación barométrica, y sólo se recalculan
+//   si cambian la configuración, la presión de referencia o el offset. Cada
+//   comprobación es una comparación de floats contra la presión cruda.
+// - La configuración es una copia propia: tras begin() sólo cambia con
+//   setConfig() desde la tarea del sensor (SensorTask::setAlertConfig), nunca
+//   leyendo Settings que la UI o el BLE pueden estar escribiendo.
+// - Histéresis: una alerta se dispara al bajar de su altitud y sólo se rearma
+//   tras volver a subir hysteresisM por encima.
+// - Cada alerta tiene fases válidas: las de caída libre (avisos, breakoff,
+//   pull, hard deck) sólo en FREEFALL y las de vela sólo en CANOPY. Un cruce
+//   en otra fase (p.ej. el avión descendiendo) consume la alerta sin avisar.
+// - Aviso visual a través de LcdDriver: inversión de píxeles por hardware y
+//   backlight a tope, en un patrón de destellos por tipo de alerta. El primer
+//   destello se aplica dentro del hook; tick() lleva el resto sin bloquear.
+//   Todo corre en la tarea del sensor: si la UI está enviando un frame, la
+//   inversión sale al cerrarlo (LcdDriver), el backlight al instante.
+//
+// Presupuesto de latencia: desde que termina la lectura del sensor hasta que
+// el primer destello está aplicado en el panel deben pasar menos de
+// ALERT_LATENCY_BUDGET_US. El final se toma cuando LcdDriver envía de verdad
+// la inversión (syncInverse), no cuando se pide: si la UI tenía el bus, eso
+// es al cerrar su frame. Se mide en cada disparo y se registra el máximo.
+// Nada de Serial en el hook: el último disparo lo saca la consola de debug.
+
+#ifndef ALERT_LATENCY_BUDGET_US
+#define ALERT_LATENCY_BUDGET_US  2000u
+#endif
+#ifndef ALERT_HARD_DECK_MAX_MS
+#define ALERT_HARD_DECK_MAX_MS   10000u   // hard deck destella mientras siga en FREEFALL
+#endif
+
+class AltitudeAlertService {
+public:
+    enum class Kind : uint8_t { FREEFALL, BREAKOFF, PULL, HARD_DECK, CANOPY };
+
+    void begin(LcdDriver* lcdDrv, const AlertConfig& initial) {
+        lcd      = lcdDrv;
+        want     = initial;
+        cfg      = AlertConfig{};
+        count    = 0;
+        cfgRef   = NAN;
+        cfgOff   = NAN;
+        phase    = FlightPhase::GROUND;
+        active   = false;
+        maxLatencyUs  = 0;
+        overBudget    = 0;
+        firedCount    = 0;
+        lastLatencyUs = 0;
+        latPending    = false;
+    }
+
+    // Nueva configuración. Sólo desde la tarea del sensor; se aplica en la
+    // siguiente muestra conservando el armado de los umbrales que no cambian.
+    void setConfig(const AlertConfig& c) { want = c; }
+
+    // Fase actual (FlightPhaseService). La del ciclo anterior basta: las
+    // alertas de caída libre están muy por debajo de la confirmación de salida.
+    void setPhase(FlightPhase p) { phase = p; }
+
+    // Hook para AltimetryService::setSampleHook().
+    static void onSampleHook(float pressurePa, float refPressurePa, float offsetMeters,
+                             uint32_t sampleUs, uint32_t nowMs, void* user) {
+        AltitudeAlertService* self = static_cast<AltitudeAlertService*>(user);
+        if (self) self->onSample(pressurePa, refPressurePa, offsetMeters, sampleUs, nowMs);
+    }
+
+    void onSample(float pressurePa, float refPressurePa, float offsetMeters,
+                  uint32_t sampleUs, uint32_t nowMs) {
+        if (!lcd) return;
+        if (!want.enabled) {
+            if (active) stopPattern();
+            count = 0;
+            cfg.enabled = false;
+            return;
+        }
+        if (want != cfg || refPressurePa != cfgRef || offsetMeters != cfgOff) {
+            rebuild(want, refPressurePa, offsetMeters);
+        }
+
+        for (uint8_t i = 0; i < count; ++i) {
+            Threshold& th = th_[i];
+            if (!th.armed) {
+                if (pressurePa <= th.armPa) th.armed = true;
+                continue;
+            }
+            if (pressurePa < th.firePa) continue;
+
+            th.armed = false;
+            if (!phaseAllows(th.kind)) continue;
+            fire(th, sampleUs, nowMs);
+        }
+
+        tick(nowMs);
+    }
+
+    // Avanza el patrón de destellos. Se llama desde el hook y en cada ciclo
+    // (por si el sensor no entrega muestra en alguna vuelta).
+    void tick(uint32_t nowMs) {
+        settleLatency();
+        if (!active) return;
+        if ((int32_t)(nowMs - nextStepMs) < 0) return;
+
+        if (curKind == Kind::HARD_DECK) {
+            // Continuo mientras siga en caída libre, con tope de seguridad.
+            bool keep = (phase == FlightPhase::FREEFALL) &&
+                        (nowMs - patternStartMs) < ALERT_HARD_DECK_MAX_MS;
+            if (!keep && !flashOn) {
+                stopPattern();
+                return;
+            }
+        } else if (stepsLeft == 0) {
+            stopPattern();
+            return;
+        }
+
+        setFlash(!flashOn);
+        if (stepsLeft > 0) stepsLeft--;
+        nextStepMs = nowMs + stepMs;
+    }
+
+    bool     isActive()          const { return active; }
+    uint32_t getMaxLatencyUs()   const { return maxLatencyUs; }
+    uint32_t getOverBudgetCount()const { return overBudget; }
+    uint32_t getFiredCount()     const { return firedCount; }
+    uint32_t getLastLatencyUs()  const { return lastLatencyUs; }
+    bool     isLatencyPending()  const { return latPending; }
+    uint16_t getLastAltM()       const { return lastAltM; }
+    const char* getLastKindName()const { return kindName(lastKind); }
+
+private:
+    static constexpr uint8_t MAX_THRESHOLDS = ALERT_FF_MAX + 3 + ALERT_CANOPY_MAX;
+
+    struct Threshold {
+        float    firePa = NAN;   // presión a la altitud de la alerta
+        float    armPa  = NAN;   // presión a altitud + histéresis
+        uint16_t altM   = 0;
+        Kind     kind   = Kind::FREEFALL;
+        bool     armed  = false;
+    };
+
+    // Patrón por tipo: medio periodo (ms) y nº de destellos.
+    struct Pattern { uint16_t stepMs; uint8_t flashes; uint8_t priority; };
+    static Pattern patternFor(Kind k) {
+        switch (k) {
+        case Kind::FREEFALL:  return {250, 2, 1};
+        case Kind::BREAKOFF:  return {150, 3, 2};
+        case Kind::PULL:      return {100, 6, 3};
+        case Kind::HARD_DECK: return { 80, 0, 4};   // continuo (ver tick)
+        case Kind::CANOPY:    return {400, 1, 1};
+        }
+        return {250, 1, 0};
+    }
+
+    bool phaseAllows(Kind k) const {
+        if (k == Kind::CANOPY) return phase == FlightPhase::CANOPY;
+        return phase == FlightPhase::FREEFALL;
+    }
+
+    // Presión a la que AltimetryService calcularía altM (sobre el cero de UI).
+    static float pressureAt(float refPa, float offsetM, float altM) {
+        float ratio = 1.0f - ((altM + offsetM) / BARO_COEFF);
+        if (ratio <= 0.0f) ratio = 0.01f;
+        return refPa * powf(ratio, BARO_INV_EXP);
+    }
+
+    void add(Kind kind, uint16_t altM, uint16_t hystM) {
+        if (altM == 0 || count >= MAX_THRESHOLDS) return;
+        Threshold& th = th_[count++];
+        th.kind  = kind;
+        th.altM  = altM;
+        th.firePa = pressureAt(cfgRef, cfgOff, (float)altM);
+        th.armPa  = pressureAt(cfgRef, cfgOff, (float)altM + (float)hystM);
+        th.armed  = false;
+    }
+
+    void rebuild(const AlertConfig& c, float refPa, float offsetM) {
+        // Conserva el armado por tipo/altitud para que un re-cero en suelo o
+        // un cambio de offset no rearme ni consuma alertas.
+        Threshold old[MAX_THRESHOLDS];
+        uint8_t   oldCount = count;
+        for (uint8_t i = 0; i < oldCount; ++i) old[i] = th_[i];
+
+        cfg    = c;
+        cfgRef = refPa;
+        cfgOff = offsetM;
+        count  = 0;
+        if (!isfinite(refPa)) return;
+
+        for (uint8_t i = 0; i < ALERT_FF_MAX; ++i)     add(Kind::FREEFALL, c.ffAltM[i], c.hysteresisM);
+        add(Kind::BREAKOFF,  c.breakoffM, c.hysteresisM);
+        add(Kind::PULL,      c.pullM,     c.hysteresisM);
+        add(Kind::HARD_DECK, c.hardDeckM, c.hysteresisM);
+        for (uint8_t i = 0; i < ALERT_CANOPY_MAX; ++i) add(Kind::CANOPY,   c.canopyAltM[i], c.hysteresisM);
+
+        for (uint8_t i = 0; i < count; ++i) {
+            for (uint8_t j = 0; j < oldCount; ++j) {
+                if (old[j].kind == th_[i].kind && old[j].altM == th_[i].altM) {
+                    th_[i].armed = old[j].armed;
+                    break;
+                }
+            }
+        }
+    }
+
+    void fire(const Threshold& th, uint32_t sampleUs, uint32_t nowMs) {
+        Pattern p = patternFor(th.kind);
+        if (active && p.priority < curPriority) return;   // no pisar uno más grave
+
+        if (!active) savedBacklight = lcd->getBacklight();
+        active         = true;
+        curKind        = th.kind;
+        curPriority    = p.priority;
+        stepMs         = p.stepMs;
+        stepsLeft      = p.flashes ? (uint16_t)(p.flashes * 2 - 1) : 0;  // el primer "on" ya va aquí
+        patternStartMs = nowMs;
+        nextStepMs     = nowMs + stepMs;
+
+        // Orden: la consola de debug ve el contador nuevo sólo con la medida
+        // ya marcada como pendiente.
+        lastKind     = th.kind;
+        lastAltM     = th.altM;
+        latSampleUs  = sampleUs;
+        latSends     = lcd->getInverseSendCount();
+        latPending   = true;
+        firedCount   = firedCount + 1;
+        setFlash(true);
+        settleLatency();
+    }
+
+    // Cierra la medida del último disparo cuando el panel ya muestra la
+    // inversión: o se envió tras el disparo, o ya estaba invertido.
+    void settleLatency() {
+        if (!latPending) return;
+        uint32_t doneUs;
+        if (lcd->getInverseSendCount() != latSends) doneUs = lcd->getInverseSentUs();
+        else if (lcd->isInverseSent())              doneUs = micros();
+        else return;   // pendiente del endRender() de la UI
+
+        latPending = false;
+        uint32_t lat = doneUs - latSampleUs;
+        lastLatencyUs = lat;
+        if (lat > maxLatencyUs) maxLatencyUs = lat;
+        if (lat > ALERT_LATENCY_BUDGET_US) overBudget++;
+    }
+
+    void setFlash(bool on) {
+        flashOn = on;
+        lcd->setInverse(on);
+        lcd->setBacklight(on ? 255 : savedBacklight);
+    }
+
+    void stopPattern() {
+        if (flashOn) setFlash(false);
+        active      = false;
+        curPriority = 0;
+    }
+
+    static const char* kindName(Kind k) {
+        switch (k) {
+        case Kind::FREEFALL:  return "FF";
+        case Kind::BREAKOFF:  return "BREAKOFF";
+        case Kind::PULL:      return "PULL";
+        case Kind::HARD_DECK: return "HARD_DECK";
+        case Kind::CANOPY:    return "CANOPY";
+        }
+        return "?";
+    }
+
+    LcdDriver*  lcd = nullptr;
+
+    AlertConfig want;        // pedida (setConfig)
+    AlertConfig cfg;         // con la que están calculados los umbrales
+    float       cfgRef = NAN;
+    float       cfgOff = NAN;
+    Threshold   th_[MAX_THRESHOLDS];
+    uint8_t     count  = 0;
+
+    FlightPhase phase = FlightPhase::GROUND;
+
+    bool     active         = false;
+    bool     flashOn        = false;
+    Kind     curKind        = Kind::FREEFALL;
+    uint8_t  curPriority    = 0;
+    uint16_t stepMs         = 0;
+    uint16_t stepsLeft      = 0;
+    uint32_t patternStartMs = 0;
+    uint32_t nextStepMs     = 0;
+    uint8_t  savedBacklight = 0;
+
+    uint32_t maxLatencyUs = 0;
+    uint32_t overBudget   = 0;
+    volatile uint32_t firedCount = 0;
+    uint32_t lastLatencyUs = 0;
+    Kind     lastKind      = Kind::FREEFALL;
+    uint16_t lastAltM      = 0;
+
+    volatile bool latPending = false;
+    uint32_t latSampleUs = 0;
+    uint32_t latSends    = 0;
+};
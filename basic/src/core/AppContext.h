@@ -4,6 +4,9 @@
 #include "core/FlightPhaseService.h"
 #include "core/SleepPolicyService.h"
 #include "core/UiStateService.h"
+#include "core/SensorTask.h"
+#include "core/AltitudeAlertService.h"
+#include "drivers/I2cBus.h"
 #include "drivers/Bmp390Driver.h"
 #include "drivers/RtcDs3231Driver.h"
 #include "drivers/LcdDriver.h"
@@ -11,6 +14,7 @@
 #include "drivers/BatteryMonitor.h"
 #include "drivers/PowerHw.h"
 #include "ui/UiRenderer.h"
+#include "util/BootTimeline.h"
 
 // Centralised context for passing references to the various services
 // and drivers used in the application.  This simplifies dependency
@@ -21,7 +25,10 @@ struct AppContext {
     FlightPhaseService* flight     = nullptr;
     SleepPolicyService* sleep      = nullptr;
     UiStateService*     uiState    = nullptr;
+    SensorTask*         sensor     = nullptr;   // dueño de altimetría/BMP tras setup()
+    AltitudeAlertService* alerts   = nullptr;   // corre en la tarea del sensor; aquí sólo contadores
 
+    I2cBus*            i2c        = nullptr;
     Bmp390Driver*      bmp        = nullptr;
     RtcDs3231Driver*   rtc        = nullptr;
     LcdDriver*         lcd        = nullptr;
@@ -29,4 +36,5 @@ struct AppContext {
     BatteryMonitor*    battery    = nullptr;
     PowerHw*           power      = nullptr;
     UiRenderer*        uiRenderer = nullptr;
+    BootTimeline*      boot       = nullptr;
 };
\ No newline at end of file
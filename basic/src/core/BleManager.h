@@ -5,7 +5,10 @@
 #include "drivers/LcdDriver.h"
 #include "drivers/BatteryMonitor.h"
 #include "drivers/RtcDs3231Driver.h"
+#include "util/CivilTime.h"
 #include "core/LogbookService.h"
+#include "core/StorageService.h"
+#include "drivers/PmLock.h"
 
 #if BLE_FEATURE_ENABLED
 #include <Arduino.h>
@@ -28,7 +31,12 @@ public:
 #if BLE_FEATURE_ENABLED
     BleManager() = default;
 
+    // Se llama tras la primera altitud en pantalla (lazyInit en main.cpp):
+    // levantar Bluedroid cuesta decenas de ms.
     void begin(const Settings& settings) {
+        if (begun) return;
+        begun = true;
+        xferLock.begin(PmLock::Kind::CPU_MAX, "ble");
         enabled = settings.bleEnabled;
         pin = settings.blePin;
         name = settings.bleName;
@@ -48,7 +56,7 @@ public:
                     LcdDriver* lcdPtr,
                     BatteryMonitor* battPtr,
                     RtcDs3231Driver* rtcPtr,
-                    LogbookService* logPtr) {
+                    StorageService* logPtr) {
         settings      = settingsPtr;
         settingsSvc   = settingsSvcPtr;
         lcd           = lcdPtr;
@@ -57,7 +65,18 @@ public:
         logbook       = logPtr;
     }
 
+    // Las alertas las evalúa la tarea del sensor con su propia copia: un
+    // cambio por BLE se le pasa por este hook (SensorTask::setAlertConfig) y
+    // sólo se guarda si lo acepta.
+    typedef bool (*AlertsHook)(const AlertConfig& alerts, void* user);
+    void setAlertsHook(AlertsHook fn, void* user) {
+        alertsHook     = fn;
+        alertsHookUser = user;
+    }
+
     void setEnabled(bool on) {
+        // Antes de begin() no hay nada que encender: begin() lee bleEnabled.
+        if (!begun) return;
         if (on == enabled) return;
         enabled = on;
         if (enabled) {
@@ -97,7 +116,7 @@ private:
                 mgr->connected = false;
                 mgr->authed = false;
                 mgr->cancelOta();
-                mgr->busy = false;
+                mgr->setBusy(false);
                 mgr->updateStatus();
                 if (mgr->enabled) {
                     mgr->startAdvertising();
@@ -251,8 +270,7 @@ private:
         }
         if (strcmp(type, "set_time") == 0 && rtc) {
             uint32_t epoch = doc["epoch"] | 0;
-            UtcDateTime dt{};
-            epochToUtc(epoch, dt);
+            UtcDateTime dt = CivilTime::epochToUtc(epoch);
             rtc->setUtc(dt);
             sendControlResp("{\"type\":\"set_time\",\"ok\":true}");
             return;
@@ -326,7 +344,7 @@ private:
             return;
         }
         otaInProgress = true;
-        busy = true;
+        setBusy(true);
         otaExpectedSize = sz;
         otaWritten = 0;
         otaHashExpected = hash;
@@ -411,18 +429,27 @@ private:
             return;
         }
         otaInProgress = false;
-        busy = false;
+        setBusy(false);
         sendControlResp("{\"type\":\"ota_end\",\"ok\":true}");
         delay(200);
         ESP.restart();
     }
 
+    // Candado "transferencia BLE": frecuencia máxima y sin light sleep
+    // mientras dura una OTA o un volcado de bitácora.
+    void setBusy(bool b) {
+        if (b == busy) return;
+        busy = b;
+        if (b) xferLock.acquire();
+        else   xferLock.release();
+    }
+
     void cancelOta() {
         if (otaInProgress) {
             Update.abort();
         }
         otaInProgress = false;
-        busy = false;
+        setBusy(false);
     }
 
     void sendSettings() {
@@ -430,7 +457,7 @@ private:
             sendControlResp("{\"type\":\"get_settings\",\"ok\":false}");
             return;
         }
-        StaticJsonDocument<256> doc;
+        StaticJsonDocument<512> doc;
         doc["type"] = "get_settings";
         doc["unit"] = (settings->unidadMetros == UnitType::METERS) ? "m" : "ft";
         doc["lang"] = (settings->idioma == Language::ES) ? "es" : "en";
@@ -440,11 +467,69 @@ private:
         doc["hudMask"] = settings->hud.toMask();
         doc["hudClean"] = settings->hudMinimalFlight;
         doc["name"] = settings->bleName;
-        char out[256];
+        addAlerts(doc, settings->alerts);
+        char out[512];
         size_t n = serializeJson(doc, out, sizeof(out));
         sendControlResp(std::string(out, n));
     }
 
+    // Alertas de altitud (metros, 0 = off):
+    // "alerts":{"en":bool,"ff":[m,m,m],"brk":m,"pull":m,"deck":m,"can":[m,m,m],"hyst":m}
+    static void addAlerts(JsonDocument& doc, const AlertConfig& a) {
+        JsonObject o = doc.createNestedObject("alerts");
+        o["en"] = a.enabled;
+        JsonArray ff = o.createNestedArray("ff");
+        for (uint8_t i = 0; i < ALERT_FF_MAX; ++i) ff.add(a.ffAltM[i]);
+        o["brk"]  = a.breakoffM;
+        o["pull"] = a.pullM;
+        o["deck"] = a.hardDeckM;
+        JsonArray can = o.createNestedArray("can");
+        for (uint8_t i = 0; i < ALERT_CANOPY_MAX; ++i) can.add(a.canopyAltM[i]);
+        o["hyst"] = a.hysteresisM;
+    }
+
+    // Valida y aplica sobre 'a' sólo las claves presentes. Devuelve el código
+    // de error o nullptr.
+    static const char* parseAlerts(JsonVariant v, AlertConfig& a) {
+        if (!v.is<JsonObject>()) return "alerts";
+        AlertConfig c = a;
+        auto alt = [](JsonVariant x, uint16_t& out) -> bool {
+            if (!x.is<int>()) return false;
+            int m = x.as<int>();
+            if (m < 0 || m > ALERT_ALT_MAX_M) return false;
+            out = (uint16_t)m;
+            return true;
+        };
+        if (v.containsKey("en")) c.enabled = v["en"];
+        if (v.containsKey("ff")) {
+            JsonArray arr = v["ff"].as<JsonArray>();
+            if (arr.isNull() || arr.size() > ALERT_FF_MAX) return "alerts_ff";
+            for (uint8_t i = 0; i < ALERT_FF_MAX; ++i) {
+                c.ffAltM[i] = 0;
+                if (i < arr.size() && !alt(arr[i], c.ffAltM[i])) return "alerts_ff";
+            }
+        }
+        if (v.containsKey("brk")  && !alt(v["brk"],  c.breakoffM)) return "alerts_brk";
+        if (v.containsKey("pull") && !alt(v["pull"], c.pullM))     return "alerts_pull";
+        if (v.containsKey("deck") && !alt(v["deck"], c.hardDeckM)) return "alerts_deck";
+        if (v.containsKey("can")) {
+            JsonArray arr = v["can"].as<JsonArray>();
+            if (arr.isNull() || arr.size() > ALERT_CANOPY_MAX) return "alerts_can";
+            for (uint8_t i = 0; i < ALERT_CANOPY_MAX; ++i) {
+                c.canopyAltM[i] = 0;
+                if (i < arr.size() && !alt(arr[i], c.canopyAltM[i])) return "alerts_can";
+            }
+        }
+        if (v.containsKey("hyst")) {
+            if (!alt(v["hyst"], c.hysteresisM) || c.hysteresisM > 300) return "alerts_hyst";
+        }
+        // El orden de seguridad tiene que tener sentido.
+        if (c.pullM && c.breakoffM && c.breakoffM <= c.pullM)   return "alerts_order";
+        if (c.hardDeckM && c.pullM && c.pullM <= c.hardDeckM)    return "alerts_order";
+        a = c;
+        return nullptr;
+    }
+
     void applySettings(JsonVariant settingsObj) {
         if (!settings || !settingsSvc) {
             sendControlResp("{\"type\":\"set_settings\",\"ok\":false}");
@@ -502,6 +587,20 @@ private:
             s.bleName[sizeof(s.bleName)-1] = '\0';
             name = s.bleName;
         }
+        if (settingsObj.containsKey("alerts")) {
+            const char* err = parseAlerts(settingsObj["alerts"], s.alerts);
+            if (err) {
+                char resp[80];
+                snprintf(resp, sizeof(resp), "{\"type\":\"set_settings\",\"ok\":false,\"err\":\"%s\"}", err);
+                sendControlResp(resp);
+                return;
+            }
+        }
+        if (alertsHook && s.alerts != settings->alerts &&
+            !alertsHook(s.alerts, alertsHookUser)) {
+            sendControlResp("{\"type\":\"set_settings\",\"ok\":false,\"err\":\"busy\"}");
+            return;
+        }
         settingsSvc->save(s);
         *settings = s;
         if (lcd) {
@@ -537,6 +636,31 @@ private:
         sendControlResp(std::string(out, n));
     }
 
+    // Campos de analítica (opcionales): sólo si el salto los tiene.
+    void addLogExt(JsonDocument& doc, uint16_t idxNewestFirst) {
+        LogbookService::Ext ext{};
+        if (!logbook->getExtByIndex(idxNewestFirst, ext)) return;
+        if (isfinite(ext.avgFFmps))         doc["vffAvg"]  = ext.avgFFmps;
+        if (isfinite(ext.peakFFmps))        doc["vffPeak"] = ext.peakFFmps;
+        if (isfinite(ext.t90s))             doc["t90"]     = ext.t90s;
+        if (isfinite(ext.canopyTimeS))      doc["tcan"]    = ext.canopyTimeS;
+        if (isfinite(ext.avgCanopyMps))     doc["vcanAvg"] = ext.avgCanopyMps;
+        if (isfinite(ext.finalApproachMps)) doc["vfinal"]  = ext.finalApproachMps;
+        if (ext.landingUtc)                 doc["tsLand"]  = ext.landingUtc;
+        if (ext.version >= 2 && ext.swoopCount > 0) {
+            JsonArray arr = doc.createNestedArray("swoop");
+            for (uint8_t k = 0; k < ext.swoopCount && k < LogbookService::EXT_MAX_SWOOPS; ++k) {
+                const LogbookService::SwoopSegment& sg = ext.swoop[k];
+                JsonObject o = arr.createNestedObject();
+                o["turn"] = sg.turnAltM;
+                o["peak"] = sg.peakAltM;
+                o["vmax"] = sg.peakDescentCms / 100.0f;
+                if (sg.planeOutAltM != INT16_MIN) o["plane"] = sg.planeOutAltM;
+                o["dur"]  = sg.durationDs / 10.0f;
+            }
+        }
+    }
+
     void sendLogRecord(int idxNewestFirst) {
         if (!logbook || idxNewestFirst < 0) {
             sendControlResp("{\"type\":\"get_log\",\"ok\":false}");
@@ -547,7 +671,7 @@ private:
             sendControlResp("{\"type\":\"get_log\",\"ok\":false}");
             return;
         }
-        StaticJsonDocument<256> doc;
+        StaticJsonDocument<768> doc;
         doc["type"] = "get_log";
         doc["ok"] = true;
         doc["id"] = rec.id;
@@ -557,7 +681,8 @@ private:
         doc["ff"] = rec.freefallTimeS;
         doc["vff"] = rec.vmaxFFmps;
         doc["vcan"] = rec.vmaxCanopymps;
-        char out[300];
+        addLogExt(doc, (uint16_t)idxNewestFirst);
+        char out[512];
         size_t n = serializeJson(doc, out, sizeof(out));
         sendControlResp(std::string(out, n));
     }
@@ -585,11 +710,11 @@ private:
             sendControlResp("{\"type\":\"get_log\",\"ok\":false,\"err\":\"range\"}");
             return;
         }
-        busy = true;
+        setBusy(true);
         for (int i = idx; i < (int)st.count; ++i) {
             LogbookService::Record rec{};
             if (!logbook->getByIndex((uint16_t)i, rec)) break;
-            StaticJsonDocument<256> doc;
+            StaticJsonDocument<768> doc;
             doc["type"] = "log";
             doc["idx"] = i;
             doc["id"] = rec.id;
@@ -599,40 +724,14 @@ private:
             doc["ff"] = rec.freefallTimeS;
             doc["vff"] = rec.vmaxFFmps;
             doc["vcan"] = rec.vmaxCanopymps;
+            addLogExt(doc, (uint16_t)i);
             doc["eof"] = (i == (int)st.count - 1);
-            char out[300];
+            char out[512];
             size_t n = serializeJson(doc, out, sizeof(out));
             controlChar->setValue((uint8_t*)out, n);
             controlChar->notify();
         }
-        busy = false;
-    }
-
-    static void epochToUtc(uint32_t epoch, UtcDateTime& dt) {
-        uint32_t t = epoch;
-        dt.second = t % 60; t /= 60;
-        dt.minute = t % 60; t /= 60;
-        dt.hour   = t % 24; t /= 24;
-        // Día/mes/año aproximado (no crítica para set_time simple)
-        uint32_t days = t;
-        uint16_t year = 1970;
-        while (true) {
-            bool leap = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
-            uint16_t daysInYear = leap ? 366 : 365;
-            if (days >= daysInYear) { days -= daysInYear; year++; }
-            else break;
-        }
-        static const uint8_t dm[] = {31,28,31,30,31,30,31,31,30,31,30,31};
-        uint8_t month = 0;
-        while (month < 12) {
-            uint8_t dim = dm[month] + ((month==1 && (year%4==0 && (year%100!=0 || year%400==0))) ? 1 : 0);
-            if (days < dim) break;
-            days -= dim;
-            month++;
-        }
-        dt.year = year;
-        dt.month = month + 1;
-        dt.day = days + 1;
+        setBusy(false);
     }
 
     String deviceName(const Settings& settings) {
@@ -662,7 +761,9 @@ private:
     bool connected = false;
     bool authed = false;
     bool initialized = false;
+    bool begun = false;
     bool busy = false;
+    PmLock xferLock;
     bool otaInProgress = false;
     size_t otaExpectedSize = 0;
     size_t otaWritten = 0;
@@ -675,7 +776,9 @@ private:
     LcdDriver* lcd = nullptr;
     BatteryMonitor* battery = nullptr;
     RtcDs3231Driver* rtc = nullptr;
-    LogbookService* logbook = nullptr;
+    StorageService* logbook = nullptr;  // lecturas vía snapshot/mutex de storage
+    AlertsHook alertsHook = nullptr;
+    void* alertsHookUser = nullptr;
     BLEServer* server = nullptr;
     BLECharacteristic* controlChar = nullptr;
     BLECharacteristic* statusChar = nullptr;
@@ -685,6 +788,8 @@ private:
 #else
     // Versión sin BLE: no-ops
     void begin(const Settings&) {}
+    typedef bool (*AlertsHook)(const AlertConfig& alerts, void* user);
+    void setAlertsHook(AlertsHook, void*) {}
     void setEnabled(bool) {}
     bool isEnabled() const { return false; }
     bool isConnected() const { return false; }
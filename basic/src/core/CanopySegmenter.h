@@ -0,0 +1,166 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+
+// Segmentador online de picados bajo vela (giro a final / swoop).
+//
+// Corre sólo en FlightPhase::CANOPY, O(1) por muestra. A partir de la VS
+// barométrica estima su derivada (aceleración vertical, filtrada) y una VS
+// de crucero de referencia, y recorre una máquina de estados con histéresis:
+//
+//   CRUISE --(acel < -DIVE_ENTER_ACCEL y VS < crucero - DIVE_ENTER_DV,
+//             sostenido CANOPY_SEG_CONFIRM_MS)--> DIVE
+//   DIVE   --(acel > +RECOVER_ACCEL)--> RECOVERY
+//   RECOVERY --(acel < -DIVE_ENTER_ACCEL)--> DIVE        (el mismo picado sigue)
+//   RECOVERY --(VS > crucero - PLANEOUT_DV o VS > -PLANEOUT_VS)--> CRUISE
+//
+// Cada picado cerrado produce un Segment (altitud de inicio del giro, máxima
+// tasa de descenso y su altitud, altitud de plane-out, duración). Se guardan
+// los CANOPY_SEG_MAX más fuertes.
+
+#ifndef CANOPY_SEG_MAX
+#define CANOPY_SEG_MAX        2
+#endif
+#ifndef CANOPY_SEG_CONFIRM_MS
+#define CANOPY_SEG_CONFIRM_MS 300
+#endif
+
+class CanopySegmenter {
+public:
+    struct Segment {
+        uint32_t startMs        = 0;
+        float    startAltM      = NAN;   // inicio del giro
+        float    peakDescentMps = 0.0f;  // máxima tasa de descenso (>0)
+        float    peakAltM       = NAN;
+        float    planeOutAltM   = NAN;   // NAN si se aterrizó sin plane-out
+        uint32_t durationMs     = 0;
+    };
+
+    void reset() {
+        state       = State::CRUISE;
+        haveSample  = false;
+        accel       = 0.0f;
+        cruiseVs    = NAN;
+        candSinceMs = 0;
+        count       = 0;
+        cur         = Segment{};
+    }
+
+    // Llamar con cada muestra bajo vela (SI: m, m/s).
+    void addSample(uint32_t tMs, float altM, float vsMps) {
+        if (!haveSample) {
+            haveSample = true;
+            lastT      = tMs;
+            lastVs     = vsMps;
+            cruiseVs   = vsMps;
+            return;
+        }
+        float dt = (tMs - lastT) / 1000.0f;
+        if (dt <= 0.0f) return;
+
+        // Derivada de VS filtrada (EMA con constante ACCEL_TAU_S).
+        float rawAcc = (vsMps - lastVs) / dt;
+        float a      = dt / (ACCEL_TAU_S + dt);
+        accel       += a * (rawAcc - accel);
+        lastT        = tMs;
+        lastVs       = vsMps;
+
+        switch (state) {
+        case State::CRUISE: {
+            // La referencia de crucero sólo se adapta fuera de los picados.
+            float b = dt / (CRUISE_TAU_S + dt);
+            cruiseVs += b * (vsMps - cruiseVs);
+
+            bool cand = (accel < -DIVE_ENTER_ACCEL) && (vsMps < cruiseVs - DIVE_ENTER_DV);
+            if (!cand) {
+                candSinceMs = 0;
+                break;
+            }
+            if (candSinceMs == 0) {
+                candSinceMs     = tMs;
+                cur             = Segment{};
+                cur.startMs     = tMs;
+                cur.startAltM   = altM;
+            }
+            trackPeak(altM, vsMps);
+            if (tMs - candSinceMs >= CANOPY_SEG_CONFIRM_MS) {
+                state = State::DIVE;
+            }
+            break;
+        }
+        case State::DIVE:
+            trackPeak(altM, vsMps);
+            if (accel > RECOVER_ACCEL) state = State::RECOVERY;
+            break;
+        case State::RECOVERY:
+            trackPeak(altM, vsMps);
+            if (accel < -DIVE_ENTER_ACCEL) {
+                state = State::DIVE;
+            } else if (vsMps > cruiseVs - PLANEOUT_DV || vsMps > -PLANEOUT_VS) {
+                cur.planeOutAltM = altM;
+                closeSegment(tMs);
+            }
+            break;
+        }
+    }
+
+    // Aterrizaje / fin de vela: cierra un picado en curso (sin plane-out).
+    void finish(uint32_t tMs) {
+        if (state != State::CRUISE) closeSegment(tMs);
+        candSinceMs = 0;
+    }
+
+    uint8_t        segmentCount()     const { return count; }
+    const Segment& segment(uint8_t i) const { return segs[i]; }
+
+private:
+    enum class State : uint8_t { CRUISE, DIVE, RECOVERY };
+
+    // Umbrales (m/s, m/s²)
+    static constexpr float ACCEL_TAU_S      = 0.3f;
+    static constexpr float CRUISE_TAU_S     = 5.0f;
+    static constexpr float DIVE_ENTER_ACCEL = 1.5f;
+    static constexpr float DIVE_ENTER_DV    = 3.0f;
+    static constexpr float RECOVER_ACCEL    = 1.0f;
+    static constexpr float PLANEOUT_DV      = 1.5f;
+    static constexpr float PLANEOUT_VS      = 2.0f;
+    static constexpr float MIN_SEG_DV       = 5.0f;   // picados menores se ignoran
+
+    void trackPeak(float altM, float vsMps) {
+        float down = -vsMps;
+        if (down > cur.peakDescentMps) {
+            cur.peakDescentMps = down;
+            cur.peakAltM       = altM;
+        }
+    }
+
+    void closeSegment(uint32_t tMs) {
+        state       = State::CRUISE;
+        candSinceMs = 0;
+        cur.durationMs = tMs - cur.startMs;
+        if (cur.peakDescentMps + cruiseVs < MIN_SEG_DV) return;
+
+        // Mantener los CANOPY_SEG_MAX picados más fuertes.
+        if (count < CANOPY_SEG_MAX) {
+            segs[count++] = cur;
+            return;
+        }
+        uint8_t weakest = 0;
+        for (uint8_t i = 1; i < count; ++i) {
+            if (segs[i].peakDescentMps < segs[weakest].peakDescentMps) weakest = i;
+        }
+        if (cur.peakDescentMps > segs[weakest].peakDescentMps) segs[weakest] = cur;
+    }
+
+    State    state       = State::CRUISE;
+    bool     haveSample  = false;
+    uint32_t lastT       = 0;
+    float    lastVs      = 0.0f;
+    float    accel       = 0.0f;
+    float    cruiseVs    = NAN;
+    uint32_t candSinceMs = 0;
+
+    Segment  cur{};
+    Segment  segs[CANOPY_SEG_MAX];
+    uint8_t  count = 0;
+};
@@ -9,10 +9,13 @@
 //    estados candidatos y temporizadores para acercarse al comportamiento
 //    de altímetros de gama alta (Ares / Optima / etc.).
 //
-// Requiere que AltitudeData entregue:
-//  - rawAlt            : altura relativa a un cero (en backend).
-//  - verticalSpeed     : velocidad vertical filtrada (m/s en backend).
+// Requiere que AltitudeData entregue (SI, ver util/Units.h):
+//  - rawAlt            : altura relativa a un cero.
+//  - verticalSpeed     : velocidad vertical filtrada.
 //  - isGroundStable    : true cuando AltimetryService detecta suelo estable.
+//
+// Los umbrales son constantes en SI: un cambio de unidad de UI en pleno
+// vuelo no afecta al estado de fase.
 
 class FlightPhaseService {
 public:
@@ -26,44 +29,39 @@ public:
         groundCandidateStartMs = 0;
         climbAbortStartMs      = 0;
 
-        groundRefAlt           = 0.0f;
-        freefallStartAlt       = 0.0f;
-        maxDownVs              = 0.0f;
+        groundRefAlt           = Meters(0.0f);
+        freefallStartAlt       = Meters(0.0f);
+        maxDownVs              = MetersPerSecond(0.0f);
         hasSeenStrongFall      = false;
-        lastVerticalSpeed      = 0.0f;
+        lastVerticalSpeed      = MetersPerSecond(0.0f);
     }
 
     // Update the current phase based on altitude data and the current timestamp.
     //
-    // unit: unidad actual del backend (para convertir umbrales m/ft).
     // prevPhaseOut: si no es nullptr, devuelve la fase anterior antes de
     //               cualquier transición (útil para generar eventos).
     void update(const AltitudeData& alt,
                 uint32_t nowMs,
-                UnitType unit,
                 FlightPhase* prevPhaseOut = nullptr)
     {
         if (prevPhaseOut) {
             *prevPhaseOut = phase;
         }
 
-        const float M_TO_FT = 3.2808399f;
-
-        // --- Umbrales "en metros" (referencia física) ---
-        // Se convierten a la unidad actual para comparar con alt.rawAlt y alt.verticalSpeed.
-        constexpr float VS_CLIMB_MIN_M        = 1.5f;   // ~ ascenso claro
-        constexpr float CLIMB_GAIN_MIN_M      = 50.0f;  // al menos +50 m sobre el suelo
+        // --- Umbrales (SI) ---
+        constexpr MetersPerSecond vsClimbMin    = 1.5_mps;   // ~ ascenso claro
+        constexpr Meters          climbGainMin  = 50.0_m;    // al menos +50 m sobre el suelo
 
-        constexpr float MIN_EXIT_ALT_M        = 250.0f; // ~800 ft sobre suelo para permitir FF
-        constexpr float VS_FREEFALL_M         = -13.0f; // caída fuerte (≈ -42 ft/s)
-        constexpr float STRONG_FALL_M         = -20.0f; // "freefall serio" para habilitar canopy
+        constexpr Meters          minExitAlt    = 250.0_m;   // ~800 ft sobre suelo para permitir FF
+        constexpr MetersPerSecond vsFreefall    = -13.0_mps; // caída fuerte (≈ -42 ft/s)
+        constexpr MetersPerSecond strongFall    = -20.0_mps; // "freefall serio" para habilitar canopy
 
         // Piso amplio para canopy (admite velas cargadas/swoop)
-        constexpr float VS_CANOPY_FLOOR_M     = -12.0f;
-        constexpr float VS_GROUND_MAX_M       = 0.5f;   // "casi quieto" en suelo
-        constexpr float GROUND_ALT_BAND_M     = 2.0f;   // ±2 m alrededor del suelo
-        constexpr float CLIMB_ABORT_ALT_M     = 150.0f; // si sube poco y se queda quieto, abortar CLIMB
-        constexpr float ALT_LOSS_CANOPY_MIN_M = 180.0f; // pérdida mínima desde exit para permitir canopy (~600 ft)
+        constexpr MetersPerSecond vsCanopyFloor = -12.0_mps;
+        constexpr MetersPerSecond vsGroundMax   = 0.5_mps;   // "casi quieto" en suelo
+        constexpr Meters          groundAltBand = 2.0_m;     // ±2 m alrededor del suelo
+        constexpr Meters          climbAbortAlt = 150.0_m;   // si sube poco y se queda quieto, abortar CLIMB
+        constexpr Meters          canopyAltLoss = 180.0_m;   // pérdida mínima desde exit para permitir canopy (~600 ft)
 
         // --- Tiempos de persistencia ---
         constexpr uint32_t CLIMB_PERSIST_MS       = 3000; // CLIMB sostenido
@@ -74,26 +72,14 @@ public:
         constexpr uint32_t MIN_CANOPY_MS_FOR_LAND = 3000; // tiempo mínimo en canopy antes de suelo opcional
         constexpr uint32_t CLIMB_ABORT_STABLE_MS  = 30000; // 30s quieto en altitud baja -> abortar CLIMB
 
-        // --- Conversión de umbrales según unidad ---
-        float vsClimbMin      = (unit == UnitType::METERS) ? VS_CLIMB_MIN_M        : VS_CLIMB_MIN_M        * M_TO_FT;
-        float climbGainMin    = (unit == UnitType::METERS) ? CLIMB_GAIN_MIN_M      : CLIMB_GAIN_MIN_M      * M_TO_FT;
-        float minExitAlt      = (unit == UnitType::METERS) ? MIN_EXIT_ALT_M        : MIN_EXIT_ALT_M        * M_TO_FT;
-        float vsFreefall      = (unit == UnitType::METERS) ? VS_FREEFALL_M         : VS_FREEFALL_M         * M_TO_FT;
-        float strongFall      = (unit == UnitType::METERS) ? STRONG_FALL_M         : STRONG_FALL_M         * M_TO_FT;
-        float vsCanopyFloor   = (unit == UnitType::METERS) ? VS_CANOPY_FLOOR_M     : VS_CANOPY_FLOOR_M     * M_TO_FT;
-        float vsGroundMax     = (unit == UnitType::METERS) ? VS_GROUND_MAX_M       : VS_GROUND_MAX_M       * M_TO_FT;
-        float groundAltBand   = (unit == UnitType::METERS) ? GROUND_ALT_BAND_M     : GROUND_ALT_BAND_M     * M_TO_FT;
-        float climbAbortAlt   = (unit == UnitType::METERS) ? CLIMB_ABORT_ALT_M     : CLIMB_ABORT_ALT_M     * M_TO_FT;
-        float canopyAltLoss   = (unit == UnitType::METERS) ? ALT_LOSS_CANOPY_MIN_M : ALT_LOSS_CANOPY_MIN_M * M_TO_FT;
-
-        float altAboveGround  = alt.rawAlt - groundRefAlt;
-        float vs              = alt.verticalSpeed;
+        Meters          altAboveGround = alt.rawAlt - groundRefAlt;
+        MetersPerSecond vs             = alt.verticalSpeed;
 
         // Actualizar referencia de suelo cuando estamos en GROUND y el backend
         // declara suelo estable. Esto ayuda al auto ground-zero gradual.
         if (phase == FlightPhase::GROUND && alt.isGroundStable) {
             groundRefAlt = alt.rawAlt;
-            altAboveGround = 0.0f;
+            altAboveGround = Meters(0.0f);
         }
 
         // Actualizar máximos de caída en FREEFALL
@@ -119,9 +105,9 @@ public:
                     // Reset de contexto de vuelo
                     freefallCandidateStartMs = 0;
                     canopyCandidateStartMs   = 0;
-                    maxDownVs                = 0.0f;
+                    maxDownVs                = MetersPerSecond(0.0f);
                     hasSeenStrongFall        = false;
-                    freefallStartAlt         = 0.0f;
+                    freefallStartAlt         = Meters(0.0f);
                 }
             } else {
                 climbCandidateStartMs = 0;
@@ -160,8 +146,8 @@ public:
             // CLIMB -> GROUND (ride-down):
             // Si el altímetro vuelve a estar cerca del suelo y estable sin haber
             // entrado a FREEFALL.
-            if (fabsf(altAboveGround) < groundAltBand &&
-                fabsf(vs) < vsGroundMax &&
+            if (qabs(altAboveGround) < groundAltBand &&
+                qabs(vs) < vsGroundMax &&
                 alt.isGroundStable)
             {
                 if (groundCandidateStartMs == 0) {
@@ -179,7 +165,7 @@ public:
 
             // Abortador de CLIMB: si estamos bajos, sin freefall y quietos mucho tiempo.
             if (altAboveGround < climbAbortAlt &&
-                fabsf(vs) < vsGroundMax)
+                qabs(vs) < vsGroundMax)
             {
                 if (climbAbortStartMs == 0) {
                     climbAbortStartMs = nowMs;
@@ -215,12 +201,12 @@ public:
             //  - VS se reduce claramente: |vs| menor que la mitad del máximo de FF
             //    y además por encima del piso de canopy (vsCanopyFloor, es decir, descenso mucho más lento).
             //  - Pérdida de altura acumulada desde la salida superior al mínimo definido.
-            float absMaxDownVs = fabsf(maxDownVs); // maxDownVs es negativo
-            float absVs        = fabsf(vs);
-            float altLoss      = freefallStartAlt - alt.rawAlt; // en unidad actual
+            MetersPerSecond absMaxDownVs = qabs(maxDownVs); // maxDownVs es negativo
+            MetersPerSecond absVs        = qabs(vs);
+            Meters          altLoss      = freefallStartAlt - alt.rawAlt;
 
             bool canCheckCanopy = (hasSeenStrongFall &&
-                                   absMaxDownVs > 0.1f && // evita divisiones raras
+                                   absMaxDownVs > 0.1_mps && // evita divisiones raras
                                    timeInFF >= MIN_FREEFALL_MS &&
                                    altLoss >= canopyAltLoss);
 
@@ -254,8 +240,8 @@ public:
             //  - Altitud muy cerca del suelo.
             //  - Backend declara suelo estable.
             //  - (Opcional) tiempo mínimo en canopy para no pasar directo FF->GROUND.
-            if (fabsf(vs) < vsGroundMax &&
-                fabsf(altAboveGround) < groundAltBand &&
+            if (qabs(vs) < vsGroundMax &&
+                qabs(altAboveGround) < groundAltBand &&
                 alt.isGroundStable &&
                 timeInCanopy >= MIN_CANOPY_MS_FOR_LAND)
             {
@@ -272,7 +258,7 @@ public:
                     freefallCandidateStartMs = 0;
                     canopyCandidateStartMs   = 0;
                     hasSeenStrongFall        = false;
-                    maxDownVs                = 0.0f;
+                    maxDownVs                = MetersPerSecond(0.0f);
                 }
             } else {
                 groundCandidateStartMs = 0;
@@ -286,6 +272,36 @@ public:
         lastVerticalSpeed = vs;
     }
 
+    // Estado que sobrevive a un deep sleep (core/WarmStartService.h). Los
+    // candidatos a transición no se guardan: se reabren con datos nuevos.
+    struct WarmState {
+        FlightPhase phase             = FlightPhase::GROUND;
+        uint32_t    lastPhaseChangeMs = 0;
+        float       groundRefAltM     = 0.0f;
+        float       freefallStartAltM = 0.0f;
+        float       maxDownVsMps      = 0.0f;
+        bool        hasSeenStrongFall = false;
+    };
+
+    void saveWarm(WarmState& w) const {
+        w.phase             = phase;
+        w.lastPhaseChangeMs = lastPhaseChangeMs;
+        w.groundRefAltM     = groundRefAlt.v;
+        w.freefallStartAltM = freefallStartAlt.v;
+        w.maxDownVsMps      = maxDownVs.v;
+        w.hasSeenStrongFall = hasSeenStrongFall;
+    }
+
+    // Tras begin(). shiftMs: ver AltimetryService::restoreWarm().
+    void restoreWarm(const WarmState& w, uint32_t shiftMs) {
+        phase             = w.phase;
+        lastPhaseChangeMs = w.lastPhaseChangeMs + shiftMs;
+        groundRefAlt      = Meters(w.groundRefAltM);
+        freefallStartAlt  = Meters(w.freefallStartAltM);
+        maxDownVs         = MetersPerSecond(w.maxDownVsMps);
+        hasSeenStrongFall = w.hasSeenStrongFall;
+    }
+
     // Retrieve the current flight phase.
     FlightPhase getPhase() const {
         return phase;
@@ -308,13 +324,13 @@ private:
     uint32_t    climbAbortStartMs        = 0;
 
     // Referencia de suelo (altura backend donde consideramos "0")
-    float       groundRefAlt       = 0.0f;
+    Meters      groundRefAlt;
 
     // Contexto de freefall
-    float       freefallStartAlt   = 0.0f;
-    float       maxDownVs          = 0.0f;   // velocidad vertical más negativa en FF
-    bool        hasSeenStrongFall  = false;
+    Meters          freefallStartAlt;
+    MetersPerSecond maxDownVs;            // velocidad vertical más negativa en FF
+    bool            hasSeenStrongFall  = false;
 
     // Historial simple de VS
-    float       lastVerticalSpeed  = 0.0f;
+    MetersPerSecond lastVerticalSpeed;
 };
@@ -0,0 +1,273 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <math.h>
+
+#include "util/Types.h"
+#include "util/TraceCodec.h"
+#include "core/StorageService.h"
+#include "core/JumpRecorder.h"
+#include "util/PreTriggerBuffer.h"
+
+// Grabador de perfil completo del salto, complementario a JumpRecorder.
+//
+// - Captura cada muestra (presión y temperatura crudas + altitud/VS) desde
+//   GROUND->CLIMB hasta volver a GROUND. Al arrancar vuelca primero el
+//   PreTriggerBuffer, así la traza incluye el inicio real de la subida.
+// - Mientras estamos en el aire NO hay I/O de flash: las muestras se codifican
+//   (ver util/TraceCodec.h) en un arena de bloques reservado una sola vez en
+//   begin(), en PSRAM si existe (TRACE_PSRAM_BLOCKS) o en RAM interna con un
+//   límite menor (TRACE_RAM_BLOCKS).
+// - Al aterrizar espera a que JumpRecorder cierre el salto, etiqueta los
+//   bloques con el id real del Record de bitácora y los vuelca a TraceStore
+//   a través de StorageService en tramos de TRACE_FLUSH_CHUNK_BLOCKS.
+// - Si el salto se descarta (sin FREEFALL) la traza se descarta también.
+//
+// El arena nunca es mayor que el anillo de TraceStore: una traza entera cabe
+// en flash sin que el anillo dé la vuelta sobre sus propios primeros bloques.
+// Si el arena se llena se dejan de guardar muestras, se cuentan en
+// droppedSamples y el último bloque lleva TRACE_FLAG_TRUNCATED (con PSRAM,
+// ~4 min a 200 Hz, unos 30 min a los 25 Hz del gobernador).
+
+#ifndef TRACE_PSRAM_BLOCKS
+#define TRACE_PSRAM_BLOCKS        TRACE_CAPACITY_BLOCKS   // 256 KiB de PSRAM
+#endif
+#ifndef TRACE_RAM_BLOCKS
+#define TRACE_RAM_BLOCKS          64     // 16 KiB de RAM interna (sin PSRAM)
+#endif
+#ifndef TRACE_FLUSH_CHUNK_BLOCKS
+#define TRACE_FLUSH_CHUNK_BLOCKS  32     // 8 KiB por comando de storage
+#endif
+
+static_assert(TRACE_PSRAM_BLOCKS <= TRACE_CAPACITY_BLOCKS &&
+              TRACE_RAM_BLOCKS   <= TRACE_CAPACITY_BLOCKS,
+              "el arena de trazas no puede superar el anillo de TraceStore");
+
+class FlightTraceRecorder {
+public:
+    void begin(StorageService* st, const JumpRecorder* jr, const PreTriggerBuffer* pre = nullptr) {
+        storage = st;
+        jumpRec = jr;
+        preBuf  = pre;
+        allocArena();
+        state          = State::IDLE;
+        used           = 0;
+        flushPos       = 0;
+        flushInflight  = false;
+        flushFailed    = false;
+        droppedSamples = 0;
+        blocksWritten  = 0;
+    }
+
+    // Llamar en cada loop, con los mismos argumentos que JumpRecorder.
+    void update(const AltitudeData& alt,
+                FlightPhase phase,
+                FlightPhase prevPhase,
+                uint32_t nowMs) {
+        if (!storage || !arena) return;
+
+        if (prevPhase == FlightPhase::GROUND && phase == FlightPhase::CLIMB) {
+            startTrace(nowMs);
+        }
+
+        if (state == State::CAPTURING) {
+            addSample(nowMs, alt.pressure.v, alt.temperatureC,
+                      alt.rawAlt.v, alt.verticalSpeed.v);
+            if (phase == FlightPhase::GROUND) {
+                stopTrace();
+            }
+        }
+
+        if (state == State::WAIT_LINK) linkJump();
+        if (state == State::FLUSHING)  pumpFlush();
+    }
+
+    // true mientras haya una traza sin volcar (no entrar en deep sleep).
+    bool     isBusy()            const { return state != State::IDLE || flushInflight; }
+    bool     arenaInPsram()      const { return inPsram; }
+    uint32_t arenaBlocks()       const { return capacity; }
+    uint32_t getDroppedSamples() const { return droppedSamples; }
+    uint32_t getBlocksWritten()  const { return blocksWritten; }
+
+private:
+    enum class State : uint8_t { IDLE, CAPTURING, WAIT_LINK, FLUSHING };
+
+    void allocArena() {
+        if (arena) return;
+        if (psramFound()) {
+            arena = static_cast<TraceBlock*>(
+                heap_caps_malloc((size_t)TRACE_PSRAM_BLOCKS * sizeof(TraceBlock),
+                                 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+            if (arena) {
+                capacity = TRACE_PSRAM_BLOCKS;
+                inPsram  = true;
+            }
+        }
+        if (!arena) {
+            arena = static_cast<TraceBlock*>(
+                heap_caps_malloc((size_t)TRACE_RAM_BLOCKS * sizeof(TraceBlock),
+                                 MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+            capacity = arena ? TRACE_RAM_BLOCKS : 0;
+            inPsram  = false;
+        }
+        Serial.printf("[TRACE] arena %lu bloques en %s\n",
+                      (unsigned long)capacity,
+                      arena ? (inPsram ? "PSRAM" : "RAM interna") : "(sin memoria)");
+    }
+
+    void startTrace(uint32_t nowMs) {
+        if (state == State::WAIT_LINK || state == State::FLUSHING) {
+            // Nuevo despegue sin haber terminado el anterior: prima el salto nuevo.
+            Serial.printf("[TRACE] descartando %lu bloques sin volcar\n",
+                          (unsigned long)(used - flushPos));
+        }
+        closedAtStart  = jumpRec ? jumpRec->getClosedCount() : 0;
+        droppedAtStart = droppedSamples;
+        used     = 0;
+        flushPos = 0;
+        state    = State::CAPTURING;
+
+        // Contexto previo a la confirmación de CLIMB (sin la muestra actual,
+        // que llega a continuación por la vía normal).
+        size_t pre = 0;
+        if (preBuf) {
+            for (size_t i = 0; i < preBuf->size(); ++i) {
+                const FlightSample& s = preBuf->at(i);
+                if (s.tMs == nowMs) break;
+                addSample(s.tMs, s.pressurePa, s.tempC, s.altM, s.vsMps);
+                pre++;
+            }
+        }
+        Serial.printf("[TRACE] start (pre-trigger %u muestras)\n", (unsigned)pre);
+    }
+
+    void stopTrace() {
+        uint8_t last = TRACE_FLAG_LAST | (droppedSamples != droppedAtStart ? TRACE_FLAG_TRUNCATED : 0);
+        if (enc.active()) {
+            enc.finish(last | (used == 0 ? TRACE_FLAG_FIRST : 0));
+            used++;
+        } else if (used > 0) {
+            arena[used - 1].hdr.flags |= last;   // linkJump() vuelve a sellarlo
+        }
+        state = (used > 0) ? State::WAIT_LINK : State::IDLE;
+        Serial.printf("[TRACE] stop blocks=%lu dropped=%lu\n",
+                      (unsigned long)used, (unsigned long)droppedSamples);
+    }
+
+    void addSample(uint32_t tMs, float pressurePa, float tempC, float altM, float vsM) {
+        // El tramo anterior aún se está escribiendo desde el arena.
+        if (flushInflight) {
+            droppedSamples++;
+            return;
+        }
+
+        if (!enc.active()) {
+            if (used >= capacity) {
+                droppedSamples++;
+                return;
+            }
+            enc.start(&arena[used], 0, (uint16_t)used);
+        }
+        if (enc.add(tMs, pressurePa, tempC, altM, vsM)) return;
+
+        // Bloque lleno: cerrarlo y seguir en el siguiente.
+        enc.finish(used == 0 ? TRACE_FLAG_FIRST : 0);
+        used++;
+        if (used >= capacity) {
+            droppedSamples++;
+            return;
+        }
+        enc.start(&arena[used], 0, (uint16_t)used);
+        if (!enc.add(tMs, pressurePa, tempC, altM, vsM)) {
+            droppedSamples++;
+        }
+    }
+
+    // Espera a que JumpRecorder cierre el salto y el Record esté escrito para
+    // etiquetar los bloques con el id que devolvió el append.
+    void linkJump() {
+        if (!jumpRec) return;
+        if (jumpRec->getClosedCount() == closedAtStart) return;
+
+        if (!jumpRec->lastJumpLogged()) {
+            Serial.println("[TRACE] salto descartado: traza descartada");
+            state = State::IDLE;
+            return;
+        }
+        if (!jumpRec->lastAppendResolved()) return;
+
+        if (!jumpRec->lastAppendOk()) {
+            Serial.println("[TRACE] append del salto fallido: traza descartada");
+            state = State::IDLE;
+            return;
+        }
+
+        uint32_t id = jumpRec->getLastJumpId();
+        for (uint32_t i = 0; i < used; ++i) {
+            arena[i].hdr.jumpId = id;
+            TraceCodec::seal(arena[i]);
+        }
+        flushPos    = 0;
+        flushFailed = false;
+        state       = State::FLUSHING;
+        Serial.printf("[TRACE] volcando jump id=%lu (%lu bloques)\n",
+                      (unsigned long)id, (unsigned long)used);
+    }
+
+    void pumpFlush() {
+        if (flushInflight) return;
+        if (flushFailed || flushPos >= used) {
+            Serial.printf("[TRACE] volcado %s (%lu/%lu bloques)\n",
+                          flushFailed ? "FAIL" : "OK",
+                          (unsigned long)flushPos, (unsigned long)used);
+            state = State::IDLE;
+            return;
+        }
+        uint32_t n = used - flushPos;
+        if (n > TRACE_FLUSH_CHUNK_BLOCKS) n = TRACE_FLUSH_CHUNK_BLOCKS;
+
+        chunkLen      = n;
+        flushInflight = true;
+        if (!storage->submitTraceBlocks(&arena[flushPos], (uint16_t)n, onChunkDone, this)) {
+            flushInflight = false;   // back-pressure: reintento en el próximo loop
+        }
+    }
+
+    // Corre en la tarea de storage.
+    static void onChunkDone(StorageService::CmdType,
+                            bool ok,
+                            const LogbookService::Record&,
+                            void* user) {
+        FlightTraceRecorder* self = static_cast<FlightTraceRecorder*>(user);
+        if (!self) return;
+        if (ok) {
+            self->flushPos      += self->chunkLen;
+            self->blocksWritten += self->chunkLen;
+        } else {
+            self->flushFailed = true;
+        }
+        self->flushInflight = false;
+    }
+
+    StorageService*     storage = nullptr;
+    const JumpRecorder* jumpRec = nullptr;
+    const PreTriggerBuffer* preBuf = nullptr;
+    TraceCodec::Encoder enc;
+
+    TraceBlock* arena    = nullptr;
+    uint32_t    capacity = 0;
+    bool        inPsram  = false;
+
+    State    state         = State::IDLE;
+    uint32_t used          = 0;      // bloques cerrados en el arena
+    uint32_t closedAtStart = 0;
+    uint32_t droppedAtStart = 0;
+
+    volatile uint32_t flushPos      = 0;
+    volatile uint32_t chunkLen      = 0;
+    volatile bool     flushInflight = false;
+    volatile bool     flushFailed   = false;
+
+    uint32_t droppedSamples = 0;
+    volatile uint32_t blocksWritten = 0;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+#include <string.h>
+
+#include "util/Types.h"
+
+// Analítica del salto en streaming, con memoria constante.
+//
+// JumpRecorder le pasa cada muestra (SI: m, m/s) y, al cerrar el salto, los
+// eventos ya afinados (salida, apertura, aterrizaje). No hace falta recorrer
+// la traza guardada: el resumen está listo en cuanto se aterriza.
+//
+// - Velocidad media de caída libre: pérdida de altura / tiempo de caída.
+// - Pico de caída libre: máximo |VS| en FREEFALL.
+// - Tiempo a 90% de terminal: se guarda el primer instante en que se alcanza
+//   cada m/s (tabla fija de ANALYTICS_SPEED_BINS) desde la salida; al final se
+//   consulta la entrada de 0.9·pico.
+// - Vela: tiempo apertura→aterrizaje y tasa media de descenso.
+// - Aproximación final: tasa media desde que se cruza ANALYTICS_FINAL_ALT_M
+//   bajo vela hasta el aterrizaje.
+
+#ifndef ANALYTICS_SPEED_BINS
+#define ANALYTICS_SPEED_BINS   96      // 1 m/s por entrada (hasta ~345 km/h)
+#endif
+#ifndef ANALYTICS_FINAL_ALT_M
+#define ANALYTICS_FINAL_ALT_M  100.0f  // inicio de la aproximación final
+#endif
+
+class JumpAnalytics {
+public:
+    struct Result {
+        float    avgFFmps         = NAN;
+        float    peakFFmps        = NAN;
+        float    t90s             = NAN;   // salida → 90% de la VS pico
+        float    canopyTimeS      = NAN;
+        float    avgCanopyMps     = NAN;
+        float    finalApproachMps = NAN;
+    };
+
+    void reset() {
+        peakFF      = 0.0f;
+        finalT      = 0;
+        finalAlt    = NAN;
+        finalSeen   = false;
+        clearBins();
+    }
+
+    void addSample(FlightPhase phase, uint32_t tMs, float altM, float vsMps) {
+        float down = -vsMps;   // velocidad de descenso (>0 cayendo)
+
+        switch (phase) {
+        case FlightPhase::CLIMB:
+            // Aún en el avión: los cruces sólo valen desde la última vez que
+            // no caíamos (la salida se confirma ya en caída).
+            if (down < 1.0f) {
+                clearBins();
+                break;
+            }
+            markBins(tMs, down);
+            break;
+        case FlightPhase::FREEFALL:
+            markBins(tMs, down);
+            if (down > peakFF) peakFF = down;
+            break;
+        case FlightPhase::CANOPY:
+            if (!finalSeen && altM < ANALYTICS_FINAL_ALT_M) {
+                finalSeen = true;
+                finalT    = tMs;
+                finalAlt  = altM;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Cierra el cálculo con los eventos del salto (ms de millis(), m).
+    Result finish(uint32_t exitMs, float exitAltM,
+                  uint32_t deployMs, float deployAltM,
+                  uint32_t landingMs, float landingAltM) const {
+        Result r;
+        if (deployMs > exitMs) {
+            float ffS   = (deployMs - exitMs) / 1000.0f;
+            r.avgFFmps  = (exitAltM - deployAltM) / ffS;
+        }
+        if (peakFF > 0.0f) {
+            r.peakFFmps = peakFF;
+            // Interpolación entre los dos m/s enteros que rodean 0.9·pico.
+            float target = 0.9f * peakFF;
+            int   bin    = (int)target;
+            if (bin >= ANALYTICS_SPEED_BINS - 1) bin = ANALYTICS_SPEED_BINS - 2;
+            if (firstReach[bin] != 0 && (int32_t)(firstReach[bin] - exitMs) >= 0) {
+                float t = (float)(firstReach[bin] - exitMs);
+                if (firstReach[bin + 1] != 0) {
+                    float frac = target - (float)bin;
+                    if (frac > 1.0f) frac = 1.0f;
+                    t += frac * (float)(firstReach[bin + 1] - firstReach[bin]);
+                }
+                r.t90s = t / 1000.0f;
+            }
+        }
+        if (landingMs > deployMs && deployMs != 0 && isfinite(landingAltM)) {
+            r.canopyTimeS  = (landingMs - deployMs) / 1000.0f;
+            r.avgCanopyMps = (deployAltM - landingAltM) / r.canopyTimeS;
+        }
+        if (finalSeen && landingMs > finalT && isfinite(landingAltM)) {
+            r.finalApproachMps = (finalAlt - landingAltM) / ((landingMs - finalT) / 1000.0f);
+        }
+        return r;
+    }
+
+private:
+    void clearBins() {
+        if (!binsDirty) return;
+        memset(firstReach, 0, sizeof(firstReach));
+        reachedTop = 0;
+        binsDirty  = false;
+    }
+
+    void markBins(uint32_t tMs, float down) {
+        if (down <= 0.0f) return;
+        int top = (int)down;
+        if (top >= ANALYTICS_SPEED_BINS) top = ANALYTICS_SPEED_BINS - 1;
+        // Los bins se llenan en orden; basta con avanzar desde el último.
+        for (int b = reachedTop; b <= top; ++b) {
+            if (firstReach[b] == 0) firstReach[b] = tMs ? tMs : 1;
+        }
+        if (top + 1 > reachedTop) reachedTop = top + 1;
+        binsDirty = true;
+    }
+
+    uint32_t firstReach[ANALYTICS_SPEED_BINS] = {};
+    int      reachedTop = 0;
+    bool     binsDirty  = true;
+
+    float    peakFF    = 0.0f;
+    bool     finalSeen = false;
+    uint32_t finalT    = 0;
+    float    finalAlt  = NAN;
+};
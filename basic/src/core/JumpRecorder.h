@@ -1,37 +1,78 @@
 #pragma once
 #include <Arduino.h>
 #include "core/LogbookService.h"
+#include "core/StorageService.h"
 #include "core/AltimetryService.h"
 #include "core/FlightPhaseService.h"
+#include "core/JumpAnalytics.h"
+#include "core/CanopySegmenter.h"
 #include "drivers/RtcDs3231Driver.h"
+#include "util/PreTriggerBuffer.h"
+#include "util/EventTiming.h"
 
 // Acumula métricas de un salto basándose en las transiciones de FlightPhaseService.
-// Usa altitud filtrada (alt.altToShow pero en unidad interna metros) para vmax y tiempos.
+// Usa la altitud y VS publicadas por AltimetryService (SI) para vmax y tiempos.
+//
+// Con un PreTriggerBuffer, cada transición mira hacia atrás para fechar el
+// inicio real del evento (las fases se confirman con retraso):
+//  - inicio de subida: primera muestra del tramo final con VS > CLIMB_ONSET_VS_M
+//  - salida: última muestra antes del tramo final con VS < EXIT_ONSET_VS_M
+//  - apertura: última muestra a >= DEPLOY_ONSET_FRAC de la VS pico de caída
+//  - aterrizaje: primera muestra del tramo final con |VS| < LANDING_ONSET_VS_M
+// y después afina instante y altitud entre muestras (util/EventTiming.h), de
+// modo que el tiempo de caída libre no depende del periodo de loop ni del ODR.
 class JumpRecorder {
 public:
-    void begin(LogbookService* lb, RtcDs3231Driver* rtc) {
-        logbook = lb;
+    void begin(StorageService* st, RtcDs3231Driver* rtc, const PreTriggerBuffer* pre = nullptr) {
+        storage = st;
         rtcDrv  = rtc;
+        preBuf  = pre;
+        pendingAppend = false;
         reset();
     }
 
+    // true si hay un salto cerrado esperando hueco en la cola de storage.
+    bool hasPendingAppend() const { return pendingAppend; }
+
+    // Cierre de saltos: se incrementa al registrar o descartar un salto.
+    // Permite a otros grabadores (trazas) saber cuándo y cómo terminó.
+    bool     isJumping()      const { return jumping; }
+    uint32_t getClosedCount() const { return closedCount; }
+    bool     lastJumpLogged() const { return lastLogged; }
+
+    // Resultado del append del último salto registrado (lo publica la tarea
+    // de storage). getLastJumpId() es el id que devolvió el append, no una
+    // predicción: sólo es válido con lastAppendResolved() && lastAppendOk().
+    bool     lastAppendResolved() const { return lastLogged && !pendingAppend && appendDone; }
+    bool     lastAppendOk()       const { return appendOk; }
+    uint32_t getLastJumpId()      const { return appendId; }
+
+    // Analítica del último salto registrado (debrief inmediato tras aterrizar).
+    bool getLastAnalytics(LogbookService::Ext& out) const {
+        if (!lastLogged) return false;
+        out = pendingExt;
+        return true;
+    }
+
     // Llamar en cada loop con el estado actual.
     void update(const AltitudeData& alt,
-                UnitType unit,
                 FlightPhase phase,
                 FlightPhase prevPhase,
                 uint32_t nowMs) {
+        // Reintentar un append que la cola rechazó (back-pressure).
+        if (pendingAppend) {
+            submitPending();
+        }
+
         // Detectar inicio de salto: GROUND -> CLIMB
         if (prevPhase == FlightPhase::GROUND && phase == FlightPhase::CLIMB) {
-            startJump(alt, unit, nowMs);
-            Serial.printf("[REC] start jump at %.2f (unit=%s)\n",
-                          alt.rawAlt,
-                          (unit == UnitType::METERS) ? "m" : "ft");
+            startJump(alt, nowMs);
+            Serial.printf("[REC] start jump at %.2f m\n", alt.rawAlt.v);
         }
 
         // Acumular altura máxima durante CLIMB
         if (jumping && phase == FlightPhase::CLIMB) {
-            float altM = toMeters(alt.rawAlt, unit);
+            float altM = alt.rawAlt.v;
             if (!isfinite(maxAltClimb) || altM > maxAltClimb) {
                 maxAltClimb = altM;
             }
@@ -39,16 +80,20 @@ public:
 
         // Marcar salida al inicio de FREEFALL
         if (jumping && prevPhase == FlightPhase::CLIMB && phase == FlightPhase::FREEFALL) {
-            markExitAndStartFF(unit, nowMs);
-            Serial.printf("[REC] enter FF, exit=%.2f m\n", exitAltM);
+            markExitAndStartFF(nowMs);
+            Serial.printf("[REC] enter FF, exit=%.2f m (onset -%lu ms)\n",
+                          exitAltM, (unsigned long)(nowMs - ffStartMs));
         }
 
         // Marcar deploy: FREEFALL -> CANOPY
         if (prevPhase == FlightPhase::FREEFALL && phase == FlightPhase::CANOPY) {
-            markDeploy(alt, unit, nowMs);
-            Serial.printf("[REC] deploy at %.2f (unit %s)\n",
-                          deployAltM,
-                          (unit == UnitType::METERS) ? "m" : "ft");
+            markDeploy(alt, nowMs);
+            Serial.printf("[REC] deploy at %.2f m\n", deployAltM);
+        }
+
+        // Aterrizaje: CANOPY -> GROUND
+        if (jumping && prevPhase == FlightPhase::CANOPY && phase == FlightPhase::GROUND) {
+            markLanding(alt, nowMs);
         }
 
         // Finalizar: requiere fase GROUND y suelo estable por un mínimo
@@ -56,7 +101,7 @@ public:
             if (alt.isGroundStable) {
                 if (groundStableStart == 0) groundStableStart = nowMs;
                 if (nowMs - groundStableStart >= MIN_GROUND_MS) {
-                    finalize(alt, unit, nowMs);
+                    finalize(alt, nowMs);
                     Serial.println("[REC] finalize jump (ground stable)");
                 }
             } else {
@@ -66,9 +111,13 @@ public:
             groundStableStart = 0;
         }
 
-        // Track vmax mientras estamos en salto
+        // Track vmax y analítica mientras estamos en salto
         if (jumping) {
-            accumulateVmax(alt, unit, nowMs, phase);
+            accumulateVmax(alt, nowMs, phase);
+            analytics.addSample(phase, nowMs, alt.rawAlt.v, alt.verticalSpeed.v);
+            if (phase == FlightPhase::CANOPY) {
+                swoops.addSample(nowMs, alt.rawAlt.v, alt.verticalSpeed.v);
+            }
         }
     }
 
@@ -84,40 +133,123 @@ private:
         exitAltM      = 0.0f;
         deployAltM    = 0.0f;
         maxAltClimb   = NAN;
+        landingMs     = 0;
+        landingAltM   = NAN;
         groundStableStart = 0;
+        analytics.reset();
+        swoops.reset();
     }
 
-    void startJump(const AltitudeData& alt, UnitType unit, uint32_t nowMs) {
+    void startJump(const AltitudeData& alt, uint32_t nowMs) {
         jumping      = true;
         deployMarked = false;
         startMs      = nowMs;
+        landingMs    = 0;
+        landingAltM  = NAN;
+        analytics.reset();
+        swoops.reset();
         ffStartMs    = 0;
         ffEndMs      = 0;
         vmaxFF       = 0.0f;
         vmaxCanopy   = 0.0f;
-        exitAltM     = toMeters(alt.rawAlt, unit);
+        exitAltM     = alt.rawAlt.v;
         deployAltM   = 0.0f;
         maxAltClimb  = exitAltM;
+
+        // Inicio real de la subida (CLIMB se confirma tras 3 s sostenidos).
+        if (preBuf) {
+            int i = preBuf->findRunStart([](const FlightSample& s) {
+                return s.vsMps > CLIMB_ONSET_VS_M;
+            });
+            if (i >= 0) startMs = preBuf->at((size_t)i).tMs;
+        }
     }
 
-    void markDeploy(const AltitudeData& alt, UnitType unit, uint32_t nowMs) {
+    void markDeploy(const AltitudeData& alt, uint32_t nowMs) {
         if (!jumping) return;
         deployMarked = true;
-        deployAltM   = toMeters(alt.rawAlt, unit);
+        deployAltM   = alt.rawAlt.v;
         ffEndMs      = nowMs;
+
+        // Inicio de la desaceleración: última muestra aún a velocidad de caída.
+        if (preBuf && !preBuf->empty()) {
+            uint32_t from = nowMs - DEPLOY_LOOKBACK_MS;
+            if ((int32_t)(from - ffStartMs) < 0) from = ffStartMs;
+            float vPeak = preBuf->minVsSince(from);
+            if (vPeak < 0.0f) {
+                float vOnset = DEPLOY_ONSET_FRAC * vPeak;
+                int i = preBuf->findRunStart([vOnset](const FlightSample& s) {
+                    return s.vsMps > vOnset;
+                }, from);
+                if (i > 0) {
+                    const FlightSample& s = preBuf->at((size_t)i - 1);
+                    deployAltM = s.altM;
+                    ffEndMs    = s.tMs;
+
+                    EventTiming::Event ev;
+                    if (EventTiming::refineDeploy(*preBuf, i, FIT_LEVEL_WINDOW_MS,
+                                                  DEPLOY_RAMP_FRAC_HI, DEPLOY_RAMP_FRAC_LO,
+                                                  BARO_FILTER, ev)) {
+                        deployAltM = ev.altM;
+                        ffEndMs    = ev.tMs;
+                    }
+                }
+            }
+        }
     }
 
-    void markExitAndStartFF(UnitType unit, uint32_t nowMs) {
+    void markExitAndStartFF(uint32_t nowMs) {
         if (!jumping) return;
         if (isfinite(maxAltClimb)) {
             exitAltM = maxAltClimb;
         }
         ffStartMs = nowMs;
+
+        // Salida real: la última muestra antes de empezar a caer.
+        if (preBuf) {
+            int i = preBuf->findRunStart([](const FlightSample& s) {
+                return s.vsMps < EXIT_ONSET_VS_M;
+            }, startMs);
+            if (i > 0) {
+                const FlightSample& s = preBuf->at((size_t)i - 1);
+                exitAltM  = s.altM;
+                ffStartMs = s.tMs;
+
+                EventTiming::Event ev;
+                if (EventTiming::refineExit(*preBuf, i, FIT_LEVEL_WINDOW_MS,
+                                            EXIT_RAMP_LO_M, EXIT_RAMP_HI_M, BARO_FILTER, ev)) {
+                    exitAltM  = ev.altM;
+                    ffStartMs = ev.tMs;
+                }
+            } else if (i == 0) {
+                ffStartMs = preBuf->at(0).tMs;
+            }
+        }
     }
 
-    void accumulateVmax(const AltitudeData& alt, UnitType unit, uint32_t nowMs, FlightPhase phase) {
-        // Convertir VS a m/s si está en ft/s
-        float vMag = fabsf(toMetersPerSecond(alt.verticalSpeed, unit));
+    void markLanding(const AltitudeData& alt, uint32_t nowMs) {
+        swoops.finish(nowMs);
+        landingMs   = nowMs;
+        landingAltM = alt.rawAlt.v;
+        if (preBuf) {
+            int i = preBuf->findRunStart([](const FlightSample& s) {
+                return fabsf(s.vsMps) < LANDING_ONSET_VS_M;
+            }, ffEndMs);
+            if (i >= 0) {
+                landingMs   = preBuf->at((size_t)i).tMs;
+                landingAltM = preBuf->at((size_t)i).altM;
+                EventTiming::Event ev;
+                if (EventTiming::refineLanding(*preBuf, i, LANDING_RAMP_MS, BARO_FILTER, ev)) {
+                    landingMs   = ev.tMs;
+                    landingAltM = ev.altM;
+                }
+            }
+        }
+        Serial.printf("[REC] landing (onset -%lu ms)\n", (unsigned long)(nowMs - landingMs));
+    }
+
+    void accumulateVmax(const AltitudeData& alt, uint32_t nowMs, FlightPhase phase) {
+        float vMag = qabs(alt.verticalSpeed).v;
         if (phase == FlightPhase::FREEFALL) {
             if (ffStartMs == 0) ffStartMs = nowMs;
             if (vMag > vmaxFF) vmaxFF = vMag;
@@ -126,8 +258,8 @@ private:
         }
     }
 
-    void finalize(const AltitudeData& alt, UnitType unit, uint32_t nowMs) {
-        if (!jumping || !logbook) {
+    void finalize(const AltitudeData& alt, uint32_t nowMs) {
+        if (!jumping || !storage) {
             reset();
             return;
         }
@@ -135,13 +267,15 @@ private:
         // Si nunca vimos freefall, interpretamos que fue un falso positivo / ride-down.
         if (ffStartMs == 0) {
             Serial.println("[REC] salto descartado: sin FREEFALL");
+            lastLogged = false;
+            closedCount++;
             reset();
             return;
         }
 
         // Si no hubo deploy marcado, usar alt actual
         if (!deployMarked) {
-            deployAltM = toMeters(alt.rawAlt, unit);
+            deployAltM = alt.rawAlt.v;
             ffEndMs    = nowMs;
         }
 
@@ -159,7 +293,95 @@ private:
         rec.vmaxCanopymps= vmaxCanopy;
         rec.flags        = 0;
 
-        bool ok = logbook->append(rec);
+        // Analítica: con los eventos ya afinados, sin recorrer la traza.
+        if (landingMs == 0) {
+            landingMs   = nowMs;
+            landingAltM = alt.rawAlt.v;
+        }
+        JumpAnalytics::Result a = analytics.finish(ffStartMs, exitAltM,
+                                                   ffEndMs, deployAltM,
+                                                   landingMs, landingAltM);
+        LogbookService::Ext ext{};
+        ext.avgFFmps         = a.avgFFmps;
+        ext.peakFFmps        = a.peakFFmps;
+        ext.t90s             = a.t90s;
+        ext.canopyTimeS      = a.canopyTimeS;
+        ext.avgCanopyMps     = a.avgCanopyMps;
+        ext.finalApproachMps = a.finalApproachMps;
+        ext.landingUtc       = rec.tsUtc ? rec.tsUtc - (nowMs - landingMs) / 1000u : 0;
+        fillSwoops(ext);
+        Serial.printf("[REC] analytics avgFF=%.1f peakFF=%.1f t90=%.1fs canopy=%.0fs@%.1f final=%.1f m/s\n",
+                      ext.avgFFmps, ext.peakFFmps, ext.t90s,
+                      ext.canopyTimeS, ext.avgCanopyMps, ext.finalApproachMps);
+
+        // La escritura real ocurre en la tarea de storage; aquí sólo encolamos.
+        pendingExt    = ext;
+        pendingRec    = rec;
+        pendingAppend = true;
+        appendDone    = false;
+        appendOk      = false;
+        appendId      = 0;
+        lastLogged    = true;
+        closedCount++;
+        submitPending();
+
+        reset();
+    }
+
+    // Resúmenes de picados en orden cronológico, en formato compacto.
+    void fillSwoops(LogbookService::Ext& ext) const {
+        uint8_t n = swoops.segmentCount();
+        if (n > LogbookService::EXT_MAX_SWOOPS) n = LogbookService::EXT_MAX_SWOOPS;
+        uint8_t order[LogbookService::EXT_MAX_SWOOPS];
+        for (uint8_t i = 0; i < n; ++i) order[i] = i;
+        for (uint8_t i = 1; i < n; ++i) {
+            for (uint8_t j = i; j > 0 &&
+                 (int32_t)(swoops.segment(order[j]).startMs - swoops.segment(order[j-1]).startMs) < 0; --j) {
+                uint8_t t = order[j]; order[j] = order[j-1]; order[j-1] = t;
+            }
+        }
+        ext.swoopCount = n;
+        for (uint8_t i = 0; i < n; ++i) {
+            const CanopySegmenter::Segment& sg = swoops.segment(order[i]);
+            LogbookService::SwoopSegment& out = ext.swoop[i];
+            out.turnAltM       = clampI16(sg.startAltM);
+            out.peakAltM       = clampI16(sg.peakAltM);
+            out.planeOutAltM   = isfinite(sg.planeOutAltM) ? clampI16(sg.planeOutAltM) : INT16_MIN;
+            long cms            = lroundf(sg.peakDescentMps * 100.0f);
+            out.peakDescentCms = (uint16_t)(cms < 0 ? 0 : (cms > 65535 ? 65535 : cms));
+            out.durationDs     = (uint16_t)((sg.durationMs / 100u > 65535u) ? 65535u : sg.durationMs / 100u);
+            Serial.printf("[REC] swoop %u: turn=%d m peak=%.1f m/s @%d m plane=%d m dur=%.1fs\n",
+                          (unsigned)i, out.turnAltM, out.peakDescentCms / 100.0f,
+                          out.peakAltM, out.planeOutAltM, out.durationDs / 10.0f);
+        }
+    }
+
+    static int16_t clampI16(float v) {
+        if (!isfinite(v)) return 0;
+        if (v >  32767.0f) return  32767;
+        if (v < -32767.0f) return -32767;
+        return (int16_t)lroundf(v);
+    }
+
+    void submitPending() {
+        if (!storage) return;
+        if (storage->submitAppend(pendingRec, onAppendDone, this, &pendingExt)) {
+            pendingAppend = false;
+        }
+    }
+
+    // Corre en la tarea de storage.
+    static void onAppendDone(StorageService::CmdType,
+                             bool ok,
+                             const LogbookService::Record& rec,
+                             void* user) {
+        JumpRecorder* self = static_cast<JumpRecorder*>(user);
+        if (self) {
+            // id antes que el flag: quien ve appendDone ya ve el id.
+            self->appendOk   = ok && rec.id != 0;
+            self->appendId   = self->appendOk ? rec.id : 0;
+            self->appendDone = true;
+        }
         Serial.printf("[REC] append jump id=%lu exit=%.1f deploy=%.1f ff=%.1fs vff=%.1f vcan=%.1f ok=%d\n",
                       (unsigned long)rec.id,
                       rec.exitAltM,
@@ -168,55 +390,27 @@ private:
                       rec.vmaxFFmps,
                       rec.vmaxCanopymps,
                       ok ? 1 : 0);
-
-        reset();
     }
 
     uint32_t getEpoch() const {
         if (!rtcDrv) return 0;
-        UtcDateTime dt = rtcDrv->nowUtc();
-        // Convertir a epoch UTC (sin depender de TZ del sistema)
-        return utcToEpoch(dt);
-    }
-
-    // days-from-civil (Howard Hinnant) → días desde 1970-01-01 (UTC).
-    static int64_t daysFromCivil(int y, unsigned m, unsigned d) {
-        y -= (m <= 2);
-        const int      era = (y >= 0 ? y : y - 399) / 400;
-        const unsigned yoe = (unsigned)(y - era * 400);                    // [0, 399]
-        const unsigned doy = (153 * (m + (m > 2 ? (unsigned)-3 : 9)) + 2) / 5 + d - 1; // [0, 365]
-        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;        // [0, 146096]
-        return (int64_t)era * 146097 + (int64_t)doe - 719468;              // 719468 = 1970-01-01
-    }
-
-    static uint32_t utcToEpoch(const UtcDateTime& dt) {
-        if (dt.year < 1970) return 0;
-        if (dt.month < 1 || dt.month > 12) return 0;
-        if (dt.day < 1 || dt.day > 31) return 0;
-        if (dt.hour > 23 || dt.minute > 59 || dt.second > 59) return 0;
-
-        int64_t days = daysFromCivil((int)dt.year, (unsigned)dt.month, (unsigned)dt.day);
-        int64_t sec  = days * 86400LL +
-                      (int64_t)dt.hour   * 3600LL +
-                      (int64_t)dt.minute * 60LL +
-                      (int64_t)dt.second;
-        if (sec < 0) return 0;
-        if (sec > 0xFFFFFFFFLL) return 0;
-        return (uint32_t)sec;
-    }
-
-    static float toMeters(float v, UnitType unit) {
-        const float M_TO_FT = 3.2808399f;
-        return (unit == UnitType::FEET) ? (v / M_TO_FT) : v;
+        // Epoch UTC de la caché del RTC (sin bus ni TZ del sistema)
+        return rtcDrv->nowEpoch();
     }
 
-    static float toMetersPerSecond(float vs, UnitType unit) {
-        const float M_TO_FT = 3.2808399f;
-        return (unit == UnitType::FEET) ? (vs / M_TO_FT) : vs;
-    }
+    StorageService*         storage = nullptr;
+    RtcDs3231Driver*        rtcDrv  = nullptr;
+    const PreTriggerBuffer* preBuf  = nullptr;
 
-    LogbookService*   logbook = nullptr;
-    RtcDs3231Driver*  rtcDrv  = nullptr;
+    // Salto cerrado aún no aceptado por la cola de storage.
+    LogbookService::Record pendingRec{};
+    LogbookService::Ext    pendingExt{};
+    bool     pendingAppend = false;
+    uint32_t closedCount   = 0;
+    bool     lastLogged    = false;
+    volatile bool     appendDone = false;
+    volatile bool     appendOk   = false;
+    volatile uint32_t appendId   = 0;
 
     bool     jumping      = false;
     bool     deployMarked = false;
@@ -228,6 +422,27 @@ private:
     float    exitAltM     = 0.0f;
     float    deployAltM   = 0.0f;
     float    maxAltClimb  = NAN;
+    uint32_t landingMs    = 0;
+    float    landingAltM  = NAN;
     uint32_t groundStableStart = 0;
+
+    JumpAnalytics   analytics;
+    CanopySegmenter swoops;
     static constexpr uint32_t MIN_GROUND_MS = 2000; // 2s en suelo estable para cerrar
+
+    // Detección de inicio real de eventos (ver PreTriggerBuffer).
+    static constexpr float    CLIMB_ONSET_VS_M   = 0.5f;   // m/s
+    static constexpr float    EXIT_ONSET_VS_M    = -1.0f;  // m/s
+    static constexpr float    DEPLOY_ONSET_FRAC  = 0.9f;   // fracción de la VS pico
+    static constexpr uint32_t DEPLOY_LOOKBACK_MS = 10000;
+    static constexpr float    LANDING_ONSET_VS_M = 0.5f;   // m/s
+
+    // Ajuste a tramos lineales (ver util/EventTiming.h).
+    static constexpr uint32_t FIT_LEVEL_WINDOW_MS = 2000;  // media del tramo "nivel"
+    static constexpr float    EXIT_RAMP_LO_M      = -2.0f; // rampa de salida: -2 .. -10 m/s
+    static constexpr float    EXIT_RAMP_HI_M      = -10.0f;
+    static constexpr float    DEPLOY_RAMP_FRAC_HI = 0.85f; // rampa de apertura: 85% .. 40% de VS terminal
+    static constexpr float    DEPLOY_RAMP_FRAC_LO = 0.40f;
+    static constexpr uint32_t LANDING_RAMP_MS     = 1500;  // último tramo de descenso
+    static constexpr EventTiming::Filter BARO_FILTER{ALT_FILTER_ALPHA}; // EMA de AltimetryService
 };
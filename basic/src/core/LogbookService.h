@@ -28,11 +28,31 @@
 #ifndef LOGBOOK_POSIX_PATH
 #define LOGBOOK_POSIX_PATH  "/littlefs" LOGBOOK_FILE_PATH
 #endif
+#ifndef LOGBOOK_EXT_FILE_PATH
+#define LOGBOOK_EXT_FILE_PATH  "/logbook_ext.bin"
+#endif
+#ifndef LOGBOOK_EXT_POSIX_PATH
+#define LOGBOOK_EXT_POSIX_PATH "/littlefs" LOGBOOK_EXT_FILE_PATH
+#endif
 #ifndef LOGBOOK_HDR_SLOT_SIZE
 #define LOGBOOK_HDR_SLOT_SIZE 4096u   // 4 KiB alineado
 #endif
+// Presupuesto de la partición LittleFS ('spiffs' en partitions.csv, 960 KiB),
+// que comparten la bitácora, sus extensiones y el anillo de trazas
+// (TraceStore). StorageService comprueba en compilación que, llenos los
+// tres, queda LOGBOOK_FS_RESERVE_BYTES libre para metadatos y copy-on-write
+// de LittleFS.
 #ifndef LOGBOOK_CAPACITY
-#define LOGBOOK_CAPACITY    30000u    // nº de saltos
+#define LOGBOOK_CAPACITY    18000u    // nº de saltos (32 B c/u, ~563 KiB)
+#endif
+#ifndef LOGBOOK_EXT_CAPACITY
+#define LOGBOOK_EXT_CAPACITY 256u     // últimos saltos con analítica (64 B c/u, 16 KiB)
+#endif
+#ifndef LOGBOOK_FS_BYTES
+#define LOGBOOK_FS_BYTES    0xF0000u  // tamaño de la partición 'spiffs'
+#endif
+#ifndef LOGBOOK_FS_RESERVE_BYTES
+#define LOGBOOK_FS_RESERVE_BYTES (24u * 4096u)   // bloques libres para LittleFS
 #endif
 
 class LogbookService {
@@ -49,6 +69,49 @@ public:
         uint16_t crc16     = 0;
     };
 
+    // Campos opcionales de un salto (analítica). Viven en un archivo paralelo
+    // (LOGBOOK_EXT_FILE_PATH), un anillo propio más pequeño que la bitácora:
+    // sólo los últimos LOGBOOK_EXT_CAPACITY saltos, en el slot (id-1) % N. Se
+    // validan por id + CRC: así Record no cambia de tamaño (no hay que
+    // reformatear) y los saltos antiguos simplemente no tienen extensión.
+    // Slot fijo de 64 bytes: las versiones nuevas consumen 'reserved'.
+    //  v1: analítica de caída libre / vela.
+    //  v2: + resúmenes de picados bajo vela (swoop).
+    static constexpr uint8_t EXT_VERSION = 2;
+
+    struct __attribute__((packed)) SwoopSegment {
+        int16_t  turnAltM       = 0;   // inicio del giro
+        int16_t  peakAltM       = 0;   // altitud de la máxima tasa de descenso
+        int16_t  planeOutAltM   = 0;   // INT16_MIN si no hubo plane-out
+        uint16_t peakDescentCms = 0;   // máxima tasa de descenso (cm/s)
+        uint16_t durationDs     = 0;   // duración (décimas de s)
+    };
+    static constexpr uint8_t EXT_MAX_SWOOPS = 2;
+
+    struct __attribute__((packed)) Ext {
+        uint32_t id               = 0;
+        uint8_t  version          = EXT_VERSION;
+        uint8_t  flags            = 0;
+        float    avgFFmps         = NAN;
+        float    peakFFmps        = NAN;
+        float    t90s             = NAN;   // salida → 90% de la VS pico
+        float    canopyTimeS      = NAN;
+        float    avgCanopyMps     = NAN;
+        float    finalApproachMps = NAN;
+        uint32_t landingUtc       = 0;
+        uint8_t      swoopCount   = 0;     // v2
+        SwoopSegment swoop[EXT_MAX_SWOOPS];
+        uint8_t  reserved[7]      = {};
+        uint16_t crc16            = 0;
+    };
+    static_assert(sizeof(Ext) == 64, "Ext debe ocupar 64 bytes");
+
+    // Tamaño máximo de cada archivo (para el presupuesto de la partición).
+    static constexpr uint32_t fileBytes(uint32_t capacity) {
+        return (uint32_t)LOGBOOK_HDR_SLOT_SIZE * 2u + capacity * (uint32_t)sizeof(Record);
+    }
+    static constexpr uint32_t EXT_FILE_BYTES = LOGBOOK_EXT_CAPACITY * (uint32_t)sizeof(Ext);
+
     struct Stats {
         uint32_t count    = 0;
         uint32_t totalIds = 0;
@@ -82,13 +145,59 @@ public:
         return true;
     }
 
+    // Cabecera que sobrevive a un deep sleep (core/WarmStartService.h).
+    struct WarmState {
+        uint32_t capacity = 0;
+        uint32_t head     = 0;
+        uint32_t count    = 0;
+        uint32_t nextId   = 1;
+        uint32_t gen      = 0;
+    };
+
+    bool saveWarm(WarmState& w) const {
+        if (!hdrLoaded) return false;
+        w.capacity = hdr.capacity;
+        w.head     = hdr.head;
+        w.count    = hdr.count;
+        w.nextId   = hdr.nextId;
+        w.gen      = hdr.gen;
+        return true;
+    }
+
+    // Alternativa a begin() tras un deep sleep: cabecera desde RTC, sin
+    // montar ni leer nada. LittleFS se monta en el primer acceso (mount()).
+    bool beginWarm(const WarmState& w) {
+        if (w.capacity != LOGBOOK_CAPACITY || w.gen == 0 ||
+            w.head >= w.capacity || w.count > w.capacity) {
+            return false;
+        }
+        hdr          = Header{};
+        hdr.capacity = w.capacity;
+        hdr.head     = w.head;
+        hdr.count    = w.count;
+        hdr.nextId   = w.nextId;
+        hdr.gen      = w.gen;
+        hdr.crc      = hdrCrc(hdr);
+        hdrLoaded    = true;
+        return true;
+    }
+
+    // Monta LittleFS si aún no lo está (también lo usa TraceStore).
+    bool mount() { return ensureFS(); }
+
+    // Cabecera cargada (begin() o beginWarm()).
+    bool isReady() const { return hdrLoaded; }
+
     bool reset() {
         if (!hdrLoaded) { Serial.println("[logbook] append abort: header not loaded"); return false; }
         formatFreshFile(hdr.capacity);
         return true;
     }
 
-    bool append(const Record& rIn) {
+    // El hueco del Record se reserva primero: la extensión es opcional y nunca
+    // le quita sitio. ext se escribe antes del commit del Record: si el Record
+    // es visible, su extensión ya está en disco.
+    bool append(const Record& rIn, const Ext* extIn = nullptr) {
         if (!hdrLoaded) return false;
 
         Record rec = rIn;
@@ -104,6 +213,20 @@ public:
             return false;
         }
 
+        if (extIn) {
+            Ext ext = *extIn;
+            ext.id      = rec.id;
+            ext.version = EXT_VERSION;
+            ext.crc16   = extCrc(ext);
+            uint32_t extOff = extOffset(rec.id);
+            if (!extRoomFor(extOff + sizeof(Ext)) ||
+                !posixExtendTo(extOff, LOGBOOK_EXT_POSIX_PATH) ||
+                !posixWriteAt(extOff, &ext, sizeof(ext), LOGBOOK_EXT_POSIX_PATH)) {
+                // La extensión es opcional: el salto se guarda igual.
+                LB_DBG("[logbook] ext write FAIL (id=%lu)\n", (unsigned long)rec.id);
+            }
+        }
+
         // Commit en 2 fases
         Record tmp = rec;
         tmp.flags &= ~FLAG_VALID;
@@ -177,6 +300,24 @@ public:
         return true;
     }
 
+    // Extensión del registro idxNewestFirst. false si no tiene (salto antiguo,
+    // escrito sin analítica o slot de otro salto).
+    bool getExtByIndex(uint16_t idxNewestFirst, Ext& out) {
+        Record rec{};
+        if (!getByIndex(idxNewestFirst, rec)) return false;
+
+        uint32_t off = extOffset(rec.id);
+        if (posixGetSize(LOGBOOK_EXT_POSIX_PATH) < off + sizeof(Ext)) return false;
+
+        Ext tmp{};
+        if (!posixReadAt(off, &tmp, sizeof(tmp), LOGBOOK_EXT_POSIX_PATH)) return false;
+        if (tmp.crc16 != extCrc(tmp)) return false;
+        if (tmp.id != rec.id)         return false;
+        if (tmp.version == 0)         return false;
+        out = tmp;
+        return true;
+    }
+
 private:
     struct __attribute__((packed)) Header {
         uint32_t magic    = 0x4C4F4742; // "LOGB"
@@ -215,8 +356,39 @@ private:
         return crc16_ccitt(reinterpret_cast<const uint8_t*>(&tmp), sizeof(tmp));
     }
 
+    static uint16_t extCrc(const Ext& e) {
+        Ext tmp = e;
+        tmp.crc16 = 0;
+        return crc16_ccitt(reinterpret_cast<const uint8_t*>(&tmp), sizeof(tmp));
+    }
+
     static uint32_t dataBaseOffset() { return (uint32_t)LOGBOOK_HDR_SLOT_SIZE * 2u; }
 
+    static uint32_t extOffset(uint32_t id) {
+        return ((id - 1u) % LOGBOOK_EXT_CAPACITY) * (uint32_t)sizeof(Ext);
+    }
+
+    // ¿Se puede hacer crecer el archivo de extensiones hasta 'extSize' sin
+    // comerse lo que aún le falta crecer a la bitácora ni la reserva de
+    // LittleFS? Normalmente sí (el presupuesto cuadra en compilación); esto
+    // cubre una partición con otros archivos o más pequeña de lo previsto.
+    bool extRoomFor(uint32_t extSize) {
+        uint32_t cur = posixGetSize(LOGBOOK_EXT_POSIX_PATH);
+        if (cur >= extSize) return true;
+        uint32_t grow    = extSize - cur;
+        uint32_t recMax  = fileBytes(hdr.capacity);
+        uint32_t recCur  = posixGetSize();
+        uint32_t recGrow = (recMax > recCur) ? (recMax - recCur) : 0;
+        size_t total = LittleFS.totalBytes();
+        size_t used  = LittleFS.usedBytes();
+        size_t freeB = (total > used) ? (total - used) : 0;
+        if (freeB >= (size_t)grow + recGrow + LOGBOOK_FS_RESERVE_BYTES) return true;
+        LB_DBG("[logbook] ext sin sitio: libre=%u necesita=%u+%u+%u\n",
+               (unsigned)freeB, (unsigned)grow, (unsigned)recGrow,
+               (unsigned)LOGBOOK_FS_RESERVE_BYTES);
+        return false;
+    }
+
     bool ensureFS() {
         if (fsMounted) return true;
         printFSPartitionInfo();
@@ -243,15 +415,15 @@ private:
         }
     }
 
-    uint32_t posixGetSize() const {
+    uint32_t posixGetSize(const char* path = LOGBOOK_POSIX_PATH) const {
         struct stat st;
-        if (::stat(LOGBOOK_POSIX_PATH, &st) == 0) return (uint32_t)st.st_size;
+        if (::stat(path, &st) == 0) return (uint32_t)st.st_size;
         return 0u;
     }
 
-    int openRWfd_with_retry() {
+    int openRWfd_with_retry(const char* path = LOGBOOK_POSIX_PATH) {
         for (int att = 0; att < 2; ++att) {
-            int fd = ::open(LOGBOOK_POSIX_PATH, O_RDWR | O_CREAT, 0666);
+            int fd = ::open(path, O_RDWR | O_CREAT, 0666);
             if (fd >= 0) return fd;
             int e = errno;
             LB_DBG("[logbook] open(O_RDWR) FAIL (errno=%d %s)\n", e, strerror(e));
@@ -272,9 +444,10 @@ private:
         return -1;
     }
 
-    bool posixWriteAt(uint32_t off, const void* buf, size_t len) {
+    bool posixWriteAt(uint32_t off, const void* buf, size_t len,
+                      const char* path = LOGBOOK_POSIX_PATH) {
         if (!ensureFS()) return false;
-        int fd = openRWfd_with_retry();
+        int fd = openRWfd_with_retry(path);
         if (fd < 0) return false;
         if (::lseek(fd, (off_t)off, SEEK_SET) < 0) {
             LB_DBG("[logbook] lseek FAIL (errno=%d %s)\n", errno, strerror(errno));
@@ -292,9 +465,10 @@ private:
         return true;
     }
 
-    bool posixReadAt(uint32_t off, void* buf, size_t len) const {
+    bool posixReadAt(uint32_t off, void* buf, size_t len,
+                     const char* path = LOGBOOK_POSIX_PATH) const {
         if (len == 0) return true;
-        int fd = ::open(LOGBOOK_POSIX_PATH, O_RDONLY);
+        int fd = ::open(path, O_RDONLY);
         if (fd < 0) { LB_DBG("[logbook] open(O_RDONLY) FAIL (errno=%d %s)\n", errno, strerror(errno)); return false; }
         if (::lseek(fd, (off_t)off, SEEK_SET) < 0) {
             LB_DBG("[logbook] lseek(READ) FAIL (errno=%d %s)\n", errno, strerror(errno));
@@ -309,12 +483,12 @@ private:
         return true;
     }
 
-    bool posixExtendTo(uint32_t targetSize) {
+    bool posixExtendTo(uint32_t targetSize, const char* path = LOGBOOK_POSIX_PATH) {
         if (!ensureFS()) return false;
-        uint32_t cur = posixGetSize();
+        uint32_t cur = posixGetSize(path);
         if (cur >= targetSize) return true;
 
-        int fd = openRWfd_with_retry();
+        int fd = openRWfd_with_retry(path);
         if (fd < 0) return false;
 
         if (::lseek(fd, 0, SEEK_END) < 0) {
@@ -338,7 +512,7 @@ private:
         }
         ::fsync(fd);
         ::close(fd);
-        LB_DBG("[logbook] Archivo extendido (POSIX) a %u bytes\n", (unsigned)targetSize);
+        LB_DBG("[logbook] %s extendido (POSIX) a %u bytes\n", path, (unsigned)targetSize);
         return true;
     }
 
@@ -391,6 +565,9 @@ private:
         File fw = LittleFS.open(LOGBOOK_FILE_PATH, "w");
         if (!fw) { LB_DBG("[logbook] NO se pudo truncar/crear con 'w'\n"); }
         fw.close();
+        // Los ids vuelven a empezar: las extensiones viejas no deben casar.
+        File fe = LittleFS.open(LOGBOOK_EXT_FILE_PATH, "w");
+        fe.close();
 
         memset(&hdr, 0, sizeof(hdr));
         hdr.magic    = LB_MAGIC;
@@ -418,6 +595,17 @@ private:
         }
         uint32_t oldCap = hdr.capacity;
         uint32_t newCap = LOGBOOK_CAPACITY;
+        if (newCap < oldCap && hdr.count == hdr.head && hdr.head <= newCap) {
+            // El anillo nunca dio la vuelta y todo cabe en la capacidad nueva:
+            // los registros ya están en sus posiciones, basta la cabecera.
+            hdr.capacity = newCap;
+            hdr.head     = hdr.head % newCap;
+            hdr.gen++;
+            writeBothHeaders();
+            LB_DBG("[logbook] Capacidad reducida old=%u -> new=%u (count=%u)\n",
+                   (unsigned)oldCap, (unsigned)newCap, (unsigned)hdr.count);
+            return;
+        }
         if (newCap > oldCap) {
             uint32_t need = dataBaseOffset();
             if (ensureDataCapacityPOSIX(need)) {
@@ -0,0 +1,116 @@
+#pragma once
+#include <Arduino.h>
+#include "esp_sleep.h"
+
+#include "drivers/Bmp390Driver.h"
+#include "util/PressureWakeModel.h"
+
+// Despertar de deep sleep por subida de presión.
+//
+// Antes, deep sleep sólo despertaba con botones o cargador: un equipo
+// olvidado dormido en el avión no daba altura. Ahora, al dormir se guarda
+// la presión de suelo en memoria RTC y se añade un timer; cada
+// PRESS_WAKE_PERIOD_S el firmware arranca, hace una conversión forced del
+// BMP390 y aplica util/PressureWakeModel.h. Si no hay subida vuelve a
+// dormir antes de iniciar pantalla, LittleFS o BLE. Si la hay, sigue el
+// arranque normal con la presión de suelo como cero (getGroundPa()).
+//
+// Coste estimado (ESP32-S3, arranque hasta la comprobación ~100 ms a
+// ~25 mA, más ~25 ms de medida): ~3.1 mC por comprobación, es decir
+// ~52 uA de media con periodo de 60 s (~1.25 mAh/día) sobre los ~10-15 uA
+// del deep sleep. La misma comprobación en el ULP RISC-V (I2C RTC en
+// GPIO3/GPIO2, ~10 ms a ~0.3 mA + sensor) quedaría por debajo de 1 uA, pero
+// el framework Arduino precompilado no permite embeber el binario ULP; el
+// modelo ya es C entero para poder llevarlo tal cual.
+#ifndef PRESS_WAKE_ENABLE
+#define PRESS_WAKE_ENABLE     1
+#endif
+#ifndef PRESS_WAKE_PERIOD_S
+#define PRESS_WAKE_PERIOD_S   60      // comprobación normal
+#endif
+#ifndef PRESS_WAKE_CONFIRM_S
+#define PRESS_WAKE_CONFIRM_S  10      // tras una primera caída
+#endif
+#ifndef PRESS_WAKE_CLIMB_PA
+#define PRESS_WAKE_CLIMB_PA   1500    // ~125 m a nivel del mar, ~150 m a 1500 m
+#endif
+
+class PressureWakeService {
+public:
+    // rtcState debe vivir en memoria RTC (RTC_DATA_ATTR).
+    void begin(pwm_state_t* rtcState) {
+        state = rtcState;
+        checkWake = false;
+        if (!state) return;
+
+        cfg.climbPa    = PRESS_WAKE_CLIMB_PA;
+        cfg.confirmN   = 2;
+        cfg.trackShift = 3;
+
+        // Sólo un wake por timer con el estado armado es una comprobación;
+        // cualquier otro arranque (botón, cargador, reset) lo desarma.
+        if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && pwm_is_armed(state)) {
+            checkWake = true;
+        } else {
+            pwm_disarm(state);
+        }
+    }
+
+    bool isCheckWake() const { return checkWake; }
+
+    // Comprobación al arrancar: true si hay que seguir con el arranque.
+    bool evaluate(Bmp390Driver& bmp) {
+        if (!checkWake) return true;
+
+        // Medida corta: x4 sin IIR (~11 ms por conversión) en vez de la de
+        // AHORRO (~21 ms); basta para un umbral de cientos de Pa.
+        SensorConfig c = Bmp390Driver::configForMode(SensorMode::AHORRO_FORCED);
+        c.pressOs = BMP3_OVERSAMPLING_4X;
+        c.tempOs  = BMP3_NO_OVERSAMPLING;
+        c.iir     = BMP3_IIR_FILTER_DISABLE;
+        bmp.setConfig(c, SensorMode::AHORRO_FORCED);
+
+        float pa = NAN, tC = NAN;
+        int32_t paI = bmp.read(pa, tC) && isfinite(pa) ? (int32_t)lroundf(pa) : 0;
+        lastAction = pwm_step(state, &cfg, paI);
+        Serial.printf("[PWAKE] #%u P=%ld ref=%ld -> %d\n",
+                      (unsigned)state->samples, (long)paI, (long)state->refPa, lastAction);
+
+        if (lastAction == PWM_WAKE) {
+            groundPa = (float)state->refPa;
+            pwm_disarm(state);
+            checkWake = false;
+            return true;
+        }
+        return false;
+    }
+
+    // Presión de suelo si este arranque lo provocó una subida (NAN si no).
+    float getGroundPa() const { return groundPa; }
+
+    // Guarda la presión de suelo para el próximo deep sleep.
+    void arm(float groundPressurePa) {
+    #if PRESS_WAKE_ENABLE
+        if (!state || !isfinite(groundPressurePa)) return;
+        pwm_arm(state, (int32_t)lroundf(groundPressurePa));
+        lastAction = PWM_SLEEP;
+    #else
+        (void)groundPressurePa;
+    #endif
+    }
+
+    // Hook de PowerHw justo antes de esp_deep_sleep_start().
+    static void onDeepSleep(void* user) {
+        PressureWakeService* self = static_cast<PressureWakeService*>(user);
+        if (!self || !self->state || !pwm_is_armed(self->state)) return;
+        uint32_t s = (self->lastAction == PWM_CONFIRM) ? PRESS_WAKE_CONFIRM_S : PRESS_WAKE_PERIOD_S;
+        esp_sleep_enable_timer_wakeup((uint64_t)s * 1000000ULL);
+    }
+
+private:
+    pwm_state_t* state      = nullptr;
+    pwm_cfg_t    cfg        = {};
+    bool         checkWake  = false;
+    int          lastAction = PWM_SLEEP;
+    float        groundPa   = NAN;
+};
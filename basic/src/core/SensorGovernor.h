@@ -0,0 +1,303 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+
+#include "util/Types.h"
+#include "drivers/Bmp390Driver.h"
+#include "core/AltimetryService.h"
+
+//---------------------------------------------
+// Gobernador de configuración del BMP390
+//---------------------------------------------
+//
+// En vuelo sustituye la tabla fija modo -> OSR/IIR/ODR por un lazo cerrado:
+//
+// - Ruido medido: con el equipo casi quieto (suelo, avión nivelado), en cada
+//   muestra nueva se calcula el residuo de la muestra central respecto a la
+//   recta entre sus vecinas (segunda diferencia, tipo Allan/Hadamard a τ0;
+//   una deriva lenta no aporta residuo). El residuo se normaliza con la
+//   correlación que introduce el IIR del sensor y el oversampling activos, y
+//   se guarda como ruido equivalente a x1 sin IIR (m).
+// - Dinámica: |VS| y |aceleración| (derivada filtrada de la VS).
+// - Para cada configuración candidata se predice:
+//     ruido   σ = σ1 / √(osr · (2c+1)) · √(α / (2-α)) · √((1+β) / (1-β))
+//             (α: EMA de AltimetryService; β = (1-α)·φ, φ = c/(c+1) la
+//             correlación que deja el IIR entre muestras: el EMA promedia
+//             menos ruido si ya viene correlado)
+//     retardo L = medida + ½/ODR + c/ODR + retardo del EMA
+//     (el EMA corre una vez por muestra nueva, es decir, a la ODR)
+//     error dinámico = |VS|·L + ½·|a|·L²
+//     consumo ≈ GOV_SENSOR_ACTIVE_UA · medida · ODR
+//   y se elige la más barata que cumple GOV_NOISE_TARGET_M,
+//   GOV_DYN_ERR_TARGET_M y GOV_MAX_LATENCY_MS. Si ninguna cumple, la de menor
+//   error total.
+// - Subir de fidelidad es inmediato (salida del avión); bajar exige que la
+//   opción barata se mantenga GOV_DOWNGRADE_HOLD_MS.
+//
+// En suelo (AHORRO / AHORRO_FORCED) manda SleepPolicyService: allí se sigue
+// midiendo el ruido, que es lo que usa el gobernador al despegar.
+
+#ifndef SENSOR_GOV_ENABLE
+#define SENSOR_GOV_ENABLE 1
+#endif
+
+constexpr float    GOV_NOISE_TARGET_M     = 0.1f;     // ruido de altitud tras el EMA
+constexpr float    GOV_DYN_ERR_TARGET_M   = 2.0f;     // error por retardo
+constexpr float    GOV_MAX_LATENCY_MS     = 300.0f;   // retardo máximo sensor + filtros
+constexpr uint32_t GOV_EVAL_MS            = 250;      // cada cuánto se re-evalúa
+constexpr uint32_t GOV_DOWNGRADE_HOLD_MS  = 3000;     // persistencia para bajar de fidelidad
+constexpr float    GOV_CALM_VS_MPS        = 1.0f;     // sólo se mide ruido casi quieto
+constexpr float    GOV_CALM_ACCEL_MPS2    = 1.0f;
+constexpr float    GOV_NOISE_X1_SEED_M    = 0.25f;    // ruido x1 hasta tener medida
+constexpr float    GOV_SENSOR_ACTIVE_UA   = 700.0f;   // consumo del BMP390 midiendo
+
+class SensorGovernor {
+public:
+    void begin() {
+        noiseX1Var   = GOV_NOISE_X1_SEED_M * GOV_NOISE_X1_SEED_M;
+        noiseSamples = 0;
+        nPts         = 0;
+        lastSampleUs = 0;
+        accel        = 0.0f;
+        absVs        = 0.0f;
+        lastVs       = 0.0f;
+        current      = 0xFF;
+        pendingIdx   = 0xFF;
+        lastEvalMs   = 0;
+    }
+
+    // Llamar tras AltimetryService::update(). sensorAltM sin EMA;
+    // 'active' = configuración con la que se tomó la muestra.
+    void addSample(float sensorAltM, float vsMps, uint32_t sampleUs, const SensorConfig& active) {
+        if (sampleUs == lastSampleUs) return;            // sin lectura nueva
+        float dt = (lastSampleUs != 0) ? (sampleUs - lastSampleUs) * 1e-6f : 0.0f;
+        lastSampleUs = sampleUs;
+
+        if (dt > 0.0f && dt < 1.0f) {
+            float k  = dt / (ACCEL_TAU_S + dt);
+            accel   += k * ((vsMps - lastVs) / dt - accel);
+        }
+        lastVs = vsMps;
+        absVs  = fabsf(vsMps);
+
+        if (!isfinite(sensorAltM)) return;
+        // El sensor repite el último dato si leemos más rápido que su ODR:
+        // las repeticiones no son muestras independientes.
+        if (nPts > 0 && sensorAltM == ptAlt[nPts - 1]) return;
+        pushPoint(sensorAltM, sampleUs);
+        if (nPts < 3) return;
+
+        // Con VS alta el instante real de conversión (hasta 1/ODR antes de
+        // la lectura) pesa más que el ruido: sólo se mide casi quieto.
+        if (absVs < GOV_CALM_VS_MPS && fabsf(accel) < GOV_CALM_ACCEL_MPS2) {
+            float var1 = residualVarX1(active);
+            if (isfinite(var1)) {
+                float k = (noiseSamples < 50) ? 0.1f : 0.01f;
+                noiseX1Var += k * (var1 - noiseX1Var);
+                if (noiseSamples < 0xFFFF) noiseSamples++;
+            }
+        }
+    }
+
+    // Configuración a aplicar este loop.
+    SensorConfig select(SensorMode policyMode, FlightPhase phase, uint32_t nowMs) {
+        bool governed = SENSOR_GOV_ENABLE &&
+                        phase != FlightPhase::GROUND &&
+                        (policyMode == SensorMode::PRECISO || policyMode == SensorMode::FREEFALL);
+        if (!governed) {
+            current    = 0xFF;
+            pendingIdx = 0xFF;
+            return Bmp390Driver::configForMode(policyMode);
+        }
+
+        if (current == 0xFF || (nowMs - lastEvalMs) >= GOV_EVAL_MS) {
+            lastEvalMs = nowMs;
+            evaluate(nowMs);
+        }
+        return candidateAt(current);
+    }
+
+    float    getNoiseX1M()      const { return sqrtf(noiseX1Var); }
+    uint16_t getNoiseSamples()  const { return noiseSamples; }
+    uint8_t  getCandidate()     const { return current; }
+    float    getPredNoiseM()    const { return predNoiseM; }
+    float    getPredDynErrM()   const { return predDynErrM; }
+    float    getPredLatencyMs() const { return predLatencyS * 1000.0f; }
+    float    getPowerUa()       const { return predPowerUa; }
+    uint32_t getSwitchCount()   const { return switches; }
+
+    // Predicciones para una candidata (también las usa test/test_sensor_governor).
+    struct Prediction { float noiseM; float latencyS; float dynErrM; float powerUa; };
+
+    Prediction predict(const SensorConfig& c, float absVsMps, float absAccel) const {
+        Prediction p;
+        float odr     = c.odrHz();
+        float a       = ALT_FILTER_ALPHA;
+        float coef    = (float)c.iirCoef();
+        float beta    = (1.0f - a) * coef / (coef + 1.0f);
+
+        p.noiseM   = sqrtf(noiseX1Var / ((float)c.osrP() * (2.0f * coef + 1.0f))) *
+                     sqrtf(a / (2.0f - a)) * sqrtf((1.0f + beta) / (1.0f - beta));
+        // La temperatura va a baja tasa (Bmp390Driver): la conversión típica
+        // es sólo de presión.
+        p.latencyS = c.measTimeUs(false) * 1e-6f + 0.5f / odr + coef / odr +
+                     ((1.0f - a) / a) / odr;
+        p.dynErrM  = absVsMps * p.latencyS + 0.5f * absAccel * p.latencyS * p.latencyS;
+        p.powerUa  = GOV_SENSOR_ACTIVE_UA * (c.measTimeUs(false) * 1e-6f) * odr;
+        return p;
+    }
+
+    static uint8_t candidateCount() { return CANDIDATE_COUNT; }
+    static const SensorConfig& candidate(uint8_t i) { return candidateAt(i); }
+
+private:
+    static constexpr float   ACCEL_TAU_S     = 0.5f;
+    static constexpr uint8_t CANDIDATE_COUNT = 8;
+
+    static SensorConfig mk(uint8_t os, uint8_t iir, uint8_t odr) {
+        SensorConfig c;
+        c.pressOs = os;
+        c.tempOs  = BMP3_NO_OVERSAMPLING;
+        c.iir     = iir;
+        c.odr     = odr;
+        c.forced  = false;
+        c.i2cHz   = 400000;
+        return c;
+    }
+
+    // Ordenadas de más fiel/cara a más barata. Todas caben en su periodo de
+    // ODR (SensorConfig::feasible) con temperatura a x1.
+    static const SensorConfig& candidateAt(uint8_t i) {
+        static const SensorConfig table[CANDIDATE_COUNT] = {
+            mk(BMP3_NO_OVERSAMPLING, BMP3_IIR_FILTER_DISABLE, BMP3_ODR_200_HZ),   // 4.9 ms  ~690 uA
+            mk(BMP3_OVERSAMPLING_2X, BMP3_IIR_FILTER_DISABLE, BMP3_ODR_100_HZ),   // 6.9 ms  ~490 uA
+            mk(BMP3_OVERSAMPLING_4X, BMP3_IIR_FILTER_COEFF_1, BMP3_ODR_50_HZ),    // 10.9 ms ~380 uA
+            mk(BMP3_OVERSAMPLING_2X, BMP3_IIR_FILTER_COEFF_1, BMP3_ODR_50_HZ),    //         ~240 uA
+            mk(BMP3_OVERSAMPLING_4X, BMP3_IIR_FILTER_COEFF_3, BMP3_ODR_25_HZ),    //         ~190 uA
+            mk(BMP3_OVERSAMPLING_2X, BMP3_IIR_FILTER_COEFF_3, BMP3_ODR_25_HZ),    //         ~120 uA
+            mk(BMP3_OVERSAMPLING_4X, BMP3_IIR_FILTER_COEFF_1, BMP3_ODR_12_5_HZ),  //         ~95 uA
+            mk(BMP3_OVERSAMPLING_8X, BMP3_IIR_FILTER_COEFF_1, BMP3_ODR_6_25_HZ),  // 18.9 ms ~85 uA
+        };
+        return table[i < CANDIDATE_COUNT ? i : 0];
+    }
+
+    void evaluate(uint32_t nowMs) {
+        float absAcc = fabsf(accel);
+        uint8_t best = 0xFF, fallback = 0;
+        float   bestPower = INFINITY, fallbackErr = INFINITY;
+
+        for (uint8_t i = 0; i < CANDIDATE_COUNT; ++i) {
+            Prediction p = predict(candidateAt(i), absVs, absAcc);
+            float total = sqrtf(p.noiseM * p.noiseM + p.dynErrM * p.dynErrM);
+            if (total < fallbackErr) {
+                fallbackErr = total;
+                fallback    = i;
+            }
+            bool ok = p.noiseM   <= GOV_NOISE_TARGET_M &&
+                      p.dynErrM  <= GOV_DYN_ERR_TARGET_M &&
+                      p.latencyS <= GOV_MAX_LATENCY_MS * 0.001f;
+            if (ok && p.powerUa < bestPower) {
+                bestPower = p.powerUa;
+                best      = i;
+            }
+        }
+        uint8_t want = (best != 0xFF) ? best : fallback;
+
+        if (current == 0xFF) {
+            apply(want);
+        } else if (want != current) {
+            bool upgrade = predict(candidateAt(want), 0.0f, 0.0f).powerUa >
+                           predict(candidateAt(current), 0.0f, 0.0f).powerUa;
+            if (upgrade) {
+                apply(want);
+            } else if (want != pendingIdx) {
+                pendingIdx     = want;
+                pendingSinceMs = nowMs;
+            } else if ((nowMs - pendingSinceMs) >= GOV_DOWNGRADE_HOLD_MS) {
+                apply(want);
+            }
+        } else {
+            pendingIdx = 0xFF;
+        }
+
+        Prediction cur = predict(candidateAt(current), absVs, absAcc);
+        predNoiseM   = cur.noiseM;
+        predDynErrM  = cur.dynErrM;
+        predLatencyS = cur.latencyS;
+        predPowerUa  = cur.powerUa;
+    }
+
+    void apply(uint8_t idx) {
+        if (current != 0xFF && idx != current) switches++;
+        current    = idx;
+        pendingIdx = 0xFF;
+        const SensorConfig& c = candidateAt(idx);
+        Serial.printf("[GOV] cfg %u: osr x%u iir %u odr %.1f Hz (σ1=%.2f m, vs=%.1f, a=%.1f)\n",
+                      (unsigned)idx, (unsigned)c.osrP(), (unsigned)c.iirCoef(), c.odrHz(),
+                      sqrtf(noiseX1Var), absVs, accel);
+    }
+
+    void pushPoint(float altM, uint32_t us) {
+        if (nPts == 3) {
+            ptAlt[0] = ptAlt[1]; ptUs[0] = ptUs[1];
+            ptAlt[1] = ptAlt[2]; ptUs[1] = ptUs[2];
+            nPts = 2;
+        }
+        ptAlt[nPts] = altM;
+        ptUs[nPts]  = us;
+        nPts++;
+    }
+
+    // Residuo de la muestra central frente a la interpolación lineal de sus
+    // vecinas, dividido por su varianza esperada (ruido unitario con la
+    // correlación del IIR a esas separaciones) y llevado a x1 sin IIR.
+    float residualVarX1(const SensorConfig& c) const {
+        float dt1 = (ptUs[1] - ptUs[0]) * 1e-6f;
+        float dt2 = (ptUs[2] - ptUs[1]) * 1e-6f;
+        if (dt1 <= 0.0f || dt2 <= 0.0f || dt1 > 1.0f || dt2 > 1.0f) return NAN;
+
+        float w0 = dt2 / (dt1 + dt2);
+        float w2 = dt1 / (dt1 + dt2);
+        float r  = ptAlt[1] - (w0 * ptAlt[0] + w2 * ptAlt[2]);
+
+        // IIR de primer orden: correlación φ por muestra del sensor.
+        float coef = (float)c.iirCoef();
+        float phi  = coef / (coef + 1.0f);
+        // Pasos del IIR entre muestras: en forced, las conversiones que
+        // dispara cada lectura; en normal, ODR · dt.
+        float n1   = c.forced ? (float)Bmp390Driver::FORCED_SAMPLES_PER_READ : c.odrHz() * dt1;
+        float n2   = c.forced ? (float)Bmp390Driver::FORCED_SAMPLES_PER_READ : c.odrHz() * dt2;
+        float r01  = powf(phi, n1);
+        float r12  = powf(phi, n2);
+        float r02  = r01 * r12;
+        float g    = 1.0f + w0 * w0 + w2 * w2 - 2.0f * w0 * r01 - 2.0f * w2 * r12 + 2.0f * w0 * w2 * r02;
+        if (g < 0.05f) return NAN;   // muestras demasiado correladas: no informa
+
+        // Varianza de salida del sensor -> x1 sin IIR.
+        return (r * r / g) * (float)c.osrP() * (2.0f * coef + 1.0f);
+    }
+
+    // Estimación de ruido
+    float    noiseX1Var   = GOV_NOISE_X1_SEED_M * GOV_NOISE_X1_SEED_M;
+    uint16_t noiseSamples = 0;
+    float    ptAlt[3]     = {};
+    uint32_t ptUs[3]      = {};
+    uint8_t  nPts         = 0;
+
+    // Dinámica
+    uint32_t lastSampleUs = 0;
+    float    lastVs       = 0.0f;
+    float    absVs        = 0.0f;
+    float    accel        = 0.0f;
+
+    // Selección
+    uint8_t  current        = 0xFF;
+    uint8_t  pendingIdx     = 0xFF;
+    uint32_t pendingSinceMs = 0;
+    uint32_t lastEvalMs     = 0;
+    uint32_t switches       = 0;
+    float    predNoiseM     = NAN;
+    float    predDynErrM    = NAN;
+    float    predLatencyS   = NAN;
+    float    predPowerUa    = NAN;
+};
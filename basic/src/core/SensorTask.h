@@ -0,0 +1,357 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include "util/Types.h"
+#include "util/SeqLock.h"
+#include "util/PreTriggerBuffer.h"
+#include "drivers/I2cBus.h"
+#include "drivers/Bmp390Driver.h"
+#include "core/AltimetryService.h"
+#include "core/FlightPhaseService.h"
+#include "core/AltitudeAlertService.h"
+#include "core/SensorGovernor.h"
+#include "core/JumpRecorder.h"
+#include "core/FlightTraceRecorder.h"
+
+// Tarea de sensor / estimación / fase.
+//
+// Todo lo que depende de cada muestra de presión corre aquí, a la cadencia
+// del sensor y con la prioridad más alta de la aplicación: lectura del BMP390
+// (y transacciones I2C de segundo plano detrás), filtrado y VS, alertas,
+// pre-trigger, gobernador, FlightPhaseService y grabadores. Un frame lento o
+// una escritura a flash ya no retrasan el muestreo.
+//
+// Reparto de tareas (prioridad FreeRTOS, mayor = más urgente):
+//
+//   tarea    core  prio  periodo                  plazo
+//   sensor    1     5    periodo de muestreo      el mismo periodo (5 ms a
+//                        (5 ms .. 500 ms)         200 Hz); se cuenta en overruns
+//   ui        0     2    UI_TASK_FRAME_MS o el    UI_TASK_DEADLINE_MS desde un
+//                        del sensor; botón antes  botón hasta el frame
+//   storage   0     1    por comando              sin plazo: cola acotada y
+//                                                 back-pressure (StorageService)
+//   battery   0     1    BATT_SAMPLE_PERIOD_MS    sin plazo (BatteryMonitor)
+//   BLE       0     (pila Bluedroid)              callbacks cortos; el trabajo
+//                                                 lo recoge la UI (BleManager)
+//
+// El core 1 queda para el sensor (el loopTask de Arduino se borra tras
+// setup()). Comunicación entre tareas:
+//  - sensor -> resto: Snapshot publicado con SeqLock tras cada ciclo; nadie
+//    fuera de esta tarea llama a AltimetryService / FlightPhaseService /
+//    Bmp390Driver tras begin().
+//  - resto -> sensor: cola de Cmd tipados (recalibrar, lock, modo, alertas).
+//    Se aplican al principio del siguiente ciclo.
+//  - Light/deep sleep desde la UI: pause() espera a que termine el ciclo en
+//    curso (ninguna transacción I2C a medias) y lo retiene hasta resume().
+
+#ifndef SENSOR_CMD_QUEUE_LEN
+#define SENSOR_CMD_QUEUE_LEN     8
+#endif
+#ifndef SENSOR_TASK_STACK
+#define SENSOR_TASK_STACK        6144
+#endif
+#ifndef SENSOR_TASK_PRIORITY
+#define SENSOR_TASK_PRIORITY     5
+#endif
+#ifndef SENSOR_TASK_CORE
+#define SENSOR_TASK_CORE         1
+#endif
+
+class SensorTask {
+public:
+    // Estado publicado tras cada ciclo.
+    struct Snapshot {
+        AltitudeData alt{};
+        FlightPhase  phase        = FlightPhase::GROUND;
+        uint32_t     sampleUs     = 0;     // instante de la muestra (AltimetryService)
+        uint32_t     samplePeriodUs = 0;   // entre las dos últimas muestras (ODR real)
+        uint32_t     tMs          = 0;     // millis() al publicar
+        bool         recorderBusy = false; // grabadores con escrituras pendientes
+    };
+
+    struct Stats {
+        uint32_t cycles      = 0;
+        uint32_t lastCycleUs = 0;
+        uint32_t maxCycleUs  = 0;
+        uint32_t overruns    = 0;   // ciclos que duraron más que su periodo
+        uint32_t cmdRejected = 0;   // comandos perdidos por cola llena
+    };
+
+    // Piezas del pipeline; todas pasan a ser de esta tarea.
+    struct Pipeline {
+        I2cBus*               bus        = nullptr;
+        Bmp390Driver*         bmp        = nullptr;
+        AltimetryService*     altimetry  = nullptr;
+        FlightPhaseService*   flight     = nullptr;
+        AltitudeAlertService* alerts     = nullptr;
+        SensorGovernor*       governor   = nullptr;
+        PreTriggerBuffer*     preTrigger = nullptr;
+        JumpRecorder*         jump       = nullptr;
+        FlightTraceRecorder*  trace      = nullptr;
+    };
+
+    bool begin(const Pipeline& p, bool lockActive) {
+        pipe       = p;
+        locked     = lockActive;
+        postedLock = lockActive;
+        if (!pipe.bmp || !pipe.altimetry || !pipe.flight) return false;
+
+        queue      = xQueueCreate(SENSOR_CMD_QUEUE_LEN, sizeof(Cmd));
+        cycleMutex = xSemaphoreCreateMutex();
+        if (!queue || !cycleMutex) {
+            Serial.println("[sensor] no se pudo crear cola/mutex");
+            return false;
+        }
+
+        // Snapshot inicial: lo que haya dejado setup().
+        publish(millis());
+
+        BaseType_t ok = xTaskCreatePinnedToCore(taskEntry,
+                                                "sensor",
+                                                SENSOR_TASK_STACK,
+                                                this,
+                                                SENSOR_TASK_PRIORITY,
+                                                &task,
+                                                SENSOR_TASK_CORE);
+        if (ok != pdPASS) {
+            Serial.println("[sensor] no se pudo crear la tarea");
+            task = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // ---- Lectores (cualquier tarea) ----
+
+    // Devuelve la secuencia del snapshot: igual a la anterior = sin muestra nueva.
+    uint32_t read(Snapshot& out) const { return snap.read(out); }
+
+    FlightPhase getPhase() const {
+        Snapshot s;
+        snap.read(s);
+        return s.phase;
+    }
+
+    Stats getStats() const {
+        Stats s;
+        portENTER_CRITICAL(&statsMux);
+        s = stats;
+        portEXIT_CRITICAL(&statsMux);
+        return s;
+    }
+
+    uint32_t getPeriodMs() const { return periodMs; }
+
+    // ---- Comandos (desde la UI) ----
+
+    // Nuevo cero con el offset dado (AltimetryService::recalibrateGround).
+    bool requestRecalibrate(Meters offset) {
+        Cmd c{};
+        c.type  = CmdType::RECALIBRATE;
+        c.value = offset.v;
+        return post(c);
+    }
+
+    // Estado del lock de UI. Sólo encola si cambió; si la cola estaba llena
+    // se reintenta en la siguiente llamada.
+    void setLockActive(bool lockActive) {
+        if (lockActive == postedLock) return;
+        Cmd c{};
+        c.type = CmdType::SET_LOCK;
+        c.flag = lockActive;
+        if (post(c)) postedLock = lockActive;
+    }
+
+    // Modo de sensor de la política de energía. Igual que setLockActive().
+    void setSensorMode(SensorMode m) {
+        if (modePosted && m == postedMode) return;
+        Cmd c{};
+        c.type = CmdType::SET_MODE;
+        c.mode = m;
+        if (post(c)) {
+            postedMode = m;
+            modePosted = true;
+        }
+    }
+
+    // Configuración de alertas (BLE / UI). Devuelve false si la cola está
+    // llena: el llamante no debe dar el cambio por aplicado.
+    bool setAlertConfig(const AlertConfig& a) {
+        Cmd c{};
+        c.type   = CmdType::SET_ALERTS;
+        c.alerts = a;
+        return post(c);
+    }
+
+    // Hook para BleManager::setAlertsHook().
+    static bool onAlertConfigHook(const AlertConfig& a, void* user) {
+        SensorTask* self = static_cast<SensorTask*>(user);
+        return self && self->setAlertConfig(a);
+    }
+
+    // ---- Sleep ----
+
+    // Retiene la tarea al terminar el ciclo en curso. Para light/deep sleep
+    // desde otra tarea: esp_light_sleep_start() congela el otro core, y no
+    // debe pillar al sensor con el bus I2C a medias.
+    void pause() {
+        if (cycleMutex) xSemaphoreTake(cycleMutex, portMAX_DELAY);
+    }
+
+    void resume() {
+        if (cycleMutex) xSemaphoreGive(cycleMutex);
+    }
+
+private:
+    enum class CmdType : uint8_t { RECALIBRATE, SET_LOCK, SET_MODE, SET_ALERTS };
+
+    struct Cmd {
+        CmdType    type  = CmdType::SET_MODE;
+        float      value = 0.0f;
+        bool       flag  = false;
+        SensorMode mode  = SensorMode::AHORRO_FORCED;
+        AlertConfig alerts{};
+    };
+
+    bool post(const Cmd& c) {
+        if (queue && xQueueSend(queue, &c, 0) == pdTRUE) return true;
+        portENTER_CRITICAL(&statsMux);
+        stats.cmdRejected++;
+        portEXIT_CRITICAL(&statsMux);
+        return false;
+    }
+
+    static void taskEntry(void* arg) {
+        static_cast<SensorTask*>(arg)->run();
+    }
+
+    void run() {
+        TickType_t last = xTaskGetTickCount();
+        for (;;) {
+            xSemaphoreTake(cycleMutex, portMAX_DELAY);
+            uint32_t t0 = micros();
+            cycle();
+            uint32_t dt = micros() - t0;
+            xSemaphoreGive(cycleMutex);
+
+            periodMs = pipe.bmp->getSamplePeriodMs();
+            if (periodMs == 0) periodMs = 1;
+
+            portENTER_CRITICAL(&statsMux);
+            stats.cycles++;
+            stats.lastCycleUs = dt;
+            if (dt > stats.maxCycleUs) stats.maxCycleUs = dt;
+            if (dt > periodMs * 1000u) stats.overruns++;
+            portEXIT_CRITICAL(&statsMux);
+
+            // Tras una pausa (sleep) o un ciclo largo no recuperamos los
+            // periodos perdidos en ráfaga: se rearranca la cadencia.
+            TickType_t period = pdMS_TO_TICKS(periodMs);
+            if (period == 0) period = 1;
+            if ((TickType_t)(xTaskGetTickCount() - last) >= period) {
+                last = xTaskGetTickCount();
+            }
+            vTaskDelayUntil(&last, period);
+        }
+    }
+
+    void applyCommands() {
+        Cmd c;
+        while (xQueueReceive(queue, &c, 0) == pdTRUE) {
+            switch (c.type) {
+            case CmdType::RECALIBRATE:
+                pipe.altimetry->recalibrateGround(Meters(c.value));
+                break;
+            case CmdType::SET_LOCK:
+                locked = c.flag;
+                break;
+            case CmdType::SET_MODE:
+                mode = c.mode;
+                break;
+            case CmdType::SET_ALERTS:
+                if (pipe.alerts) pipe.alerts->setConfig(c.alerts);
+                break;
+            }
+        }
+    }
+
+    void cycle() {
+        applyCommands();
+
+        uint32_t now = millis();
+        AltimetryService& altimetry = *pipe.altimetry;
+
+        altimetry.setLockActive(locked);
+        altimetry.update(now);
+        AltitudeData alt = altimetry.getAltitudeData();
+        if (pipe.preTrigger) pipe.preTrigger->push(alt, now);
+        if (pipe.governor) {
+            pipe.governor->addSample(altimetry.getPressureAltMeters(), alt.verticalSpeed.v,
+                                     altimetry.getSampleUs(), pipe.bmp->getConfig());
+        }
+
+        FlightPhase prevPhase = FlightPhase::GROUND;
+        pipe.flight->update(alt, now, &prevPhase);
+        FlightPhase phase = pipe.flight->getPhase();
+        if (pipe.alerts) {
+            pipe.alerts->setPhase(phase);
+            pipe.alerts->tick(now);
+        }
+        if (pipe.trace) pipe.trace->update(alt, phase, prevPhase, now);
+        if (pipe.jump)  pipe.jump->update(alt, phase, prevPhase, now);
+
+        // Modo del BMP390 según la política (en vuelo, el gobernador elige
+        // OSR/IIR/ODR según ruido medido y dinámica).
+        SensorConfig cfg = pipe.governor ? pipe.governor->select(mode, phase, now)
+                                         : Bmp390Driver::configForMode(mode);
+        pipe.bmp->setConfig(cfg, mode);
+
+        // Transacciones I2C de segundo plano (hora del RTC), detrás del sensor
+        if (pipe.bus) pipe.bus->service();
+
+        publish(now);
+    }
+
+    void publish(uint32_t nowMs) {
+        Snapshot s;
+        s.alt      = pipe.altimetry->getAltitudeData();
+        s.phase    = pipe.flight->getPhase();
+        s.sampleUs = pipe.altimetry->getSampleUs();
+        s.tMs      = nowMs;
+        // La UI lee un snapshot por frame y se salta muestras: el periodo
+        // real del sensor sólo se ve desde aquí.
+        if (s.sampleUs != prevSampleUs) {
+            if (prevSampleUs != 0) samplePeriodUs = s.sampleUs - prevSampleUs;
+            prevSampleUs = s.sampleUs;
+        }
+        s.samplePeriodUs = samplePeriodUs;
+        s.recorderBusy = (pipe.jump && pipe.jump->hasPendingAppend()) ||
+                         (pipe.trace && pipe.trace->isBusy());
+        snap.write(s);
+    }
+
+    Pipeline          pipe{};
+    QueueHandle_t     queue      = nullptr;
+    SemaphoreHandle_t cycleMutex = nullptr;
+    TaskHandle_t      task       = nullptr;
+
+    // Estado propio de la tarea (aplicado desde la cola).
+    bool       locked = false;
+    SensorMode mode   = SensorMode::AHORRO_FORCED;
+    volatile uint32_t periodMs = 500;   // forced hasta el primer ciclo
+    uint32_t   prevSampleUs   = 0;
+    uint32_t   samplePeriodUs = 0;
+
+    // Último valor encolado (sólo lo toca la tarea de UI).
+    bool       postedLock = false;
+    SensorMode postedMode = SensorMode::AHORRO_FORCED;
+    bool       modePosted = false;
+
+    SeqLock<Snapshot>    snap;
+    mutable portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+    Stats                stats{};
+};
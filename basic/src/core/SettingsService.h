@@ -8,7 +8,8 @@
 #include "include/config_ble.h"
 
 // Servicio de configuración persistente sobre NVS.
-// Guarda: unidades, brillo, tiempo de ahorro, offset, idioma, invert, usuario.
+// Guarda: unidades, brillo, tiempo de ahorro, offset, idioma, invert, usuario,
+// alertas de altitud.
 
 struct HudConfig {
     // Iconos opcionales
@@ -42,11 +43,41 @@ struct HudConfig {
     }
 };
 
+#ifndef ALERT_FF_MAX
+#define ALERT_FF_MAX      3
+#endif
+#ifndef ALERT_CANOPY_MAX
+#define ALERT_CANOPY_MAX  3
+#endif
+#ifndef ALERT_ALT_MAX_M
+#define ALERT_ALT_MAX_M   9999
+#endif
+
+// Alertas de altitud (ver core/AltitudeAlertService.h). Siempre en metros
+// sobre el cero de UI, independiente de la unidad; 0 = alerta desactivada.
+// Se guarda como blob en NVS (clave "alerts"); el campo version permite
+// descartar blobs de otra disposición.
+struct AlertConfig {
+    static constexpr uint8_t VERSION = 1;
+
+    uint8_t  version                      = VERSION;
+    bool     enabled                      = false;
+    uint16_t ffAltM[ALERT_FF_MAX]         = {0, 0, 0};      // avisos en caída libre
+    uint16_t breakoffM                    = 1700;
+    uint16_t pullM                        = 1000;
+    uint16_t hardDeckM                    = 750;
+    uint16_t canopyAltM[ALERT_CANOPY_MAX] = {300, 200, 100}; // patrón de aterrizaje
+    uint16_t hysteresisM                  = 30;              // rearme por encima del umbral
+
+    bool operator==(const AlertConfig& o) const { return memcmp(this, &o, sizeof(*this)) == 0; }
+    bool operator!=(const AlertConfig& o) const { return !(*this == o); }
+};
+
 struct Settings {
     UnitType   unidadMetros        = UnitType::METERS;
     uint8_t    brilloPantalla      = 1;     // 0=low, 1=medium, 2=high
     uint8_t    ahorroTimeoutOption = 1;     // índice opciones de deep sleep
-    float      alturaOffset        = 0.0f;  // offset de altura (en unidad de usuario)
+    Meters     alturaOffset;                // offset de altura (SI; la UI lo muestra en su unidad)
     Language   idioma              = Language::ES;
     bool       inverPant           = false; // true = invertir pantalla
     uint8_t    usrActual           = 0;     // reservado multi-usuario
@@ -55,6 +86,7 @@ struct Settings {
     bool       bleEnabled          = false; // BLE activado por usuario (si la build lo soporta)
     char       blePin[7]           = "000000"; // PIN BLE persistente (ASCII 6 dígitos)
     char       bleName[BLE_NAME_MAX_LEN] = "ALTI-0000"; // Nombre visible en advertising
+    AlertConfig alerts;                    // alertas de altitud (off por defecto)
 };
 
 class SettingsService {
@@ -83,18 +115,24 @@ public:
             s.ahorroTimeoutOption = 1; // valor seguro
         }
 
-        // Offset de altura
-        s.alturaOffset = prefs.getFloat("offset", 0.0f);
-        Serial.print("[Settings] offset cargado = ");
-Serial.println(s.alturaOffset);
+        // Offset de altura en metros ("offset_m"). Las versiones anteriores
+        // lo guardaban en la unidad de UI ("offset"): se migra una vez.
+        float offM = prefs.getFloat("offset_m", NAN);
+        if (isnan(offM)) {
+            float legacy = prefs.getFloat("offset", 0.0f);
+            offM = (s.unidadMetros == UnitType::FEET) ? toMeters(Feet(legacy)).v : legacy;
+            prefs.putFloat("offset_m", offM);
+        }
+        s.alturaOffset = Meters(offM);
+        Serial.printf("[Settings] offset cargado = %.1f m\n", s.alturaOffset.v);
 
         // *** Protección temporal: limpiar offsets corruptos o heredados ***
-        // Si el offset es muy grande (por ejemplo, > ±500 unidades),
-        // asumimos que viene de una versión vieja / basura y lo reseteamos.
-        if (s.alturaOffset < -500.0f || s.alturaOffset > 500.0f) {
+        // Si el offset es muy grande (> ±500 m) asumimos que viene de una
+        // versión vieja / basura y lo reseteamos.
+        if (qabs(s.alturaOffset) > Meters(500.0f)) {
             Serial.println("[Settings] offset fuera de rango, reseteando a 0");
-            s.alturaOffset = 0.0f;
-            prefs.putFloat("offset", 0.0f);  // lo dejamos limpio en NVS
+            s.alturaOffset = Meters(0.0f);
+            prefs.putFloat("offset_m", 0.0f);  // lo dejamos limpio en NVS
         }
 
         // Idioma: por defecto ES
@@ -116,6 +154,13 @@ Serial.println(s.alturaOffset);
         // Pantalla limpia en vuelo/FF (off por defecto)
         s.hudMinimalFlight = prefs.getBool("minhud", false);
 
+        // Alertas de altitud: blob completo o defaults si no coincide.
+        AlertConfig ac;
+        if (prefs.getBytes("alerts", &ac, sizeof(ac)) == sizeof(ac) &&
+            ac.version == AlertConfig::VERSION) {
+            s.alerts = ac;
+        }
+
 #if BLE_FEATURE_ENABLED
         // BLE on/off
         s.bleEnabled = prefs.getBool("ble", false);
@@ -149,12 +194,13 @@ Serial.println(s.alturaOffset);
         prefs.putUChar("unit",   static_cast<uint8_t>(s.unidadMetros));
         prefs.putUChar("bright", s.brilloPantalla);
         prefs.putUChar("slpopt", s.ahorroTimeoutOption);
-        prefs.putFloat("offset", s.alturaOffset);
+        prefs.putFloat("offset_m", s.alturaOffset.v);
         prefs.putUChar("lang",   static_cast<uint8_t>(s.idioma));
         prefs.putBool("invert",  s.inverPant);
         prefs.putUChar("user",   s.usrActual);
         prefs.putUChar("hudmask", s.hud.toMask());
         prefs.putBool("minhud",  s.hudMinimalFlight);
+        prefs.putBytes("alerts", &s.alerts, sizeof(s.alerts));
 #if BLE_FEATURE_ENABLED
         prefs.putBool("ble",     s.bleEnabled);
         prefs.putString("blename", s.bleName);
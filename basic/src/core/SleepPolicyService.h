@@ -26,7 +26,7 @@ public:
 
     SleepDecision evaluate(uint32_t nowMs,
                            UiStateService& ui,
-                           const FlightPhaseService& flight,
+                           FlightPhase phase,          // snapshot de SensorTask
                            const Settings& settings,
                            BatteryMonitor& battery,
                            bool bleBusy = false)
@@ -41,7 +41,6 @@ public:
         d.lightSleepMaxMs = 0;
         d.showZzzHint     = false;
 
-        FlightPhase phase   = flight.getPhase();
         UiScreen   screen   = ui.getScreen();
         bool       locked   = ui.isLocked();
         uint32_t   lastInt  = ui.getLastInteractionMs();
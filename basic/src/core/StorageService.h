@@ -0,0 +1,332 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include "core/LogbookService.h"
+#include "core/TraceStore.h"
+#include "drivers/PmLock.h"
+
+// Escritor asíncrono de bitácora.
+//
+// LogbookService::append() hace varios fsync y, a veces, extiende el archivo
+// con ceros en bloques de 1 KiB; eso puede bloquear decenas/centenas de ms.
+// Este servicio mueve todas las escrituras a una tarea FreeRTOS propia:
+//  - Cola acotada de comandos (APPEND / RESET / STATS / TRACE_BLOCK).
+//  - Callback opcional de finalización (se ejecuta en la tarea de storage).
+//  - Back-pressure: submit*() devuelve false si la cola está llena, y se
+//    contabiliza en el snapshot (rejected).
+//  - Lecturas consistentes: Stats se publica como snapshot (copia bajo
+//    spinlock) y getByIndex() serializa el acceso al archivo con un mutex.
+//
+// Tras begin(), nadie fuera de esta clase debe llamar a LogbookService
+// directamente.
+//
+// Apertura diferida: begin() no toca la flash. La tarea monta LittleFS y
+// carga las cabeceras (open()) nada más arrancar, con prioridad por debajo
+// de la UI, así que no retrasa la primera altitud en pantalla. Tras un
+// arranque en caliente las cabeceras ya vienen de RTC y sólo se monta.
+
+// Los tres archivos llenos deben caber en la partición con margen.
+static_assert(LogbookService::fileBytes(LOGBOOK_CAPACITY) + LogbookService::EXT_FILE_BYTES +
+              TraceStore::FILE_BYTES + LOGBOOK_FS_RESERVE_BYTES <= LOGBOOK_FS_BYTES,
+              "bitácora + extensiones + trazas no caben en la partición LittleFS");
+
+#ifndef STORAGE_QUEUE_LEN
+#define STORAGE_QUEUE_LEN        8
+#endif
+#ifndef STORAGE_TASK_STACK
+#define STORAGE_TASK_STACK       4096
+#endif
+#ifndef STORAGE_TASK_PRIORITY
+#define STORAGE_TASK_PRIORITY    1
+#endif
+#ifndef STORAGE_TASK_CORE
+#define STORAGE_TASK_CORE        0      // el core 1 es de SensorTask
+#endif
+#ifndef STORAGE_READ_TIMEOUT_MS
+#define STORAGE_READ_TIMEOUT_MS  50     // máximo que una lectura espera al escritor
+#endif
+
+class StorageService {
+public:
+    enum class CmdType : uint8_t { APPEND, RESET, STATS, TRACE_BLOCK };
+
+    // Callback de finalización. Corre en la tarea de storage: debe ser corto
+    // y no tocar la UI directamente (sólo flags/contadores).
+    using Callback = void (*)(CmdType type,
+                              bool ok,
+                              const LogbookService::Record& rec,
+                              void* user);
+
+    // Estado publicado tras cada comando procesado.
+    struct Snapshot {
+        LogbookService::Stats stats{};
+        bool     statsValid   = false;
+        uint32_t seq          = 0;   // se incrementa en cada comando completado
+        uint32_t lastAppendId = 0;   // id asignado al último append OK
+        uint32_t pendingAppends = 0; // appends aceptados aún no escritos
+        bool     lastOk       = true;
+        uint32_t pending      = 0;   // comandos aceptados y aún no completados
+        uint32_t rejected     = 0;   // submits rechazados por cola llena
+        uint32_t failed       = 0;   // comandos que terminaron con error
+        uint32_t maxCmdMs     = 0;   // peor duración observada de un comando
+    };
+
+    bool begin(LogbookService* lb, TraceStore* tr = nullptr) {
+        logbook = lb;
+        trace   = tr;
+        if (!logbook) return false;
+
+        queue = xQueueCreate(STORAGE_QUEUE_LEN, sizeof(Cmd));
+        fileMutex = xSemaphoreCreateMutex();
+        if (!queue || !fileMutex) {
+            Serial.println("[storage] no se pudo crear cola/mutex");
+            return false;
+        }
+
+        flashLock.begin(PmLock::Kind::NO_SLEEP, "flash");
+
+        // Snapshot inicial antes de arrancar la tarea.
+        publishStats(true, 0);
+
+        BaseType_t ok = xTaskCreatePinnedToCore(taskEntry,
+                                                "storage",
+                                                STORAGE_TASK_STACK,
+                                                this,
+                                                STORAGE_TASK_PRIORITY,
+                                                &task,
+                                                STORAGE_TASK_CORE);
+        if (ok != pdPASS) {
+            Serial.println("[storage] no se pudo crear la tarea");
+            task = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // ext (opcional): campos de analítica que se guardan junto al Record.
+    bool submitAppend(const LogbookService::Record& rec,
+                      Callback cb = nullptr,
+                      void* user = nullptr,
+                      const LogbookService::Ext* ext = nullptr) {
+        Cmd c{};
+        c.type = CmdType::APPEND;
+        c.rec  = rec;
+        c.cb   = cb;
+        c.user = user;
+        if (ext) {
+            c.ext    = *ext;
+            c.hasExt = true;
+        }
+        return submit(c);
+    }
+
+    // Escribe 'count' bloques de traza contiguos. El buffer debe seguir vivo
+    // hasta que el callback confirme (FlightTraceRecorder no lo reutiliza
+    // hasta entonces).
+    bool submitTraceBlocks(const TraceBlock* blks,
+                           uint16_t count,
+                           Callback cb = nullptr,
+                           void* user = nullptr) {
+        Cmd c{};
+        c.type   = CmdType::TRACE_BLOCK;
+        c.block  = blks;
+        c.blocks = count;
+        c.cb     = cb;
+        c.user   = user;
+        return submit(c);
+    }
+
+    bool submitReset(Callback cb = nullptr, void* user = nullptr) {
+        Cmd c{};
+        c.type = CmdType::RESET;
+        c.cb   = cb;
+        c.user = user;
+        return submit(c);
+    }
+
+    bool submitStats(Callback cb = nullptr, void* user = nullptr) {
+        Cmd c{};
+        c.type = CmdType::STATS;
+        c.cb   = cb;
+        c.user = user;
+        return submit(c);
+    }
+
+    // Copia consistente del último estado publicado. No bloquea.
+    Snapshot snapshot() const {
+        Snapshot s;
+        portENTER_CRITICAL(&snapMux);
+        s = snap;
+        portEXIT_CRITICAL(&snapMux);
+        return s;
+    }
+
+    // Equivalente a LogbookService::getStats() pero desde el snapshot.
+    bool getStats(LogbookService::Stats& st) const {
+        Snapshot s = snapshot();
+        if (!s.statsValid) return false;
+        st = s.stats;
+        return true;
+    }
+
+    // Lectura de un registro. Espera como máximo STORAGE_READ_TIMEOUT_MS a
+    // que termine una escritura en curso; si no, devuelve false.
+    bool getByIndex(uint16_t idxNewestFirst, LogbookService::Record& out) {
+        if (!logbook || !fileMutex) return false;
+        if (xSemaphoreTake(fileMutex, pdMS_TO_TICKS(STORAGE_READ_TIMEOUT_MS)) != pdTRUE) {
+            return false;
+        }
+        bool ok = open() && logbook->getByIndex(idxNewestFirst, out);
+        xSemaphoreGive(fileMutex);
+        return ok;
+    }
+
+    // Igual que getByIndex() pero para la extensión del registro.
+    bool getExtByIndex(uint16_t idxNewestFirst, LogbookService::Ext& out) {
+        if (!logbook || !fileMutex) return false;
+        if (xSemaphoreTake(fileMutex, pdMS_TO_TICKS(STORAGE_READ_TIMEOUT_MS)) != pdTRUE) {
+            return false;
+        }
+        bool ok = open() && logbook->getExtByIndex(idxNewestFirst, out);
+        xSemaphoreGive(fileMutex);
+        return ok;
+    }
+
+    // true si hay comandos pendientes (p.ej. para no dormir en deep sleep).
+    bool isBusy() const { return snapshot().pending > 0; }
+
+private:
+    struct Cmd {
+        CmdType                type = CmdType::STATS;
+        LogbookService::Record rec{};
+        LogbookService::Ext    ext{};
+        bool                   hasExt = false;
+        const TraceBlock*      block = nullptr;
+        uint16_t               blocks = 0;
+        Callback               cb   = nullptr;
+        void*                  user = nullptr;
+    };
+
+    bool submit(const Cmd& c) {
+        if (!queue) return false;
+        // El pending se cuenta antes de encolar para que el snapshot nunca
+        // muestre "0 pendientes" con un comando ya en la cola.
+        bool isAppend = (c.type == CmdType::APPEND);
+        portENTER_CRITICAL(&snapMux);
+        snap.pending++;
+        if (isAppend) snap.pendingAppends++;
+        portEXIT_CRITICAL(&snapMux);
+
+        if (xQueueSend(queue, &c, 0) != pdTRUE) {
+            portENTER_CRITICAL(&snapMux);
+            snap.pending--;
+            if (isAppend) snap.pendingAppends--;
+            snap.rejected++;
+            portEXIT_CRITICAL(&snapMux);
+            return false;
+        }
+        return true;
+    }
+
+    static void taskEntry(void* arg) {
+        static_cast<StorageService*>(arg)->run();
+    }
+
+    // Con fileMutex tomado.
+    bool open() {
+        bool ok = logbook->isReady() ? logbook->mount() : logbook->begin();
+        if (ok && trace && !trace->isReady() && !trace->begin()) {
+            Serial.println("[storage] trace store init failed");
+        }
+        return ok;
+    }
+
+    void run() {
+        flashLock.acquire();
+        xSemaphoreTake(fileMutex, portMAX_DELAY);
+        bool opened = open();
+        xSemaphoreGive(fileMutex);
+        flashLock.release();
+        publishStats(opened, 0);
+
+        Cmd c;
+        for (;;) {
+            if (xQueueReceive(queue, &c, portMAX_DELAY) != pdTRUE) continue;
+
+            uint32_t t0 = millis();
+            bool ok = false;
+            LogbookService::Record done = c.rec;
+
+            // Candado "flash": sin light sleep mientras se escribe.
+            flashLock.acquire();
+            xSemaphoreTake(fileMutex, portMAX_DELAY);
+            // Reintenta la apertura si falló al arrancar la tarea.
+            bool mounted = open();
+            switch (mounted ? c.type : CmdType::STATS) {
+            case CmdType::APPEND: {
+                LogbookService::Stats before{};
+                bool haveBefore = logbook->getStats(before);
+                ok = logbook->append(c.rec, c.hasExt ? &c.ext : nullptr);
+                // append() asigna id = nextId; lo reflejamos en el callback.
+                if (ok && haveBefore) done.id = before.totalIds + 1;
+                break;
+            }
+            case CmdType::RESET:
+                ok = logbook->reset();
+                break;
+            case CmdType::TRACE_BLOCK:
+                ok = (trace && c.block) ? trace->appendBlocks(c.block, c.blocks) : false;
+                break;
+            case CmdType::STATS:
+                ok = mounted;
+                break;
+            }
+            xSemaphoreGive(fileMutex);
+            flashLock.release();
+
+            uint32_t dt = millis() - t0;
+            publishStats(ok, (c.type == CmdType::APPEND && ok) ? done.id : 0, dt, true,
+                         c.type == CmdType::APPEND);
+
+            if (c.cb) {
+                c.cb(c.type, ok, done, c.user);
+            }
+        }
+    }
+
+    // Publica stats del backend en el snapshot. completed=true descuenta un
+    // comando pendiente.
+    void publishStats(bool ok, uint32_t appendedId, uint32_t cmdMs = 0,
+                      bool completed = false, bool wasAppend = false) {
+        LogbookService::Stats st{};
+        bool valid = logbook->getStats(st);
+
+        portENTER_CRITICAL(&snapMux);
+        snap.stats      = st;
+        snap.statsValid = valid;
+        snap.lastOk     = ok;
+        if (appendedId) snap.lastAppendId = appendedId;
+        if (!ok) snap.failed++;
+        if (cmdMs > snap.maxCmdMs) snap.maxCmdMs = cmdMs;
+        if (completed) {
+            snap.seq++;
+            if (snap.pending > 0) snap.pending--;
+            if (wasAppend && snap.pendingAppends > 0) snap.pendingAppends--;
+        }
+        portEXIT_CRITICAL(&snapMux);
+    }
+
+    LogbookService*   logbook   = nullptr;
+    TraceStore*       trace     = nullptr;
+    QueueHandle_t     queue     = nullptr;
+    SemaphoreHandle_t fileMutex = nullptr;
+    TaskHandle_t      task      = nullptr;
+    PmLock            flashLock;
+
+    mutable portMUX_TYPE snapMux = portMUX_INITIALIZER_UNLOCKED;
+    Snapshot             snap{};
+};
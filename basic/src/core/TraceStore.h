@@ -0,0 +1,233 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <string.h>
+
+#include "util/TraceCodec.h"
+
+// Área de trazas de vuelo: anillo de bloques TRACE_BLOCK_SIZE en un archivo
+// propio de LittleFS. Cada bloque lleva el jumpId del Record de bitácora.
+//
+// Layout:  [cabecera (1 bloque)] [bloque 0] [bloque 1] ... [bloque N-1]
+//
+// Sólo la tarea de storage escribe aquí (ver StorageService), y sólo en
+// tierra: FlightTraceRecorder acumula el salto en RAM y lo vuelca al aterrizar
+// en tramos de TRACE_FLUSH_CHUNK_BLOCKS bloques (escrituras secuenciales
+// grandes, latencia por comando acotada).
+
+#ifndef TRACE_DEBUG
+#define TRACE_DEBUG 1
+#endif
+#if TRACE_DEBUG
+  #define TR_DBG(...)  do{ Serial.printf(__VA_ARGS__); }while(0)
+#else
+  #define TR_DBG(...)  do{}while(0)
+#endif
+
+#ifndef TRACE_FILE_PATH
+#define TRACE_FILE_PATH        "/trace.bin"
+#endif
+#ifndef TRACE_POSIX_PATH
+#define TRACE_POSIX_PATH       "/littlefs" TRACE_FILE_PATH
+#endif
+#ifndef TRACE_CAPACITY_BLOCKS
+#define TRACE_CAPACITY_BLOCKS  1024u   // 256 KiB
+#endif
+
+class TraceStore {
+public:
+    // Tamaño máximo del archivo (cabecera + anillo), para el presupuesto de
+    // la partición (ver LogbookService.h).
+    static constexpr uint32_t FILE_BYTES = (uint32_t)TRACE_BLOCK_SIZE * (1u + TRACE_CAPACITY_BLOCKS);
+
+    // LittleFS ya debe estar montado (LogbookService::begin lo garantiza).
+    bool begin() {
+        if (!loadHeader()) {
+            TR_DBG("[trace] creando area de trazas\n");
+            hdr = Header{};
+            hdr.capacity = TRACE_CAPACITY_BLOCKS;
+            hdr.crc      = hdrCrc(hdr);
+            File fw = LittleFS.open(TRACE_FILE_PATH, "w");
+            fw.close();
+            if (!writeAt(0, &hdr, sizeof(hdr))) return false;
+        } else if (hdr.capacity != TRACE_CAPACITY_BLOCKS) {
+            // Capacidad distinta: se reinicia el anillo (las trazas no son críticas).
+            hdr.capacity = TRACE_CAPACITY_BLOCKS;
+            hdr.head     = 0;
+            hdr.count    = 0;
+            hdr.gen++;
+            hdr.crc      = hdrCrc(hdr);
+            (void)writeAt(0, &hdr, sizeof(hdr));
+        }
+        ready = true;
+        return true;
+    }
+
+    bool isReady() const { return ready; }
+
+    // Escribe 'n' bloques ya cerrados (con CRC) a partir de la siguiente
+    // posición del anillo. Cada tramo contiguo va en una sola escritura
+    // secuencial (dos si el anillo da la vuelta) y la cabecera se actualiza
+    // una vez al final.
+    bool appendBlocks(const TraceBlock* blks, uint32_t n) {
+        if (!ready || !blks || n == 0) return false;
+        if (n > hdr.capacity) {
+            // Más que el anillo entero: se pisaría a sí mismo. FlightTraceRecorder
+            // nunca lo pide (su arena está acotado a TRACE_CAPACITY_BLOCKS).
+            TR_DBG("[trace] %lu bloques no caben en el anillo (%lu)\n",
+                   (unsigned long)n, (unsigned long)hdr.capacity);
+            return false;
+        }
+        uint32_t done = 0;
+        while (done < n) {
+            uint32_t pos = hdr.head % hdr.capacity;
+            uint32_t run = hdr.capacity - pos;
+            if (run > n - done) run = n - done;
+            uint32_t off = (uint32_t)TRACE_BLOCK_SIZE * (1u + pos);
+            if (!writeAt(off, blks + done, (size_t)run * sizeof(TraceBlock))) return false;
+
+            hdr.head = (pos + run) % hdr.capacity;
+            hdr.count = (hdr.count + run > hdr.capacity) ? hdr.capacity : hdr.count + run;
+            done += run;
+        }
+        hdr.gen++;
+        hdr.crc = hdrCrc(hdr);
+        return writeAt(0, &hdr, sizeof(hdr));
+    }
+
+    // Cabecera que sobrevive a un deep sleep (core/WarmStartService.h).
+    struct WarmState {
+        uint32_t capacity = 0;
+        uint32_t head     = 0;
+        uint32_t count    = 0;
+        uint32_t gen      = 0;
+    };
+
+    bool saveWarm(WarmState& w) const {
+        if (!ready) return false;
+        w.capacity = hdr.capacity;
+        w.head     = hdr.head;
+        w.count    = hdr.count;
+        w.gen      = hdr.gen;
+        return true;
+    }
+
+    // Alternativa a begin() sin leer el archivo; LittleFS debe estar montado
+    // antes de la primera escritura (StorageService lo hace).
+    bool beginWarm(const WarmState& w) {
+        if (w.capacity != TRACE_CAPACITY_BLOCKS || w.gen == 0 ||
+            w.head >= w.capacity || w.count > w.capacity) {
+            return false;
+        }
+        hdr          = Header{};
+        hdr.capacity = w.capacity;
+        hdr.head     = w.head;
+        hdr.count    = w.count;
+        hdr.gen      = w.gen;
+        hdr.crc      = hdrCrc(hdr);
+        ready        = true;
+        return true;
+    }
+
+    bool appendBlock(const TraceBlock& blk) { return appendBlocks(&blk, 1); }
+
+    bool reset() {
+        if (!ready) return false;
+        hdr.head  = 0;
+        hdr.count = 0;
+        hdr.gen++;
+        hdr.crc   = hdrCrc(hdr);
+        return writeAt(0, &hdr, sizeof(hdr));
+    }
+
+    uint32_t blockCount() const { return ready ? hdr.count : 0; }
+
+private:
+    struct __attribute__((packed)) Header {
+        uint32_t magic     = 0x54524342; // "TRCB"
+        uint16_t version   = 1;
+        uint16_t blockSize = TRACE_BLOCK_SIZE;
+        uint32_t capacity  = TRACE_CAPACITY_BLOCKS;
+        uint32_t head      = 0;
+        uint32_t count     = 0;
+        uint32_t gen       = 1;
+        uint16_t crc       = 0;
+    };
+
+    static uint16_t hdrCrc(const Header& h) {
+        Header tmp = h;
+        tmp.crc = 0;
+        return TraceCodec::crc16(reinterpret_cast<const uint8_t*>(&tmp), sizeof(tmp));
+    }
+
+    bool loadHeader() {
+        Header tmp{};
+        int fd = ::open(TRACE_POSIX_PATH, O_RDONLY);
+        if (fd < 0) return false;
+        ssize_t rd = ::read(fd, &tmp, sizeof(tmp));
+        ::close(fd);
+        if (rd != (ssize_t)sizeof(tmp))        return false;
+        if (tmp.magic != Header{}.magic)       return false;
+        if (tmp.version != Header{}.version)   return false;
+        if (tmp.blockSize != TRACE_BLOCK_SIZE) return false;
+        if (tmp.capacity == 0)                 return false;
+        if (tmp.crc != hdrCrc(tmp))            return false;
+        hdr = tmp;
+        return true;
+    }
+
+    bool writeAt(uint32_t off, const void* buf, size_t len) {
+        int fd = ::open(TRACE_POSIX_PATH, O_RDWR | O_CREAT, 0666);
+        if (fd < 0) {
+            TR_DBG("[trace] open FAIL (errno=%d %s)\n", errno, strerror(errno));
+            return false;
+        }
+        // El anillo crece bloque a bloque: si escribimos justo después del
+        // final sólo hace falta rellenar el hueco (normalmente 0 bytes).
+        if (!padTo(fd, off)) {
+            ::close(fd);
+            return false;
+        }
+        if (::lseek(fd, (off_t)off, SEEK_SET) < 0) {
+            TR_DBG("[trace] lseek FAIL (errno=%d %s)\n", errno, strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        ssize_t wr = ::write(fd, buf, len);
+        ::fsync(fd);
+        ::close(fd);
+        if (wr != (ssize_t)len) {
+            TR_DBG("[trace] write FAIL (off=0x%X wr=%d len=%u)\n",
+                   (unsigned)off, (int)wr, (unsigned)len);
+            return false;
+        }
+        return true;
+    }
+
+    bool padTo(int fd, uint32_t off) {
+        struct stat st;
+        if (::fstat(fd, &st) != 0) return false;
+        uint32_t cur = (uint32_t)st.st_size;
+        if (cur >= off) return true;
+        if (::lseek(fd, 0, SEEK_END) < 0) return false;
+        static uint8_t zeros[TRACE_BLOCK_SIZE];
+        while (cur < off) {
+            uint32_t need  = off - cur;
+            uint32_t chunk = (need > sizeof(zeros)) ? sizeof(zeros) : need;
+            ssize_t wr = ::write(fd, zeros, chunk);
+            if (wr <= 0) {
+                TR_DBG("[trace] pad FAIL (cur=%u off=%u)\n", (unsigned)cur, (unsigned)off);
+                return false;
+            }
+            cur += (uint32_t)wr;
+        }
+        return true;
+    }
+
+    Header hdr{};
+    bool   ready = false;
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+#include <sys/time.h>
+#include "esp_system.h"
+
+#include "drivers/Bmp390Driver.h"
+#include "core/AltimetryService.h"
+#include "core/FlightPhaseService.h"
+#include "core/LogbookService.h"
+#include "core/TraceStore.h"
+#include "core/SettingsService.h"
+
+// Arranque en caliente tras deep sleep.
+//
+// El ESP32 reinicia por completo al salir de deep sleep. Al entrar se guarda
+// en RTC slow memory (WarmStartImage, RTC_DATA_ATTR en main.cpp) el estado
+// lento de cada servicio: cero de presión, deriva acumulada, latch airborne,
+// fase y sus temporizadores, cabeceras de bitácora y trazas, calibración del
+// BMP390 y Settings. Al despertar, si la imagen es válida, setup() lo
+// restaura en vez de:
+//  - bmp3_init() (soft reset + lectura de calibración por I2C),
+//  - leer las cabeceras de bitácora y trazas (la tarea de StorageService
+//    sólo monta LittleFS),
+//  - cargar Settings de NVS,
+//  - esperar al auto-cero: la primera muestra ya es altitud válida.
+//
+// Validez: sólo tras un reset por deep sleep, con magic, versión, tamaño y
+// CRC-32 correctos. Cambiar cualquier WarmState cambia sizeof() y basta; si
+// cambia el significado de un campo, subir WARM_START_VERSION.
+//
+// Los temporizadores (millis()) se guardan tal cual y se trasladan al reloj
+// nuevo con shiftMs(), que descuenta el tiempo dormido medido con el reloj
+// del sistema (sigue corriendo en deep sleep con el timer RTC).
+//
+// Objetivo: primera altitud válida en pantalla antes de BOOT_BUDGET_WARM_MS
+// desde el arranque; lo mide util/BootTimeline.h.
+
+#ifndef WARM_START_ENABLE
+#define WARM_START_ENABLE     1
+#endif
+#ifndef WARM_START_VERSION
+#define WARM_START_VERSION    1
+#endif
+
+struct WarmStartImage {
+    uint32_t magic    = 0;
+    uint16_t version  = 0;
+    uint16_t size     = 0;
+    uint64_t savedUs  = 0;   // reloj del sistema al guardar
+    uint32_t savedMs  = 0;   // millis() al guardar
+
+    Bmp390Driver::WarmState       bmp;
+    AltimetryService::WarmState   altimetry;
+    FlightPhaseService::WarmState flight;
+    LogbookService::WarmState     logbook;
+    TraceStore::WarmState         trace;
+    Settings                      settings;
+
+    uint32_t crc      = 0;   // CRC-32 de todo lo anterior
+};
+
+class WarmStartService {
+public:
+    static constexpr uint32_t MAGIC = 0x57524D53; // "WRMS"
+
+    // rtc: imagen en RTC slow memory. Devuelve true si se puede restaurar.
+    bool begin(WarmStartImage* rtc) {
+        img     = rtc;
+        warm    = false;
+        slept   = 0;
+        shift   = 0;
+    #if WARM_START_ENABLE
+        if (!img) return false;
+        if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+            img->magic = 0;   // arranque en frío: la imagen no vale
+            return false;
+        }
+        if (img->magic != MAGIC || img->version != WARM_START_VERSION ||
+            img->size != sizeof(WarmStartImage)) {
+            return false;
+        }
+        if (img->crc != crcOf(*img)) {
+            Serial.println("[warm] CRC incorrecto, arranque en frío");
+            return false;
+        }
+        uint64_t nowUs = systemUs();
+        slept = (nowUs > img->savedUs) ? (uint32_t)((nowUs - img->savedUs) / 1000ULL) : 0;
+        shift = millis() - img->savedMs - slept;
+        warm  = true;
+    #endif
+        return warm;
+    }
+
+    bool isWarm() const { return warm; }
+    const WarmStartImage& image() const { return *img; }
+
+    // Suma a un millis() guardado para pasarlo al reloj de este arranque.
+    uint32_t shiftMs() const { return shift; }
+    uint32_t sleptMs() const { return slept; }
+
+    // Al entrar en deep sleep, con la tarea del sensor retenida y storage
+    // sin trabajo pendiente (SleepPolicy no duerme con storage ocupado).
+    void save(const Bmp390Driver& bmp,
+              const AltimetryService& altimetry,
+              const FlightPhaseService& flight,
+              const LogbookService& logbook,
+              const TraceStore& trace,
+              const Settings& settings) {
+    #if WARM_START_ENABLE
+        if (!img) return;
+        // Se construye en sitio: el CRC cubre también el relleno entre
+        // campos, que así queda a cero y no cambia hasta el wake.
+        WarmStartImage& w = *img;
+        memset(static_cast<void*>(&w), 0, sizeof(w));
+        w.magic   = MAGIC;
+        w.version = WARM_START_VERSION;
+        w.size    = sizeof(WarmStartImage);
+        w.savedUs = systemUs();
+        w.savedMs = millis();
+        bool ok = bmp.saveWarm(w.bmp) &&
+                  logbook.saveWarm(w.logbook) &&
+                  trace.saveWarm(w.trace);
+        altimetry.saveWarm(w.altimetry);
+        flight.saveWarm(w.flight);
+        w.settings = settings;
+        if (!ok) {
+            w.magic = 0;
+            return;
+        }
+        w.crc = crcOf(w);
+    #else
+        (void)bmp; (void)altimetry; (void)flight; (void)logbook; (void)trace; (void)settings;
+    #endif
+    }
+
+    // CRC-32 (IEEE, reflejado); crcOf() lo aplica a la imagen sin el
+    // propio campo crc.
+    static uint32_t crc32(const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < len; ++i) {
+            crc ^= p[i];
+            for (uint8_t b = 0; b < 8; ++b) {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            }
+        }
+        return ~crc;
+    }
+
+private:
+    static uint64_t systemUs() {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        return (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
+    }
+
+    static uint32_t crcOf(const WarmStartImage& w) {
+        return crc32(&w, offsetof(WarmStartImage, crc));
+    }
+
+    WarmStartImage* img     = nullptr;
+    bool            warm    = false;
+    uint32_t        slept   = 0;
+    uint32_t        shift   = 0;
+};
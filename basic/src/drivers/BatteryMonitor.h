@@ -1,5 +1,7 @@
 #pragma once
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "include/config_pins.h"
 
 // Lee VBAT y presencia de cargador usando divisores 100k/100k.
@@ -7,6 +9,33 @@
 // - % de batería con curva no lineal real de LiPo.
 // - Actualización inteligente que previene desfases en descarga.
 // - En carga se permite subir/bajar de 1 en 1 hasta converger.
+//
+// Nada de esto bloquea el loop:
+// - El oversampling de VBAT (64 lecturas ADC, ~13 ms) corre en una tarea de
+//   baja prioridad en el core 0 cada BATT_SAMPLE_PERIOD_MS; el loop sólo
+//   recoge la última media publicada y la pasa por el filtro.
+// - El cargador se detecta por GPIO (flancos por interrupción + anti-rebote),
+//   sin ADC. Una relectura digital cada CHARGER_RECHECK_MS cubre flancos
+//   perdidos durante light sleep.
+
+#ifndef BATT_TASK_STACK
+#define BATT_TASK_STACK          2048
+#endif
+#ifndef BATT_TASK_PRIORITY
+#define BATT_TASK_PRIORITY       1
+#endif
+#ifndef BATT_TASK_CORE
+#define BATT_TASK_CORE           0      // el core 1 es de SensorTask
+#endif
+#ifndef BATT_SAMPLE_PERIOD_MS
+#define BATT_SAMPLE_PERIOD_MS    1000
+#endif
+#ifndef CHARGER_DEBOUNCE_MS
+#define CHARGER_DEBOUNCE_MS      30
+#endif
+#ifndef CHARGER_RECHECK_MS
+#define CHARGER_RECHECK_MS       1000
+#endif
 
 class BatteryMonitor {
 public:
@@ -16,9 +45,9 @@ public:
         // VBAT (divisor 100k/100k, 4.2V -> ~2.1V en el pin)
         // 11 dB da más margen y suele ser más lineal cerca de 2.1V en ESP32.
         analogSetPinAttenuation(PIN_BATT_VOLTAGE, ADC_11db);
-        // Cargador (5V -> ~2.5V en el pin)
-        analogSetPinAttenuation(PIN_CHARGER_SENSE, ADC_11db);
 
+        // Cargador (5V -> ~2.5V en el pin): entrada digital, igual que el
+        // wake de PowerHw.
         pinMode(PIN_CHARGER_SENSE, INPUT);
 
         _initialized         = false;
@@ -27,9 +56,25 @@ public:
         _lastPercent         = 100;
         _lastVoltageSampleMs = 0;
         _lastPercentUpdateMs = 0;
-        _chargerInitialized  = false;
-        _chargerPresent      = false;
-        _lastChargerSampleMs = 0;
+        _chargerPresent      = (digitalRead(PIN_CHARGER_SENSE) == HIGH);
+        _chargerEdgePending  = false;
+        _lastChargerSampleMs = millis();
+        attachInterruptArg(PIN_CHARGER_SENSE, onChargerEdge, this, CHANGE);
+
+        // Primera muestra aquí (arranque), el resto en la tarea.
+        publishSample(sampleBatteryVoltageRaw());
+
+        BaseType_t ok = xTaskCreatePinnedToCore(taskEntry,
+                                                "battery",
+                                                BATT_TASK_STACK,
+                                                this,
+                                                BATT_TASK_PRIORITY,
+                                                &_task,
+                                                BATT_TASK_CORE);
+        if (ok != pdPASS) {
+            Serial.println("[BATT] no se pudo crear la tarea; muestreo en el loop");
+            _task = nullptr;
+        }
     }
 
     // Voltaje de batería en voltios, filtrado.
@@ -37,12 +82,21 @@ public:
         uint32_t now   = millis();
         uint32_t gapMs = (_lastVoltageSampleMs == 0) ? 999999 : (now - _lastVoltageSampleMs);
 
-        // Actualizar solo si pasó el período de muestreo (1 segundo)
-        // o si es la primera vez
-        constexpr uint32_t VOLTAGE_SAMPLE_PERIOD_MS = 1000;
-        
-        if (!_initialized || gapMs >= VOLTAGE_SAMPLE_PERIOD_MS) {
-            float vBatRaw = sampleBatteryVoltageRaw();
+        // Sin tarea (no se pudo crear): muestreo en el loop como antes.
+        if (!_task && gapMs >= BATT_SAMPLE_PERIOD_MS) {
+            publishSample(sampleBatteryVoltageRaw());
+        }
+
+        // Filtrar sólo cuando hay una media nueva publicada
+        float    vBatRaw;
+        uint32_t seq;
+        portENTER_CRITICAL(&_sampleMux);
+        vBatRaw = _publishedV;
+        seq     = _publishedSeq;
+        portEXIT_CRITICAL(&_sampleMux);
+
+        if (!_initialized || seq != _consumedSeq) {
+            _consumedSeq = seq;
             
             // Filtro exponencial (suaviza mucho el ruido)
             const float alpha = 0.05f; // 0.05 ~ muy suave
@@ -62,28 +116,19 @@ public:
 
     bool isChargerConnected() {
         uint32_t now = millis();
-        
-        // Cache de 500ms para reducir lecturas ADC
-        constexpr uint32_t CHARGER_SAMPLE_PERIOD_MS = 500;
-        
-        if (!_chargerInitialized || 
-            (now - _lastChargerSampleMs) >= CHARGER_SAMPLE_PERIOD_MS) {
-            
-            const int   NUM_SAMPLES = 8;
-            uint32_t    accMv       = 0;
-
-            for (int i = 0; i < NUM_SAMPLES; ++i) {
-                accMv += analogReadMilliVolts(PIN_CHARGER_SENSE);
-                delayMicroseconds(200);
-            }
 
-            float avgMv = accMv / float(NUM_SAMPLES);
-            // Umbral simple: por encima de ~1.5V en el pin (con divisor 1/2 -> ~3V en USB)
-            _chargerPresent = (avgMv > 1500.0f);
+        // Tras un flanco, esperar CHARGER_DEBOUNCE_MS sin flancos nuevos y
+        // leer el nivel; además, relectura periódica (barata: un registro).
+        bool recheck = (now - _lastChargerSampleMs) >= CHARGER_RECHECK_MS;
+        if (_chargerEdgePending && (now - _chargerEdgeMs) >= CHARGER_DEBOUNCE_MS) {
+            _chargerEdgePending = false;
+            recheck = true;
+        }
+        if (recheck && !_chargerEdgePending) {
+            _chargerPresent      = (digitalRead(PIN_CHARGER_SENSE) == HIGH);
             _lastChargerSampleMs = now;
-            _chargerInitialized  = true;
         }
-        
+
         return _chargerPresent;
     }
 
@@ -189,6 +234,31 @@ public:
     }
 
 private:
+    static void taskEntry(void* arg) {
+        static_cast<BatteryMonitor*>(arg)->run();
+    }
+
+    void run() {
+        TickType_t last = xTaskGetTickCount();
+        for (;;) {
+            vTaskDelayUntil(&last, pdMS_TO_TICKS(BATT_SAMPLE_PERIOD_MS));
+            publishSample(sampleBatteryVoltageRaw());
+        }
+    }
+
+    void publishSample(float v) {
+        portENTER_CRITICAL(&_sampleMux);
+        _publishedV = v;
+        _publishedSeq++;
+        portEXIT_CRITICAL(&_sampleMux);
+    }
+
+    static void IRAM_ATTR onChargerEdge(void* arg) {
+        BatteryMonitor* self = static_cast<BatteryMonitor*>(arg);
+        self->_chargerEdgeMs      = millis();
+        self->_chargerEdgePending = true;
+    }
+
     // Muestreo raw del ADC con oversampling
     float sampleBatteryVoltageRaw() {
         const int   NUM_SAMPLES = 64;
@@ -254,8 +324,16 @@ private:
     uint32_t _lastVoltageSampleMs = 0;
     uint32_t _lastPercentUpdateMs = 0;
     
-    // Cache para detección de cargador
-    bool     _chargerInitialized  = false;
-    bool     _chargerPresent      = false;
-    uint32_t _lastChargerSampleMs = 0;
+    // Última media de la tarea de muestreo
+    TaskHandle_t _task            = nullptr;
+    portMUX_TYPE _sampleMux       = portMUX_INITIALIZER_UNLOCKED;
+    float        _publishedV      = 0.0f;
+    uint32_t     _publishedSeq    = 0;
+    uint32_t     _consumedSeq     = 0;
+
+    // Detección de cargador (GPIO)
+    bool              _chargerPresent      = false;
+    uint32_t          _lastChargerSampleMs = 0;
+    volatile bool     _chargerEdgePending  = false;
+    volatile uint32_t _chargerEdgeMs       = 0;
 };
\ No newline at end of file
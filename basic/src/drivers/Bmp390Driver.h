@@ -1,64 +1,22 @@
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
 
-#include "include/config_pins.h"
+#include "drivers/I2cBus.h"
+#include "drivers/PmLock.h"
 #include "util/Types.h"  // para SensorMode
 
 // Incluimos la API de Bosch desde src/bmp3
 #include "bmp3/bmp3.h"
 #include "bmp3/bmp3_defs.h"
 
-// Adaptadores para la API de Bosch (I2C + delay)
-// Usan Wire + constantes de la API
+// Adaptadores para la API de Bosch (delay). Las funciones de lectura/escritura
+// van por el gestor de bus compartido (drivers/I2cBus.h) con prioridad de
+// sensor y viven dentro de Bmp390Driver (onBusRead/onBusWrite).
 namespace {
 
     // mi 390L es direccion 0x77
     uint8_t g_bmp3_i2c_addr = BMP3_ADDR_I2C_SEC;
 
-    // Función de lectura I2C que la API de Bosch va a usar internamente
-    BMP3_INTF_RET_TYPE bmp3_i2c_read(uint8_t reg_addr,
-                                     uint8_t *reg_data,
-                                     uint32_t len,
-                                     void *intf_ptr)
-    {
-        (void)intf_ptr; // no la usamos, pero la API la pide
-
-        Wire.beginTransmission(g_bmp3_i2c_addr);
-        Wire.write(reg_addr);
-        if (Wire.endTransmission(false) != 0) {  // false = no STOP, repeated start
-            return BMP3_E_COMM_FAIL;
-        }
-
-        uint32_t i = 0;
-        Wire.requestFrom((uint8_t)g_bmp3_i2c_addr, (uint8_t)len);
-        while (Wire.available() && (i < len)) {
-            reg_data[i++] = Wire.read();
-        }
-
-        return (i == len) ? BMP3_OK : BMP3_E_COMM_FAIL;
-    }
-
-    // Función de escritura I2C
-    BMP3_INTF_RET_TYPE bmp3_i2c_write(uint8_t reg_addr,
-                                      const uint8_t *reg_data,
-                                      uint32_t len,
-                                      void *intf_ptr)
-    {
-        (void)intf_ptr;
-
-        Wire.beginTransmission(g_bmp3_i2c_addr);
-        Wire.write(reg_addr);
-        for (uint32_t i = 0; i < len; ++i) {
-            Wire.write(reg_data[i]);
-        }
-        if (Wire.endTransmission() != 0) {
-            return BMP3_E_COMM_FAIL;
-        }
-
-        return BMP3_OK;
-    }
-
     // Delay en microsegundos que la API usa internamente
     void bmp3_delay_us(uint32_t period, void *intf_ptr)
     {
@@ -68,30 +26,105 @@ namespace {
     }
 } // namespace anónimo
 
+// Temperatura a baja tasa: la presión se convierte sola a ritmo completo y
+// cada BMP_TEMP_INTERVAL_MS se intercala una conversión con temperatura. La
+// compensación de presión usa el último registro de temperatura (la API lo
+// relee en cada bmp3_get_sensor_data), coherente con la caché que devuelve
+// read(). El intervalo se adapta para acotar la deriva entre refrescos a
+// BMP_TEMP_DRIFT_MAX_C, y un cambio de presión grande (ascenso/caída, donde la
+// temperatura cambia con la altitud) fuerza un refresco anticipado.
+#ifndef BMP_TEMP_INTERVAL_MS
+#define BMP_TEMP_INTERVAL_MS      10000u
+#endif
+#ifndef BMP_TEMP_INTERVAL_MIN_MS
+#define BMP_TEMP_INTERVAL_MIN_MS  1000u
+#endif
+#ifndef BMP_TEMP_DRIFT_MAX_C
+#define BMP_TEMP_DRIFT_MAX_C      0.5f
+#endif
+#ifndef BMP_TEMP_REFRESH_PA
+#define BMP_TEMP_REFRESH_PA       600.0f   // ~50 m
+#endif
+
+// Configuración de medida del BMP390 (valores BMP3_* de bmp3_defs.h).
+struct SensorConfig {
+    uint8_t  pressOs = BMP3_OVERSAMPLING_8X;
+    uint8_t  tempOs  = BMP3_OVERSAMPLING_2X;
+    uint8_t  iir     = BMP3_IIR_FILTER_COEFF_15;
+    uint8_t  odr     = BMP3_ODR_25_HZ;
+    bool     forced  = false;
+    uint32_t i2cHz   = 100000;
+
+    bool operator==(const SensorConfig& o) const {
+        return pressOs == o.pressOs && tempOs == o.tempOs && iir == o.iir &&
+               odr == o.odr && forced == o.forced && i2cHz == o.i2cHz;
+    }
+    bool operator!=(const SensorConfig& o) const { return !(*this == o); }
+
+    // Factores físicos de los códigos BMP3_*.
+    uint8_t  osrP()    const { return (uint8_t)(1u << pressOs); }
+    uint8_t  osrT()    const { return (uint8_t)(1u << tempOs); }
+    uint8_t  iirCoef() const { return (uint8_t)((1u << iir) - 1u); }   // 0, 1, 3, 7, 15...
+    float    odrHz()   const { return 200.0f / (float)(1u << odr); }
+
+    // Duración de una medida (datasheet 3.9.2, mismas constantes que la API
+    // de Bosch). En modo normal debe ser menor que el periodo de ODR o
+    // bmp3_set_sensor_settings la rechaza; se comprueba con temperatura porque
+    // ésta se intercala de vez en cuando.
+    uint32_t measTimeUs(bool withTemp = true) const {
+        uint32_t t = 234u + 392u + osrP() * 2000u;
+        if (withTemp) t += 313u + osrT() * 2000u;
+        return t;
+    }
+    bool feasible() const {
+        return forced || measTimeUs() < (uint32_t)(5000u << odr);
+    }
+};
+
 // Driver de alto nivel para el BMP390, usando la API oficial de Bosch.
 class Bmp390Driver {
 public:
+    // Lo mínimo para reanudar sin bmp3_init() (ver core/WarmStartService.h):
+    // los coeficientes de calibración son fijos de cada chip.
+    struct WarmState {
+        bmp3_calib_data calib{};
+        uint8_t         chipId = 0;
+    };
+
     // Inicializa I2C + API de Bosch + configura modo AHORRO por defecto.
-    bool begin() {
-        // Iniciar bus I2C con tus pines
-        Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
-        // Frecuencia por defecto: modo ahorro → 100 kHz
-        Wire.setClock(100000);
+    // Con 'warm' se salta el soft reset y la lectura de calibración.
+    bool begin(I2cBus* i2c, const WarmState* warm = nullptr) {
+        // Bus compartido; frecuencia por defecto: modo ahorro → 100 kHz
+        if (!i2c || !i2c->begin()) {
+            initialized = false;
+            return false;
+        }
+        link.bus = i2c;
+        link.id  = i2c->addDevice(g_bmp3_i2c_addr, 100000, 100000, 100000,
+                                  I2cBus::Priority::SENSOR);
+        i2c->setRecoveryHook(link.id, onBusRecovered, this);
+        pmLock.begin(PmLock::Kind::APB_MAX, "bmp");
 
         // Configurar estructura de dispositivo de Bosch
         dev.intf      = BMP3_I2C_INTF;
-        dev.read      = bmp3_i2c_read;
-        dev.write     = bmp3_i2c_write;
+        dev.read      = onBusRead;
+        dev.write     = onBusWrite;
         dev.delay_us  = bmp3_delay_us;
-        dev.intf_ptr  = &g_bmp3_i2c_addr;
+        dev.intf_ptr  = &link;
         dev.calib_data = {};   // por si acaso, limpiamos
 
-        int8_t rslt = bmp3_init(&dev);
-        if (rslt != BMP3_OK) {
-            Serial.print("bmp3_init error: ");
-            Serial.println(rslt);
-            initialized = false;
-            return false;
+        if (warm && warm->chipId != 0) {
+            dev.dummy_byte = 0;
+            dev.chip_id    = warm->chipId;
+            dev.calib_data = warm->calib;
+        } else {
+            int8_t rslt = bmp3_init(&dev);
+            if (rslt != BMP3_OK) {
+                Serial.print("bmp3_init error: ");
+                Serial.println(rslt);
+                initialized = false;
+                return false;
+            }
         }
 
         // Configuración base: presión + temperatura activadas, interrupción DRDY
@@ -109,54 +142,88 @@ public:
         return true;
     }
 
-    // Cambia dinámicamente el modo del sensor según tu diseño:
+    // Tabla fija modo -> configuración:
     // - AHORRO: oversampling alto, IIR fuerte, ODR baja (25 Hz), I2C 100 kHz
     // - PRECISO: oversampling medio, IIR medio, ODR 50 Hz, I2C 400 kHz
     // - FREEFALL: oversampling mínimo, sin filtro, ODR alta (ej. 200 Hz), I2C 400 kHz
-    void setMode(SensorMode mode) {
-        if (!initialized) {
-            // Si begin() falló, no intentamos configurar
-            currentMode = mode;
-            return;
-        }
-
-        forcedMode = (mode == SensorMode::AHORRO_FORCED);
-
-        // Base: siempre presión + temperatura + DRDY
-        settings.int_settings.drdy_en = BMP3_ENABLE;
-        settings.press_en             = BMP3_ENABLE;
-        settings.temp_en              = BMP3_ENABLE;
-
+    // En vuelo, SensorGovernor puede sustituirla (ver core/SensorGovernor.h).
+    static SensorConfig configForMode(SensorMode mode) {
+        SensorConfig c;
         switch (mode) {
         case SensorMode::AHORRO:
         case SensorMode::AHORRO_FORCED:
             // Alta precisión pero poca frecuencia, filtro fuerte
-            settings.odr_filter.press_os   = BMP3_OVERSAMPLING_8X;
-            settings.odr_filter.temp_os    = BMP3_OVERSAMPLING_2X;
-            settings.odr_filter.iir_filter = BMP3_IIR_FILTER_COEFF_15;
-            settings.odr_filter.odr        = forcedMode ? BMP3_ODR_3_1_HZ : BMP3_ODR_25_HZ;
-            Wire.setClock(100000); // 100 kHz para ahorro / forced
+            c.pressOs = BMP3_OVERSAMPLING_8X;
+            c.tempOs  = BMP3_OVERSAMPLING_2X;
+            c.iir     = BMP3_IIR_FILTER_COEFF_15;
+            c.forced  = (mode == SensorMode::AHORRO_FORCED);
+            c.odr     = c.forced ? BMP3_ODR_3_1_HZ : BMP3_ODR_25_HZ;
+            c.i2cHz   = 100000; // 100 kHz para ahorro / forced
             break;
 
         case SensorMode::PRECISO:
-            // Modo “ultra preciso”: oversampling alto + filtro medio
-            settings.odr_filter.press_os   = BMP3_OVERSAMPLING_16X;
-            settings.odr_filter.temp_os    = BMP3_OVERSAMPLING_16X;
-            settings.odr_filter.iir_filter = BMP3_IIR_FILTER_COEFF_7;
-            settings.odr_filter.odr        = BMP3_ODR_50_HZ;
-            Wire.setClock(400000); // 400 kHz
-            Serial.println(F("BMP: Modo Ultra Preciso (CLIMB/CANOPY)"));
+            // Modo “ultra preciso”: oversampling alto + filtro medio.
+            // x8/x1 es lo máximo que cabe en 20 ms (50 Hz).
+            c.pressOs = BMP3_OVERSAMPLING_8X;
+            c.tempOs  = BMP3_NO_OVERSAMPLING;
+            c.iir     = BMP3_IIR_FILTER_COEFF_7;
+            c.odr     = BMP3_ODR_50_HZ;
+            c.i2cHz   = 400000; // 400 kHz
             break;
 
         case SensorMode::FREEFALL:
-            // Alta velocidad, poco oversampling, sin filtro
-            settings.odr_filter.press_os   = BMP3_NO_OVERSAMPLING;
-            settings.odr_filter.temp_os    = BMP3_OVERSAMPLING_2X;
-            settings.odr_filter.iir_filter = BMP3_IIR_FILTER_DISABLE;
-            settings.odr_filter.odr        = BMP3_ODR_200_HZ;
-            Wire.setClock(400000); // 400 kHz
+            // Alta velocidad, poco oversampling, sin filtro (x1/x1 cabe en 5 ms)
+            c.pressOs = BMP3_NO_OVERSAMPLING;
+            c.tempOs  = BMP3_NO_OVERSAMPLING;
+            c.iir     = BMP3_IIR_FILTER_DISABLE;
+            c.odr     = BMP3_ODR_200_HZ;
+            c.i2cHz   = 400000; // 400 kHz
             break;
         }
+        return c;
+    }
+
+    // Cambia dinámicamente el modo del sensor (tabla fija de configForMode).
+    void setMode(SensorMode mode) {
+        setConfig(configForMode(mode), mode);
+    }
+
+    // Aplica una configuración concreta. 'mode' queda como modo nominal
+    // (getMode). Si la configuración ya está aplicada no toca el bus.
+    void setConfig(const SensorConfig& cfg, SensorMode mode) {
+        if (!initialized) {
+            // Si begin() falló, no intentamos configurar
+            currentMode = mode;
+            return;
+        }
+        if (configApplied && cfg == appliedCfg) {
+            currentMode = mode;
+            return;
+        }
+
+        forcedMode = cfg.forced;
+
+        // Base: presión + DRDY siempre; temperatura según su calendario
+        settings.int_settings.drdy_en  = BMP3_ENABLE;
+        settings.press_en              = BMP3_ENABLE;
+        settings.temp_en               = tempEnabled ? BMP3_ENABLE : BMP3_DISABLE;
+        settings.odr_filter.press_os   = cfg.pressOs;
+        settings.odr_filter.temp_os    = cfg.tempOs;
+        settings.odr_filter.iir_filter = cfg.iir;
+        settings.odr_filter.odr        = cfg.odr;
+        // Perfil de reloj fijo del BMP; el bus lo aplica en la próxima transacción
+        link.bus->setClockProfile(link.id, cfg.i2cHz, cfg.i2cHz, cfg.i2cHz);
+
+        if (mode == SensorMode::PRECISO && currentMode != SensorMode::PRECISO) {
+            Serial.println(F("BMP: Modo Ultra Preciso (CLIMB/CANOPY)"));
+        }
+        if (cfg != appliedCfg) {
+            // Ahorro de la temperatura a baja tasa: tiempo activo por conversión
+            uint32_t tPT = cfg.measTimeUs(true), tP = cfg.measTimeUs(false);
+            Serial.printf("[BMP] medida P+T %lu us, solo P %lu us (-%lu%%)\n",
+                          (unsigned long)tPT, (unsigned long)tP,
+                          (unsigned long)((tPT - tP) * 100u / tPT));
+        }
 
         uint16_t sel = 0;
         sel |= BMP3_SEL_PRESS_EN;
@@ -175,19 +242,25 @@ public:
 
         // Modo operativo: NORMAL (continuo) o FORCED (toma puntual y duerme)
         settings.op_mode = forcedMode ? BMP3_MODE_FORCED : BMP3_MODE_NORMAL;
-        rslt = bmp3_set_op_mode(&settings, &dev);
-        if (rslt != BMP3_OK) {
+        int8_t opRslt = bmp3_set_op_mode(&settings, &dev);
+        if (opRslt != BMP3_OK) {
             Serial.print("bmp3_set_op_mode error: ");
-            Serial.println(rslt);
+            Serial.println(opRslt);
         }
 
+        if (!forcedMode && tempEnabled) tempEnableMs = millis();
+
         // Reset de cache de lectura forced
         if (forcedMode) {
             lastForcedSampleMs = 0;
             forcedSampleValid  = false;
         }
 
-        currentMode = mode;
+        // Si el sensor la rechazó (p.ej. OSR/ODR incompatibles) se reintenta
+        // en la próxima llamada.
+        appliedCfg    = cfg;
+        configApplied = (rslt == BMP3_OK && opRslt == BMP3_OK);
+        currentMode   = mode;
     }
 
     // Lee presión (Pa) y temperatura (°C). Devuelve true si todo OK.
@@ -195,6 +268,72 @@ public:
         if (!initialized) {
             return false;
         }
+        // Candado "lectura de sensor": APB estable y sin light sleep mientras
+        // se habla con el BMP (se suelta durante la conversión forced).
+        pmLock.acquire();
+        bool ok = readLocked(pressurePa, temperatureC);
+        pmLock.release();
+        return ok;
+    }
+
+    // Periodo entre muestras nuevas con la configuración aplicada.
+    uint32_t getSamplePeriodMs() const {
+        if (forcedMode) return FORCED_MIN_INTERVAL_MS;
+        return (uint32_t)(1000.0f / appliedCfg.odrHz());
+    }
+
+    SensorMode getMode() const { return currentMode; }
+
+    bool saveWarm(WarmState& w) const {
+        if (!initialized) return false;
+        w.calib  = dev.calib_data;
+        w.chipId = dev.chip_id;
+        return true;
+    }
+
+    // Última configuración enviada al sensor.
+    const SensorConfig& getConfig() const { return appliedCfg; }
+
+    static constexpr int FORCED_SAMPLES_PER_READ = 2;  // dos lecturas puntuales por wake
+
+    // Calendario de temperatura (ver BMP_TEMP_INTERVAL_MS).
+    uint32_t getTempIntervalMs() const { return tempIntervalMs; }
+    uint32_t getTempAgeMs(uint32_t nowMs) const { return tempValid ? nowMs - tempSampleMs : 0; }
+    uint32_t getTempConversions() const { return tempConversions; }
+
+    // Duración medida de una conversión forced (us, media móvil), sólo
+    // presión o presión + temperatura. 0 si aún no se ha medido.
+    uint32_t getConvTimeUs(bool withTemp) const { return (uint32_t)convUs[withTemp ? 1 : 0]; }
+
+private:
+    // Lo que la API de Bosch recibe como intf_ptr.
+    struct BusLink {
+        I2cBus*          bus = nullptr;
+        I2cBus::DeviceId id  = I2cBus::NO_DEVICE;
+    };
+
+    // Lectura/escritura I2C que la API de Bosch usa internamente.
+    static BMP3_INTF_RET_TYPE onBusRead(uint8_t reg_addr, uint8_t *reg_data,
+                                        uint32_t len, void *intf_ptr) {
+        BusLink* l = static_cast<BusLink*>(intf_ptr);
+        return l->bus->readReg(l->id, reg_addr, reg_data, len) ? BMP3_OK : BMP3_E_COMM_FAIL;
+    }
+
+    static BMP3_INTF_RET_TYPE onBusWrite(uint8_t reg_addr, const uint8_t *reg_data,
+                                         uint32_t len, void *intf_ptr) {
+        BusLink* l = static_cast<BusLink*>(intf_ptr);
+        return l->bus->writeReg(l->id, reg_addr, reg_data, len) ? BMP3_OK : BMP3_E_COMM_FAIL;
+    }
+
+    bool readLocked(float &pressurePa, float &temperatureC) {
+
+        // Tras recuperar el bus el sensor puede haber perdido la configuración
+        // (o haberse reiniciado): se vuelve a escribir la última aplicada.
+        if (needsReapply) {
+            needsReapply  = false;
+            configApplied = false;
+            setConfig(appliedCfg, currentMode);
+        }
 
         uint32_t now = millis();
 
@@ -210,13 +349,31 @@ public:
         int samplesToTake = forcedMode ? FORCED_SAMPLES_PER_READ : 1;
         bool gotSample    = false;
 
+        // Normal: la temperatura se activa cuando toca y, en cuanto llega una
+        // muestra que la incluye seguro, se cachea y se vuelve a apagar.
+        bool takeTemp = false;
+        if (!forcedMode) {
+            if (tempEnabled) {
+                takeTemp = (now - tempEnableMs) >= tempSettleMs();
+            } else if (tempDue(now)) {
+                setTempEnabled(true);
+                tempEnableMs = now;
+            }
+        }
+
         for (int i = 0; i < samplesToTake; ++i) {
             if (forcedMode) {
+                // Forced: cada disparo decide si incluye temperatura.
+                bool want = tempDue(now);
+                if (want != tempEnabled) setTempEnabled(want);
+                takeTemp = tempEnabled;
+
                 settings.op_mode = BMP3_MODE_FORCED;
                 int8_t setRslt = bmp3_set_op_mode(&settings, &dev);
                 if (setRslt != BMP3_OK) {
                     continue; // intenta siguiente lectura forced si aplica
                 }
+                waitForcedConversion(takeTemp);
             }
 
             int8_t rslt = bmp3_get_sensor_data(BMP3_PRESS_TEMP, &data, &dev);
@@ -232,12 +389,14 @@ public:
             }
 
         #ifdef BMP3_FLOAT_COMPENSATION
-            temperatureC = data.temperature;
+            float tNow   = data.temperature;
             pressurePa   = data.pressure;
         #else
-            temperatureC = data.temperature / 100.0f;
+            float tNow   = data.temperature / 100.0f;
             pressurePa   = data.pressure   / 100.0f;
         #endif
+            if (takeTemp) noteTemperature(tNow, pressurePa, now);
+            temperatureC = tempValid ? cachedTempC : tNow;
 
             gotSample = true;
             // Si necesitamos varias muestras forced, nos quedamos con la última
@@ -246,6 +405,8 @@ public:
         if (!gotSample) {
             return false;
         }
+        lastSeenPa = pressurePa;
+        if (!forcedMode && takeTemp) setTempEnabled(false);
 
         if (forcedMode) {
             lastForcedSampleMs = now;
@@ -268,14 +429,16 @@ public:
         return true;
     }
 
-    SensorMode getMode() const { return currentMode; }
-
-private:
     struct bmp3_dev      dev{};
     struct bmp3_settings settings{};
     struct bmp3_data     data{};
+    BusLink              link{};
+    PmLock               pmLock;
     bool                 initialized = false;
     SensorMode           currentMode = SensorMode::AHORRO;
+    SensorConfig         appliedCfg{};
+    bool                 configApplied = false;
+    volatile bool        needsReapply  = false;
 
     bool     forcedMode          = false;
     bool     forcedSampleValid   = false;
@@ -283,6 +446,94 @@ private:
     float    lastPressurePa      = 0.0f;
     float    lastTempC           = 0.0f;
 
+    // Calendario de temperatura
+    bool     tempEnabled         = true;    // temp_en en el sensor
+    bool     tempValid           = false;
+    float    cachedTempC         = NAN;
+    float    tempRefPa           = NAN;     // presión en el último refresco
+    float    lastSeenPa          = NAN;
+    uint32_t tempSampleMs        = 0;
+    uint32_t tempEnableMs        = 0;
+    uint32_t tempIntervalMs      = BMP_TEMP_INTERVAL_MS;
+    uint32_t tempConversions     = 0;
+    float    convUs[2]           = {0.0f, 0.0f};
+
     static constexpr uint32_t FORCED_MIN_INTERVAL_MS = 500; // limita spam en modo forced
-    static constexpr int      FORCED_SAMPLES_PER_READ = 2;  // dos lecturas puntuales por wake
+
+    // Hook de I2cBus: se llama con el bus tomado, sólo marca.
+    static void onBusRecovered(void* user) {
+        static_cast<Bmp390Driver*>(user)->needsReapply = true;
+    }
+
+    bool tempDue(uint32_t now) const {
+        if (!tempValid) return true;
+        if ((now - tempSampleMs) >= tempIntervalMs) return true;
+        return isfinite(tempRefPa) && fabsf(lastSeenPa - tempRefPa) >= BMP_TEMP_REFRESH_PA;
+    }
+
+    // En normal, la primera muestra que seguro incluye temperatura llega tras
+    // terminar la conversión en curso y hacer otra completa.
+    uint32_t tempSettleMs() const {
+        uint32_t periodUs = 5000u << appliedCfg.odr;
+        return (periodUs + appliedCfg.measTimeUs(true)) / 1000u + 1u;
+    }
+
+    // Sólo toca PWR_CTRL (lectura-modificación-escritura: conserva el modo).
+    void setTempEnabled(bool en) {
+        settings.temp_en = en ? BMP3_ENABLE : BMP3_DISABLE;
+        if (bmp3_set_sensor_settings(BMP3_SEL_TEMP_EN, &settings, &dev) == BMP3_OK) {
+            tempEnabled = en;
+        }
+    }
+
+    // Refresco de la caché. Si la temperatura se movió más de lo permitido
+    // entre refrescos, se acorta el intervalo; si apenas se movió, se alarga.
+    void noteTemperature(float tC, float pPa, uint32_t now) {
+        if (tempValid) {
+            float drift = fabsf(tC - cachedTempC);
+            if (drift > BMP_TEMP_DRIFT_MAX_C) {
+                tempIntervalMs = tempIntervalMs / 2u;
+                if (tempIntervalMs < BMP_TEMP_INTERVAL_MIN_MS) tempIntervalMs = BMP_TEMP_INTERVAL_MIN_MS;
+            } else if (drift < 0.25f * BMP_TEMP_DRIFT_MAX_C) {
+                tempIntervalMs = tempIntervalMs * 2u;
+                if (tempIntervalMs > BMP_TEMP_INTERVAL_MS) tempIntervalMs = BMP_TEMP_INTERVAL_MS;
+            }
+        }
+        cachedTempC  = tC;
+        tempRefPa    = pPa;
+        tempSampleMs = now;
+        tempValid    = true;
+        tempConversions++;
+    }
+
+    // Forced: espera a que termine la conversión (DRDY en STATUS) en vez de
+    // leer los registros del disparo anterior, y mide cuánto tarda.
+    void waitForcedConversion(bool withTemp) {
+        uint32_t expectUs = appliedCfg.measTimeUs(withTemp);
+        uint32_t t0 = micros();
+        uint32_t waitUs = expectUs - expectUs / 8u;
+    #if PM_LOCKS_ACTIVE
+        // Con gestión automática la CPU duerme durante la conversión.
+        if (waitUs >= 2000u) {
+            pmLock.release();
+            delay(waitUs / 1000u);
+            pmLock.acquire();
+            waitUs %= 1000u;
+        }
+    #endif
+        delayMicroseconds(waitUs);
+
+        struct bmp3_status st{};
+        while (true) {
+            if (bmp3_get_status(&st, &dev) == BMP3_OK &&
+                st.sensor.drdy_press && (!withTemp || st.sensor.drdy_temp)) {
+                break;
+            }
+            if ((micros() - t0) > 2u * expectUs) return;   // sin DRDY: no medimos
+            delayMicroseconds(100);
+        }
+        float us = (float)(micros() - t0);
+        float& m = convUs[withTemp ? 1 : 0];
+        m = (m == 0.0f) ? us : m + 0.125f * (us - m);
+    }
 };
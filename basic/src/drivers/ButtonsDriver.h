@@ -1,160 +1,153 @@
 #pragma once
 #include <Arduino.h>
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
 #include "include/config_pins.h"
-
-// Identifiers for the physical buttons on the device.
-enum class ButtonId { UP, MID, DOWN };
-
-// Types of button events that can be reported.
-enum class ButtonEventType { PRESS, REPEAT, LONG_PRESS_3S, LONG_PRESS_6S, RELEASE };
-
-// Event structure returned by poll().
-struct ButtonEvent {
-    ButtonId id;
-    ButtonEventType type;
-    uint32_t timestampMs;
-};
+#include "util/ButtonLogic.h"
+#include "util/SpscRing.h"
 
 // ButtonsDriver detecta pulsaciones y long presses.
-// Reacciona inmediato al flanco (como el firmware viejo) pero con
-// un pequeño intervalo mínimo entre eventos para evitar rebotes.
+//
+// Los flancos los captura una ISR por botón (CHANGE) con su millis() y los
+// deja en una cola sin bloqueo; poll() los pasa por ButtonLogic, que aplica
+// antirrebote, repetición y long-press sobre esas marcas de tiempo. Así los
+// eventos no dependen de cada cuánto corra el loop: un loop lento entrega
+// los mismos eventos, en orden y con su hora real.
+//
+// Red de seguridad: si se pierde un flanco (cola llena, ISR enmascarada
+// durante light sleep) el nivel se relee cada BTN_RESYNC_MS o al llamar a
+// notifyWake(), y se sintetiza el flanco que falte.
+#ifndef BTN_EDGE_QUEUE_LEN
+#define BTN_EDGE_QUEUE_LEN  64      // flancos (8 B c/u); potencia de 2
+#endif
+#ifndef BTN_RESYNC_MS
+#define BTN_RESYNC_MS       250
+#endif
+
 class ButtonsDriver {
 public:
     void begin() {
         // Botones conectados a 3.3V, activos en HIGH, con PULLDOWN interno
-        pinMode(PIN_BTN_UP,   INPUT_PULLDOWN);
-        pinMode(PIN_BTN_MID,  INPUT_PULLDOWN);
-        pinMode(PIN_BTN_DOWN, INPUT_PULLDOWN);
+        bool pressed[ButtonLogic::COUNT];
+        for (uint8_t i = 0; i < ButtonLogic::COUNT; ++i) {
+            pinMode(pinFor(i), INPUT_PULLDOWN);
+            pressed[i] = digitalRead(pinFor(i)) == HIGH;  // debería ser LOW en reposo
+        }
 
         uint32_t now = millis();
-
-        for (int i = 0; i < 3; ++i) {
-            int pin;
-            switch (i) {
-                case 0: pin = PIN_BTN_UP;   break;
-                case 1: pin = PIN_BTN_MID;  break;
-                case 2: pin = PIN_BTN_DOWN; break;
-                default: pin = PIN_BTN_UP;  break;
-            }
-
-            int r = digitalRead(pin);  // debería ser LOW en reposo
-
-            lastState[i]    = r;
-            pressStartMs[i] = 0;
-            long3Reported[i] = false;
-            long6Reported[i] = false;
-            lastEventMs[i]   = now;
-            repeating[i]     = false;
-            lastRepeatMs[i]  = now;
+        logic.reset(pressed, now);
+        lastResyncMs = now;
+
+        for (uint8_t i = 0; i < ButtonLogic::COUNT; ++i) {
+            isrCtx[i].self = this;
+            isrCtx[i].idx  = i;
+            isrCtx[i].pin  = pinFor(i);
+            attachInterruptArg(pinFor(i), onEdge, &isrCtx[i], CHANGE);
         }
     }
 
     // Poll the buttons to see if a new event occurred. Returns true
     // if an event was generated and fills 'ev' with the event data.
     bool poll(ButtonEvent& ev) {
-        uint32_t now = millis();
+        // 1) Flancos capturados por la ISR, intercalando los eventos
+        //    temporizados que vencieron antes de cada uno (a igual
+        //    milisegundo gana el flanco, como en el driver por polling).
+        Edge e;
+        while (edges.peek(e)) {
+            if (logic.nextTimed(e.tMs - 1, ev)) return true;
+            edges.pop(e);
+            if (logic.onEdge(e.idx, e.high, e.tMs, ev)) return true;
+        }
 
-        // Tiempo mínimo entre eventos aceptados por botón.
-        // Esto NO obliga a mantener apretado; solo evita dos eventos
-        // seguidos demasiado rápidos (rebote).
-        constexpr uint32_t MIN_EVENT_INTERVAL_MS = 30;
-        constexpr uint32_t REPEAT_DELAY_MS       = 500;
-        constexpr uint32_t REPEAT_INTERVAL_MS    = 120;
-
-        // Iterate over the 3 buttons.
-        for (int i = 0; i < 3; ++i) {
-            uint8_t pin;
-            switch (i) {
-                case 0: pin = PIN_BTN_UP;   break;
-                case 1: pin = PIN_BTN_MID;  break;
-                case 2: pin = PIN_BTN_DOWN; break;
-                default: pin = PIN_BTN_UP;  break;
+        // 2) Repetición y long-press vencidos.
+        uint32_t now = millis();
+        if (logic.nextTimed(now, ev)) return true;
+
+        // 3) Flancos perdidos: con la cola vacía, el nivel real manda. Se
+        //    aplica aquí (no por la cola) para que la ISR siga siendo el
+        //    único productor.
+        if (resyncPending || now - lastResyncMs >= BTN_RESYNC_MS) {
+            for (uint8_t i = 0; i < ButtonLogic::COUNT; ++i) {
+                if (!edges.empty()) return false;
+                bool high = digitalRead(pinFor(i)) == HIGH;
+                if (logic.onEdge(i, high, now, ev)) return true;
             }
+            resyncPending = false;
+            lastResyncMs  = now;
+        }
+        return false;
+    }
 
-            int reading = digitalRead(pin);  // HIGH = pulsado, LOW = suelto
-
-            // 1) Detectar flanco (cambio de estado)
-            if (reading != lastState[i]) {
-                uint32_t elapsed = now - lastEventMs[i];
-
-                // Si el cambio ocurre demasiado rápido después del último evento,
-                // lo tomamos como rebote y lo ignoramos.
-                if (elapsed < MIN_EVENT_INTERVAL_MS) {
-                    // Actualizamos el estado interno para no quedarnos colgados,
-                    // pero no generamos evento.
-                    lastState[i] = reading;
-                    continue;
-                }
-
-                lastState[i]  = reading;
-                lastEventMs[i] = now;
-
-                ev.id          = static_cast<ButtonId>(i);
-                ev.timestampMs = now;
-
-                if (reading == HIGH) {
-                    // Flanco de subida → PRESS inmediato
-                    pressStartMs[i]  = now;
-                    long3Reported[i] = false;
-                    long6Reported[i] = false;
-                    repeating[i]     = false;
-                    lastRepeatMs[i]  = now;
-                    ev.type = ButtonEventType::PRESS;
-                } else {
-                    // Flanco de bajada → RELEASE
-                    ev.type = ButtonEventType::RELEASE;
-                    repeating[i] = false;
-                }
-                return true;
-            }
+    // Cada flanco avisa a 'task' (la tarea de UI) con una notificación para
+    // que salga de su espera sin aguardar al siguiente frame.
+    void setNotifyTask(TaskHandle_t task) { wakeTask = task; }
+
+    // Gestión automática de energía: sólo un nivel despierta de light sleep,
+    // así que la interrupción pasa a ser por nivel y la ISR alterna
+    // HIGH/LOW en cada disparo (equivale a flancos).
+    void enableSleepWake(TaskHandle_t task) {
+        setNotifyTask(task);
+        levelMode = true;
+        for (uint8_t i = 0; i < ButtonLogic::COUNT; ++i) {
+            bool high = digitalRead(pinFor(i)) == HIGH;
+            gpio_wakeup_enable((gpio_num_t)pinFor(i),
+                               high ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+        }
+    }
 
-            // 2) Si está estable en HIGH, mirar long-press
-            if (lastState[i] == HIGH && pressStartMs[i] != 0) {
-                uint32_t held = now - pressStartMs[i];
-
-                // LONG_PRESS_3S: entre 3s y 6s, solo una vez
-                if (!long3Reported[i] && held >= 3000 && held < 6000) {
-                    long3Reported[i] = true;
-                    ev.id            = static_cast<ButtonId>(i);
-                    ev.timestampMs   = now;
-                    ev.type          = ButtonEventType::LONG_PRESS_3S;
-                    return true;
-                }
-
-                // LONG_PRESS_6S: a partir de 6s, solo una vez
-                if (!long6Reported[i] && held >= 6000) {
-                    long6Reported[i] = true;
-                    ev.id            = static_cast<ButtonId>(i);
-                    ev.timestampMs   = now;
-                    ev.type          = ButtonEventType::LONG_PRESS_6S;
-                    return true;
-                }
-
-                // Repetición acelerada después de un delay
-                if (!repeating[i] && held >= REPEAT_DELAY_MS) {
-                    repeating[i]    = true;
-                    lastRepeatMs[i] = now;
-                }
-
-                if (repeating[i] && (now - lastRepeatMs[i] >= REPEAT_INTERVAL_MS)) {
-                    lastRepeatMs[i] = now;
-                    ev.id           = static_cast<ButtonId>(i);
-                    ev.timestampMs  = now;
-                    ev.type         = ButtonEventType::REPEAT;
-                    return true;
-                }
-            }
+    // Al salir de light sleep la ISR estuvo enmascarada: releer los niveles
+    // en el próximo poll().
+    void notifyWake() { resyncPending = true; }
+
+    uint32_t getDroppedEdges() const { return edges.getDropped(); }
+
+private:
+    struct Edge {
+        uint32_t tMs;
+        uint8_t  idx;
+        bool     high;
+    };
+
+    struct IsrCtx {
+        ButtonsDriver* self;
+        uint8_t        idx;
+        uint8_t        pin;
+    };
+
+    static uint8_t pinFor(uint8_t i) {
+        switch (i) {
+            case 0:  return PIN_BTN_UP;
+            case 1:  return PIN_BTN_MID;
+            case 2:  return PIN_BTN_DOWN;
+            default: return PIN_BTN_UP;
         }
+    }
 
-        return false;
+    // Todas las ISR de GPIO comparten nivel y no se anidan: un solo productor.
+    static void IRAM_ATTR onEdge(void* arg) {
+        IsrCtx* c = static_cast<IsrCtx*>(arg);
+        Edge e;
+        e.tMs  = millis();
+        e.idx  = c->idx;
+        e.high = digitalRead(c->pin) == HIGH;
+        ButtonsDriver* self = c->self;
+        if (self->levelMode) {
+            gpio_ll_set_intr_type(&GPIO, (gpio_num_t)c->pin,
+                                  e.high ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+        }
+        self->edges.push(e);
+        if (self->wakeTask) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(self->wakeTask, &woken);
+            if (woken) portYIELD_FROM_ISR();
+        }
     }
 
-private:
-    int      lastState[3];      // último estado lógico visto (HIGH/LOW)
-    uint32_t pressStartMs[3];   // cuándo empezó la pulsación (para long press)
-    bool     long3Reported[3];  // flags de long-press
-    bool     long6Reported[3];
-    uint32_t lastEventMs[3];    // última vez que emitimos un evento por botón
-    bool     repeating[3];
-    uint32_t lastRepeatMs[3];
+    ButtonLogic                          logic;
+    SpscRing<Edge, BTN_EDGE_QUEUE_LEN>   edges;
+    IsrCtx                               isrCtx[ButtonLogic::COUNT];
+    uint32_t                             lastResyncMs  = 0;
+    volatile bool                        resyncPending = false;
+    bool                                 levelMode     = false;
+    TaskHandle_t                         wakeTask      = nullptr;
 };
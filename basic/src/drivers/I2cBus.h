@@ -0,0 +1,488 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "include/config_pins.h"
+
+// Gestor único del bus I2C compartido (BMP390 + DS3231).
+//
+// - Un solo Wire.begin() para todo el firmware; los drivers se registran con
+//   addDevice() y hablan con el bus a través de su DeviceId.
+// - Perfil de reloj por dispositivo: rango [minHz, maxHz] y reloj preferido.
+//   El reloj sólo se cambia cuando el actual queda fuera del rango del
+//   dispositivo que va a transmitir, y nunca a mitad de una transacción
+//   (todas van bajo el mutex del bus).
+// - Prioridad: las transacciones síncronas del camino del sensor (SENSOR)
+//   pasan delante de la cola de segundo plano. service() suelta el bus entre
+//   transacciones en cuanto hay un lector SENSOR esperando.
+// - Cola asíncrona para lecturas de segundo plano (RTC): submitRead() no
+//   bloquea; service() ejecuta en un solo lote todo lo pendiente, agrupado por
+//   reloj para cambiarlo como mucho una vez, y avisa con callback + user.
+//   Las lecturas idénticas ya encoladas se fusionan.
+//
+// Salud del bus:
+// - Cada transacción lleva un presupuesto de timeout según bytes y reloj
+//   (2× lo nominal + I2C_TIMEOUT_MARGIN_US), en vez de los 50 ms por defecto
+//   de Wire.
+// - Fallos consecutivos por dispositivo. Al llegar a I2C_FAILS_BEFORE_RECOVERY
+//   se recupera el bus: hasta 9 pulsos de SCL para que un esclavo suelte SDA,
+//   STOP manual y Wire reiniciado con el reloj actual. Los drivers se enteran
+//   por su hook de recuperación (p.ej. el BMP390 re-aplica su configuración).
+// - Si el dispositivo sigue sin responder queda "caído": sus transacciones
+//   fallan al instante y sólo se deja pasar un reintento real tras un
+//   back-off exponencial (I2C_DOWN_RETRY_MIN_MS .. I2C_DOWN_RETRY_MS). Así el
+//   atasco por vuelta del loop queda acotado (ver stallBoundUs()) en lugar de
+//   sumar un timeout por transacción en cada vuelta, y un fallo pasajero
+//   sólo cuesta un par de muestras.
+
+#ifndef I2C_BUS_MAX_DEVICES
+#define I2C_BUS_MAX_DEVICES   4
+#endif
+#ifndef I2C_BUS_QUEUE_LEN
+#define I2C_BUS_QUEUE_LEN     8
+#endif
+#ifndef I2C_BUS_MAX_ASYNC_LEN
+#define I2C_BUS_MAX_ASYNC_LEN 8      // bytes por lectura asíncrona
+#endif
+#ifndef I2C_BUS_DEFAULT_HZ
+#define I2C_BUS_DEFAULT_HZ    100000u
+#endif
+#ifndef I2C_TIMEOUT_MARGIN_US
+#define I2C_TIMEOUT_MARGIN_US 1000u
+#endif
+#ifndef I2C_FAILS_BEFORE_RECOVERY
+#define I2C_FAILS_BEFORE_RECOVERY 3
+#endif
+#ifndef I2C_DOWN_RETRY_MIN_MS
+#define I2C_DOWN_RETRY_MIN_MS 10u
+#endif
+#ifndef I2C_DOWN_RETRY_MS
+#define I2C_DOWN_RETRY_MS     200u
+#endif
+#ifndef I2C_MAX_XFER_BYTES
+#define I2C_MAX_XFER_BYTES    32u     // mayor transferencia prevista (calibración BMP: 21)
+#endif
+
+class I2cBus {
+public:
+    enum class Priority : uint8_t { SENSOR = 0, BACKGROUND };
+
+    typedef uint8_t DeviceId;
+    static constexpr DeviceId NO_DEVICE = 0xFF;
+
+    // Fin de una lectura asíncrona (se llama desde service(), con el bus libre).
+    typedef void (*ReadDoneFn)(void* user, bool ok, const uint8_t* data, uint8_t len);
+
+    // Aviso tras una recuperación del bus. Se llama con el bus tomado: sólo
+    // debe marcar estado, no hacer transacciones.
+    typedef void (*RecoveredFn)(void* user);
+
+    struct Stats {
+        uint32_t transactions    = 0;
+        uint32_t errors          = 0;
+        uint32_t clockSwitches   = 0;
+        uint32_t batches         = 0;
+        uint32_t merged          = 0;    // lecturas asíncronas fusionadas
+        uint32_t dropped         = 0;    // cola llena
+        uint32_t queueMaxUs      = 0;    // encolado -> callback
+        float    queueAvgUs      = 0.0f;
+        uint32_t sensorWaitMaxUs = 0;    // espera del mutex en el camino del sensor
+        uint32_t timeouts        = 0;
+        uint32_t recoveries      = 0;
+        uint32_t recoveryFails   = 0;    // SDA seguía abajo tras los 9 pulsos
+        uint32_t fastFails       = 0;    // rechazadas sin tocar el bus (dispositivo caído)
+        uint32_t worstXferUs     = 0;    // transacción más larga (incluida recuperación)
+        uint32_t worstOutageMs   = 0;    // primer fallo -> siguiente éxito
+    };
+
+    // Idempotente: el primer driver que llega inicia el bus.
+    bool begin(int sda = PIN_I2C_SDA, int scl = PIN_I2C_SCL) {
+        if (started) return true;
+        mutex = xSemaphoreCreateMutex();
+        if (!mutex) return false;
+        sdaPin = sda;
+        sclPin = scl;
+        Wire.begin(sda, scl);
+        Wire.setClock(I2C_BUS_DEFAULT_HZ);
+        currentHz = I2C_BUS_DEFAULT_HZ;
+        timeoutMs = 0;
+        started   = true;
+        return true;
+    }
+
+    DeviceId addDevice(uint8_t addr, uint32_t preferredHz, uint32_t minHz, uint32_t maxHz,
+                       Priority prio) {
+        if (deviceCount >= I2C_BUS_MAX_DEVICES) return NO_DEVICE;
+        Device& d = devices[deviceCount];
+        d.addr  = addr;
+        d.prefHz = preferredHz;
+        d.minHz = minHz;
+        d.maxHz = maxHz;
+        d.prio  = prio;
+        return deviceCount++;
+    }
+
+    void setRecoveryHook(DeviceId id, RecoveredFn fn, void* user) {
+        if (id >= deviceCount) return;
+        devices[id].onRecovered = fn;
+        devices[id].hookUser    = user;
+    }
+
+    // Cambia el perfil de reloj de un dispositivo (p.ej. BMP390 100/400 kHz
+    // según modo). El bus no se toca hasta su próxima transacción.
+    void setClockProfile(DeviceId id, uint32_t preferredHz, uint32_t minHz, uint32_t maxHz) {
+        if (id >= deviceCount) return;
+        Device& d = devices[id];
+        d.prefHz = preferredHz;
+        d.minHz  = minHz;
+        d.maxHz  = maxHz;
+    }
+
+    // --- Transacciones síncronas ---------------------------------------------
+
+    bool readReg(DeviceId id, uint8_t reg, uint8_t* buf, uint32_t len) {
+        if (!acquire(id)) return false;
+        bool ok = doRead(devices[id], reg, buf, len);
+        release();
+        return ok;
+    }
+
+    bool writeReg(DeviceId id, uint8_t reg, const uint8_t* buf, uint32_t len) {
+        if (!acquire(id)) return false;
+        bool ok = doWrite(devices[id], reg, buf, len);
+        release();
+        return ok;
+    }
+
+    // Dirección sin datos: ¿responde con ACK?
+    bool probe(DeviceId id) {
+        if (!acquire(id)) return false;
+        Device& d = devices[id];
+        bool ok = false;
+        if (begin_xfer(d, 1)) {
+            Wire.beginTransmission(d.addr);
+            uint8_t err = Wire.endTransmission();
+            ok = (err == 0);
+            end_xfer(d, ok, err);
+        }
+        release();
+        return ok;
+    }
+
+    bool isDeviceDown(DeviceId id) const {
+        return id < deviceCount && devices[id].fails >= I2C_FAILS_BEFORE_RECOVERY;
+    }
+
+    // Cota del atasco que un dispositivo roto puede meter en una vuelta del
+    // loop: como mucho I2C_FAILS_BEFORE_RECOVERY transacciones con timeout
+    // completo y una recuperación; el resto falla al instante hasta el
+    // siguiente reintento (que vuelve a costar, como mucho, lo mismo).
+    uint32_t stallBoundUs() const {
+        uint32_t slowHz = currentHz;    // reloj más lento que puede llegar a usarse
+        for (uint8_t i = 0; i < deviceCount; ++i) {
+            if (devices[i].prefHz < slowHz) slowHz = devices[i].prefHz;
+        }
+        uint32_t xfer = budgetMs(I2C_MAX_XFER_BYTES, slowHz) * 1000u;
+        return (uint32_t)I2C_FAILS_BEFORE_RECOVERY * xfer + recoveryBoundUs();
+    }
+
+    // --- Cola asíncrona (segundo plano) ---------------------------------------
+
+    // Encola una lectura de 'len' bytes desde 'reg'. No bloquea.
+    bool submitRead(DeviceId id, uint8_t reg, uint8_t len, ReadDoneFn fn, void* user) {
+        if (!started || id >= deviceCount || len == 0 || len > I2C_BUS_MAX_ASYNC_LEN) return false;
+        bool ok = true;
+        portENTER_CRITICAL(&queueMux);
+        for (uint8_t i = 0; i < queued; ++i) {
+            const Pending& p = queue[i];
+            if (p.dev == id && p.reg == reg && p.len == len && p.fn == fn && p.user == user) {
+                stats.merged++;
+                portEXIT_CRITICAL(&queueMux);
+                return true;
+            }
+        }
+        if (queued >= I2C_BUS_QUEUE_LEN) {
+            stats.dropped++;
+            ok = false;
+        } else {
+            Pending& p = queue[queued++];
+            p.dev  = id;
+            p.reg  = reg;
+            p.len  = len;
+            p.fn   = fn;
+            p.user = user;
+            p.tUs  = micros();
+        }
+        portEXIT_CRITICAL(&queueMux);
+        return ok;
+    }
+
+    // Ejecuta la cola pendiente en un lote. Llamar desde el loop después del
+    // camino del sensor. Devuelve cuántas transacciones se completaron.
+    uint8_t service() {
+        if (!started || queued == 0) return 0;
+
+        Pending batch[I2C_BUS_QUEUE_LEN];
+        uint8_t n = takeQueue(batch);
+        if (n == 0) return 0;
+
+        // Agrupar: primero lo que cabe en el reloj actual, luego el resto.
+        uint8_t order[I2C_BUS_QUEUE_LEN];
+        uint8_t k = 0;
+        for (uint8_t i = 0; i < n; ++i) if (clockOk(devices[batch[i].dev], currentHz)) order[k++] = i;
+        for (uint8_t i = 0; i < n; ++i) if (!clockOk(devices[batch[i].dev], currentHz)) order[k++] = i;
+
+        uint8_t done = 0;
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        stats.batches++;
+        uint8_t results[I2C_BUS_QUEUE_LEN][I2C_BUS_MAX_ASYNC_LEN];
+        bool    okFlags[I2C_BUS_QUEUE_LEN];
+        for (; done < n; ++done) {
+            if (sensorWaiting) break;    // el sensor pasa delante
+            const Pending& p = batch[order[done]];
+            okFlags[done] = doRead(devices[p.dev], p.reg, results[done], p.len);
+        }
+        xSemaphoreGive(mutex);
+
+        // Lo no ejecutado vuelve a la cola (delante, conserva su marca de tiempo).
+        if (done < n) {
+            Pending rest[I2C_BUS_QUEUE_LEN];
+            uint8_t r = 0;
+            for (uint8_t i = done; i < n; ++i) rest[r++] = batch[order[i]];
+            requeueFront(rest, r);
+        }
+
+        // Callbacks fuera del mutex.
+        uint32_t nowUs = micros();
+        for (uint8_t i = 0; i < done; ++i) {
+            const Pending& p = batch[order[i]];
+            noteQueueLatency(nowUs - p.tUs);
+            if (p.fn) p.fn(p.user, okFlags[i], results[i], p.len);
+        }
+        return done;
+    }
+
+    uint8_t pending() const { return queued; }
+    uint32_t getClockHz() const { return currentHz; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Device {
+        uint8_t  addr   = 0;
+        uint32_t prefHz = I2C_BUS_DEFAULT_HZ;
+        uint32_t minHz  = I2C_BUS_DEFAULT_HZ;
+        uint32_t maxHz  = I2C_BUS_DEFAULT_HZ;
+        Priority prio   = Priority::BACKGROUND;
+
+        uint8_t     fails        = 0;       // fallos consecutivos
+        uint32_t    nextTryMs    = 0;       // caído: próximo reintento real
+        uint32_t    failSinceMs  = 0;       // inicio de la racha de fallos
+        RecoveredFn onRecovered  = nullptr;
+        void*       hookUser     = nullptr;
+    };
+
+    struct Pending {
+        DeviceId   dev  = NO_DEVICE;
+        uint8_t    reg  = 0;
+        uint8_t    len  = 0;
+        ReadDoneFn fn   = nullptr;
+        void*      user = nullptr;
+        uint32_t   tUs  = 0;
+    };
+
+    static bool clockOk(const Device& d, uint32_t hz) {
+        return hz >= d.minHz && hz <= d.maxHz;
+    }
+
+    bool acquire(DeviceId id) {
+        if (!started || id >= deviceCount) return false;
+        if (devices[id].prio == Priority::SENSOR) {
+            uint32_t t0 = micros();
+            sensorWaiting++;
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            sensorWaiting--;
+            uint32_t w = micros() - t0;
+            if (w > stats.sensorWaitMaxUs) stats.sensorWaitMaxUs = w;
+        } else {
+            xSemaphoreTake(mutex, portMAX_DELAY);
+        }
+        return true;
+    }
+
+    void release() { xSemaphoreGive(mutex); }
+
+    void applyClock(const Device& d) {
+        if (clockOk(d, currentHz)) return;
+        Wire.setClock(d.prefHz);
+        currentHz = d.prefHz;
+        stats.clockSwitches++;
+    }
+
+    // Presupuesto de una transacción: 2× el tiempo nominal de 'bytes' (9 bits
+    // por byte, + dirección) más margen. Wire lo toma en ms.
+    static uint32_t budgetMs(uint32_t bytes, uint32_t hz) {
+        uint32_t nominalUs = (uint32_t)(((uint64_t)(bytes + 2u) * 9u * 1000000u) / hz);
+        return (2u * nominalUs + I2C_TIMEOUT_MARGIN_US + 999u) / 1000u;
+    }
+
+    // 9 pulsos de SCL + STOP + Wire.begin, con medio periodo de 5 us.
+    static uint32_t recoveryBoundUs() { return (9u * 2u + 4u) * 5u + 1000u; }
+
+    // Prepara reloj + timeout. Devuelve false si el dispositivo está caído y
+    // aún no toca reintentar (falla sin tocar el bus).
+    bool begin_xfer(Device& d, uint32_t bytes) {
+        if (d.fails >= I2C_FAILS_BEFORE_RECOVERY &&
+            (int32_t)(millis() - d.nextTryMs) < 0) {
+            stats.fastFails++;
+            stats.errors++;
+            return false;
+        }
+        applyClock(d);
+        uint32_t ms = budgetMs(bytes, currentHz);
+        if (ms != timeoutMs) {
+            Wire.setTimeOut((uint16_t)ms);
+            timeoutMs = ms;
+        }
+        xferStartUs = micros();
+        return true;
+    }
+
+    // Contabiliza el resultado; con demasiados fallos seguidos, recupera el bus.
+    // err: código de Wire.endTransmission (5 = timeout en arduino-esp32).
+    void end_xfer(Device& d, bool ok, uint8_t err) {
+        stats.transactions++;
+        if (ok) {
+            if (d.fails) {
+                uint32_t outage = millis() - d.failSinceMs;
+                if (outage > stats.worstOutageMs) stats.worstOutageMs = outage;
+            }
+            d.fails = 0;
+        } else {
+            stats.errors++;
+            if (err == 5) stats.timeouts++;
+            if (d.fails == 0) d.failSinceMs = millis();
+            if (d.fails < 0xFF) d.fails++;
+            if (d.fails >= I2C_FAILS_BEFORE_RECOVERY) {
+                recoverBus();
+                uint8_t  k     = (uint8_t)(d.fails - I2C_FAILS_BEFORE_RECOVERY);
+                uint32_t retry = (k < 8) ? (I2C_DOWN_RETRY_MIN_MS << k) : I2C_DOWN_RETRY_MS;
+                if (retry > I2C_DOWN_RETRY_MS) retry = I2C_DOWN_RETRY_MS;
+                d.nextTryMs = millis() + retry;
+            }
+        }
+        uint32_t us = micros() - xferStartUs;
+        if (us > stats.worstXferUs) stats.worstXferUs = us;
+    }
+
+    // Libera un esclavo que se quedó a mitad de byte sujetando SDA: pulsos de
+    // SCL hasta que suelte (máx. 9), STOP y Wire de nuevo. Con el mutex tomado.
+    void recoverBus() {
+        stats.recoveries++;
+        Wire.end();
+
+        pinMode(sdaPin, INPUT_PULLUP);
+        pinMode(sclPin, OUTPUT_OPEN_DRAIN);
+        digitalWrite(sclPin, HIGH);
+        delayMicroseconds(5);
+        for (uint8_t i = 0; i < 9 && digitalRead(sdaPin) == LOW; ++i) {
+            digitalWrite(sclPin, LOW);
+            delayMicroseconds(5);
+            digitalWrite(sclPin, HIGH);
+            delayMicroseconds(5);
+        }
+
+        // STOP: SDA sube con SCL alto.
+        pinMode(sdaPin, OUTPUT_OPEN_DRAIN);
+        digitalWrite(sclPin, LOW);
+        digitalWrite(sdaPin, LOW);
+        delayMicroseconds(5);
+        digitalWrite(sclPin, HIGH);
+        delayMicroseconds(5);
+        digitalWrite(sdaPin, HIGH);
+        delayMicroseconds(5);
+        pinMode(sdaPin, INPUT_PULLUP);
+        if (digitalRead(sdaPin) == LOW) stats.recoveryFails++;
+
+        Wire.begin(sdaPin, sclPin);
+        Wire.setClock(currentHz);
+        Wire.setTimeOut((uint16_t)timeoutMs);
+
+        for (uint8_t i = 0; i < deviceCount; ++i) {
+            if (devices[i].onRecovered) devices[i].onRecovered(devices[i].hookUser);
+        }
+        Serial.printf("[I2C] bus recuperado (%lu)\n", (unsigned long)stats.recoveries);
+    }
+
+    // Dirección de registro + repeated start + lectura.
+    bool doRead(Device& d, uint8_t reg, uint8_t* buf, uint32_t len) {
+        if (!begin_xfer(d, len + 1u)) return false;
+        Wire.beginTransmission(d.addr);
+        Wire.write(reg);
+        uint8_t err = Wire.endTransmission(false);   // false = sin STOP
+        bool ok = (err == 0);
+        uint32_t i = 0;
+        if (ok) {
+            Wire.requestFrom(d.addr, (uint8_t)len);
+            while (Wire.available() && i < len) buf[i++] = (uint8_t)Wire.read();
+            ok = (i == len);
+        }
+        end_xfer(d, ok, err);
+        return ok;
+    }
+
+    bool doWrite(Device& d, uint8_t reg, const uint8_t* buf, uint32_t len) {
+        if (!begin_xfer(d, len + 1u)) return false;
+        Wire.beginTransmission(d.addr);
+        Wire.write(reg);
+        for (uint32_t i = 0; i < len; ++i) Wire.write(buf[i]);
+        uint8_t err = Wire.endTransmission();
+        bool ok = (err == 0);
+        end_xfer(d, ok, err);
+        return ok;
+    }
+
+    uint8_t takeQueue(Pending* out) {
+        portENTER_CRITICAL(&queueMux);
+        uint8_t n = queued;
+        for (uint8_t i = 0; i < n; ++i) out[i] = queue[i];
+        queued = 0;
+        portEXIT_CRITICAL(&queueMux);
+        return n;
+    }
+
+    void requeueFront(const Pending* items, uint8_t n) {
+        portENTER_CRITICAL(&queueMux);
+        uint8_t keep = queued;
+        if (keep + n > I2C_BUS_QUEUE_LEN) keep = (uint8_t)(I2C_BUS_QUEUE_LEN - n);
+        for (int i = keep - 1; i >= 0; --i) queue[i + n] = queue[i];
+        for (uint8_t i = 0; i < n; ++i) queue[i] = items[i];
+        stats.dropped += (uint32_t)(queued - keep);
+        queued = (uint8_t)(keep + n);
+        portEXIT_CRITICAL(&queueMux);
+    }
+
+    void noteQueueLatency(uint32_t us) {
+        if (us > stats.queueMaxUs) stats.queueMaxUs = us;
+        stats.queueAvgUs = (stats.queueAvgUs == 0.0f) ? (float)us
+                         : stats.queueAvgUs + 0.125f * ((float)us - stats.queueAvgUs);
+    }
+
+    Device            devices[I2C_BUS_MAX_DEVICES];
+    uint8_t           deviceCount = 0;
+    SemaphoreHandle_t mutex       = nullptr;
+    bool              started     = false;
+    uint32_t          currentHz   = I2C_BUS_DEFAULT_HZ;
+    uint32_t          timeoutMs   = 0;
+    uint32_t          xferStartUs = 0;
+    int               sdaPin      = PIN_I2C_SDA;
+    int               sclPin      = PIN_I2C_SCL;
+    volatile uint8_t  sensorWaiting = 0;
+
+    Pending           queue[I2C_BUS_QUEUE_LEN];
+    volatile uint8_t  queued      = 0;
+    portMUX_TYPE      queueMux    = portMUX_INITIALIZER_UNLOCKED;
+
+    Stats             stats;
+};
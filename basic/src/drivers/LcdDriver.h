@@ -1,13 +1,24 @@
 #pragma once
 #include <Arduino.h>
 #include <U8g2lib.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 #include "include/config_pins.h"
+#include "drivers/PmLock.h"
 
 // Wrapper del LCD ST7567A usando u8g2.
+//
+// El panel se usa desde dos tareas: la UI pinta (beginRender/endRender) y
+// las alertas, desde la tarea del sensor, invierten el panel. Con SPI por
+// software dos envíos a la vez se corrompen, así que todo acceso a u8g2 va
+// bajo busMutex. setInverse() no espera: si hay un frame en curso, la
+// inversión se envía al cerrarlo (el backlight, por PWM, sí es inmediato).
 class LcdDriver {
 public:
     bool begin() {
+        if (!busMutex) busMutex = xSemaphoreCreateRecursiveMutex();
+
         // Inicializar u8g2
         u8g2.begin();
         u8g2.enableUTF8Print();
@@ -19,6 +30,8 @@ public:
         u8g2.clearBuffer();
         u8g2.sendBuffer();
 
+        renderLock.begin(PmLock::Kind::CPU_MAX, "lcd");
+
         // Configurar backlight por PWM usando la API nueva ledcAttach(pin, freq, resolution)
         pinMode(PIN_LCD_LED, OUTPUT);
         // 5 kHz, resolución 8 bits
@@ -44,34 +57,75 @@ public:
     void setPowerSave(bool enable) {
         if (enable == powerSave) return;
         powerSave = enable;
+        lockBus(portMAX_DELAY);
         u8g2.setPowerSave(enable ? 1 : 0);
+        unlockBus();
     }
 
     bool isPowerSave() const { return powerSave; }
 
     // Aplica rotación 0° (false) o 180° (true)
     void setRotation(bool inverted) {
+        lockBus(portMAX_DELAY);   // también la llama BleManager
         rotationInverted = inverted;
         u8g2.setDisplayRotation(rotationInverted ? U8G2_R2 : U8G2_R0);
+        unlockBus();
     }
 
     bool isRotationInverted() const {
         return rotationInverted;
     }
 
+    // Inversión de píxeles por hardware (ST7567: 0xA7 inverso, 0xA6 normal).
+    // No toca el framebuffer, así que no espera a un repintado; como mucho,
+    // al final del frame que se esté enviando.
+    void setInverse(bool on) {
+        if (on == inverse) return;
+        inverse = on;
+        if (lockBus(0)) {
+            syncInverse();
+            unlockBus();
+        }
+    }
+
+    bool isInverse() const { return inverse; }
+
+    // Lo que el panel muestra de verdad: cuántas veces se ha enviado la
+    // inversión y cuándo (micros()) salió la última. Con un frame en curso,
+    // setInverse() vuelve sin enviar y el envío sale en endRender().
+    bool     isInverseSent()      const { return sentInverse; }
+    uint32_t getInverseSendCount()const { return inverseSends; }
+    uint32_t getInverseSentUs()   const { return inverseSentUs; }
+
+    // Candado "render": el SPI es por software, así que el envío del frame
+    // va a la frecuencia máxima y se acaba antes. Envolver el pintado.
+    void beginRender() {
+        renderLock.acquire();
+        lockBus(portMAX_DELAY);
+    }
+    void endRender() {
+        syncInverse();   // inversión pedida durante el frame
+        unlockBus();
+        renderLock.release();
+    }
+
     // Acceso al objeto u8g2 para que UiRenderer dibuje
     U8G2& getU8g2() {
         return u8g2;
     }
 
     void prepareForDeepSleep() {
-        // Apagar backlight
+        // Apagar backlight y dejar el panel sin invertir
         setBacklight(0);
+        lockBus(portMAX_DELAY);
+        inverse = false;
+        syncInverse();
 
         // Poner el display en power save y limpiar cualquier contenido
         setPowerSave(true);
         u8g2.clearBuffer();
         u8g2.sendBuffer();
+        unlockBus();
     }
 
 private:
@@ -85,7 +139,30 @@ private:
         PIN_LCD_RST    // reset
     };
 
+    bool lockBus(TickType_t wait) {
+        return !busMutex || xSemaphoreTakeRecursive(busMutex, wait) == pdTRUE;
+    }
+    void unlockBus() {
+        if (busMutex) xSemaphoreGiveRecursive(busMutex);
+    }
+
+    // Con busMutex tomado.
+    void syncInverse() {
+        bool want = inverse;
+        if (want == sentInverse) return;
+        u8g2.sendF("c", want ? 0xA7 : 0xA6);
+        sentInverse   = want;
+        inverseSentUs = micros();
+        inverseSends  = inverseSends + 1;   // tras la marca: quien lee la cuenta ve la hora ya puesta
+    }
+
+    PmLock  renderLock;
+    SemaphoreHandle_t busMutex = nullptr;
     uint8_t backlightLevel = 0;
     bool    rotationInverted = false;
     bool    powerSave = false;
+    volatile bool inverse = false;   // pedido (tarea del sensor)
+    volatile bool     sentInverse   = false;   // enviado al panel (bajo busMutex)
+    volatile uint32_t inverseSentUs = 0;
+    volatile uint32_t inverseSends  = 0;
 };
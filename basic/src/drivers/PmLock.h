@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+#include "include/config_power.h"
+
+#if POWER_PM_AUTO_LIGHT_SLEEP && defined(CONFIG_PM_ENABLE)
+#include "esp_pm.h"
+#define PM_LOCKS_ACTIVE 1
+#else
+#define PM_LOCKS_ACTIVE 0
+#endif
+
+// Candado de esp_pm para un subsistema (ver PowerHw::beginPm).
+//
+// Con gestión automática de energía la CPU corre a la frecuencia mínima y
+// entra en light sleep en cuanto todas las tareas se bloquean. Un
+// subsistema toma su candado sólo mientras trabaja:
+// - CPU_MAX:  sube a la frecuencia máxima (render por SPI software, BLE).
+// - APB_MAX:  APB a 80 MHz y sin light sleep (lecturas I2C del sensor).
+// - NO_SLEEP: frecuencia libre pero sin light sleep (escrituras a flash).
+// Los candados cuentan: acquire/release anidados desde varias tareas están
+// bien. Sin POWER_PM_AUTO_LIGHT_SLEEP todo es no-op.
+class PmLock {
+public:
+    enum class Kind : uint8_t { CPU_MAX, APB_MAX, NO_SLEEP };
+
+    void begin(Kind kind, const char* name) {
+    #if PM_LOCKS_ACTIVE
+        if (handle) return;
+        esp_pm_lock_type_t t = (kind == Kind::CPU_MAX) ? ESP_PM_CPU_FREQ_MAX
+                             : (kind == Kind::APB_MAX) ? ESP_PM_APB_FREQ_MAX
+                             : ESP_PM_NO_LIGHT_SLEEP;
+        if (esp_pm_lock_create(t, 0, name, &handle) != ESP_OK) {
+            handle = nullptr;
+            Serial.printf("[PM] no se pudo crear el candado %s\n", name);
+        }
+    #else
+        (void)kind; (void)name;
+    #endif
+    }
+
+    void acquire() {
+    #if PM_LOCKS_ACTIVE
+        if (handle) esp_pm_lock_acquire(handle);
+    #endif
+    }
+
+    void release() {
+    #if PM_LOCKS_ACTIVE
+        if (handle) esp_pm_lock_release(handle);
+    #endif
+    }
+
+private:
+#if PM_LOCKS_ACTIVE
+    esp_pm_lock_handle_t handle = nullptr;
+#endif
+};
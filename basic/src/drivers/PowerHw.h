@@ -8,6 +8,7 @@
 #include "include/config_power.h"
 #include "include/config_pins.h"
 #include "core/SleepPolicyService.h"
+#include "drivers/PmLock.h"
 
 // Aplica SleepDecision al hardware (CPU freq, light sleep, deep sleep).
 class PowerHw {
@@ -16,6 +17,51 @@ public:
         // Nada especial por ahora.
     }
 
+    // Gestión automática de energía (POWER_PM_AUTO_LIGHT_SLEEP): DFS con
+    // minFreqMHz como suelo y light sleep en la tarea idle. Devuelve false
+    // si no está disponible; entonces se siguen usando las ventanas fijas.
+    bool beginPm(uint32_t minFreqMHz) {
+    #if PM_LOCKS_ACTIVE
+        s_pmLightSleep = true;
+        if (!configurePm(minFreqMHz)) {
+            // Sin tickless idle en el sdkconfig: al menos DFS.
+            s_pmLightSleep = false;
+            if (!configurePm(minFreqMHz)) return false;
+        }
+        // Botones (nivel) como fuente de wake; ver ButtonsDriver::enableSleepWake.
+        esp_sleep_enable_gpio_wakeup();
+        s_pmActive = true;
+        Serial.printf("[PM] auto: %lu-%lu MHz, light sleep %s\n",
+                      (unsigned long)minFreqMHz, (unsigned long)POWER_PM_MAX_FREQ_MHZ,
+                      s_pmLightSleep ? "si" : "no (solo DFS)");
+        return true;
+    #else
+        (void)minFreqMHz;
+        return false;
+    #endif
+    }
+
+    bool isPmActive() const { return s_pmActive; }
+
+    // Se llama justo antes de esp_deep_sleep_start() para añadir fuentes de
+    // wake (p.ej. el timer de PressureWakeService).
+    typedef void (*DeepSleepHook)(void* user);
+    void setDeepSleepHook(DeepSleepHook fn, void* user) {
+        s_deepSleepHook     = fn;
+        s_deepSleepHookUser = user;
+    }
+
+    // Vuelve a deep sleep tras una comprobación de arranque. Sólo vuelve
+    // si se cancela (botón pulsado).
+    void resumeDeepSleep() {
+        // Los pines siguen en modo RTC desde el sueño anterior: pasarlos a
+        // GPIO para que la comprobación de botones lea el nivel real.
+        pinMode(PIN_BTN_UP,   INPUT_PULLDOWN);
+        pinMode(PIN_BTN_MID,  INPUT_PULLDOWN);
+        pinMode(PIN_BTN_DOWN, INPUT_PULLDOWN);
+        enterDeepSleep();
+    }
+
     bool consumeLightSleepWake() {
         if (s_wokeFromLightSleep) {
             s_wokeFromLightSleep = false;
@@ -24,7 +70,17 @@ public:
         return false;
     }
 
-    void apply(const SleepDecision& d) {
+    // idleMs: tiempo que la tarea que llama (la UI) puede esperar. Con gestión
+    // automática se bloquea ese tiempo (o la ventana de light sleep de la
+    // política, si es mayor) y la CPU duerme sola; sin ella se ignora.
+    // Sin gestión automática, quien llama debe haber pausado SensorTask si
+    // la decisión incluye light o deep sleep.
+    void apply(const SleepDecision& d, uint32_t idleMs = 0) {
+        if (s_pmActive) {
+            applyPm(d, idleMs);
+            return;
+        }
+
         // 1) Frecuencia de CPU
         static uint32_t s_lastCpuFreq = 0;
         if (d.cpuFreqMHz > 0 && d.cpuFreqMHz != s_lastCpuFreq) {
@@ -50,6 +106,11 @@ public:
 
 private:
     inline static bool s_wokeFromLightSleep = false;
+    inline static bool     s_pmActive     = false;
+    inline static bool     s_pmLightSleep = false;
+    inline static uint32_t s_pmMinFreq    = 0;
+    inline static DeepSleepHook s_deepSleepHook     = nullptr;
+    inline static void*         s_deepSleepHookUser = nullptr;
 
     // Configura un pin RTC como entrada con PULLDOWN para deep sleep.
     static void configureRtcPulldown(uint8_t pin) {
@@ -98,6 +159,7 @@ private:
             (1ULL << PIN_CHARGER_SENSE);
 
         esp_sleep_enable_ext1_wakeup(mask, ESP_EXT1_WAKEUP_ANY_HIGH);
+        if (s_deepSleepHook) s_deepSleepHook(s_deepSleepHookUser);
 
         Serial.println(F("[POWER] Entrando a deep sleep..."));
         Serial.flush();
@@ -120,11 +182,14 @@ private:
 
         esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
 
-        // Wake por GPIO (dominio digital) como en tu firmware viejo
-        gpio_wakeup_enable((gpio_num_t)PIN_BTN_UP,   GPIO_INTR_HIGH_LEVEL);
-        gpio_wakeup_enable((gpio_num_t)PIN_BTN_MID,  GPIO_INTR_HIGH_LEVEL);
-        gpio_wakeup_enable((gpio_num_t)PIN_BTN_DOWN, GPIO_INTR_HIGH_LEVEL);
-        gpio_wakeup_enable((gpio_num_t)PIN_CHARGER_SENSE, GPIO_INTR_HIGH_LEVEL);
+        // Wake por GPIO (dominio digital) como en tu firmware viejo.
+        // Botones y cargador tienen ISR por flanco (ButtonsDriver,
+        // BatteryMonitor): gpio_wakeup_enable las pasa a nivel, así que se
+        // enmascaran mientras dura el sueño.
+        armLevelWake(PIN_BTN_UP);
+        armLevelWake(PIN_BTN_MID);
+        armLevelWake(PIN_BTN_DOWN);
+        armLevelWake(PIN_CHARGER_SENSE);
         esp_sleep_enable_gpio_wakeup();
 
         // Wake por timer
@@ -133,6 +198,14 @@ private:
         Serial.flush();
         esp_light_sleep_start();
 
+        // Devolver las ISR a flancos. El flanco que despertó se perdió con la
+        // ISR enmascarada: ButtonsDriver::notifyWake() y la relectura
+        // periódica de BatteryMonitor recogen el nivel actual.
+        restoreEdgeIrq(PIN_BTN_UP);
+        restoreEdgeIrq(PIN_BTN_MID);
+        restoreEdgeIrq(PIN_BTN_DOWN);
+        restoreEdgeIrq(PIN_CHARGER_SENSE);
+
         s_wokeFromLightSleep = true;
 
         // DEBUG: quién me despertó
@@ -141,6 +214,73 @@ private:
         Serial.println((int)cause);
     }
 
+    void applyPm(const SleepDecision& d, uint32_t idleMs) {
+        // La frecuencia de la política pasa a ser el suelo de DFS; los
+        // candados CPU_MAX suben al techo sólo mientras trabajan.
+        if (d.cpuFreqMHz > 0 && d.cpuFreqMHz != s_pmMinFreq) {
+            configurePm(d.cpuFreqMHz);
+        }
+
+    #if DEBUG_DISABLE_SLEEP
+        return;
+    #endif
+
+        if (d.enterDeepSleep) {
+            enterDeepSleep();
+        }
+
+        uint32_t waitMs = idleMs;
+        if (d.enterLightSleep && d.lightSleepMaxMs > waitMs) {
+            waitMs = d.lightSleepMaxMs;
+        }
+        if (waitMs == 0) return;
+
+        // Bloquear la tarea de UI: la tarea idle entra en light sleep si ningún
+        // candado lo impide. Un botón (ISR) corta la espera.
+        uint32_t t0 = millis();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+        if (millis() - t0 >= POWER_PM_LONG_WAIT_MS) {
+            s_wokeFromLightSleep = true;
+        }
+    }
+
+    static bool configurePm(uint32_t minMHz) {
+    #if PM_LOCKS_ACTIVE
+        uint32_t maxMHz = (POWER_PM_MAX_FREQ_MHZ > minMHz) ? POWER_PM_MAX_FREQ_MHZ : minMHz;
+    #if ESP_IDF_VERSION_MAJOR >= 5
+        esp_pm_config_t cfg = {};
+    #else
+        esp_pm_config_esp32s3_t cfg = {};
+    #endif
+        cfg.max_freq_mhz       = (int)maxMHz;
+        cfg.min_freq_mhz       = (int)minMHz;
+        cfg.light_sleep_enable = s_pmLightSleep;
+        esp_err_t err = esp_pm_configure(&cfg);
+        if (err != ESP_OK) {
+            Serial.printf("[PM] esp_pm_configure(%lu-%lu MHz, ls=%d): %s\n",
+                          (unsigned long)minMHz, (unsigned long)maxMHz,
+                          (int)s_pmLightSleep, esp_err_to_name(err));
+            return false;
+        }
+        s_pmMinFreq = minMHz;
+        return true;
+    #else
+        (void)minMHz;
+        return false;
+    #endif
+    }
+
+    static void armLevelWake(uint8_t pin) {
+        gpio_intr_disable((gpio_num_t)pin);
+        gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_HIGH_LEVEL);
+    }
+
+    static void restoreEdgeIrq(uint8_t pin) {
+        gpio_wakeup_disable((gpio_num_t)pin);
+        gpio_set_intr_type((gpio_num_t)pin, GPIO_INTR_ANYEDGE);
+        gpio_intr_enable((gpio_num_t)pin);
+    }
+
 #if POWER_LIGHT_SLEEP_PD_ENABLE
     static void configureLightSleepPowerDomains() {
         // Configuracion minima segura: mantener RTC periph para wake, apagar dominios RTC no usados.
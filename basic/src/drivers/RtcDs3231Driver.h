@@ -1,79 +1,191 @@
 // src/drivers/RtcDs3231Driver.h
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
-#include "include/config_pins.h"
+#include "drivers/I2cBus.h"
 #include "util/Types.h"
+#include "util/CivilTime.h"
+
+// Hora servida desde caché, sin tráfico I2C por consulta.
+//
+// El DS3231 se lee en begin() (arranque y salida de deep sleep) y cuando se
+// pide con requestResync() (salida de light sleep, donde millis() corre con
+// el oscilador RC y puede derivar). Entre lecturas:
+// - Con RTC_SQW_PIN cableado: la salida SQW del DS3231 a 1 Hz hace de tick;
+//   cada flanco de bajada suma un segundo.
+// - Sin SQW (placa actual): se extrapola con millis() y se resincroniza cada
+//   RTC_RESYNC_MS. La resincronización conserva la fase de sub-segundo si la
+//   extrapolación ya coincidía con el RTC.
+// Las resincronizaciones van por la cola asíncrona de I2cBus.
+#ifndef RTC_RESYNC_MS
+#define RTC_RESYNC_MS  600000u     // 10 min: ~6 ms de deriva con cristal de 10 ppm
+#endif
+#ifndef RTC_SQW_PIN
+#define RTC_SQW_PIN    -1          // GPIO conectado a INT/SQW del DS3231 (-1 = no)
+#endif
 
 class RtcDs3231Driver {
 public:
     static constexpr uint8_t DS3231_ADDR = 0x68;
 
-    void begin() {
-        // Usa el mismo bus I2C (pines personalizados) que el BMP390
-        Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
+    void begin(I2cBus* i2c) {
+        // Mismo bus I2C (pines personalizados) que el BMP390. El DS3231
+        // admite hasta 400 kHz: usa el reloj que tenga el bus sin cambiarlo.
+        bus = i2c;
+        if (!bus || !bus->begin()) return;
+        busId = bus->addDevice(DS3231_ADDR, 100000, 10000, 400000,
+                               I2cBus::Priority::BACKGROUND);
 
         // Validación simple: si no responde, sólo avisamos por serial
-        Wire.beginTransmission(DS3231_ADDR);
-        if (Wire.endTransmission() != 0) {
+        if (!bus->probe(busId)) {
             Serial.println(F("[RTC] DS3231 no respondió en I2C"));
+            return;
         }
-    }
 
-    UtcDateTime nowUtc() {
-        UtcDateTime dt{2025,1,1,0,0,0};
+        // Primera hora síncrona para no arrancar con la de defecto
+        uint8_t raw[7];
+        if (bus->readReg(busId, 0x00, raw, sizeof(raw))) {
+            applySync(rawToEpoch(raw), millis());
+        }
 
-        Wire.beginTransmission(DS3231_ADDR);
-        Wire.write(0x00); // registro de segundos
-        Wire.endTransmission(false);
+    #if RTC_SQW_PIN >= 0
+        // Control (0x0E): INTCN=0 -> SQW; RS2:RS1=00 -> 1 Hz.
+        uint8_t ctrl = 0;
+        if (bus->readReg(busId, 0x0E, &ctrl, 1)) {
+            ctrl &= (uint8_t)~(0x04 | 0x18);
+            if (bus->writeReg(busId, 0x0E, &ctrl, 1)) {
+                pinMode(RTC_SQW_PIN, INPUT_PULLUP);     // SQW es drenador abierto
+                attachInterruptArg(RTC_SQW_PIN, onSqwEdge, this, FALLING);
+                sqwActive = true;
+            }
+        }
+    #endif
+    }
 
-        Wire.requestFrom(DS3231_ADDR, (uint8_t)7);
-        if (Wire.available() < 7) {
-            return dt; // devuelve algo por defecto si falla
+    // Segundos desde 1970 (UTC). No toca el bus; como mucho encola una
+    // resincronización.
+    uint32_t nowEpoch() {
+        uint32_t now = millis();
+        portENTER_CRITICAL(&cacheMux);
+        bool     sqwLive = sqwActive && (now - sqwEdgeMs) < 3000u;
+        uint32_t epoch   = (sqwLive && sqwSynced) ? sqwEpoch
+                         : baseEpoch + (now - baseMs) / 1000u;
+        bool     due     = resyncPending || (now - lastSyncMs) >= RTC_RESYNC_MS;
+        // Con SQW, leer justo después de un flanco para alinear el contador.
+        bool     aligned = !sqwLive || (now - sqwEdgeMs) < 500u;
+        portEXIT_CRITICAL(&cacheMux);
+
+        if (due && aligned && bus) {
+            bus->submitRead(busId, 0x00, 7, onRead, this);  // registro de segundos
         }
+        return epoch;
+    }
 
-        uint8_t sec  = Wire.read();
-        uint8_t min  = Wire.read();
-        uint8_t hour = Wire.read();
-        uint8_t dayOfWeek = Wire.read(); (void)dayOfWeek;
-        uint8_t day  = Wire.read();
-        uint8_t month= Wire.read();
-        uint8_t year = Wire.read();
-
-        dt.second = bcdToDec(sec & 0x7F);
-        dt.minute = bcdToDec(min & 0x7F);
-        dt.hour   = bcdToDec(hour & 0x3F);
-        dt.day    = bcdToDec(day & 0x3F);
-        dt.month  = bcdToDec(month & 0x1F);
-        dt.year   = 2000 + bcdToDec(year);
-
-        return dt;
+    UtcDateTime nowUtc() {
+        return CivilTime::epochToUtc(nowEpoch());
     }
 
-    void setUtc(const UtcDateTime& dt) {
-        Wire.beginTransmission(DS3231_ADDR);
-        Wire.write(0x00); // empezamos en registro de segundos
+    // Pide releer el DS3231 en cuanto se pueda (p.ej. al salir de light sleep).
+    void requestResync() { resyncPending = true; }
 
-        Wire.write(decToBcd(dt.second));
-        Wire.write(decToBcd(dt.minute));
-        Wire.write(decToBcd(dt.hour)); // 24h
+    void setUtc(const UtcDateTime& dt) {
+        if (!bus) return;
+        uint8_t raw[7];
+        raw[0] = decToBcd(dt.second);
+        raw[1] = decToBcd(dt.minute);
+        raw[2] = decToBcd(dt.hour); // 24h
 
         // DOW lo dejamos en 1 (no lo usas)
-        Wire.write(0x01);
+        raw[3] = 0x01;
+
+        raw[4] = decToBcd(dt.day);
+        raw[5] = decToBcd(dt.month);
+        raw[6] = decToBcd((uint8_t)(dt.year - 2000));
+
+        // empezamos en registro de segundos. Escribir los segundos reinicia
+        // la cuenta del DS3231: la fase de millis() arranca aquí.
+        if (bus->writeReg(busId, 0x00, raw, sizeof(raw))) {
+            uint32_t now   = millis();
+            uint32_t epoch = CivilTime::utcToEpoch(dt);
+            portENTER_CRITICAL(&cacheMux);
+            baseEpoch  = epoch;
+            baseMs     = now;
+            sqwEpoch   = epoch;
+            lastSyncMs = now;
+            portEXIT_CRITICAL(&cacheMux);
+        }
+    }
+
+private:
+    static void onRead(void* user, bool ok, const uint8_t* data, uint8_t len) {
+        if (!ok || len < 7) return;
+        RtcDs3231Driver* self = static_cast<RtcDs3231Driver*>(user);
+        self->applySync(rawToEpoch(data), millis());
+    }
 
-        Wire.write(decToBcd(dt.day));
-        Wire.write(decToBcd(dt.month));
-        Wire.write(decToBcd((uint8_t)(dt.year - 2000)));
+    static void IRAM_ATTR onSqwEdge(void* user) {
+        RtcDs3231Driver* self = static_cast<RtcDs3231Driver*>(user);
+        portENTER_CRITICAL_ISR(&self->cacheMux);
+        self->sqwEpoch++;
+        self->sqwEdgeMs = millis();
+        portEXIT_CRITICAL_ISR(&self->cacheMux);
+    }
 
-        Wire.endTransmission();
+    void applySync(uint32_t rtcEpoch, uint32_t now) {
+        if (rtcEpoch == 0) return;
+        portENTER_CRITICAL(&cacheMux);
+        // millis(): si la extrapolación ya daba ese segundo, sólo se adelanta la
+        // base (mantiene la fase y evita el desborde de millis a 49 días).
+        uint32_t elapsedS  = (now - baseMs) / 1000u;
+        if (baseEpoch != 0 && baseEpoch + elapsedS == rtcEpoch) {
+            baseEpoch += elapsedS;
+            baseMs    += elapsedS * 1000u;
+        } else {
+            baseEpoch = rtcEpoch;
+            baseMs    = now;
+        }
+        // SQW: la lectura es posterior al último flanco, el contador se alinea.
+        if (sqwActive && (now - sqwEdgeMs) < 500u) {
+            sqwEpoch  = rtcEpoch;
+            sqwSynced = true;
+        }
+        lastSyncMs    = now;
+        resyncPending = false;
+        portEXIT_CRITICAL(&cacheMux);
     }
 
-private:
-    uint8_t bcdToDec(uint8_t val) {
+    static uint32_t rawToEpoch(const uint8_t* raw) {
+        UtcDateTime dt;
+        dt.second = bcdToDec(raw[0] & 0x7F);
+        dt.minute = bcdToDec(raw[1] & 0x7F);
+        dt.hour   = bcdToDec(raw[2] & 0x3F);
+        // raw[3]: día de la semana, no se usa
+        dt.day    = bcdToDec(raw[4] & 0x3F);
+        dt.month  = bcdToDec(raw[5] & 0x1F);
+        dt.year   = 2000 + bcdToDec(raw[6]);
+        return CivilTime::utcToEpoch(dt);
+    }
+
+    static uint8_t bcdToDec(uint8_t val) {
         return (val / 16 * 10) + (val % 16);
     }
 
-    uint8_t decToBcd(uint8_t val) {
+    static uint8_t decToBcd(uint8_t val) {
         return ((val / 10) * 16) + (val % 10);
     }
+
+    static constexpr uint32_t DEFAULT_EPOCH = 1735689600u;   // 2025-01-01, si nunca se leyó
+
+    I2cBus*           bus           = nullptr;
+    I2cBus::DeviceId  busId         = I2cBus::NO_DEVICE;
+    uint32_t          baseEpoch     = DEFAULT_EPOCH;
+    uint32_t          baseMs        = 0;
+    uint32_t          lastSyncMs    = 0;
+    volatile bool     resyncPending = false;
+
+    bool              sqwActive     = false;
+    bool              sqwSynced     = false;
+    volatile uint32_t sqwEpoch      = 0;
+    volatile uint32_t sqwEdgeMs     = 0;
+
+    portMUX_TYPE      cacheMux      = portMUX_INITIALIZER_UNLOCKED;
 };
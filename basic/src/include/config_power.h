@@ -12,6 +12,21 @@
 #ifndef POWER_LIGHT_SLEEP_PD_ENABLE
 #define POWER_LIGHT_SLEEP_PD_ENABLE 1
 #endif
+
+// Gestión automática (esp_pm): DFS + light sleep en la tarea idle, con
+// candados por subsistema (drivers/PmLock.h) en vez de ventanas fijas de
+// light sleep. Requiere CONFIG_PM_ENABLE; sin CONFIG_FREERTOS_USE_TICKLESS_IDLE
+// queda sólo DFS. Ojo: el UART de depuración puede cambiar de baudios al
+// bajar el APB.
+#ifndef POWER_PM_AUTO_LIGHT_SLEEP
+#define POWER_PM_AUTO_LIGHT_SLEEP 0
+#endif
+#ifndef POWER_PM_MAX_FREQ_MHZ
+#define POWER_PM_MAX_FREQ_MHZ 160     // techo con candado CPU_MAX
+#endif
+#ifndef POWER_PM_LONG_WAIT_MS
+#define POWER_PM_LONG_WAIT_MS 10000   // esperas más largas cuentan como "wake de sleep"
+#endif
 // Default power management settings and thresholds.  These values are
 // used by SleepPolicyService to decide when to change CPU frequency,
 // enter light sleep, or enter deep sleep.  Adjust these to balance
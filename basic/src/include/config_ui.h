@@ -35,3 +35,31 @@ constexpr uint8_t UI_MENU_ITEM_COUNT = 14;
 // Iconos configurables (flechas, hora, temperatura, unidad, borde, saltos) + opción de volver.
 constexpr uint8_t UI_HUD_ICON_COUNT = 6;
 constexpr uint8_t UI_HUD_MENU_COUNT = UI_HUD_ICON_COUNT + 1; // incluye "Volver"
+
+// Compensación de latencia de pantalla (ui/DisplayPredictor.h), por fase.
+// Activa: muestra la altitud predicha al instante en que los píxeles cambian.
+// Extra: adelanto adicional fijo (tiempo de respuesta del cristal LCD).
+constexpr bool     UI_PRED_ENABLE_CLIMB    = false;
+constexpr bool     UI_PRED_ENABLE_FREEFALL = true;
+constexpr bool     UI_PRED_ENABLE_CANOPY   = true;
+constexpr uint16_t UI_PRED_EXTRA_MS_CLIMB    = 0;
+constexpr uint16_t UI_PRED_EXTRA_MS_FREEFALL = 60;
+constexpr uint16_t UI_PRED_EXTRA_MS_CANOPY   = 60;
+constexpr uint16_t UI_PRED_MAX_LEAD_MS       = 600;  // tope de seguridad del adelanto
+
+// Tarea de UI (main.cpp). Reparto de tareas y plazos en core/SensorTask.h.
+#ifndef UI_TASK_STACK
+#define UI_TASK_STACK        8192   // igual que el loopTask de Arduino (BLE, printf)
+#endif
+#ifndef UI_TASK_PRIORITY
+#define UI_TASK_PRIORITY     2
+#endif
+#ifndef UI_TASK_CORE
+#define UI_TASK_CORE         0
+#endif
+#ifndef UI_TASK_FRAME_MS
+#define UI_TASK_FRAME_MS     40     // frame mínimo; en MAIN, no más rápido que el sensor
+#endif
+#ifndef UI_TASK_DEADLINE_MS
+#define UI_TASK_DEADLINE_MS  100    // botón -> frame pintado
+#endif
@@ -1,5 +1,4 @@
 #include <Arduino.h>
-#include <LittleFS.h>
 
 #include "include/config_pins.h"
 #include "include/config_power.h"
@@ -7,13 +6,23 @@
 
 #include "core/AppContext.h"
 #include "util/DebugConsole.h"
+#include "util/BootTimeline.h"
 
 #include "ui/UiInputController.h"
 #include "core/LogbookService.h"
+#include "core/StorageService.h"
 #include "core/JumpRecorder.h"
+#include "core/TraceStore.h"
+#include "core/FlightTraceRecorder.h"
+#include "core/AltitudeAlertService.h"
+#include "core/SensorGovernor.h"
+#include "util/PreTriggerBuffer.h"
 #include "ui/LogbookUi.h"
 #include "game/DoomMiniGame.h"
 #include "core/BleManager.h"
+#include "core/PressureWakeService.h"
+#include "core/SensorTask.h"
+#include "core/WarmStartService.h"
 
 // Instancias globales de servicios y drivers.
 SettingsService    gSettingsService;
@@ -22,8 +31,21 @@ FlightPhaseService gFlightPhaseService;
 SleepPolicyService gSleepPolicyService;
 UiStateService     gUiStateService;
 JumpRecorder       gJumpRecorder;
+FlightTraceRecorder gTraceRecorder;
+PreTriggerBuffer   gPreTrigger;
+AltitudeAlertService gAlerts;
+SensorGovernor     gSensorGov;
 BleManager         gBle;
-
+PressureWakeService gPressWake;
+SensorTask         gSensorTask;
+TaskHandle_t       gUiTask = nullptr;
+RTC_DATA_ATTR pwm_state_t gPressWakeRtc;   // sobrevive al deep sleep
+WarmStartService   gWarmStart;
+BootTimeline       gBoot;
+// Bytes crudos: un objeto con constructor se reescribiría en cada arranque.
+RTC_DATA_ATTR alignas(8) uint8_t gWarmRtc[sizeof(WarmStartImage)];
+
+I2cBus             gI2cBus;
 Bmp390Driver       gBmpDriver;
 RtcDs3231Driver    gRtcDriver;
 LcdDriver          gLcdDriver;
@@ -32,7 +54,9 @@ BatteryMonitor     gBatteryMonitor;
 PowerHw            gPowerHw;
 UiRenderer         gUiRenderer(&gLcdDriver, &gBatteryMonitor);
 LogbookService     gLogbook;
-LogbookUi          gLogbookUi(&gLogbook, &gLcdDriver);
+TraceStore         gTraceStore;
+StorageService     gStorage;
+LogbookUi          gLogbookUi(&gStorage, &gLcdDriver);
 DoomMiniGame       gGame;
 
 AppContext         gAppCtx;
@@ -40,11 +64,10 @@ Settings           gSettings;
 UiInputController  gUiInputController(gUiStateService,
                                       gSettings,
                                       gSettingsService,
-                                      gAltimetryService,
+                                      gSensorTask,
                                       gLcdDriver,
                                       gLogbookUi,
                                       gRtcDriver,
-                                      gFlightPhaseService,
                                       &gBle);
 
 // Configura AppContext para apuntar a las instancias globales.
@@ -54,7 +77,10 @@ void setupContext() {
     gAppCtx.flight     = &gFlightPhaseService;
     gAppCtx.sleep      = &gSleepPolicyService;
     gAppCtx.uiState    = &gUiStateService;
+    gAppCtx.sensor     = &gSensorTask;
+    gAppCtx.alerts     = &gAlerts;
 
+    gAppCtx.i2c        = &gI2cBus;
     gAppCtx.bmp        = &gBmpDriver;
     gAppCtx.rtc        = &gRtcDriver;
     gAppCtx.lcd        = &gLcdDriver;
@@ -62,36 +88,70 @@ void setupContext() {
     gAppCtx.battery    = &gBatteryMonitor;
     gAppCtx.power      = &gPowerHw;
     gAppCtx.uiRenderer = &gUiRenderer;
+    gAppCtx.boot       = &gBoot;
 }
 
+static bool uiStep();
+static void lazyInit(uint32_t nowMs);
+static void uiWait(uint32_t frameStartMs);
+static void uiTaskEntry(void*);
+
 void setup() {
+    // Cada paso deja su marca (util/BootTimeline.h); tecla 'b' la vuelca.
+    gBoot.mark("setup");
     Serial.begin(115200);
-    delay(500);
-    Serial.println("\nAlti Andes boot...");
+    gBoot.mark("serial");
 
-    // Montar LittleFS (bitácora, etc.) en la partición "spiffs".
-    // Importante: no auto-formatear en fallo de mount para no perder bitácora.
-    if (!LittleFS.begin(false, "/littlefs", 5, "spiffs")) {
-        Serial.println("LittleFS mount failed");
+    // Tras deep sleep: estado guardado en RTC (core/WarmStartService.h).
+    bool warm = gWarmStart.begin(reinterpret_cast<WarmStartImage*>(gWarmRtc));
+    const WarmStartImage& wimg = gWarmStart.image();
+    gBoot.setWarm(warm);
+    gBoot.mark("warm start");
+
+    // Bus I2C compartido (BMP390 + DS3231): un único Wire.begin()
+    if (!gI2cBus.begin()) {
+        Serial.println("I2C bus init failed");
+    }
+    gBoot.mark("i2c");
+
+    if (!gBmpDriver.begin(&gI2cBus, warm ? &wimg.bmp : nullptr)) {
+        Serial.println("BMP390 init failed");
+    }
+    gBoot.mark("bmp390");
+
+    // Wake por timer desde deep sleep: sólo mirar la presión y, si no hay
+    // subida, volver a dormir sin iniciar nada más.
+    gPressWake.begin(&gPressWakeRtc);
+    gPowerHw.setDeepSleepHook(PressureWakeService::onDeepSleep, &gPressWake);
+    if (gPressWake.isCheckWake() && !gPressWake.evaluate(gBmpDriver)) {
+        gPowerHw.resumeDeepSleep();
+        // Sólo vuelve si un botón está pulsado: arranque normal.
     }
+    gBoot.mark("press wake");
 
-    // Settings en NVS
+#if BOOT_SERIAL_WAIT_MS > 0
+    if (!warm) {
+        delay(BOOT_SERIAL_WAIT_MS);
+    }
+#endif
+    Serial.println(warm ? "\nAlti Andes boot (caliente)..." : "\nAlti Andes boot...");
+
+    // Settings en NVS (en caliente, la copia de RTC: nada ha podido cambiarlos).
+    // Se cargan antes del primer frame: unidades, HUD y orientación.
     if (!gSettingsService.begin()) {
         Serial.println("Settings NVS init failed");
     }
-    gSettings = gSettingsService.load();
+    gSettings = warm ? wimg.settings : gSettingsService.load();
+    gBoot.mark("settings");
 
     // Drivers
     gButtonsDriver.begin();
     gBatteryMonitor.begin();
     gPowerHw.begin();
-
-    if (!gBmpDriver.begin()) {
-        Serial.println("BMP390 init failed");
-    }
+    gBoot.mark("drivers");
 
     // RTC: begin() devuelve void, así que sólo lo llamamos
-    gRtcDriver.begin();
+    gRtcDriver.begin(&gI2cBus);
 
     if (!gLcdDriver.begin()) {
         Serial.println("LCD init failed");
@@ -99,40 +159,122 @@ void setup() {
 
     // Aplicar orientación guardada (invertPant) tras init
     gLcdDriver.setRotation(gSettings.inverPant);
-
-    // Logbook backend (sólo persistencia; sin UI por ahora)
-    gLogbook.begin();
+    gBoot.mark("lcd");
+
+    // Logbook backend: un único montaje de LittleFS (partición "spiffs", en
+    // LogbookService::ensureFS) y las cabeceras los hace la tarea de storage
+    // al arrancar, fuera del camino hasta la primera altitud. En caliente las
+    // cabeceras vienen de RTC; si no valen, la tarea las lee como en frío.
+    if (warm && gLogbook.beginWarm(wimg.logbook)) {
+        (void)gTraceStore.beginWarm(wimg.trace);
+    }
+    // A partir de aquí todas las escrituras van por la tarea de storage.
+    if (!gStorage.begin(&gLogbook, &gTraceStore)) {
+        Serial.println("Storage task init failed");
+    }
+    gBoot.mark("storage task");
 
     // Servicios y UI
     gAltimetryService.begin(&gBmpDriver, &gSettings);
+    if (warm) {
+        gAltimetryService.restoreWarm(wimg.altimetry, gWarmStart.shiftMs());
+    } else {
+        // Despertados por una subida: el cero es el suelo de antes de dormir.
+        gAltimetryService.seedReference(gPressWake.getGroundPa());
+    }
+    gAlerts.begin(&gLcdDriver, gSettings.alerts);
+    gAltimetryService.setSampleHook(AltitudeAlertService::onSampleHook, &gAlerts);
     gFlightPhaseService.begin();
+    if (warm) {
+        gFlightPhaseService.restoreWarm(wimg.flight, gWarmStart.shiftMs());
+    }
     gSleepPolicyService.begin();
+    gSensorGov.begin();
     gUiStateService.begin();
-    gJumpRecorder.begin(&gLogbook, &gRtcDriver);
+    gJumpRecorder.begin(&gStorage, &gRtcDriver, &gPreTrigger);
+    gTraceRecorder.begin(&gStorage, &gJumpRecorder, &gPreTrigger);
     gUiRenderer.begin();
-    gGame.begin(&gLcdDriver, &gUiStateService);
-    gBle.begin(gSettings);
+    // Juego y pila BLE: se inician al primer uso (lazyInit / pantalla GAME).
     gBle.setContext(&gSettings,
                     &gSettingsService,
                     &gLcdDriver,
                     &gBatteryMonitor,
                     &gRtcDriver,
-                    &gLogbook);
+                    &gStorage);
+    gBle.setAlertsHook(SensorTask::onAlertConfigHook, &gSensorTask);
 
     // Contexto
     setupContext();
+    gBoot.mark("services");
+
+    // Gestión automática de energía (antes de arrancar las tareas): sensor y
+    // UI se bloquean entre muestras/frames y la CPU duerme sola.
+    bool pmActive = false;
+#if POWER_PM_AUTO_LIGHT_SLEEP
+    pmActive = gPowerHw.beginPm(CPU_FREQ_LOW);
+#endif
+
+    // Runtime por tareas (reparto y plazos en core/SensorTask.h). Desde aquí
+    // altimetría, fase y grabadores son de la tarea del sensor (core 1) y la
+    // UI corre en su propia tarea en el core 0.
+    SensorTask::Pipeline pipe;
+    pipe.bus        = &gI2cBus;
+    pipe.bmp        = &gBmpDriver;
+    pipe.altimetry  = &gAltimetryService;
+    pipe.flight     = &gFlightPhaseService;
+    pipe.alerts     = &gAlerts;
+    pipe.governor   = &gSensorGov;
+    pipe.preTrigger = &gPreTrigger;
+    pipe.jump       = &gJumpRecorder;
+    pipe.trace      = &gTraceRecorder;
+    if (!gSensorTask.begin(pipe, gUiStateService.isLocked())) {
+        Serial.println("Sensor task init failed");
+    }
+    gBoot.mark("sensor task");
+
+    if (xTaskCreatePinnedToCore(uiTaskEntry, "ui", UI_TASK_STACK, nullptr,
+                                UI_TASK_PRIORITY, &gUiTask, UI_TASK_CORE) != pdPASS) {
+        Serial.println("UI task init failed");   // loop() hará de UI
+        gUiTask = nullptr;
+    }
+    if (pmActive) {
+        // Los botones pasan a despertar por nivel.
+        gButtonsDriver.enableSleepWake(gUiTask);
+    } else {
+        gButtonsDriver.setNotifyTask(gUiTask);
+    }
 
+    gBoot.mark("setup complete");
     Serial.println("Setup complete");
 }
 
 void loop() {
+    // La UI tiene su tarea: el loopTask deja el core 1 al sensor.
+    if (gUiTask) {
+        vTaskDelete(nullptr);
+    }
+    uint32_t t0 = millis();
+    if (!uiStep()) uiWait(t0);
+}
+
+// Un frame de UI: botones, política de energía y pintado. La altimetría
+// llega por el snapshot de SensorTask. Devuelve true si el frame terminó
+// en light sleep (el propio sueño hizo de espera).
+static bool uiStep() {
     static FlightPhase s_lastPhase = FlightPhase::GROUND;
+    static uint32_t    s_lastSeq   = 0;
+    static uint32_t    s_overruns  = 0;
+    static bool        s_framed    = false;
 
     uint32_t now = millis();
 
-    if (gPowerHw.consumeLightSleepWake() &&
-        gUiStateService.getScreen() == UiScreen::MAIN) {
-        gUiRenderer.notifyMainInteraction();
+    if (gPowerHw.consumeLightSleepWake()) {
+        // En light sleep millis() corre con el oscilador RC: releer el RTC
+        gRtcDriver.requestResync();
+        gButtonsDriver.notifyWake();
+        if (gUiStateService.getScreen() == UiScreen::MAIN) {
+            gUiRenderer.notifyMainInteraction();
+        }
     }
 
     // 1) Botones
@@ -158,15 +300,16 @@ void loop() {
         }
     }
 
-    // 2) Altimetría y fase de vuelo
-    gAltimetryService.setLockActive(gUiStateService.isLocked());
-    gAltimetryService.update(now);
-    AltitudeData alt = gAltimetryService.getAltitudeData();
-
-    FlightPhase prevPhase = FlightPhase::GROUND;
-    gFlightPhaseService.update(alt, now, gSettings.unidadMetros, &prevPhase);
-    FlightPhase phase = gFlightPhaseService.getPhase();
-    gJumpRecorder.update(alt, gSettings.unidadMetros, phase, prevPhase, now);
+    // 2) Altimetría y fase de vuelo: último snapshot de la tarea del sensor
+    SensorTask::Snapshot snap;
+    uint32_t seq = gSensorTask.read(snap);
+    if (seq != s_lastSeq) {
+        gUiRenderer.addAltitudeSample(snap.alt, snap.sampleUs, snap.samplePeriodUs);
+        s_lastSeq = seq;
+    }
+    const AltitudeData& alt = snap.alt;
+    FlightPhase phase = snap.phase;
+    gSensorTask.setLockActive(gUiStateService.isLocked());
 
     // Si la fase cambió, lo consideramos una interacción (resetea inactividad)
     if (phase != s_lastPhase) {
@@ -182,14 +325,14 @@ void loop() {
     SleepDecision dec = gSleepPolicyService.evaluate(
         now,
         gUiStateService,
-        gFlightPhaseService,
+        phase,
         gSettings,
         gBatteryMonitor,
-        gBle.isBusy()
+        gBle.isBusy() || gStorage.isBusy() || snap.recorderBusy
     );
 
-    // Aplicar modo del sensor BMP390 según decisión
-    gBmpDriver.setMode(dec.sensorMode);
+    // El modo del BMP390 lo aplica la tarea del sensor en su próximo ciclo
+    gSensorTask.setSensorMode(dec.sensorMode);
 
     // 4) Modelo de UI principal
     MainUiModel model;
@@ -199,6 +342,7 @@ void loop() {
     model.climbing       = (phase == FlightPhase::CLIMB) && !alt.isGroundStable;
     model.freefall       = (phase == FlightPhase::FREEFALL);
     model.canopy         = (phase == FlightPhase::CANOPY);
+    model.phase          = phase;
     model.minimalFlight  = gSettings.hudMinimalFlight &&
                            (phase == FlightPhase::CLIMB || phase == FlightPhase::FREEFALL);
     model.charging       = gBatteryMonitor.isChargerConnected();
@@ -206,7 +350,7 @@ void loop() {
     model.temperatureC   = alt.temperatureC;
     model.unit           = gSettings.unidadMetros;
     LogbookService::Stats lbStats{};
-    if (gLogbook.getStats(lbStats)) {
+    if (gStorage.getStats(lbStats)) {
         model.totalJumps = lbStats.totalIds;
     }
 
@@ -235,8 +379,10 @@ void loop() {
     }
 #endif
 
+    gLcdDriver.beginRender();
     if (screen == UiScreen::MAIN) {
         gUiRenderer.renderMainIfNeeded(model, gSettings.hud, inAhorroMain, screen, now);
+        if (snap.sampleUs != 0) gBoot.markFirstAltitude();
     } else if (screen == UiScreen::MENU_ROOT) {
         // Render del menú raíz
         UtcDateTime nowUtc = gRtcDriver.nowUtc();
@@ -268,11 +414,20 @@ void loop() {
                                     gBle.isConnected(),
                                     gSettings.idioma);
     } else if (screen == UiScreen::GAME) {
-        if (!gGame.isRunning()) {
-            gGame.start(now);
+        static bool s_gameReady = false;
+        if (!s_gameReady) {
+            gGame.begin(&gLcdDriver, &gUiStateService);   // sólo el primer uso
+            s_gameReady = true;
         }
+        if (!gGame.isRunning()) gGame.start(now);
         gGame.update(now);
     }
+    gLcdDriver.endRender();
+    if (!s_framed) {
+        s_framed = true;
+        gBoot.mark("primer frame");
+    }
+    lazyInit(now);
 
     // Auto-cerrar menús (root y icons) tras 6s de inactividad
     if (screen == UiScreen::MENU_ROOT || screen == UiScreen::MENU_ICONS) {
@@ -287,16 +442,71 @@ void loop() {
 
     // 6) Debug centralizado
     debugPrintStatus(gAppCtx, gSettings, dec, now);
+    debugPollSerial(gAppCtx);
+
+    uint32_t frameMs = millis() - now;
+    if (frameMs > UI_TASK_DEADLINE_MS) {
+        s_overruns++;
+        Serial.printf("[ui] frame %lu ms > plazo %u ms (%lu)\n",
+                      (unsigned long)frameMs, (unsigned)UI_TASK_DEADLINE_MS,
+                      (unsigned long)s_overruns);
+    }
 
     // 7) Aplicar decisión de energía (CPU freq, sleeps)
+    // Light sleep (sin gestión automática) y deep sleep congelan el core del
+    // sensor: esperar a que cierre su ciclo y retenerlo mientras dura.
+    bool holdSensor = dec.enterDeepSleep ||
+                      (dec.enterLightSleep && !gPowerHw.isPmActive());
+    if (holdSensor) gSensorTask.pause();
     if (dec.enterDeepSleep) {
         gLcdDriver.prepareForDeepSleep();
+        gPressWake.arm(alt.pressure.v);
+        // Con el sensor retenido el estado no se mueve bajo nuestros pies.
+        gWarmStart.save(gBmpDriver, gAltimetryService, gFlightPhaseService,
+                        gLogbook, gTraceStore, gSettings);
     }
-
     gPowerHw.apply(dec);
+    if (holdSensor) gSensorTask.resume();
 
     // Si salimos del juego, asegúrate de detener su ciclo
     if (gUiStateService.getScreen() != UiScreen::GAME && gGame.isRunning()) {
+        gLcdDriver.beginRender();
         gGame.stop();
+        gLcdDriver.endRender();
+    }
+
+    return dec.enterLightSleep && dec.lightSleepMaxMs > 0;
+}
+
+// Subsistemas no críticos para la primera altitud: se inician después de
+// pintarla (o a los BOOT_LAZY_INIT_MS si el sensor no da muestras).
+static void lazyInit(uint32_t nowMs) {
+    static bool s_done = false;
+    if (s_done) return;
+    if (!gBoot.hasFirstAltitude() && nowMs < BOOT_LAZY_INIT_MS) return;
+    s_done = true;
+
+    gBle.begin(gSettings);
+    gBoot.mark("ble (diferido)");
+}
+
+// Espera hasta el próximo frame; un botón (notificación) la corta. En MAIN
+// no tiene sentido repintar más rápido de lo que llegan muestras.
+static void uiWait(uint32_t frameStartMs) {
+    uint32_t frameMs = UI_TASK_FRAME_MS;
+    if (gUiStateService.getScreen() == UiScreen::MAIN) {
+        uint32_t sensorMs = gSensorTask.getPeriodMs();
+        if (sensorMs > frameMs) frameMs = sensorMs;
+    }
+    uint32_t spent = millis() - frameStartMs;
+    if (spent < frameMs) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(frameMs - spent));
+    }
+}
+
+static void uiTaskEntry(void*) {
+    for (;;) {
+        uint32_t t0 = millis();
+        if (!uiStep()) uiWait(t0);
     }
 }
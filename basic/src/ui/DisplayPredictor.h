@@ -0,0 +1,116 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+
+#include "util/Types.h"
+#include "include/config_ui.h"
+#include "core/AltimetryService.h"
+
+// Etapa de presentación: compensa la latencia entre la muestra y el píxel.
+//
+// La altitud que llega al LCD ya es vieja cuando se ve:
+//   - el EMA de AltimetryService (ALT_FILTER_ALPHA) retrasa una rampa
+//     (1 - α) / α muestras;
+//   - entre la lectura del sensor y el inicio del repintado corre el resto
+//     del loop;
+//   - el repintado (clearBuffer + dibujo + sendBuffer por SW SPI) tarda;
+//   - el cristal tarda en responder (UI_PRED_EXTRA_MS_*).
+// A 55 m/s eso son decenas de metros. Aquí se predice la altitud en el
+// instante previsto de actualización de píxeles:
+//   alt(t + L) ≈ alt + vs·L + ½·a·L²
+// con la VS publicada, una aceleración estimada (derivada filtrada de la VS)
+// y L = retardo del filtro + retardo medido hasta el fin de sendBuffer +
+// extra por fase. Los retardos del pipeline se miden en cada repintado
+// (micros) y se promedian.
+//
+// Sólo actúa en las fases activadas en config_ui.h; en suelo nunca (allí
+// manda la zona muerta). La cuantización de 50 unidades de
+// formatAltitudeString se mantiene: redondea hacia abajo bajando, o sea,
+// hacia el lado seguro.
+
+class DisplayPredictor {
+public:
+    // Llamar con cada muestra nueva que vea la UI. La UI sólo recoge el
+    // último snapshot de cada frame, así que el dt entre llamadas es el del
+    // frame, no el del sensor: samplePeriodUs (SensorTask::Snapshot) da el
+    // periodo real con el que se estima el retardo del EMA. Con 0 se usa el
+    // dt entre llamadas (alimentación a la tasa del sensor).
+    void addSample(const AltitudeData& alt, uint32_t sampleUs, uint32_t samplePeriodUs = 0) {
+        if (sampleUs == lastSampleUs) return;    // sin muestra nueva
+        if (haveSample) {
+            float dt = (float)(sampleUs - lastSampleUs) * 1e-6f;
+            if (dt > 0.0f && dt < 1.0f) {
+                float rawAcc = (alt.verticalSpeed - lastVs).v / dt;
+                float k      = dt / (ACCEL_TAU_S + dt);
+                accel       += k * (rawAcc - accel);
+                float period = samplePeriodUs ? samplePeriodUs * 1e-6f : dt;
+                float kd     = dt / (PERIOD_TAU_S + dt);
+                samplePeriodS += kd * (period - samplePeriodS);
+            }
+        }
+        haveSample   = true;
+        lastSampleUs = sampleUs;
+        lastVs       = alt.verticalSpeed;
+    }
+
+    // Devuelve la altitud a mostrar para un repintado que empieza ahora.
+    // La conversión a la unidad de UI la hace el renderer.
+    Meters predict(const AltitudeData& alt, FlightPhase phase) {
+        lastLeadMs = 0.0f;
+        if (!haveSample || !enabledFor(phase)) return alt.altToShow;
+
+        float filterLagS = samplePeriodS * (1.0f - ALT_FILTER_ALPHA) / ALT_FILTER_ALPHA;
+        float sinceS     = (float)(micros() - lastSampleUs) * 1e-6f;
+        float leadS      = filterLagS + sinceS + renderS + extraMsFor(phase) * 0.001f;
+        float maxS       = UI_PRED_MAX_LEAD_MS * 0.001f;
+        if (leadS > maxS) leadS = maxS;
+        lastLeadMs = leadS * 1000.0f;
+
+        Meters pred = alt.rawAlt + Meters(alt.verticalSpeed.v * leadS + 0.5f * accel * leadS * leadS);
+        return (qabs(pred) < Meters(ALT_DEADBAND_METERS)) ? Meters(0.0f) : pred;
+    }
+
+    // Duración medida del repintado principal (inicio → fin de sendBuffer).
+    void noteRenderUs(uint32_t us) {
+        float s = us * 1e-6f;
+        renderS += RENDER_EMA * (s - renderS);
+        if (us > maxRenderUs) maxRenderUs = us;
+    }
+
+    float    getLastLeadMs()  const { return lastLeadMs; }
+    float    getRenderMs()    const { return renderS * 1000.0f; }
+    uint32_t getMaxRenderUs() const { return maxRenderUs; }
+    float    getAccel()       const { return accel; }
+
+private:
+    static constexpr float ACCEL_TAU_S  = 0.5f;
+    static constexpr float PERIOD_TAU_S = 1.0f;
+    static constexpr float RENDER_EMA   = 0.1f;
+
+    static bool enabledFor(FlightPhase p) {
+        switch (p) {
+        case FlightPhase::CLIMB:    return UI_PRED_ENABLE_CLIMB;
+        case FlightPhase::FREEFALL: return UI_PRED_ENABLE_FREEFALL;
+        case FlightPhase::CANOPY:   return UI_PRED_ENABLE_CANOPY;
+        default:                    return false;
+        }
+    }
+
+    static uint16_t extraMsFor(FlightPhase p) {
+        switch (p) {
+        case FlightPhase::CLIMB:    return UI_PRED_EXTRA_MS_CLIMB;
+        case FlightPhase::FREEFALL: return UI_PRED_EXTRA_MS_FREEFALL;
+        case FlightPhase::CANOPY:   return UI_PRED_EXTRA_MS_CANOPY;
+        default:                    return 0;
+        }
+    }
+
+    bool     haveSample    = false;
+    uint32_t lastSampleUs  = 0;
+    MetersPerSecond lastVs;
+    float    accel         = 0.0f;     // m/s²
+    float    samplePeriodS = 0.05f;
+    float    renderS       = 0.02f;    // estimación inicial hasta medir
+    uint32_t maxRenderUs   = 0;
+    float    lastLeadMs    = 0.0f;
+};
@@ -2,19 +2,21 @@
 #include <Arduino.h>
 #include <U8g2lib.h>
 #include "core/LogbookService.h"
+#include "core/StorageService.h"
 #include "drivers/LcdDriver.h"
 #include "core/SettingsService.h"
 #include "util/Types.h"
+#include "util/AltFormat.h"
 #include "drivers/ButtonsDriver.h"
 #include "core/UiStateService.h"
 #include "include/config_ui.h"
-#include <time.h>
+#include "util/CivilTime.h"
 
 // UI para la bitácora: listado de saltos y borrado.
 class LogbookUi {
 public:
-    LogbookUi(LogbookService* lb, LcdDriver* lcd)
-        : logbook(lb), lcdDrv(lcd) {}
+    LogbookUi(StorageService* st, LcdDriver* lcd)
+        : logbook(st), lcdDrv(lcd) {}
 
     void enter() {
         LogbookService::Stats st{};
@@ -83,15 +85,13 @@ public:
                 erasePrompt = true;
                 eraseRequireRelease = true; // evita borrar en el mismo hold (llegan 2 eventos: UP y DOWN)
             } else if (!eraseRequireRelease) {
-                if (logbook->reset()) {
+                // El borrado corre en la tarea de storage; el toast aparece
+                // cuando el callback confirma (ver render()).
+                resetDone = false;
+                if (logbook->submitReset(onResetDone, this)) {
                     count = 0;
                     idx = 0;
-                    toastActive = true;
-                    toastUntil  = millis() + 900;
-                    strncpy(toastMsg, (settings.idioma == Language::ES) ? "Bit\u00e1cora borrada"
-                                                                        : "Logbook erased",
-                            sizeof(toastMsg)-1);
-                    toastMsg[sizeof(toastMsg)-1] = '\0';
+                    toastLang = settings.idioma;
                 }
                 erasePrompt = false;
                 eraseRequireRelease = false;
@@ -105,6 +105,17 @@ public:
         if (!lcdDrv) return;
         U8G2& u8g2 = lcdDrv->getU8g2();
 
+        if (resetDone) {
+            resetDone   = false;
+            toastActive = true;
+            toastUntil  = millis() + 900;
+            const char* msg = resetOk
+                ? ((toastLang == Language::ES) ? "Bit\u00e1cora borrada" : "Logbook erased")
+                : ((toastLang == Language::ES) ? "Error al borrar"       : "Erase failed");
+            strncpy(toastMsg, msg, sizeof(toastMsg)-1);
+            toastMsg[sizeof(toastMsg)-1] = '\0';
+        }
+
         if (toastActive) {
             u8g2.clearBuffer();
             const uint8_t* fontText = chooseFont(settings.idioma);
@@ -139,16 +150,22 @@ public:
     }
 
 private:
+    // Corre en la tarea de storage: sólo marca flags.
+    static void onResetDone(StorageService::CmdType,
+                            bool ok,
+                            const LogbookService::Record&,
+                            void* user) {
+        LogbookUi* self = static_cast<LogbookUi*>(user);
+        if (!self) return;
+        self->resetOk   = ok;
+        self->resetDone = true;
+    }
+
     static void formatTime(uint32_t epoch, char* hhmm, size_t hhmmLen, char* dmy, size_t dmyLen) {
-        time_t t = (time_t)epoch;
-        struct tm *tmv = gmtime(&t);
-        if (!tmv) {
-            snprintf(hhmm, hhmmLen, "--:--");
-            snprintf(dmy,  dmyLen,  "--/--/--");
-            return;
-        }
-        snprintf(hhmm, hhmmLen, "%02d:%02d", tmv->tm_hour, tmv->tm_min);
-        snprintf(dmy,  dmyLen,  "%02d/%02d/%02d", tmv->tm_mday, tmv->tm_mon+1, (tmv->tm_year+1900)%100);
+        UtcDateTime dt = CivilTime::epochToUtc(epoch);
+        snprintf(hhmm, hhmmLen, "%02u:%02u", (unsigned)dt.hour, (unsigned)dt.minute);
+        snprintf(dmy,  dmyLen,  "%02u/%02u/%02u", (unsigned)dt.day, (unsigned)dt.month,
+                 (unsigned)(dt.year % 100));
     }
 
     static void drawEmpty(U8G2& u8g2, Language lang) {
@@ -169,13 +186,8 @@ private:
     }
 
     static String fmtAlt(float altM, UnitType unit, int decimals) {
-        float v = altM;
-        const float M_TO_FT = 3.2808399f;
-        const char* suffix = " m";
-        if (unit == UnitType::FEET) {
-            v *= M_TO_FT;
-            suffix = " ft";
-        }
+        float v = toDisplayUnit(Meters(altM), unit);
+        const char* suffix = (unit == UnitType::FEET) ? " ft" : " m";
         char buf[24];
         dtostrf(v, 0, decimals, buf);
         return String(buf) + suffix;
@@ -263,7 +275,7 @@ private:
         u8g2.sendBuffer();
     }
 
-    LogbookService* logbook   = nullptr;
+    StorageService* logbook   = nullptr;
     LcdDriver*      lcdDrv    = nullptr;
     uint16_t        count     = 0;
     int             idx       = 0;   // 0 = más reciente
@@ -275,4 +287,8 @@ private:
     bool     toastActive = false;
     uint32_t toastUntil  = 0;
     char     toastMsg[48]{};
+
+    volatile bool resetDone = false;
+    volatile bool resetOk   = false;
+    Language      toastLang = Language::ES;
 };
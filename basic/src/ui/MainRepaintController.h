@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include "ui/UiModels.h"
+#include "util/AltFormat.h"
 #include "core/SettingsService.h"
 
 // Controla cuándo repintar la pantalla principal según las reglas de ahorro.
@@ -57,7 +58,7 @@ public:
             repaint = true;
         }
 
-        float altShown = model.alt.altToShow;
+        float altShown = toDisplayUnit(model.alt.altToShow, model.unit);
         if (!state.haveLastAlt ||
             fabsf(altShown - state.lastAltShown) > 1e-3f) {
             repaint = true;
@@ -25,7 +25,7 @@ public:
         // Si modo minimal para CLIMB/FF está activo, dibuja sólo la altura
         // (ajusta fuente/posición en config_ui.h para probar centrado).
         if (model.minimalFlight) {
-            String altStr = formatAltitudeString(model.alt.altToShow, model.freefall);
+            String altStr = formatAltitudeString(toDisplayUnit(model.alt.altToShow, model.unit), model.freefall);
             u8g2.setFont(UI_FONT_ALT_CLEAR);
             uint16_t altWidth = u8g2.getStrWidth(altStr.c_str());
             uint16_t altX     = ((128 - altWidth) / 2);
@@ -94,7 +94,7 @@ public:
         u8g2.drawStr(battX, yTop, battBuf);
 
         // 2) Altura grande centrada (Logisoso)
-        String altStr = formatAltitudeString(model.alt.altToShow, model.freefall);
+        String altStr = formatAltitudeString(toDisplayUnit(model.alt.altToShow, model.unit), model.freefall);
 
         u8g2.setFont(UI_FONT_ALT_MAIN);
         uint16_t altWidth = u8g2.getStrWidth(altStr.c_str());
@@ -1,8 +1,9 @@
 #pragma once
 #include <Arduino.h>
 #include "util/Types.h"
+#include "util/AltFormat.h"
 #include "core/UiStateService.h"
-#include "core/AltimetryService.h"
+#include "core/SensorTask.h"
 #include "drivers/LcdDriver.h"
 #include "core/SettingsService.h"
 #include "drivers/RtcDs3231Driver.h"
@@ -16,20 +17,18 @@ public:
     UiInputController(UiStateService&    uiState,
                       Settings&          settings,
                       SettingsService&   settingsService,
-                      AltimetryService&  altimetry,
+                      SensorTask&        sensor,
                       LcdDriver&         lcd,
                       LogbookUi&         logbookUi,
                       RtcDs3231Driver&   rtc,
-                      FlightPhaseService& flightPhase,
                       BleManager*        bleMgr = nullptr)
         : uiState(uiState),
           settings(settings),
           settingsService(settingsService),
-          altimetry(altimetry),
+          sensor(sensor),
           lcd(lcd),
           logbookUi(logbookUi),
           rtcDrv(rtc),
-          flight(&flightPhase),
           bleManager(bleMgr)
     {}
 
@@ -82,11 +81,10 @@ private:
     UiStateService&   uiState;
     Settings&         settings;
     SettingsService&  settingsService;
-    AltimetryService& altimetry;
+    SensorTask&       sensor;    // altimetría: sólo snapshot y comandos
     LcdDriver&        lcd;
     LogbookUi&        logbookUi;
     RtcDs3231Driver&  rtcDrv;
-    FlightPhaseService* flight = nullptr;
     BleManager*       bleManager = nullptr;
 
     // Estado del backlight (para toggle). Arrancamos apagado.
@@ -163,12 +161,12 @@ private:
             // ACTIVAR LOCK: sólo en suelo (fase GROUND) y desbloqueado
             if (!locked &&
                 ev.type == ButtonEventType::LONG_PRESS_3S &&
-                flight && flight->getPhase() == FlightPhase::GROUND) {
+                sensor.getPhase() == FlightPhase::GROUND) {
 
                 uiState.setLocked(true);
 
                 // Recalibra altura según offset configurado
-                altimetry.recalibrateGround(settings.alturaOffset);
+                sensor.requestRecalibrate(settings.alturaOffset);
 
                 Serial.println(F("[LOCK] Activado (3s)"));
                 return;
@@ -244,20 +242,9 @@ private:
 
         switch (idx) {
         case 0: { // Unidad m/ft
-            UnitType oldUnit = settings.unidadMetros;
-            UnitType newUnit = (oldUnit == UnitType::METERS) ? UnitType::FEET
-                                                             : UnitType::METERS;
-
-            // Convertimos el offset a la nueva unidad para mantener el mismo cero físico
-            float offset = settings.alturaOffset;
-            if (oldUnit == UnitType::METERS && newUnit == UnitType::FEET) {
-                offset = offset * M_TO_FT;
-            } else if (oldUnit == UnitType::FEET && newUnit == UnitType::METERS) {
-                offset = offset / M_TO_FT;
-            }
-
-            settings.unidadMetros = newUnit;
-            settings.alturaOffset = offset;
+            // El offset se guarda en metros: cambiar de unidad no mueve el cero.
+            settings.unidadMetros = (settings.unidadMetros == UnitType::METERS) ? UnitType::FEET
+                                                                                 : UnitType::METERS;
             settingsService.save(settings);
             Serial.printf("[MENU] Unidad -> %s\n",
                           settings.unidadMetros == UnitType::METERS ? "m" : "ft");
@@ -344,7 +331,7 @@ private:
             break;
 
         case 9: // Offset (editor más adelante)
-            uiState.startOffsetEdit(settings.alturaOffset);
+            uiState.startOffsetEdit(toDisplayUnit(settings.alturaOffset, settings.unidadMetros));
             uiState.setScreen(UiScreen::MENU_OFFSET);
             Serial.println(F("[MENU] Offset editor"));
             break;
@@ -401,14 +388,14 @@ private:
                 return;
             }
             if (logicalId == ButtonId::MID && ev.type == ButtonEventType::PRESS) {
-                settings.alturaOffset = uiState.getOffsetEditValue();
+                settings.alturaOffset = fromDisplayUnit(uiState.getOffsetEditValue(), settings.unidadMetros);
                 settingsService.save(settings);
 
                 // Recalibramos para que el nuevo offset sea efectivo ya
-                altimetry.recalibrateGround(settings.alturaOffset);
+                sensor.requestRecalibrate(settings.alturaOffset);
 
                 uiState.setScreen(UiScreen::MENU_ROOT);
-                Serial.printf("[OFFSET] Guardado: %.1f\n", settings.alturaOffset);
+                Serial.printf("[OFFSET] Guardado: %.1f m\n", settings.alturaOffset.v);
                 return;
             }
         }
@@ -12,6 +12,7 @@ struct MainUiModel {
     bool climbing          = false;
     bool freefall          = false;
     bool canopy            = false;
+    FlightPhase phase      = FlightPhase::GROUND;
     bool charging          = false;
     bool showZzz           = false;
     char         timeText[6];   // "HH:MM"
@@ -7,6 +7,7 @@
 #include "ui/UiModels.h"
 #include "ui/MainScreenRenderer.h"
 #include "ui/MainRepaintController.h"
+#include "ui/DisplayPredictor.h"
 #include "ui/MenuRenderer.h"
 #include "ui/OffsetScreenRenderer.h"
 #include "ui/DateTimeScreenRenderer.h"
@@ -33,6 +34,13 @@ public:
         // Nada especial de momento; LcdDriver::begin() ya inicializa u8g2
     }
 
+    // Muestra nueva de altimetría para la etapa de presentación.
+    void addAltitudeSample(const AltitudeData& alt, uint32_t sampleUs, uint32_t samplePeriodUs) {
+        predictor.addSample(alt, sampleUs, samplePeriodUs);
+    }
+
+    const DisplayPredictor& getPredictor() const { return predictor; }
+
     // Aviso de interacción en pantalla principal para forzar repintado.
     void notifyMainInteraction() {
         repaintController.force();
@@ -68,7 +76,12 @@ public:
 
         if (mustRepaint) {
             repaintCounter++;
-            mainRenderer.render(model, hudCfg, repaintCounter);
+            // Altitud predicha al fin del repintado; se mide cuánto tarda.
+            uint32_t t0 = micros();
+            MainUiModel shown = model;
+            shown.alt.altToShow = predictor.predict(model.alt, model.phase);
+            mainRenderer.render(shown, hudCfg, repaintCounter);
+            predictor.noteRenderUs(micros() - t0);
         }
 
         lastScreen = screen;
@@ -115,6 +128,7 @@ private:
     MainScreenRenderer    mainRenderer;
     MenuRenderer          menuRenderer;
     MainRepaintController repaintController;
+    DisplayPredictor      predictor;
     OffsetScreenRenderer  offsetRenderer;
     DateTimeScreenRenderer dateTimeRenderer;
     IconsScreenRenderer   iconsRenderer;
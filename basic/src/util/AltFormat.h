@@ -3,6 +3,23 @@
 #include <math.h>
 #include "util/Types.h"
 
+// Conversión a la unidad de usuario. Todo el firmware trabaja en SI; esto
+// sólo se usa al pintar o al editar valores en pantalla.
+inline float toDisplayUnit(Meters m, UnitType unit)
+{
+    return (unit == UnitType::FEET) ? toFeet(m).v : m.v;
+}
+
+inline float toDisplayUnit(MetersPerSecond s, UnitType unit)
+{
+    return (unit == UnitType::FEET) ? toFeetPerSecond(s).v : s.v;
+}
+
+inline Meters fromDisplayUnit(float v, UnitType unit)
+{
+    return (unit == UnitType::FEET) ? toMeters(Feet(v)) : Meters(v);
+}
+
 // Aplica las reglas de visualización descritas:
 // - Entrada: altToShow en la unidad actual (m o ft).
 // - isFreefall: si true, aplica cuantización en el tramo con 2 decimales.
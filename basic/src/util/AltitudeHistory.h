@@ -0,0 +1,263 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// Historial de altitud multi-resolución con memoria constante.
+//
+// Tres anillos de cubetas con min/máx/media de altitud y VS:
+//   - SEC_1  : 1 s  por cubeta, ALT_HIST_SEC_SLOTS  cubetas (2 min)
+//   - SEC_10 : 10 s por cubeta, ALT_HIST_10S_SLOTS  cubetas (10 min)
+//   - SEC_60 : 60 s por cubeta, ALT_HIST_MIN_SLOTS  cubetas (1 h)
+//
+// push() es O(1): acumula en la cubeta del segundo en curso y, al cambiar de
+// segundo, la cierra en el anillo de 1 s y la mezcla en los acumuladores de
+// 10 s y 60 s (que a su vez se cierran al cambiar de periodo). Sólo se
+// guardan segundos con muestras: cada cubeta lleva su índice de tiempo y un
+// hueco (sensor parado, sueño) simplemente no aparece en las consultas.
+//
+// window() agrega los últimos N segundos *cerrados* con la resolución más fina
+// que los cubre (1 s hasta 2 min, 10 s hasta 10 min, 60 s después). Además de
+// los extremos por muestra, devuelve los extremos de las medias por cubeta
+// (vsMeanMin/vsMeanMax), que es lo que usan las comprobaciones de "quieto
+// durante N s": la media de VS en 1 s equivale a la VS del flujo lento.
+//
+// La altitud se guarda tal como llega (AltimetryService: metros sobre el cero
+// de usuario). rebase() desplaza todo el historial cuando cambia el cero.
+
+#ifndef ALT_HIST_SEC_SLOTS
+#define ALT_HIST_SEC_SLOTS  120
+#endif
+#ifndef ALT_HIST_10S_SLOTS
+#define ALT_HIST_10S_SLOTS  60
+#endif
+#ifndef ALT_HIST_MIN_SLOTS
+#define ALT_HIST_MIN_SLOTS  60
+#endif
+
+class AltitudeHistory {
+public:
+    enum class Resolution : uint8_t { SEC_1 = 0, SEC_10, SEC_60 };
+
+    struct Bucket {
+        float    altMin  = NAN;
+        float    altMax  = NAN;
+        float    altMean = NAN;
+        float    vsMin   = NAN;
+        float    vsMax   = NAN;
+        float    vsMean  = NAN;
+        uint32_t idx     = 0;    // inicio, en unidades de la resolución (s, 10 s, 60 s)
+        uint16_t n       = 0;    // muestras
+        uint16_t secs    = 0;    // segundos con muestras
+    };
+
+    struct Window {
+        float    altMin    = NAN;
+        float    altMax    = NAN;
+        float    altMean   = NAN;
+        float    vsMin     = NAN;
+        float    vsMax     = NAN;
+        float    vsMean    = NAN;
+        float    vsMeanMin = NAN;   // extremos de la VS media por cubeta
+        float    vsMeanMax = NAN;
+        uint32_t seconds   = 0;     // segundos con muestras dentro de la ventana
+        uint32_t samples   = 0;
+
+        float altRange() const { return altMax - altMin; }
+        // Máximo de |VS media por cubeta|.
+        float vsMeanAbsMax() const { return fmaxf(fabsf(vsMeanMin), fabsf(vsMeanMax)); }
+    };
+
+    void reset() {
+        cur  = Bucket{};
+        sum  = {};
+        for (uint8_t l = 0; l < LEVELS; ++l) {
+            acc[l]  = Bucket{};
+            head[l] = 0;
+            used[l] = 0;
+        }
+    }
+
+    // Añade una muestra (altitud en m, VS en m/s).
+    void push(uint32_t nowMs, float altM, float vsMps) {
+        if (!isfinite(altM) || !isfinite(vsMps)) return;
+        uint32_t sec = nowMs / 1000u;
+
+        if (cur.n && sec != cur.idx) closeSecond();
+        if (cur.n == 0) {
+            cur.idx     = sec;
+            cur.altMin  = cur.altMax = altM;
+            cur.vsMin   = cur.vsMax  = vsMps;
+            sum.alt     = 0.0f;
+            sum.vs      = 0.0f;
+        }
+        if (altM  < cur.altMin) cur.altMin = altM;
+        if (altM  > cur.altMax) cur.altMax = altM;
+        if (vsMps < cur.vsMin)  cur.vsMin  = vsMps;
+        if (vsMps > cur.vsMax)  cur.vsMax  = vsMps;
+        sum.alt += altM;
+        sum.vs  += vsMps;
+        if (cur.n < 0xFFFF) cur.n++;
+    }
+
+    // Agrega los últimos 'seconds' segundos cerrados respecto a nowMs.
+    // Devuelve false si no hay ninguna cubeta en la ventana.
+    bool window(uint32_t nowMs, uint32_t seconds, Window& out) const {
+        out = Window{};
+        if (seconds == 0) return false;
+
+        uint8_t l = (seconds <= span(0) * cap(0)) ? 0
+                  : (seconds <= span(1) * cap(1)) ? 1 : 2;
+        uint32_t nowSec = nowMs / 1000u;
+        uint32_t start  = nowSec - seconds;
+
+        bool any = false;
+        // Acumulador del nivel (segundos ya cerrados aún sin rodar al anillo).
+        if (l > 0 && acc[l].secs && inWindow(acc[l], l, start, nowSec)) {
+            mergeInto(out, acc[l]);
+            any = true;
+        }
+        for (uint8_t i = 0; i < used[l]; ++i) {
+            const Bucket& b = at(l, i);
+            if (!inWindow(b, l, start, nowSec)) break;
+            mergeInto(out, b);
+            any = true;
+        }
+        return any;
+    }
+
+    // Cubetas cerradas para gráficas: age 0 = la más reciente.
+    uint8_t bucketCount(Resolution r) const { return used[(uint8_t)r]; }
+
+    bool bucketAt(Resolution r, uint8_t age, Bucket& out) const {
+        uint8_t l = (uint8_t)r;
+        if (age >= used[l]) return false;
+        out = at(l, age);
+        return true;
+    }
+
+    // Desplaza toda la altitud guardada (re-cero de AltimetryService).
+    void rebase(float deltaM) {
+        if (!isfinite(deltaM) || deltaM == 0.0f) return;
+        shift(cur, deltaM);
+        sum.alt += deltaM * cur.n;
+        for (uint8_t l = 0; l < LEVELS; ++l) {
+            shift(acc[l], deltaM);
+            for (uint8_t i = 0; i < used[l]; ++i) shift(ring(l, i), deltaM);
+        }
+    }
+
+private:
+    static constexpr uint8_t LEVELS = 3;
+
+    // Segundos por cubeta y nº de cubetas de cada nivel.
+    static uint32_t span(uint8_t l) { return (l == 0) ? 1u : (l == 1) ? 10u : 60u; }
+    static uint8_t  cap(uint8_t l) {
+        return (l == 0) ? ALT_HIST_SEC_SLOTS : (l == 1) ? ALT_HIST_10S_SLOTS : ALT_HIST_MIN_SLOTS;
+    }
+
+    static_assert(ALT_HIST_SEC_SLOTS <= 255 && ALT_HIST_10S_SLOTS <= 255 && ALT_HIST_MIN_SLOTS <= 255,
+                  "anillos de historial: máx. 255 cubetas");
+
+    void closeSecond() {
+        cur.altMean = sum.alt / cur.n;
+        cur.vsMean  = sum.vs  / cur.n;
+        cur.secs    = 1;
+        pushRing(0, cur);
+
+        for (uint8_t l = 1; l < LEVELS; ++l) {
+            uint32_t idx = cur.idx / span(l);
+            if (acc[l].secs && acc[l].idx != idx) {
+                pushRing(l, acc[l]);
+                acc[l] = Bucket{};
+            }
+            if (acc[l].secs == 0) acc[l].idx = idx;
+            mergeBucket(acc[l], cur);
+        }
+        cur = Bucket{};
+    }
+
+    static void mergeBucket(Bucket& a, const Bucket& b) {
+        if (b.n == 0) return;
+        if (a.n == 0) {
+            uint32_t idx = a.idx;
+            a = b;
+            a.idx = idx;
+            return;
+        }
+        float wa = (float)a.n, wb = (float)b.n;
+        a.altMin  = fminf(a.altMin, b.altMin);
+        a.altMax  = fmaxf(a.altMax, b.altMax);
+        a.vsMin   = fminf(a.vsMin,  b.vsMin);
+        a.vsMax   = fmaxf(a.vsMax,  b.vsMax);
+        a.altMean = (a.altMean * wa + b.altMean * wb) / (wa + wb);
+        a.vsMean  = (a.vsMean  * wa + b.vsMean  * wb) / (wa + wb);
+        uint32_t n = (uint32_t)a.n + b.n;
+        a.n    = (n > 0xFFFF) ? 0xFFFF : (uint16_t)n;
+        a.secs = (uint16_t)(a.secs + b.secs);
+    }
+
+    static void mergeInto(Window& w, const Bucket& b) {
+        if (w.samples == 0) {
+            w.altMin = b.altMin;  w.altMax = b.altMax;  w.altMean = b.altMean;
+            w.vsMin  = b.vsMin;   w.vsMax  = b.vsMax;   w.vsMean  = b.vsMean;
+            w.vsMeanMin = w.vsMeanMax = b.vsMean;
+        } else {
+            float wa = (float)w.samples, wb = (float)b.n;
+            w.altMin  = fminf(w.altMin, b.altMin);
+            w.altMax  = fmaxf(w.altMax, b.altMax);
+            w.vsMin   = fminf(w.vsMin,  b.vsMin);
+            w.vsMax   = fmaxf(w.vsMax,  b.vsMax);
+            w.altMean = (w.altMean * wa + b.altMean * wb) / (wa + wb);
+            w.vsMean  = (w.vsMean  * wa + b.vsMean  * wb) / (wa + wb);
+            w.vsMeanMin = fminf(w.vsMeanMin, b.vsMean);
+            w.vsMeanMax = fmaxf(w.vsMeanMax, b.vsMean);
+        }
+        w.samples += b.n;
+        w.seconds += b.secs;
+    }
+
+    // La cubeta cae entera dentro de [start, nowSec).
+    static bool inWindow(const Bucket& b, uint8_t l, uint32_t start, uint32_t nowSec) {
+        uint32_t t0 = b.idx * span(l);
+        return (int32_t)(t0 - start) >= 0 && (int32_t)(nowSec - t0) > 0;
+    }
+
+    static void shift(Bucket& b, float d) {
+        if (b.n == 0) return;
+        b.altMin  += d;
+        b.altMax  += d;
+        b.altMean += d;
+    }
+
+    void pushRing(uint8_t l, const Bucket& b) {
+        slot(l, head[l]) = b;
+        head[l] = (uint8_t)((head[l] + 1) % cap(l));
+        if (used[l] < cap(l)) used[l]++;
+    }
+
+    // age 0 = más reciente
+    Bucket& ring(uint8_t l, uint8_t age) {
+        return slot(l, (uint8_t)((head[l] + cap(l) - 1 - age) % cap(l)));
+    }
+    const Bucket& at(uint8_t l, uint8_t age) const {
+        return const_cast<AltitudeHistory*>(this)->ring(l, age);
+    }
+
+    Bucket& slot(uint8_t l, uint8_t i) {
+        switch (l) {
+        case 0:  return sec1[i];
+        case 1:  return sec10[i];
+        default: return sec60[i];
+        }
+    }
+
+    Bucket  sec1[ALT_HIST_SEC_SLOTS];
+    Bucket  sec10[ALT_HIST_10S_SLOTS];
+    Bucket  sec60[ALT_HIST_MIN_SLOTS];
+    uint8_t head[LEVELS] = {};
+    uint8_t used[LEVELS] = {};
+    Bucket  acc[LEVELS];             // acc[0] no se usa: el segundo en curso es 'cur'
+
+    Bucket  cur;
+    struct { float alt = 0.0f; float vs = 0.0f; } sum;
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+// Línea de tiempo del arranque.
+//
+// Cada paso de setup() deja una marca con micros() (desde que arranca la
+// app, tras el bootloader) y la UI marca el primer frame y la primera
+// altitud válida en pantalla. Al llegar a la primera altitud se imprime una
+// línea de resumen contra el presupuesto de esta build; la tabla completa
+// se vuelca a petición (tecla 'b' en el monitor serie, util/DebugConsole).
+//
+// Presupuesto por build: BOOT_BUDGET_COLD_MS / BOOT_BUDGET_WARM_MS se fijan
+// en build_flags y el resumen va etiquetado con BOOT_BUILD_ID, así que cada
+// firmware deja constancia de lo que tardó frente a lo que debía tardar.
+
+#ifndef BOOT_TIMELINE_ENABLE
+#define BOOT_TIMELINE_ENABLE   1
+#endif
+#ifndef BOOT_TIMELINE_MAX_MARKS
+#define BOOT_TIMELINE_MAX_MARKS 32
+#endif
+#ifndef BOOT_BUDGET_COLD_MS
+#define BOOT_BUDGET_COLD_MS    400    // power-on -> primera altitud
+#endif
+#ifndef BOOT_BUDGET_WARM_MS
+#define BOOT_BUDGET_WARM_MS    150    // deep sleep -> primera altitud (WarmStartService)
+#endif
+#ifndef BOOT_BUILD_ID
+#define BOOT_BUILD_ID          __DATE__ " " __TIME__
+#endif
+#ifndef BOOT_LAZY_INIT_MS
+#define BOOT_LAZY_INIT_MS      2000   // BLE sin esperar más a la primera altitud
+#endif
+#ifndef BOOT_SERIAL_WAIT_MS
+#define BOOT_SERIAL_WAIT_MS    0      // >0: esperar al monitor serie (sólo en frío)
+#endif
+
+class BootTimeline {
+public:
+    // step: literal (se guarda el puntero).
+    void mark(const char* step) {
+    #if BOOT_TIMELINE_ENABLE
+        uint32_t t = micros();
+        portENTER_CRITICAL(&mux);
+        if (count < BOOT_TIMELINE_MAX_MARKS) {
+            marks[count].step = step;
+            marks[count].us   = t;
+            count++;
+        } else {
+            dropped++;
+        }
+        portEXIT_CRITICAL(&mux);
+    #else
+        (void)step;
+    #endif
+    }
+
+    void setWarm(bool w) { warm = w; }
+
+    // Desde la UI, con la primera altitud válida pintada. Sólo cuenta la
+    // primera llamada; imprime el resumen contra el presupuesto.
+    void markFirstAltitude() {
+    #if BOOT_TIMELINE_ENABLE
+        if (firstAltUs) return;
+        firstAltUs = micros();
+        if (firstAltUs == 0) firstAltUs = 1;
+        mark("primera altitud");
+        Serial.printf("[boot] build %s: primera altitud a %lu.%03lu ms (%s, presupuesto %u ms) %s\n",
+                      BOOT_BUILD_ID,
+                      (unsigned long)(firstAltUs / 1000u),
+                      (unsigned long)(firstAltUs % 1000u),
+                      warm ? "caliente" : "frio",
+                      (unsigned)budgetMs(),
+                      overBudget() ? "EXCEDIDO" : "OK");
+    #endif
+    }
+
+    bool     hasFirstAltitude() const { return firstAltUs != 0; }
+    uint32_t firstAltitudeUs() const  { return firstAltUs; }
+    uint32_t budgetMs() const { return warm ? BOOT_BUDGET_WARM_MS : BOOT_BUDGET_COLD_MS; }
+    bool     overBudget() const {
+        return firstAltUs && firstAltUs > budgetMs() * 1000u;
+    }
+
+    // Tabla completa: instante absoluto y delta con la marca anterior.
+    void dump() const {
+    #if BOOT_TIMELINE_ENABLE
+        Mark copy[BOOT_TIMELINE_MAX_MARKS];
+        uint8_t n;
+        uint16_t lost;
+        portENTER_CRITICAL(&mux);
+        n    = count;
+        lost = dropped;
+        for (uint8_t i = 0; i < n; ++i) copy[i] = marks[i];
+        portEXIT_CRITICAL(&mux);
+
+        Serial.printf("[boot] build %s, arranque %s, presupuesto %u ms\n",
+                      BOOT_BUILD_ID, warm ? "caliente" : "frio", (unsigned)budgetMs());
+        uint32_t prev = 0;
+        for (uint8_t i = 0; i < n; ++i) {
+            Serial.printf("[boot] %10lu us  +%8lu us  %s\n",
+                          (unsigned long)copy[i].us,
+                          (unsigned long)(copy[i].us - prev),
+                          copy[i].step);
+            prev = copy[i].us;
+        }
+        if (lost) {
+            Serial.printf("[boot] %u marcas perdidas (BOOT_TIMELINE_MAX_MARKS)\n", (unsigned)lost);
+        }
+        if (!firstAltUs) {
+            Serial.println("[boot] aún sin altitud en pantalla");
+        }
+    #endif
+    }
+
+private:
+    struct Mark {
+        const char* step = nullptr;
+        uint32_t    us   = 0;
+    };
+
+    Mark     marks[BOOT_TIMELINE_MAX_MARKS];
+    uint8_t  count      = 0;
+    uint16_t dropped    = 0;
+    bool     warm       = false;
+    volatile uint32_t firstAltUs = 0;
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
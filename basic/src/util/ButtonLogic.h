@@ -0,0 +1,150 @@
+#pragma once
+#include <stdint.h>
+
+// Identifiers for the physical buttons on the device.
+enum class ButtonId { UP, MID, DOWN };
+
+// Types of button events that can be reported.
+enum class ButtonEventType { PRESS, REPEAT, LONG_PRESS_3S, LONG_PRESS_6S, RELEASE };
+
+// Event structure returned by poll().
+struct ButtonEvent {
+    ButtonId id;
+    ButtonEventType type;
+    uint32_t timestampMs;
+};
+
+// Máquina de estados de los botones sobre flancos con marca de tiempo.
+//
+// No lee pines ni millis(): recibe flancos (onEdge) y genera los eventos
+// temporizados (nextTimed) a partir de la marca de tiempo de la pulsación,
+// así que el resultado no depende de cuándo se ejecute el loop. Reglas (las
+// del driver por polling):
+// - PRESS inmediato en el flanco de subida, RELEASE en el de bajada.
+// - Un cambio a menos de MIN_EVENT_INTERVAL_MS del último PRESS/RELEASE es
+//   rebote: actualiza el estado pero no genera evento.
+// - REPEAT a los REPEAT_DELAY_MS + k·REPEAT_INTERVAL_MS (k >= 1) de pulsación.
+// - LONG_PRESS_3S y LONG_PRESS_6S una vez cada uno.
+// Si el loop se retrasa, nextTimed() entrega los eventos atrasados en orden
+// y con su marca de tiempo original.
+class ButtonLogic {
+public:
+    static constexpr uint8_t  COUNT                 = 3;
+    static constexpr uint32_t MIN_EVENT_INTERVAL_MS = 30;
+    static constexpr uint32_t REPEAT_DELAY_MS       = 500;
+    static constexpr uint32_t REPEAT_INTERVAL_MS    = 120;
+    static constexpr uint32_t LONG3_MS              = 3000;
+    static constexpr uint32_t LONG6_MS              = 6000;
+
+    void reset(const bool pressed[COUNT], uint32_t nowMs) {
+        for (uint8_t i = 0; i < COUNT; ++i) {
+            Btn& b = btn[i];
+            b = Btn{};
+            b.high        = pressed[i];
+            b.lastEventMs = nowMs;
+        }
+    }
+
+    bool isHigh(uint8_t i) const { return btn[i].high; }
+
+    // Procesa un flanco. Antes hay que vaciar nextTimed(tMs) para conservar
+    // el orden. Devuelve true si genera PRESS/RELEASE.
+    bool onEdge(uint8_t i, bool high, uint32_t tMs, ButtonEvent& ev) {
+        if (i >= COUNT) return false;
+        Btn& b = btn[i];
+        if (high == b.high) return false;            // flanco ya visto
+
+        b.high = high;
+        if (tMs - b.lastEventMs < MIN_EVENT_INTERVAL_MS) {
+            // Rebote: seguimos el nivel sin emitir. La pulsación en curso
+            // (si la hay) conserva su inicio para long-press y repetición.
+            return false;
+        }
+        b.lastEventMs = tMs;
+
+        ev.id          = static_cast<ButtonId>(i);
+        ev.timestampMs = tMs;
+        if (high) {
+            b.pressed     = true;
+            b.pressStart  = tMs;
+            b.long3Done   = false;
+            b.long6Done   = false;
+            b.repeatCount = 0;
+            ev.type = ButtonEventType::PRESS;
+        } else {
+            b.pressed = false;
+            ev.type = ButtonEventType::RELEASE;
+        }
+        return true;
+    }
+
+    // Siguiente evento temporizado con marca <= nowMs (el más antiguo de
+    // todos los botones). false si no hay ninguno pendiente.
+    bool nextTimed(uint32_t nowMs, ButtonEvent& ev) {
+        int8_t   bestI    = -1;
+        uint8_t  bestKind = 0;
+        uint32_t bestT    = 0;
+        for (uint8_t i = 0; i < COUNT; ++i) {
+            const Btn& b = btn[i];
+            if (!b.high || !b.pressed) continue;
+            uint32_t t;
+            uint8_t  kind;
+            earliestDue(b, t, kind);
+            if ((int32_t)(nowMs - t) < 0) continue;
+            if (bestI < 0 || (int32_t)(t - bestT) < 0) {
+                bestI = (int8_t)i; bestT = t; bestKind = kind;
+            }
+        }
+        if (bestI < 0) return false;
+
+        Btn& b = btn[bestI];
+        ev.id          = static_cast<ButtonId>(bestI);
+        ev.timestampMs = bestT;
+        switch (bestKind) {
+        case 0:  b.long3Done = true;  ev.type = ButtonEventType::LONG_PRESS_3S; break;
+        case 1:  b.long6Done = true;  ev.type = ButtonEventType::LONG_PRESS_6S; break;
+        default: b.repeatCount++;     ev.type = ButtonEventType::REPEAT;        break;
+        }
+        return true;
+    }
+
+    // Próximo instante en que habrá un evento temporizado (para dormir hasta
+    // entonces). false si no hay botones pulsados.
+    bool nextDeadline(uint32_t& tMs) const {
+        bool any = false;
+        for (uint8_t i = 0; i < COUNT; ++i) {
+            const Btn& b = btn[i];
+            if (!b.high || !b.pressed) continue;
+            uint32_t t; uint8_t k;
+            earliestDue(b, t, k);
+            if (!any || (int32_t)(t - tMs) < 0) tMs = t;
+            any = true;
+        }
+        return any;
+    }
+
+private:
+    struct Btn {
+        bool     high        = false;   // nivel actual
+        bool     pressed     = false;   // pulsación aceptada en curso
+        bool     long3Done   = false;
+        bool     long6Done   = false;
+        uint32_t pressStart  = 0;
+        uint32_t lastEventMs = 0;       // último PRESS/RELEASE emitido
+        uint32_t repeatCount = 0;
+    };
+
+    // kind: 0 = long 3 s, 1 = long 6 s, 2 = repeat
+    static void earliestDue(const Btn& b, uint32_t& t, uint8_t& kind) {
+        t    = b.pressStart + REPEAT_DELAY_MS + (b.repeatCount + 1) * REPEAT_INTERVAL_MS;
+        kind = 2;
+        if (!b.long3Done && (int32_t)(b.pressStart + LONG3_MS - t) <= 0) {
+            t = b.pressStart + LONG3_MS; kind = 0;
+        }
+        if (!b.long6Done && (int32_t)(b.pressStart + LONG6_MS - t) <= 0) {
+            t = b.pressStart + LONG6_MS; kind = 1;
+        }
+    }
+
+    Btn btn[COUNT];
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include "util/Types.h"
+
+// Conversión fecha civil UTC <-> epoch (s desde 1970-01-01), en tiempo
+// constante y sin depender de la TZ ni de gmtime (no reentrante).
+// Algoritmos days_from_civil / civil_from_days de Howard Hinnant.
+
+namespace CivilTime {
+
+// Días desde 1970-01-01 (puede ser negativo).
+inline int32_t daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= (m <= 2);
+    const int      era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);                              // [0, 399]
+    const unsigned doy = (153 * (m + (m > 2 ? (unsigned)-3 : 9)) + 2) / 5 + d - 1; // [0, 365]
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                  // [0, 146096]
+    return era * 146097 + (int32_t)doe - 719468;                                // 719468 = 1970-01-01
+}
+
+inline void civilFromDays(int32_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int32_t  era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);                           // [0, 146096]
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // [0, 399]
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                // [0, 365]
+    const unsigned mp  = (5 * doy + 2) / 153;                                    // [0, 11]
+    d = doy - (153 * mp + 2) / 5 + 1;                                            // [1, 31]
+    m = mp < 10 ? mp + 3 : mp - 9;                                               // [1, 12]
+    y = (int)yoe + era * 400 + (m <= 2);
+}
+
+// 0 si la fecha no es válida o cae fuera de uint32.
+inline uint32_t utcToEpoch(const UtcDateTime& dt) {
+    if (dt.year < 1970) return 0;
+    if (dt.month < 1 || dt.month > 12) return 0;
+    if (dt.day < 1 || dt.day > 31) return 0;
+    if (dt.hour > 23 || dt.minute > 59 || dt.second > 59) return 0;
+
+    int64_t days = daysFromCivil((int)dt.year, (unsigned)dt.month, (unsigned)dt.day);
+    int64_t sec  = days * 86400LL +
+                   (int64_t)dt.hour   * 3600LL +
+                   (int64_t)dt.minute * 60LL +
+                   (int64_t)dt.second;
+    if (sec < 0) return 0;
+    if (sec > 0xFFFFFFFFLL) return 0;
+    return (uint32_t)sec;
+}
+
+inline UtcDateTime epochToUtc(uint32_t epoch) {
+    UtcDateTime dt;
+    uint32_t secOfDay = epoch % 86400u;
+    dt.hour   = (uint8_t)(secOfDay / 3600u);
+    dt.minute = (uint8_t)((secOfDay / 60u) % 60u);
+    dt.second = (uint8_t)(secOfDay % 60u);
+
+    int y; unsigned m, d;
+    civilFromDays((int32_t)(epoch / 86400u), y, m, d);
+    dt.year  = (uint16_t)y;
+    dt.month = (uint8_t)m;
+    dt.day   = (uint8_t)d;
+    return dt;
+}
+
+} // namespace CivilTime
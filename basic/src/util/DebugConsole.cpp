@@ -19,22 +19,40 @@ void debugPrintStatus(const AppContext& ctx,
     return;
 #endif
 
+    // Disparos de alerta: el hook corre en la tarea del sensor y no imprime;
+    // el último se saca aquí en cuanto su latencia está medida.
+    if (ctx.alerts) {
+        static uint32_t alertsSeen = 0;
+        uint32_t fired = ctx.alerts->getFiredCount();
+        if (fired != alertsSeen && !ctx.alerts->isLatencyPending()) {
+            alertsSeen = fired;
+            uint32_t lat = ctx.alerts->getLastLatencyUs();
+            Serial.printf("[ALERT] %s %u m lat=%lu us%s (max %lu, fuera %lu)\n",
+                          ctx.alerts->getLastKindName(), (unsigned)ctx.alerts->getLastAltM(),
+                          (unsigned long)lat,
+                          lat > ALERT_LATENCY_BUDGET_US ? " (fuera de presupuesto)" : "",
+                          (unsigned long)ctx.alerts->getMaxLatencyUs(),
+                          (unsigned long)ctx.alerts->getOverBudgetCount());
+        }
+    }
+
     static uint32_t callCounter = 0;
     callCounter++;
     if (callCounter % DEBUG_CONSOLE_EVERY_N_CALLS != 0) {
         return; // solo imprimimos 1 de cada N llamadas
     }
 
-    AltitudeData alt = ctx.altimetry->getAltitudeData();
+    // El BMP es de la tarea del sensor: la presión sale del snapshot.
+    SensorTask::Snapshot snap;
+    ctx.sensor->read(snap);
+    const AltitudeData& alt = snap.alt;
     uint8_t battPct  = ctx.battery->getBatteryPercent();
 
-    // Leer presión directamente del BMP para ver si realmente varía
-    float pressurePa = 0.0f;
-    float tempC      = 0.0f;
-    bool  gotPressure = ctx.bmp->read(pressurePa, tempC);
+    float pressurePa  = alt.pressure.v;
+    bool  gotPressure = !isnan(pressurePa);
     Serial.print(F("AltI: "));
-    Serial.print(alt.rawAlt, 2);
-    Serial.print(F(" u, "));
+    Serial.print(alt.rawAlt.v, 2);
+    Serial.print(F(" m, "));
 
     if (gotPressure) {
         Serial.print(F("P: "));
@@ -65,9 +83,62 @@ Serial.print(F("ms), Ds:"));
 Serial.print(dec.enterDeepSleep ? 1 : 0);
 Serial.print(F(", Zzz:"));
 Serial.print(dec.showZzzHint ? 1 : 0);
+Serial.print(F(", Rej:"));
+Serial.print(ctx.altimetry->getRejectedSamples());
+Serial.print(F("/"));
+Serial.print(ctx.altimetry->getFilteredSamples());
+Serial.print(F(" ("));
+Serial.print(ctx.altimetry->getOutlierAvgCycles(), 0);
+Serial.print(F(" cyc)"));
+Serial.print(F(", Tage:"));
+Serial.print(ctx.bmp->getTempAgeMs(nowMs) / 1000u);
+Serial.print(F("/"));
+Serial.print(ctx.bmp->getTempIntervalMs() / 1000u);
+Serial.print(F("s, conv P/PT:"));
+Serial.print(ctx.bmp->getConvTimeUs(false));
+Serial.print(F("/"));
+Serial.print(ctx.bmp->getConvTimeUs(true));
+Serial.print(F(" us"));
+if (ctx.i2c) {
+    const I2cBus::Stats& bs = ctx.i2c->getStats();
+    Serial.printf(", I2C: %lu tx %lu err %lu clk, q %.0f/%lu us",
+                  (unsigned long)bs.transactions, (unsigned long)bs.errors,
+                  (unsigned long)bs.clockSwitches, bs.queueAvgUs,
+                  (unsigned long)bs.queueMaxUs);
+    Serial.printf(", to %lu rec %lu/%lu, xfer %lu us (cota %lu us), caida %lu ms",
+                  (unsigned long)bs.timeouts, (unsigned long)bs.recoveries,
+                  (unsigned long)bs.recoveryFails, (unsigned long)bs.worstXferUs,
+                  (unsigned long)ctx.i2c->stallBoundUs(), (unsigned long)bs.worstOutageMs);
+}
+{
+    SensorTask::Stats ss = ctx.sensor->getStats();
+    Serial.printf(", sensor: T %lu ms, ciclo %lu/%lu us, overruns %lu, cmd rej %lu",
+                  (unsigned long)ctx.sensor->getPeriodMs(), (unsigned long)ss.lastCycleUs,
+                  (unsigned long)ss.maxCycleUs, (unsigned long)ss.overruns,
+                  (unsigned long)ss.cmdRejected);
+}
 Serial.println();
 Serial.println();
 
 (void)settings;
 (void)nowMs;
 }
+
+void debugPollSerial(const AppContext& ctx)
+{
+#if !DEBUG_CONSOLE_ENABLED
+    (void)ctx;
+    return;
+#endif
+
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        switch (c) {
+        case 'b':
+            if (ctx.boot) ctx.boot->dump();
+            break;
+        default:
+            break;
+        }
+    }
+}
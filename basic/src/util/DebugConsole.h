@@ -15,3 +15,7 @@ void debugPrintStatus(const AppContext& ctx,
                       const Settings& settings,
                       const SleepDecision& dec,
                       uint32_t nowMs);
+
+// Órdenes de una tecla por el monitor serie:
+//   'b' -> línea de tiempo del arranque (util/BootTimeline.h)
+void debugPollSerial(const AppContext& ctx);
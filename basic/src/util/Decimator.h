@@ -0,0 +1,108 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// Decimadores baratos para el pipeline multi-tasa de AltimetryService.
+//
+// CicDecimator<N>: filtro CIC (integrador-peine) de orden N con razón R
+// ajustable en tiempo de ejecución. Trabaja en enteros (centímetros): los
+// integradores pueden desbordar sin problema porque la aritmética modular se
+// cancela en los peines, mientras la salida quepa en int64. Coste por
+// muestra de entrada: N sumas; por muestra de salida: N restas.
+// Retardo de grupo: N·(R-1)/2 muestras de entrada.
+//
+// La entrada se da en metros y se cuantiza a ALT_DECIM_SCALE (1 cm).
+
+#ifndef ALT_DECIM_SCALE
+#define ALT_DECIM_SCALE 100.0f   // metros -> centímetros
+#endif
+
+template <uint8_t N>
+class CicDecimator {
+public:
+    static_assert(N >= 1 && N <= 4, "orden CIC 1..4");
+
+    void setRatio(uint16_t r) {
+        if (r == 0) r = 1;
+        if (r == ratio) return;
+        ratio = r;
+        reset();
+    }
+
+    uint16_t getRatio() const { return ratio; }
+
+    void reset() {
+        for (uint8_t i = 0; i < N; ++i) {
+            integ[i] = 0;
+            comb[i]  = 0;
+        }
+        phase  = 0;
+        primed = false;
+    }
+
+    // Añade una muestra (m). Devuelve true cuando hay una salida nueva en 'out'.
+    bool push(float valueM, float& out) {
+        int64_t x = (int64_t)lroundf(valueM * ALT_DECIM_SCALE);
+
+        // Arranque sin transitorio: cargar el estado como si la entrada
+        // hubiera sido constante desde siempre.
+        if (!primed) {
+            prime(x);
+            primed = true;
+        }
+
+        int64_t acc = x;
+        for (uint8_t i = 0; i < N; ++i) {
+            integ[i] += acc;
+            acc = integ[i];
+        }
+        if (++phase < ratio) return false;
+        phase = 0;
+
+        for (uint8_t i = 0; i < N; ++i) {
+            int64_t prev = comb[i];
+            comb[i] = acc;
+            acc    -= prev;
+        }
+        out = (float)acc / (gain() * ALT_DECIM_SCALE);
+        return true;
+    }
+
+    // Retardo de grupo en muestras de entrada.
+    float groupDelaySamples() const { return N * (ratio - 1) * 0.5f; }
+
+private:
+    float gain() const {
+        float g = 1.0f;
+        for (uint8_t i = 0; i < N; ++i) g *= (float)ratio;
+        return g;
+    }
+
+    // Estado estacionario para entrada constante x: el integrador k crece
+    // como un polinomio en n; basta con dejar los peines coherentes con él.
+    void prime(int64_t x) {
+        for (uint8_t i = 0; i < N; ++i) integ[i] = 0;
+        // Simula R·N muestras de x para llenar los peines con historia válida.
+        for (uint16_t rep = 0; rep < N; ++rep) {
+            int64_t acc = 0;
+            for (uint16_t k = 0; k < ratio; ++k) {
+                acc = x;
+                for (uint8_t i = 0; i < N; ++i) {
+                    integ[i] += acc;
+                    acc = integ[i];
+                }
+            }
+            for (uint8_t i = 0; i < N; ++i) {
+                int64_t prev = comb[i];
+                comb[i] = acc;
+                acc    -= prev;
+            }
+        }
+    }
+
+    int64_t  integ[N] = {};
+    int64_t  comb[N]  = {};
+    uint16_t ratio    = 1;
+    uint16_t phase    = 0;
+    bool     primed   = false;
+};
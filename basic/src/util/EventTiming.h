@@ -0,0 +1,254 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "util/PreTriggerBuffer.h"
+
+// Fechado fino de eventos (salida, apertura, aterrizaje) sobre el
+// PreTriggerBuffer, con resolución mejor que el periodo de muestreo.
+//
+// Modelo a tramos lineales de la VS real alrededor del evento:
+//   - tramo "nivel": VS constante antes del evento (avión ≈ 0, caída libre ≈
+//     VS terminal, suelo = 0), estimada como media de las muestras previas;
+//   - tramo "rampa": VS que cambia a ritmo constante desde (o hasta) el
+//     instante del evento t0.
+// Lo que hay en el buffer no es esa VS: AltimetryService la publica como
+// primera diferencia de una altitud suavizada con un EMA, que la retrasa
+// ~(1-α)/α + ½ muestras y redondea la esquina (de ~0.2 s a 25 Hz a ~0.7 s a
+// 6.25 Hz con el gobernador). Por eso el ajuste no corta rectas: para cada t0
+// candidato pasa la rampa modelo por el mismo filtro, con los instantes
+// reales de las muestras, ajusta la pendiente por mínimos cuadrados y se
+// queda con el t0 de menor error. Con Filter{1} (sin filtrar) es el ajuste
+// de una recta de siempre.
+//
+// El nivel se recalcula una vez con la ventana terminada en el t0 estimado,
+// para que las muestras ya en transición no lo sesguen. La altitud del
+// evento se toma de la altitud filtrada un retardo del EMA más tarde,
+// interpolando entre las dos muestras que rodean ese instante.
+
+namespace EventTiming {
+
+struct Event {
+    uint32_t tMs  = 0;
+    float    altM = NAN;
+};
+
+// Filtrado que ya trae el buffer: EMA de coeficiente alpha sobre la altitud
+// (la VS es su primera diferencia). alpha = 1: datos sin filtrar.
+struct Filter {
+    float alpha = 1.0f;
+
+    float lagSamples() const { return (1.0f - alpha) / alpha; }
+};
+
+// Media de VS en [i0, i1]. Devuelve NAN si el rango está vacío.
+inline float meanVs(const PreTriggerBuffer& b, int i0, int i1) {
+    if (i0 < 0) i0 = 0;
+    if (i1 >= (int)b.size()) i1 = (int)b.size() - 1;
+    if (i1 < i0) return NAN;
+    float acc = 0.0f;
+    for (int i = i0; i <= i1; ++i) acc += b.at((size_t)i).vsMps;
+    return acc / (float)(i1 - i0 + 1);
+}
+
+// Media de VS de las muestras con t en [tEnd - windowMs, tEnd).
+inline float levelBefore(const PreTriggerBuffer& b, uint32_t tEnd, uint32_t windowMs, int& iFirst) {
+    iFirst = (int)b.indexAtOrAfter(tEnd - windowMs);
+    int iLast = (int)b.indexAtOrAfter(tEnd) - 1;
+    return meanVs(b, iFirst, iLast);
+}
+
+// Periodo medio de muestreo en [i0, i1] (ms). 0 si no hay dos muestras.
+inline float periodMs(const PreTriggerBuffer& b, int i0, int i1) {
+    if (i0 < 0) i0 = 0;
+    if (i1 >= (int)b.size()) i1 = (int)b.size() - 1;
+    if (i1 <= i0) return 0.0f;
+    return (float)(b.at((size_t)i1).tMs - b.at((size_t)i0).tMs) / (float)(i1 - i0);
+}
+
+// Rampa unitaria (m/s por s) que empieza en t0 (after) o termina en t0
+// (!after), vista como la publica AltimetryService: la VS de cada muestra es
+// el incremento de altitud desde la anterior entre su dt, y luego el EMA.
+// Recorre [iStart, i1] y deja en g[i - iStart] la respuesta en cada muestra.
+// Para !after, el filtro arranca en régimen (la rampa ya venía de antes).
+struct RampModel {
+    const PreTriggerBuffer& b;
+    int    iStart;
+    int    i1;
+    Filter filter;
+    bool   after;
+
+    // Integral de la rampa unitaria hasta t (s relativos a t0).
+    float integral(float x) const {
+        float c = after ? (x > 0.0f ? x : 0.0f) : (x < 0.0f ? x : 0.0f);
+        return 0.5f * c * c;
+    }
+
+    float seconds(int i, uint32_t t0) const {
+        return (float)(int32_t)(b.at((size_t)i).tMs - t0) * 0.001f;
+    }
+
+    // Error cuadrático del mejor ajuste level + k·g en [i0, i1] para este t0.
+    float sse(uint32_t t0, int i0, float level, float& kOut) const {
+        float y = 0.0f;
+        if (!after) {
+            // En régimen, el EMA de una rampa va (1-α)/α muestras (más medio
+            // periodo de la diferencia) por detrás.
+            float T = periodMs(b, iStart, i1) * 0.001f;
+            y = seconds(iStart, t0) - (filter.lagSamples() + 0.5f) * T;
+            if (y > 0.0f) y = 0.0f;
+        }
+        float sgg = 0.0f, sgv = 0.0f, svv = 0.0f;
+        for (int i = iStart + 1; i <= i1; ++i) {
+            float x1 = seconds(i, t0), x0 = seconds(i - 1, t0);
+            float dt = x1 - x0;
+            if (dt <= 0.0f) continue;
+            float raw = (integral(x1) - integral(x0)) / dt;
+            y += filter.alpha * (raw - y);
+            if (i < i0) continue;
+            float v = b.at((size_t)i).vsMps - level;
+            sgg += y * y;
+            sgv += y * v;
+            svv += v * v;
+        }
+        if (sgg < 1e-9f) return INFINITY;
+        kOut = sgv / sgg;
+        return svv - kOut * sgv;
+    }
+};
+
+// Busca t0 en [tLoMs, tHiMs] para el modelo nivel + rampa filtrada ajustado a
+// las muestras [i0, i1]. El filtro corre desde iStart (<= i0). false si hay
+// pocas muestras o la pendiente es casi nula (no es una rampa).
+inline bool rampBreak(const PreTriggerBuffer& b, int iStart, int i0, int i1,
+                      float level, uint32_t tLoMs, uint32_t tHiMs,
+                      const Filter& filter, bool after, uint32_t& tOut) {
+    if (iStart < 0 || i0 < iStart || i1 >= (int)b.size() || i1 - i0 < 1) return false;
+    if ((int32_t)(tHiMs - tLoMs) <= 0) return false;
+
+    RampModel m{b, iStart, i1, filter, after};
+    float T = periodMs(b, i0, i1);
+    uint32_t step = (uint32_t)(T / 8.0f);
+    if (step < 1) step = 1;
+
+    uint32_t best = tLoMs;
+    float    bestErr = INFINITY, bestK = 0.0f, k = 0.0f;
+    for (uint32_t t = tLoMs; (int32_t)(t - tHiMs) <= 0; t += step) {
+        float e = m.sse(t, i0, level, k);
+        if (e < bestErr) { bestErr = e; best = t; bestK = k; }
+    }
+    // Afinado al ms alrededor del mejor punto de la rejilla.
+    uint32_t lo = best - step, hi = best + step;
+    if ((int32_t)(lo - tLoMs) < 0) lo = tLoMs;
+    if ((int32_t)(hi - tHiMs) > 0) hi = tHiMs;
+    for (uint32_t t = lo; (int32_t)(t - hi) <= 0; ++t) {
+        float e = m.sse(t, i0, level, k);
+        if (e < bestErr) { bestErr = e; best = t; bestK = k; }
+    }
+    if (!isfinite(bestErr) || fabsf(bestK) < 0.05f) return false;   // < 0.05 m/s²
+    tOut = best;
+    return true;
+}
+
+// Altitud interpolada linealmente en tMs (NAN si queda fuera del buffer).
+inline float altAt(const PreTriggerBuffer& b, uint32_t tMs) {
+    size_t j = b.indexAtOrAfter(tMs);
+    if (j >= b.size()) return NAN;
+    const FlightSample& s1 = b.at(j);
+    if (s1.tMs == tMs) return s1.altM;
+    if (j == 0) return NAN;
+    const FlightSample& s0 = b.at(j - 1);
+    float f = (float)(tMs - s0.tMs) / (float)(s1.tMs - s0.tMs);
+    return s0.altM + f * (s1.altM - s0.altM);
+}
+
+// Evento en t0: la altitud filtrada refleja la real un retardo del EMA más
+// tarde (exacto con altitud lineal: avión nivelado, VS terminal, vela).
+inline bool finish(const PreTriggerBuffer& b, int i0, int i1, uint32_t t0,
+                   const Filter& filter, Event& ev) {
+    float lagMs = filter.lagSamples() * periodMs(b, i0, i1);
+    ev.tMs  = t0;
+    ev.altM = altAt(b, t0 + (uint32_t)lroundf(lagMs));
+    return isfinite(ev.altM);
+}
+
+// Índice de la primera muestra >= i0 que cumple pred (o -1).
+template <typename Pred>
+inline int firstFrom(const PreTriggerBuffer& b, int i0, Pred pred) {
+    for (int i = (i0 < 0 ? 0 : i0); i < (int)b.size(); ++i) {
+        if (pred(b.at((size_t)i))) return i;
+    }
+    return -1;
+}
+
+// Corte nivel previo a tOn / rampa [r0, r1], con un refinado del nivel.
+inline bool fitBreak(const PreTriggerBuffer& b, int r0, int r1, uint32_t tOn,
+                     uint32_t levelWindowMs, const Filter& filter, uint32_t& tOut) {
+    uint32_t tEnd = tOn;
+    bool ok = false;
+    for (int pass = 0; pass < 2; ++pass) {
+        int iLvl;
+        float lvl = levelBefore(b, tEnd, levelWindowMs, iLvl);
+        if (!isfinite(lvl) || iLvl >= r0) break;
+        uint32_t t;
+        if (!rampBreak(b, iLvl, r0, r1, lvl, b.at((size_t)iLvl).tMs + 1,
+                       b.at((size_t)r1).tMs, filter, true, t)) break;
+        tOut = t;
+        ok   = true;
+        tEnd = t;
+    }
+    return ok;
+}
+
+// Salida: nivel = VS media del avión antes de 'onset' (primera muestra ya
+// cayendo); rampa = muestras entre rampLo y rampHi (m/s, negativas).
+inline bool refineExit(const PreTriggerBuffer& b, int onset, uint32_t levelWindowMs,
+                       float rampLo, float rampHi, const Filter& filter, Event& ev) {
+    if (onset <= 0) return false;
+    int r0 = firstFrom(b, onset, [rampLo](const FlightSample& s) { return s.vsMps < rampLo; });
+    int r1 = firstFrom(b, r0,    [rampHi](const FlightSample& s) { return s.vsMps < rampHi; });
+    if (r0 < 0) return false;
+    if (r1 < 0) r1 = (int)b.size() - 1;
+
+    uint32_t t;
+    if (!fitBreak(b, r0, r1, b.at((size_t)onset).tMs, levelWindowMs, filter, t)) return false;
+    return finish(b, r0, r1, t, filter, ev);
+}
+
+// Apertura: nivel = VS media de caída libre antes de 'onset' (primera muestra
+// ya desacelerando); rampa = muestras con VS entre fracHi·nivel y fracLo·nivel.
+inline bool refineDeploy(const PreTriggerBuffer& b, int onset, uint32_t levelWindowMs,
+                         float fracHi, float fracLo, const Filter& filter, Event& ev) {
+    if (onset <= 0) return false;
+    uint32_t tOn = b.at((size_t)onset).tMs;
+    int iLvl;
+    float lvl = levelBefore(b, tOn, levelWindowMs, iLvl);
+    if (!isfinite(lvl) || lvl >= 0.0f) return false;
+
+    float vHi = fracHi * lvl;   // p.ej. 0.85·VS terminal
+    float vLo = fracLo * lvl;   // p.ej. 0.40·VS terminal
+    int r0 = firstFrom(b, onset, [vHi](const FlightSample& s) { return s.vsMps > vHi; });
+    int r1 = firstFrom(b, r0,    [vLo](const FlightSample& s) { return s.vsMps > vLo; });
+    if (r0 < 0) return false;
+    if (r1 < 0) r1 = (int)b.size() - 1;
+
+    uint32_t t;
+    if (!fitBreak(b, r0, r1, tOn, levelWindowMs, filter, t)) return false;
+    return finish(b, r0, r1, t, filter, ev);
+}
+
+// Aterrizaje: nivel = 0; rampa = últimas muestras de descenso (rampWindowMs)
+// antes de 'onset' (primera muestra ya quieta), que termina en t0.
+inline bool refineLanding(const PreTriggerBuffer& b, int onset, uint32_t rampWindowMs,
+                          const Filter& filter, Event& ev) {
+    if (onset <= 1) return false;
+    uint32_t tOn = b.at((size_t)onset).tMs;
+    int r0 = (int)b.indexAtOrAfter(tOn - rampWindowMs);
+    uint32_t t;
+    if (!rampBreak(b, r0, r0, onset, 0.0f, b.at((size_t)r0).tMs, tOn,
+                   filter, false, t)) return false;
+    return finish(b, r0, onset, t, filter, ev);
+}
+
+} // namespace EventTiming
@@ -0,0 +1,123 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// Filtro de Hampel causal sobre una ventana deslizante de N muestras.
+//
+// Rechaza lecturas aisladas absurdas (una lectura I2C corrupta, el golpe de
+// presión al abrir la puerta del avión) antes de que entren en el EMA y en
+// la VS de AltimetryService:
+//   med = mediana(ventana), MAD = mediana(|x - med|)
+//   si |x - med| > max(HAMPEL_K · 1.4826 · MAD, minThresh) -> x se sustituye
+//   por med y se cuenta como rechazada.
+//
+// - La muestra nueva entra siempre en la ventana (aunque se rechace), así un
+//   cambio real y sostenido se acepta en cuanto ocupa la mitad de la ventana:
+//   retardo máximo (N-1)/2 muestras sólo ante escalones; rampas y ruido
+//   normal pasan sin retardo.
+// - La ventana se mantiene ordenada (inserción O(N)) y el MAD sale del
+//   propio orden con dos punteros desde la mediana, sin ordenar de nuevo.
+// - Sin memoria dinámica. minThresh evita rechazar todo cuando la ventana
+//   es casi constante (MAD ≈ 0, p.ej. lecturas forced repetidas).
+
+#ifndef HAMPEL_K
+#define HAMPEL_K 3.0f
+#endif
+
+template <uint8_t N>
+class HampelFilter {
+public:
+    static_assert(N >= 3 && (N & 1), "ventana impar >= 3");
+
+    explicit HampelFilter(float minThreshold = 0.0f) : minThresh(minThreshold) {}
+
+    void setMinThreshold(float t) { minThresh = t; }
+
+    void reset() {
+        count = 0;
+        head  = 0;
+    }
+
+    // Filtra x. Devuelve true si x se rechazó (out = mediana).
+    bool filter(float x, float& out) {
+        if (!isfinite(x)) {
+            total++;
+            rejected++;
+            out = count ? sorted[count / 2] : x;
+            return true;
+        }
+        insert(x);
+        total++;
+        if (count < N) {
+            out = x;
+            return false;
+        }
+
+        const uint8_t m = N / 2;
+        float med = sorted[m];
+        float mad = madAround(m);
+        float thr = HAMPEL_K * 1.4826f * mad;
+        if (thr < minThresh) thr = minThresh;
+
+        if (fabsf(x - med) > thr) {
+            out = med;
+            rejected++;
+            return true;
+        }
+        out = x;
+        return false;
+    }
+
+    uint32_t getRejected() const { return rejected; }
+    uint32_t getTotal()    const { return total; }
+
+private:
+    // Sustituye la muestra más antigua por x manteniendo 'sorted' ordenada.
+    void insert(float x) {
+        uint8_t pos;
+        if (count < N) {
+            pos = count++;
+        } else {
+            // Quitar la más antigua del orden.
+            float old = ring[head];
+            pos = 0;
+            while (pos < N - 1 && sorted[pos] != old) pos++;
+            for (uint8_t i = pos; i < N - 1; ++i) sorted[i] = sorted[i + 1];
+            pos = N - 1;
+        }
+        ring[head] = x;
+        head = (uint8_t)((head + 1) % N);
+
+        // Inserción ordenada en [0, pos].
+        uint8_t i = pos;
+        while (i > 0 && sorted[i - 1] > x) {
+            sorted[i] = sorted[i - 1];
+            --i;
+        }
+        sorted[i] = x;
+    }
+
+    // Mediana de |sorted[i] - sorted[m]|: las desviaciones crecen hacia
+    // ambos lados desde m, así que basta con fusionar los dos lados.
+    float madAround(uint8_t m) const {
+        float med = sorted[m];
+        int lo = m - 1;
+        int hi = m + 1;
+        float d = 0.0f;                  // la propia mediana: desviación 0
+        for (uint8_t k = 0; k < N / 2; ++k) {
+            float dl = (lo >= 0)     ? med - sorted[lo] : INFINITY;
+            float dh = (hi < (int)N) ? sorted[hi] - med : INFINITY;
+            if (dl <= dh) { d = dl; --lo; }
+            else          { d = dh; ++hi; }
+        }
+        return d;
+    }
+
+    float    ring[N]   = {};
+    float    sorted[N] = {};
+    uint8_t  count     = 0;
+    uint8_t  head      = 0;
+    float    minThresh = 0.0f;
+    uint32_t rejected  = 0;
+    uint32_t total     = 0;
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "util/Types.h"
+
+// Buffer circular de pre-disparo.
+//
+// FlightPhaseService confirma cada transición tras una ventana de persistencia
+// (CLIMB 3 s, FREEFALL 0.4 s, CANOPY 1.5 s, GROUND 2 s) y los grabadores sólo
+// se enteran en ese momento. Este buffer guarda los últimos PRETRIG_WINDOW_MS
+// de muestras para que, al confirmarse una fase, se pueda mirar hacia atrás y
+// encontrar el inicio real del evento (salida, apertura, aterrizaje).
+//
+// - Sin memoria dinámica: capacidad fija PRETRIG_CAPACITY.
+// - Unidades SI (m, m/s, Pa, °C), independientes de la unidad de UI.
+// - Para que siempre quepa la ventana completa, las muestras más seguidas que
+//   PRETRIG_WINDOW_MS / PRETRIG_CAPACITY se ignoran (≈50 Hz con los valores
+//   por defecto).
+
+#ifndef PRETRIG_WINDOW_MS
+#define PRETRIG_WINDOW_MS  20000u
+#endif
+#ifndef PRETRIG_CAPACITY
+#define PRETRIG_CAPACITY   1024u     // 20 B por muestra → 20 KiB
+#endif
+
+struct FlightSample {
+    uint32_t tMs        = 0;
+    float    altM       = 0.0f;
+    float    vsMps      = 0.0f;
+    float    pressurePa = NAN;
+    float    tempC      = NAN;
+};
+
+class PreTriggerBuffer {
+public:
+    static constexpr uint32_t MIN_DT_MS = PRETRIG_WINDOW_MS / PRETRIG_CAPACITY;
+
+    void clear() {
+        head  = 0;
+        count = 0;
+    }
+
+    // Añade la muestra actual (AltitudeData, SI).
+    void push(const AltitudeData& alt, uint32_t nowMs) {
+        if (count > 0 && (nowMs - newest().tMs) < MIN_DT_MS) return;
+
+        FlightSample& s = buf[head];
+        s.tMs        = nowMs;
+        s.altM       = alt.rawAlt.v;
+        s.vsMps      = alt.verticalSpeed.v;
+        s.pressurePa = alt.pressure.v;
+        s.tempC      = alt.temperatureC;
+
+        head = (head + 1) % PRETRIG_CAPACITY;
+        if (count < PRETRIG_CAPACITY) count++;
+    }
+
+    size_t size()  const { return count; }
+    bool   empty() const { return count == 0; }
+
+    // i = 0 es la muestra más antigua.
+    const FlightSample& at(size_t i) const {
+        return buf[(head + PRETRIG_CAPACITY - count + i) % PRETRIG_CAPACITY];
+    }
+
+    const FlightSample& newest() const { return at(count - 1); }
+
+    // Índice de la primera muestra con tMs >= t (size() si no hay).
+    size_t indexAtOrAfter(uint32_t t) const {
+        for (size_t i = 0; i < count; ++i) {
+            if ((int32_t)(at(i).tMs - t) >= 0) return i;
+        }
+        return count;
+    }
+
+    // Recorre hacia atrás desde la muestra más nueva mientras pred(muestra)
+    // sea cierto y tMs >= notBeforeMs. Devuelve el índice de la muestra más
+    // antigua de ese tramo final, o -1 si la más nueva no cumple pred.
+    template <typename Pred>
+    int findRunStart(Pred pred, uint32_t notBeforeMs = 0) const {
+        int start = -1;
+        for (int i = (int)count - 1; i >= 0; --i) {
+            const FlightSample& s = at((size_t)i);
+            if (notBeforeMs && (int32_t)(s.tMs - notBeforeMs) < 0) break;
+            if (!pred(s)) break;
+            start = i;
+        }
+        return start;
+    }
+
+    // VS más negativa entre las muestras con tMs >= fromMs (0 si no hay).
+    float minVsSince(uint32_t fromMs) const {
+        float v = 0.0f;
+        for (size_t i = indexAtOrAfter(fromMs); i < count; ++i) {
+            if (at(i).vsMps < v) v = at(i).vsMps;
+        }
+        return v;
+    }
+
+private:
+    FlightSample buf[PRETRIG_CAPACITY];
+    size_t       head  = 0;
+    size_t       count = 0;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <stdint.h>
+
+// Decisión "¿despertar por subida?" durante deep sleep.
+//
+// C puro, sólo enteros y sin dependencias: lo comparten el firmware (que lo
+// evalúa al arrancar por timer) y cualquier programa para el coprocesador
+// ULP que haga la misma comprobación. También se compila tal cual en host.
+//
+// Entrada: presión compensada en Pa. Estado en memoria RTC entre muestras.
+// - refPa sigue al suelo: baja de golpe con las bajadas (presión que sube) y
+//   se acerca poco a poco (1/2^trackShift por muestra) a las caídas lentas
+//   de presión, que son meteorología y no subida.
+// - Una caída >= climbPa respecto a refPa se confirma con confirmN muestras
+//   seguidas antes de despertar; entre medias se pide una muestra temprana.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int32_t climbPa;      // caída que cuenta como subida (~12 Pa/m a nivel del mar)
+    uint8_t confirmN;     // muestras seguidas por encima del umbral
+    uint8_t trackShift;   // velocidad de seguimiento de la deriva lenta
+} pwm_cfg_t;
+
+typedef struct {
+    uint32_t magic;       // PWM_MAGIC si el estado es válido
+    int32_t  refPa;       // presión de suelo de referencia
+    int32_t  lastPa;
+    uint8_t  hits;        // muestras seguidas por encima del umbral
+    uint8_t  armed;
+    uint16_t samples;     // comprobaciones desde que se armó
+} pwm_state_t;
+
+enum {
+    PWM_SLEEP   = 0,      // seguir durmiendo, periodo normal
+    PWM_CONFIRM = 1,      // posible subida: repetir pronto
+    PWM_WAKE    = 2       // subida confirmada: arrancar
+};
+
+#define PWM_MAGIC     0x50574D31u   // "PWM1"
+#define PWM_MIN_PA    30000         // fuera de rango = lectura inválida
+#define PWM_MAX_PA    110000
+
+static inline void pwm_arm(pwm_state_t* s, int32_t groundPa) {
+    s->magic   = PWM_MAGIC;
+    s->refPa   = groundPa;
+    s->lastPa  = groundPa;
+    s->hits    = 0;
+    s->armed   = (groundPa >= PWM_MIN_PA && groundPa <= PWM_MAX_PA) ? 1 : 0;
+    s->samples = 0;
+}
+
+static inline void pwm_disarm(pwm_state_t* s) {
+    s->armed = 0;
+}
+
+static inline int pwm_is_armed(const pwm_state_t* s) {
+    return s->magic == PWM_MAGIC && s->armed;
+}
+
+static inline int pwm_step(pwm_state_t* s, const pwm_cfg_t* c, int32_t pa) {
+    if (!pwm_is_armed(s)) return PWM_SLEEP;
+    if (pa < PWM_MIN_PA || pa > PWM_MAX_PA) return PWM_SLEEP;   // no tocar el estado
+
+    if (s->samples < 0xFFFF) s->samples++;
+    s->lastPa = pa;
+
+    int32_t drop = s->refPa - pa;          // > 0: la presión bajó (subida)
+    if (drop >= c->climbPa) {
+        if (++s->hits >= c->confirmN) return PWM_WAKE;
+        return PWM_CONFIRM;
+    }
+
+    s->hits = 0;
+    if (drop < 0) {
+        s->refPa = pa;                     // bajamos: el suelo nuevo es éste
+    } else {
+        s->refPa -= drop >> c->trackShift; // deriva lenta
+    }
+    return PWM_SLEEP;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+
+// Publicación sin bloqueo de un valor (un escritor, varios lectores), p.ej.
+// el snapshot de altimetría de SensorTask para la UI.
+//
+// El escritor nunca espera: incrementa la secuencia (impar = escribiendo),
+// copia y la vuelve a incrementar. El lector copia y reintenta si la
+// secuencia cambió por medio. T debe ser copiable con memcpy (sin punteros
+// a sí mismo ni recursos).
+//
+// Ojo: el lector reintenta mientras el escritor esté a medias, así que el
+// escritor no puede ser expulsado por un lector del mismo core. Aquí el
+// escritor es la tarea de mayor prioridad y los lectores están en el otro.
+
+template <typename T>
+class SeqLock {
+public:
+    // Escritor (único).
+    void write(const T& v) {
+        uint32_t s = seq;
+        __atomic_store_n(&seq, s + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        data = v;
+        __atomic_store_n(&seq, s + 2, __ATOMIC_RELEASE);
+    }
+
+    // Copia consistente. Devuelve la secuencia (par) de lo leído: si no
+    // cambia entre dos lecturas, no hay dato nuevo.
+    uint32_t read(T& out) const {
+        for (;;) {
+            uint32_t s0 = __atomic_load_n(&seq, __ATOMIC_ACQUIRE);
+            if (s0 & 1u) continue;
+            out = data;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&seq, __ATOMIC_RELAXED) == s0) return s0;
+        }
+    }
+
+    uint32_t sequence() const { return __atomic_load_n(&seq, __ATOMIC_ACQUIRE) & ~1u; }
+
+private:
+    volatile uint32_t seq = 0;
+    T                 data{};
+};
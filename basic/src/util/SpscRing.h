@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+
+// Cola circular sin bloqueo para un productor y un consumidor (p.ej. ISR ->
+// loop). N potencia de 2. Los índices se publican con release/acquire, así
+// que funciona aunque productor y consumidor estén en cores distintos.
+// Si está llena, push() descarta y cuenta.
+
+template <typename T, uint8_t N>
+class SpscRing {
+public:
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N potencia de 2");
+
+    // Productor.
+    bool push(const T& v) {
+        uint8_t h = head;
+        uint8_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+        if ((uint8_t)(h - t) >= N) {
+            dropped++;
+            return false;
+        }
+        buf[h & (N - 1)] = v;
+        __atomic_store_n(&head, (uint8_t)(h + 1), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Consumidor.
+    bool pop(T& out) {
+        uint8_t t = tail;
+        uint8_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+        if (h == t) return false;
+        out = buf[t & (N - 1)];
+        __atomic_store_n(&tail, (uint8_t)(t + 1), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Consumidor: mira el siguiente sin sacarlo.
+    bool peek(T& out) const {
+        uint8_t t = tail;
+        if (__atomic_load_n(&head, __ATOMIC_ACQUIRE) == t) return false;
+        out = buf[t & (N - 1)];
+        return true;
+    }
+
+    bool empty() const {
+        return __atomic_load_n(&head, __ATOMIC_ACQUIRE) == __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    }
+
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    T                 buf[N];
+    uint8_t           head    = 0;   // escribe el productor
+    uint8_t           tail    = 0;   // escribe el consumidor
+    volatile uint32_t dropped = 0;
+};
@@ -0,0 +1,197 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+// Codec de trazas de vuelo en bloques de tamaño fijo.
+//
+// Cada bloque es autocontenido (se puede decodificar sin los anteriores):
+//  - Cabecera con la primera muestra completa (t0, p0, temp0, alt0, vs0).
+//  - Resto de muestras como varints zigzag:
+//      * tiempo:   delta-of-delta en ms (a ODR estable suele ser 0 → 1 byte)
+//      * presión:  delta-of-delta en décimas de Pa (muestra cruda del BMP390)
+//      * temp.:    delta en centésimas de °C
+//      * altitud:  delta-of-delta en decímetros
+//      * VS:       delta en cm/s
+//
+// El formato está documentado también en tools/decode_trace.py (decoder host).
+
+constexpr uint16_t TRACE_BLOCK_MAGIC   = 0x5254;   // "TR"
+constexpr uint8_t  TRACE_BLOCK_VERSION = 2;
+constexpr size_t   TRACE_BLOCK_SIZE    = 256;
+
+constexpr uint8_t  TRACE_FLAG_FIRST    = 0x01;     // primer bloque del salto
+constexpr uint8_t  TRACE_FLAG_LAST     = 0x02;     // último bloque del salto
+constexpr uint8_t  TRACE_FLAG_TRUNCATED = 0x04;    // (en el último) se perdieron muestras: arena lleno
+
+struct __attribute__((packed)) TraceBlockHeader {
+    uint16_t magic      = TRACE_BLOCK_MAGIC;
+    uint8_t  version    = TRACE_BLOCK_VERSION;
+    uint8_t  flags      = 0;
+    uint32_t jumpId     = 0;     // id del Record de bitácora al que pertenece
+    uint16_t seq        = 0;     // nº de bloque dentro del salto
+    uint16_t count      = 0;     // nº de muestras (incluida la de cabecera)
+    uint16_t payloadLen = 0;     // bytes válidos de payload
+    uint16_t crc16      = 0;     // CRC-CCITT del bloque completo con crc16=0
+    uint32_t t0Ms       = 0;     // millis() de la primera muestra
+    int32_t  alt0Dm     = 0;     // altitud en decímetros
+    int16_t  vs0Cms     = 0;     // velocidad vertical en cm/s
+    uint32_t p0Dpa      = 0;     // presión en décimas de Pa
+    int16_t  temp0Cc    = 0;     // temperatura en centésimas de °C
+};
+static_assert(sizeof(TraceBlockHeader) == 32, "TraceBlockHeader: cambiar también tools/decode_trace.py");
+
+constexpr size_t TRACE_PAYLOAD_SIZE = TRACE_BLOCK_SIZE - sizeof(TraceBlockHeader);
+
+struct TraceBlock {
+    TraceBlockHeader hdr;
+    uint8_t          payload[TRACE_PAYLOAD_SIZE];
+};
+static_assert(sizeof(TraceBlock) == TRACE_BLOCK_SIZE, "TraceBlock debe medir TRACE_BLOCK_SIZE");
+
+namespace TraceCodec {
+
+inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Escribe un varint LEB128. Devuelve bytes escritos (máx. 5).
+inline size_t putVarint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// Lee un varint LEB128. Devuelve bytes consumidos, 0 si está truncado.
+inline size_t getVarint(const uint8_t* in, size_t avail, uint32_t& v) {
+    v = 0;
+    for (size_t i = 0; i < avail && i < 5; ++i) {
+        v |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+inline uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; ++b) crc = (crc & 0x8000) ? ((crc<<1) ^ 0x1021) : (crc<<1);
+    }
+    return crc;
+}
+
+inline int32_t toDm(float meters)  { return (int32_t)lroundf(meters * 10.0f); }
+inline int32_t toDpa(float pa)     { return (pa > 0.0f) ? (int32_t)lroundf(pa * 10.0f) : 0; }
+inline int16_t toCms(float mps) {
+    float v = mps * 100.0f;
+    if (v >  32767.0f) v =  32767.0f;
+    if (v < -32768.0f) v = -32768.0f;
+    return (int16_t)lroundf(v);
+}
+inline int16_t toCc(float c, int16_t fallback) {
+    if (!isfinite(c)) return fallback;            // sin temperatura: repetir la anterior
+    float v = c * 100.0f;
+    if (v >  32767.0f) v =  32767.0f;
+    if (v < -32768.0f) v = -32768.0f;
+    return (int16_t)lroundf(v);
+}
+
+// Recalcula el CRC de un bloque ya cerrado (p.ej. tras reetiquetar jumpId).
+inline void seal(TraceBlock& b) {
+    b.hdr.crc16 = 0;
+    b.hdr.crc16 = crc16(reinterpret_cast<const uint8_t*>(&b), sizeof(b));
+}
+
+// Codificador incremental de un bloque.
+class Encoder {
+public:
+    void start(TraceBlock* b, uint32_t jumpId, uint16_t seq) {
+        blk = b;
+        *blk = TraceBlock{};
+        blk->hdr.jumpId = jumpId;
+        blk->hdr.seq    = seq;
+    }
+
+    // Intenta añadir una muestra. Devuelve false si no cabe (bloque lleno).
+    bool add(uint32_t tMs, float pressurePa, float tempC, float altM, float vsMps) {
+        if (!blk) return false;
+        int32_t pDpa  = toDpa(pressurePa);
+        int16_t tCc   = toCc(tempC, prevTemp);
+        int32_t altDm = toDm(altM);
+        int16_t vsCms = toCms(vsMps);
+
+        if (blk->hdr.count == 0) {
+            blk->hdr.t0Ms    = tMs;
+            blk->hdr.p0Dpa   = (uint32_t)pDpa;
+            blk->hdr.temp0Cc = tCc;
+            blk->hdr.alt0Dm  = altDm;
+            blk->hdr.vs0Cms  = vsCms;
+            blk->hdr.count   = 1;
+            prevT    = tMs;   prevDt   = 0;
+            prevP    = pDpa;  prevDP   = 0;
+            prevTemp = tCc;
+            prevAlt  = altDm; prevDAlt = 0;
+            prevVs   = vsCms;
+            return true;
+        }
+
+        int32_t dt   = (int32_t)(tMs - prevT);
+        int32_t dP   = pDpa - prevP;
+        int32_t dAlt = altDm - prevAlt;
+
+        uint8_t tmp[25];
+        size_t  n = 0;
+        n += putVarint(tmp + n, zigzag(dt - prevDt));
+        n += putVarint(tmp + n, zigzag(dP - prevDP));
+        n += putVarint(tmp + n, zigzag((int32_t)tCc - (int32_t)prevTemp));
+        n += putVarint(tmp + n, zigzag(dAlt - prevDAlt));
+        n += putVarint(tmp + n, zigzag((int32_t)vsCms - (int32_t)prevVs));
+
+        if (blk->hdr.payloadLen + n > TRACE_PAYLOAD_SIZE) return false;
+
+        memcpy(blk->payload + blk->hdr.payloadLen, tmp, n);
+        blk->hdr.payloadLen += (uint16_t)n;
+        blk->hdr.count++;
+
+        prevT    = tMs;   prevDt   = dt;
+        prevP    = pDpa;  prevDP   = dP;
+        prevTemp = tCc;
+        prevAlt  = altDm; prevDAlt = dAlt;
+        prevVs   = vsCms;
+        return true;
+    }
+
+    // Cierra el bloque (flags + CRC). Tras esto no se deben añadir muestras.
+    void finish(uint8_t flags) {
+        if (!blk) return;
+        blk->hdr.flags |= flags;
+        seal(*blk);
+        blk = nullptr;
+    }
+
+    bool     active() const { return blk != nullptr; }
+    uint16_t count()  const { return blk ? blk->hdr.count : 0; }
+
+private:
+    TraceBlock* blk = nullptr;
+    uint32_t prevT    = 0;
+    int32_t  prevDt   = 0;
+    int32_t  prevP    = 0;
+    int32_t  prevDP   = 0;
+    int16_t  prevTemp = 0;
+    int32_t  prevAlt  = 0;
+    int32_t  prevDAlt = 0;
+    int16_t  prevVs   = 0;
+};
+
+} // namespace TraceCodec
@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "util/Units.h"
 
 // Enum definitions and simple structs used throughout the firmware.
 
@@ -52,13 +53,15 @@ enum class FlightPhase : uint8_t {
 
 // Struct representing altitude and motion information.  Computed by
 // AltimetryService and used by higher‑level components to decide
-// behaviour.
+// behaviour.  Always SI (see util/Units.h); the user's unit is only
+// applied when presenting.
 struct AltitudeData {
-    float altToShow      = 0.0f; // formatted altitude for UI display
-    float rawAlt         = 0.0f; // raw altitude relative to reference
-    float verticalSpeed  = 0.0f; // vertical speed in m/s or ft/s
-    bool  isGroundStable = true; // whether the ground altitude is stable
-    float temperatureC   = NAN;  // ambient temperature (C) from BMP390
+    Meters          altToShow;             // altitude for UI display (decimated, deadband)
+    Meters          rawAlt;                // altitude relative to the user's zero
+    MetersPerSecond verticalSpeed;         // filtered vertical speed
+    bool            isGroundStable = true; // whether the ground altitude is stable
+    float           temperatureC   = NAN;  // ambient temperature (C) from BMP390
+    Pascals         pressure{NAN};         // last raw pressure sample from BMP390
 };
 
 struct UtcDateTime {
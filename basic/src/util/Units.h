@@ -0,0 +1,76 @@
+#pragma once
+#include <math.h>
+
+// Magnitudes con unidad, sin coste en tiempo de ejecución.
+//
+// Internamente todo el firmware trabaja en SI (m, m/s, Pa). Cada magnitud es
+// un float envuelto en un tipo distinto, así que no se puede mezclar metros
+// con pies (ni altitud con velocidad) sin una conversión explícita:
+//
+//   Meters h = alt.rawAlt;          // ok
+//   Meters h = Feet(1000.0f);       // no compila
+//   Meters h = toMeters(Feet(1000)); // ok, conversión constexpr
+//
+// La unidad de usuario (Settings::unidadMetros) sólo se aplica en la capa de
+// presentación (pantalla, BLE), ver util/AltFormat.h.
+
+template <typename Tag>
+struct Quantity {
+    float v = 0.0f;
+
+    constexpr Quantity() = default;
+    constexpr explicit Quantity(float x) : v(x) {}
+
+    constexpr Quantity operator+(Quantity o) const { return Quantity(v + o.v); }
+    constexpr Quantity operator-(Quantity o) const { return Quantity(v - o.v); }
+    constexpr Quantity operator-()           const { return Quantity(-v); }
+    constexpr Quantity operator*(float k)    const { return Quantity(v * k); }
+    constexpr Quantity operator/(float k)    const { return Quantity(v / k); }
+    constexpr float    operator/(Quantity o) const { return v / o.v; }   // razón adimensional
+
+    Quantity& operator+=(Quantity o) { v += o.v; return *this; }
+    Quantity& operator-=(Quantity o) { v -= o.v; return *this; }
+
+    constexpr bool operator< (Quantity o) const { return v <  o.v; }
+    constexpr bool operator> (Quantity o) const { return v >  o.v; }
+    constexpr bool operator<=(Quantity o) const { return v <= o.v; }
+    constexpr bool operator>=(Quantity o) const { return v >= o.v; }
+    constexpr bool operator==(Quantity o) const { return v == o.v; }
+    constexpr bool operator!=(Quantity o) const { return v != o.v; }
+};
+
+template <typename Tag>
+constexpr Quantity<Tag> operator*(float k, Quantity<Tag> q) { return q * k; }
+
+template <typename Tag>
+inline Quantity<Tag> qabs(Quantity<Tag> q) { return Quantity<Tag>(fabsf(q.v)); }
+
+template <typename Tag>
+inline bool qfinite(Quantity<Tag> q) { return isfinite(q.v); }
+
+struct MetersTag;
+struct FeetTag;
+struct MetersPerSecondTag;
+struct FeetPerSecondTag;
+struct PascalsTag;
+
+using Meters          = Quantity<MetersTag>;
+using Feet            = Quantity<FeetTag>;
+using MetersPerSecond = Quantity<MetersPerSecondTag>;
+using FeetPerSecond   = Quantity<FeetPerSecondTag>;
+using Pascals         = Quantity<PascalsTag>;
+
+constexpr float FT_PER_M = 3.2808399f;
+
+constexpr Feet            toFeet(Meters m)                    { return Feet(m.v * FT_PER_M); }
+constexpr Meters          toMeters(Feet f)                    { return Meters(f.v / FT_PER_M); }
+constexpr FeetPerSecond   toFeetPerSecond(MetersPerSecond s)  { return FeetPerSecond(s.v * FT_PER_M); }
+constexpr MetersPerSecond toMetersPerSecond(FeetPerSecond s)  { return MetersPerSecond(s.v / FT_PER_M); }
+
+// Velocidad media: distancia / tiempo (s).
+constexpr MetersPerSecond perSecond(Meters d, float seconds) { return MetersPerSecond(d.v / seconds); }
+
+constexpr Meters          operator"" _m  (long double x)        { return Meters((float)x); }
+constexpr Meters          operator"" _m  (unsigned long long x) { return Meters((float)x); }
+constexpr MetersPerSecond operator"" _mps(long double x)        { return MetersPerSecond((float)x); }
+constexpr MetersPerSecond operator"" _mps(unsigned long long x) { return MetersPerSecond((float)x); }
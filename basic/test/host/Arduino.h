@@ -0,0 +1,113 @@
+#pragma once
+// Arduino mínimo para los tests de host (pio test -e native).
+//
+// El tiempo es virtual: millis()/micros() sólo avanzan con host::advanceMs()
+// o delay(), así los tests temporizados son deterministas. Serial descarta
+// la salida salvo con host::serialEcho = true.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <string>
+
+#define F(x)          x
+#define PROGMEM
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#define HIGH 1
+#define LOW  0
+#define INPUT             0x01
+#define OUTPUT            0x03
+#define INPUT_PULLUP      0x05
+#define INPUT_PULLDOWN    0x09
+#define OUTPUT_OPEN_DRAIN 0x13
+#define CHANGE  3
+#define RISING  1
+#define FALLING 2
+
+namespace host {
+inline std::atomic<uint64_t> nowUs{0};
+inline bool serialEcho = false;
+inline uint8_t pinLevel[64] = {};
+inline uint8_t pinModes[64] = {};
+
+inline void setMs(uint32_t ms)     { nowUs = (uint64_t)ms * 1000u; }
+inline void advanceMs(uint32_t ms) { nowUs += (uint64_t)ms * 1000u; }
+inline void advanceUs(uint32_t us) { nowUs += us; }
+}
+
+inline uint32_t millis() { return (uint32_t)(host::nowUs.load() / 1000u); }
+inline uint32_t micros() { return (uint32_t)host::nowUs.load(); }
+inline void delay(uint32_t ms)             { host::advanceMs(ms); }
+inline void delayMicroseconds(uint32_t us) { host::advanceUs(us); }
+
+// Pines: con INPUT_PULLUP (o sin tocar) se leen altos, como el bus I2C en reposo.
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    host::pinModes[pin & 63] = mode;
+    if (mode == INPUT_PULLUP) host::pinLevel[pin & 63] = HIGH;
+}
+inline void digitalWrite(uint8_t pin, uint8_t v) { host::pinLevel[pin & 63] = v ? HIGH : LOW; }
+inline int  digitalRead(uint8_t pin) {
+    uint8_t m = host::pinModes[pin & 63];
+    return (m == 0) ? HIGH : host::pinLevel[pin & 63];
+}
+
+inline bool psramFound() { return false; }
+
+// String de Arduino, lo justo para SettingsService.
+class String {
+public:
+    String(const char* c = "") : s(c ? c : "") {}
+    unsigned    length() const { return (unsigned)s.size(); }
+    const char* c_str()  const { return s.c_str(); }
+    void toCharArray(char* buf, unsigned n) const {
+        if (!n) return;
+        strncpy(buf, s.c_str(), n - 1);
+        buf[n - 1] = '\0';
+    }
+private:
+    std::string s;
+};
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    int  printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        if (!host::serialEcho) return 0;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vprintf(fmt, ap);
+        va_end(ap);
+        return n;
+    }
+    void print(const char* s)             { if (host::serialEcho) fputs(s, stdout); }
+    void print(char c)                    { if (host::serialEcho) putchar(c); }
+    void print(int v)                     { printf("%d", v); }
+    void print(unsigned v)                { printf("%u", v); }
+    void print(long v)                    { printf("%ld", v); }
+    void print(unsigned long v)           { printf("%lu", v); }
+    void print(double v, int digits = 2)  { printf("%.*f", digits, v); }
+    template <typename T> void println(T v) { print(v); println(); }
+    void println(double v, int digits)    { print(v, digits); println(); }
+    void println()                        { if (host::serialEcho) putchar('\n'); }
+    void flush()                          {}
+    int  available()                      { return 0; }
+    int  read()                           { return -1; }
+};
+
+inline HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getCycleCount() const { return micros() * 240u; }
+    uint32_t getFreeHeap()   const { return 256u * 1024u; }
+    uint32_t getCpuFreqMHz() const { return 240; }
+};
+
+inline EspClass ESP;
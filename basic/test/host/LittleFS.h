@@ -0,0 +1,72 @@
+#pragma once
+// LittleFS de host: un directorio real (HOST_FS_ROOT) hace de partición.
+// LogbookService/TraceStore también acceden por POSIX; sus rutas se
+// redirigen aquí antes de que los headers pongan las de /littlefs.
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef HOST_FS_ROOT
+#define HOST_FS_ROOT "/tmp/alti_host_fs"
+#endif
+#define LOGBOOK_POSIX_PATH     HOST_FS_ROOT LOGBOOK_FILE_PATH
+#define LOGBOOK_EXT_POSIX_PATH HOST_FS_ROOT LOGBOOK_EXT_FILE_PATH
+#define TRACE_POSIX_PATH       HOST_FS_ROOT TRACE_FILE_PATH
+
+class File {
+public:
+    File() = default;
+    explicit File(FILE* f) : fp(f) {}
+    explicit operator bool() const { return fp != nullptr; }
+    size_t write(const uint8_t* b, size_t n) { return fp ? fwrite(b, 1, n, fp) : 0; }
+    size_t read(uint8_t* b, size_t n)        { return fp ? fread(b, 1, n, fp) : 0; }
+    void   close() { if (fp) fclose(fp); fp = nullptr; }
+private:
+    FILE* fp = nullptr;
+};
+
+class HostLittleFS {
+public:
+    bool begin(bool = false, const char* = "/littlefs", uint8_t = 5, const char* = "spiffs") {
+        if (failMount) return false;
+        mkdir(HOST_FS_ROOT, 0777);
+        mounts++;
+        return true;
+    }
+    void end() {}
+    bool format() { wipe(); return true; }
+    File open(const char* path, const char* mode) {
+        return File(fopen(full(path).c_str(), (mode[0] == 'w') ? "wb" : (mode[0] == 'a') ? "ab" : "rb"));
+    }
+    // Bytes por bloques de 4 KiB, como LittleFS (más el par del directorio raíz).
+    size_t totalBytes() { return totalBytesHost; }
+    size_t usedBytes() {
+        size_t used = 2 * BLOCK;
+        for (const char* f : {"/logbook.bin", "/logbook_ext.bin", "/trace.bin"}) {
+            struct stat st;
+            if (stat(full(f).c_str(), &st) == 0) used += ((size_t)st.st_size + BLOCK - 1) / BLOCK * BLOCK;
+        }
+        return used + extraUsedBytes;
+    }
+    bool exists(const char* path) { struct stat st; return stat(full(path).c_str(), &st) == 0; }
+    bool remove(const char* path) { return ::unlink(full(path).c_str()) == 0; }
+
+    // Para los tests: partición vacía.
+    void wipe() {
+        ::unlink(HOST_FS_ROOT "/logbook.bin");
+        ::unlink(HOST_FS_ROOT "/logbook_ext.bin");
+        ::unlink(HOST_FS_ROOT "/trace.bin");
+    }
+
+    bool   failMount      = false;
+    int    mounts         = 0;
+    size_t totalBytesHost = 0xF0000;   // partición 'spiffs'
+    size_t extraUsedBytes = 0;         // otros archivos simulados
+
+private:
+    static constexpr size_t BLOCK = 4096;
+    static std::string full(const char* path) { return std::string(HOST_FS_ROOT) + path; }
+};
+
+inline HostLittleFS LittleFS;
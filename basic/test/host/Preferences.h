@@ -0,0 +1,58 @@
+#pragma once
+// NVS de host: un mapa en memoria compartido por todas las instancias.
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* ns, bool = false) { space = ns; return true; }
+    void end() {}
+    bool clear() { store().erase(space); return true; }
+
+    uint8_t getUChar(const char* k, uint8_t d = 0) const { return get(k, d); }
+    float   getFloat(const char* k, float d = 0.0f) const { return get(k, d); }
+    bool    getBool(const char* k, bool d = false) const  { return get(k, d); }
+    size_t  putUChar(const char* k, uint8_t v) { return put(k, &v, sizeof(v)); }
+    size_t  putFloat(const char* k, float v)   { return put(k, &v, sizeof(v)); }
+    size_t  putBool(const char* k, bool v)     { return put(k, &v, sizeof(v)); }
+    size_t  putBytes(const char* k, const void* v, size_t n) { return put(k, v, n); }
+    size_t  getBytes(const char* k, void* out, size_t n) const {
+        const std::vector<uint8_t>* v = find(k);
+        if (!v || v->size() > n) return 0;
+        memcpy(out, v->data(), v->size());
+        return v->size();
+    }
+    size_t  putString(const char* k, const char* v) { return put(k, v, strlen(v) + 1); }
+    size_t  putString(const char* k, const String& v) { return putString(k, v.c_str()); }
+    String  getString(const char* k, const char* d = "") const {
+        const std::vector<uint8_t>* v = find(k);
+        return v ? String((const char*)v->data()) : String(d);
+    }
+
+private:
+    using Space = std::map<std::string, std::vector<uint8_t>>;
+    static std::map<std::string, Space>& store() {
+        static std::map<std::string, Space> s;
+        return s;
+    }
+    const std::vector<uint8_t>* find(const char* k) const {
+        auto& sp = store()[space];
+        auto it = sp.find(k);
+        return it == sp.end() ? nullptr : &it->second;
+    }
+    template <typename T> T get(const char* k, T d) const {
+        const std::vector<uint8_t>* v = find(k);
+        if (!v || v->size() != sizeof(T)) return d;
+        T out;
+        memcpy(&out, v->data(), sizeof(T));
+        return out;
+    }
+    size_t put(const char* k, const void* v, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(v);
+        store()[space][k] = std::vector<uint8_t>(b, b + n);
+        return n;
+    }
+    std::string space;
+};
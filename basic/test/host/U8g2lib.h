@@ -0,0 +1,8 @@
+#pragma once
+// U8g2 de host: sólo las fuentes que nombra include/config_ui.h.
+#include <stdint.h>
+
+inline const uint8_t u8g2_font_logisoso32_tn[1] = {0};
+inline const uint8_t u8g2_font_logisoso50_tn[1] = {0};
+inline const uint8_t u8g2_font_6x10_tf[1]       = {0};
+inline const uint8_t u8g2_font_6x13_tf[1]       = {0};
@@ -0,0 +1,84 @@
+#pragma once
+// Wire de host con dispositivos simulados e inyección de fallos.
+//
+// Cada dirección se comporta según su HostI2cDevice: ausente (NACK), fallo
+// programado (código de endTransmission) o datos de lectura. Registra el
+// orden de las transacciones y el reloj con que se hizo cada una.
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <vector>
+
+struct HostI2cDevice {
+    bool     present  = true;
+    uint8_t  failCode = 0;        // !=0: endTransmission devuelve esto (2 = NACK, 5 = timeout)
+    uint32_t failNext = 0;        // fallos pendientes (con failCode); 0xFFFFFFFF = siempre
+    uint8_t  fill     = 0;        // byte que devuelve cada lectura (reg + fill)
+};
+
+struct HostI2cXfer {
+    uint8_t  addr;
+    uint8_t  reg;
+    uint32_t hz;
+    bool     ok;
+};
+
+class TwoWire {
+public:
+    bool begin(int, int, uint32_t = 0) { begins++; return true; }
+    void end() {}
+    void setClock(uint32_t hz) { clockHz = hz; clockSets++; }
+    void setTimeOut(uint16_t ms) { timeoutMs = ms; }
+
+    void beginTransmission(uint8_t a) { addr = a; txLen = 0; }
+    size_t write(uint8_t b) { if (txLen < sizeof(tx)) tx[txLen++] = b; return 1; }
+
+    uint8_t endTransmission(bool = true) {
+        HostI2cDevice& d = dev[addr & 0x7F];
+        uint8_t err = 0;
+        if (!d.present) {
+            err = 2;
+        } else if (d.failNext) {
+            if (d.failNext != 0xFFFFFFFFu) d.failNext--;
+            err = d.failCode ? d.failCode : 2;
+        }
+        log.push_back({addr, txLen ? tx[0] : (uint8_t)0, clockHz, err == 0});
+        if (onXfer) onXfer(log.back());
+        return err;
+    }
+
+    uint8_t requestFrom(uint8_t a, uint8_t n) {
+        rxPos = 0;
+        rxLen = n;
+        rxVal = (uint8_t)((txLen ? tx[0] : 0) + dev[a & 0x7F].fill);
+        return n;
+    }
+    int available() { return rxPos < rxLen ? (int)(rxLen - rxPos) : 0; }
+    int read()      { if (rxPos >= rxLen) return -1; rxPos++; return rxVal; }
+
+    // Estado del simulador (los tests lo leen y lo programan).
+    HostI2cDevice            dev[128];
+    std::vector<HostI2cXfer> log;
+    std::function<void(const HostI2cXfer&)> onXfer;
+    uint32_t clockHz   = 100000;
+    uint32_t clockSets = 0;
+    uint16_t timeoutMs = 50;
+    uint32_t begins    = 0;
+
+    void reset() {
+        for (auto& d : dev) d = HostI2cDevice{};
+        log.clear();
+        onXfer    = nullptr;
+        clockHz   = 100000;
+        clockSets = 0;
+        begins    = 0;
+    }
+
+private:
+    uint8_t addr  = 0;
+    uint8_t tx[64];
+    uint8_t txLen = 0;
+    uint8_t rxPos = 0, rxLen = 0, rxVal = 0;
+};
+
+inline TwoWire Wire;
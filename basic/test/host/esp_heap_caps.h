@@ -0,0 +1,8 @@
+#pragma once
+#include <stdlib.h>
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+inline void*  heap_caps_malloc(size_t n, uint32_t) { return malloc(n); }
+inline size_t heap_caps_get_free_size(uint32_t)   { return 0; }
@@ -0,0 +1,8 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+inline int esp_efuse_mac_get_default(uint8_t* mac) {
+    static const uint8_t m[6] = {0x24, 0x6F, 0x28, 0x12, 0x34, 0x56};
+    memcpy(mac, m, 6);
+    return 0;
+}
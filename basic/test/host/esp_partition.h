@@ -0,0 +1,6 @@
+#pragma once
+#include <stdint.h>
+typedef struct { const char* label; uint32_t address; uint32_t size; } esp_partition_t;
+#define ESP_PARTITION_TYPE_DATA   1
+#define ESP_PARTITION_SUBTYPE_ANY 0xff
+inline const esp_partition_t* esp_partition_find_first(int, int, const char*) { return nullptr; }
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+namespace host {
+// Motivo del último reset que devuelve esp_reset_reason().
+inline esp_reset_reason_t resetReason = ESP_RST_POWERON;
+}
+
+inline void esp_restart() {}
+inline esp_reset_reason_t esp_reset_reason() { return host::resetReason; }
@@ -0,0 +1,31 @@
+#pragma once
+// FreeRTOS de host sobre std::thread (tests nativos). Un tick = 1 ms real
+// para las esperas de colas y semáforos; millis() sigue siendo virtual.
+#include <stdint.h>
+#include <mutex>
+
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t     TickType_t;
+
+#define pdTRUE          1
+#define pdFALSE         0
+#define pdPASS          1
+#define pdFAIL          0
+#define portMAX_DELAY   0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+
+// Las secciones críticas son un mutex recursivo por instancia.
+struct portMUX_TYPE {
+    std::recursive_mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux)     ((mux)->m.lock())
+#define portEXIT_CRITICAL(mux)      ((mux)->m.unlock())
+#define portENTER_CRITICAL_ISR(mux) ((mux)->m.lock())
+#define portEXIT_CRITICAL_ISR(mux)  ((mux)->m.unlock())
+#define portYIELD_FROM_ISR(...)
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
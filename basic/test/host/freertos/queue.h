@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <string.h>
+#include "FreeRTOS.h"
+
+struct HostQueue {
+    std::mutex              m;
+    std::condition_variable cv;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t len  = 0;
+    UBaseType_t size = 0;
+};
+typedef HostQueue* QueueHandle_t;
+
+namespace host {
+template <typename Pred>
+inline bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lk,
+                    TickType_t ticks, Pred pred) {
+    if (ticks == portMAX_DELAY) { cv.wait(lk, pred); return true; }
+    return cv.wait_for(lk, std::chrono::milliseconds(ticks), pred);
+}
+}
+
+inline QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t itemSize) {
+    HostQueue* q = new HostQueue();
+    q->len  = len;
+    q->size = itemSize;
+    return q;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lk(q->m);
+    if (!host::waitFor(q->cv, lk, ticks, [q] { return q->items.size() < q->len; })) return pdFALSE;
+    const uint8_t* p = static_cast<const uint8_t*>(item);
+    q->items.emplace_back(p, p + q->size);
+    q->cv.notify_all();
+    return pdTRUE;
+}
+#define xQueueSendToBack xQueueSend
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t*) {
+    return xQueueSend(q, item, 0);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void* out, TickType_t ticks) {
+    std::unique_lock<std::mutex> lk(q->m);
+    if (!host::waitFor(q->cv, lk, ticks, [q] { return !q->items.empty(); })) return pdFALSE;
+    memcpy(out, q->items.front().data(), q->size);
+    q->items.pop_front();
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lk(q->m);
+    return (UBaseType_t)q->items.size();
+}
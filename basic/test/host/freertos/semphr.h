@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "FreeRTOS.h"
+
+struct HostSemaphore {
+    std::recursive_timed_mutex m;
+};
+typedef HostSemaphore* SemaphoreHandle_t;
+
+namespace host {
+// Tareas bloqueadas ahora mismo en xSemaphoreTake (para sincronizar tests).
+inline std::atomic<int> blockedTakes{0};
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()          { return new HostSemaphore(); }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new HostSemaphore(); }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+    if (s->m.try_lock()) return pdTRUE;
+    if (ticks == 0) return pdFALSE;
+    host::blockedTakes++;
+    bool ok = true;
+    if (ticks == portMAX_DELAY) s->m.lock();
+    else ok = s->m.try_lock_for(std::chrono::milliseconds(ticks));
+    host::blockedTakes--;
+    return ok ? pdTRUE : pdFALSE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) { s->m.unlock(); return pdTRUE; }
+#define xSemaphoreTakeRecursive xSemaphoreTake
+#define xSemaphoreGiveRecursive xSemaphoreGive
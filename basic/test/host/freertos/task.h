@@ -0,0 +1,23 @@
+#pragma once
+#include <thread>
+#include <chrono>
+#include "FreeRTOS.h"
+#include <Arduino.h>
+
+// Cada tarea es un std::thread separado; nunca termina (como en el firmware).
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    std::thread t(fn, arg);
+    if (handle) *handle = reinterpret_cast<TaskHandle_t>(t.native_handle());
+    t.detach();
+    return pdPASS;
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+inline TickType_t xTaskGetTickCount() { return millis(); }
+inline void vTaskDelayUntil(TickType_t* last, TickType_t period) {
+    vTaskDelay(period);
+    *last += period;
+}
@@ -0,0 +1,180 @@
+// AltitudeHistory (util/AltitudeHistory.h): consultas por ventana sobre
+// series conocidas (altitud = función del tiempo, VS por segundo), en las
+// tres resoluciones, con huecos, re-cero y vuelta de los anillos.
+#include <unity.h>
+#include <math.h>
+
+#include "util/AltitudeHistory.h"
+
+namespace {
+
+constexpr uint32_t STEP_MS = 100;   // 10 Hz
+
+AltitudeHistory gHist;
+
+// Empuja [fromMs, toMs) a 10 Hz con altitud = slope·t(s) + off y VS = vs(seg).
+template <typename VsFn>
+void feed(uint32_t fromMs, uint32_t toMs, float slope, float off, VsFn vs) {
+    for (uint32_t t = fromMs; t < toMs; t += STEP_MS) {
+        gHist.push(t, slope * (t * 0.001f) + off, vs(t / 1000u));
+    }
+}
+void feed(uint32_t fromMs, uint32_t toMs, float slope = 1.0f, float off = 0.0f) {
+    feed(fromMs, toMs, slope, off, [](uint32_t) { return 0.0f; });
+}
+
+// Media exacta de slope·t + off sobre las muestras de [s0, s1) s.
+float meanAlt(uint32_t s0, uint32_t s1, float slope = 1.0f, float off = 0.0f) {
+    // t = s0 .. s1 - 0.1 en pasos de 0.1 s
+    return slope * ((float)s0 + (float)s1 - 0.1f) * 0.5f + off;
+}
+
+} // namespace
+
+void setUp()    { gHist.reset(); }
+void tearDown() {}
+
+// Sólo cuentan los segundos cerrados: el segundo en curso queda fuera.
+void test_window_covers_closed_seconds_only() {
+    feed(0, 30000);
+    gHist.push(30000, 30.0f, 0.0f);             // abre el segundo 30, cierra el 29
+    gHist.push(30500, 1000.0f, 0.0f);           // aún abierto: no debe verse
+
+    AltitudeHistory::Window w;
+    TEST_ASSERT_TRUE(gHist.window(30500, 10, w));
+    TEST_ASSERT_EQUAL_UINT32(10, w.seconds);
+    TEST_ASSERT_EQUAL_UINT32(100, w.samples);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 20.0f, w.altMin);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 29.9f, w.altMax);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, meanAlt(20, 30), w.altMean);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 9.9f, w.altRange());
+
+    TEST_ASSERT_FALSE(gHist.window(30500, 0, w));
+}
+
+// Un hueco (sensor parado) no aparece: menos segundos que los pedidos.
+void test_gap_reduces_seconds() {
+    feed(0, 10001);                                 // hasta el segundo 10 (abierto)
+
+    // Ventana entera dentro del hueco: nada.
+    AltitudeHistory::Window w;
+    TEST_ASSERT_FALSE(gHist.window(14000, 3, w));   // 11..13
+
+    feed(15000, 20001);
+    TEST_ASSERT_TRUE(gHist.window(20000, 20, w));   // 0..19 sin 11..14
+    TEST_ASSERT_EQUAL_UINT32(16, w.seconds);
+    TEST_ASSERT_EQUAL_UINT32(151, w.samples);
+    TEST_ASSERT_TRUE(gHist.window(20000, 5, w));    // 15..19
+    TEST_ASSERT_EQUAL_UINT32(5, w.seconds);
+}
+
+// Extremos por muestra y extremos de la VS media por segundo.
+void test_vs_sample_and_mean_extremes() {
+    // VS por segundo: 0, 1, 2, ..., 9 y una muestra suelta de -5 en el segundo 4.
+    for (uint32_t t = 0; t < 10000; t += STEP_MS) {
+        float vs = (float)(t / 1000u);
+        if (t == 4500) vs = -5.0f;
+        gHist.push(t, 0.0f, vs);
+    }
+    gHist.push(10000, 0.0f, 0.0f);
+
+    AltitudeHistory::Window w;
+    TEST_ASSERT_TRUE(gHist.window(10000, 10, w));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -5.0f, w.vsMin);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 9.0f, w.vsMax);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, w.vsMeanMin);                   // segundo 0
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 9.0f, w.vsMeanMax);                   // segundo 9
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 9.0f, w.vsMeanAbsMax());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, (45.0f * 10.0f - 9.0f) / 100.0f, w.vsMean);
+
+    // Sólo los segundos 7..9.
+    TEST_ASSERT_TRUE(gHist.window(10000, 3, w));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 7.0f, w.vsMin);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 7.0f, w.vsMeanMin);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 9.0f, w.vsMeanMax);
+}
+
+// Más de 2 min: cubetas de 10 s enteras dentro de la ventana, incluida la
+// que aún se está acumulando.
+void test_ten_second_resolution() {
+    feed(0, 400001, 0.5f, 100.0f);                   // abre el segundo 400
+
+    AltitudeHistory::Window w;
+    TEST_ASSERT_TRUE(gHist.window(400000, 300, w));   // alineada: 100..399
+    TEST_ASSERT_EQUAL_UINT32(300, w.seconds);
+    TEST_ASSERT_EQUAL_UINT32(3000, w.samples);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 150.0f, w.altMin);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 299.95f, w.altMax);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, meanAlt(100, 400, 0.5f, 100.0f), w.altMean);
+
+    // No alineada: la cubeta 100..109 empieza antes de 105 y no entra.
+    feed(400100, 405001, 0.5f, 100.0f);
+    TEST_ASSERT_TRUE(gHist.window(405000, 300, w));
+    TEST_ASSERT_EQUAL_UINT32(295, w.seconds);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 155.0f, w.altMin);
+}
+
+// Más de 10 min: cubetas de 60 s.
+void test_minute_resolution() {
+    feed(0, 3600001, -0.1f, 500.0f);
+
+    AltitudeHistory::Window w;
+    TEST_ASSERT_TRUE(gHist.window(3600000, 1800, w));
+    TEST_ASSERT_EQUAL_UINT32(1800, w.seconds);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, 500.0f - 359.99f, w.altMin);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, 500.0f - 180.0f, w.altMax);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, meanAlt(1800, 3600, -0.1f, 500.0f), w.altMean);
+    // La última hora entera menos el minuto que aún se acumula.
+    TEST_ASSERT_EQUAL_UINT8(59, gHist.bucketCount(AltitudeHistory::Resolution::SEC_60));
+}
+
+// Los anillos se quedan con lo más reciente; age 0 = última cubeta cerrada.
+void test_rings_keep_latest_buckets() {
+    feed(0, 200000);
+    gHist.push(200000, 200.0f, 0.0f);
+
+    TEST_ASSERT_EQUAL_UINT8(ALT_HIST_SEC_SLOTS, gHist.bucketCount(AltitudeHistory::Resolution::SEC_1));
+    TEST_ASSERT_EQUAL_UINT8(19, gHist.bucketCount(AltitudeHistory::Resolution::SEC_10));
+
+    AltitudeHistory::Bucket b;
+    TEST_ASSERT_TRUE(gHist.bucketAt(AltitudeHistory::Resolution::SEC_1, 0, b));
+    TEST_ASSERT_EQUAL_UINT32(199, b.idx);
+    TEST_ASSERT_EQUAL_UINT16(10, b.n);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 199.45f, b.altMean);
+    TEST_ASSERT_TRUE(gHist.bucketAt(AltitudeHistory::Resolution::SEC_1, ALT_HIST_SEC_SLOTS - 1, b));
+    TEST_ASSERT_EQUAL_UINT32(200 - ALT_HIST_SEC_SLOTS, b.idx);
+    TEST_ASSERT_FALSE(gHist.bucketAt(AltitudeHistory::Resolution::SEC_1, ALT_HIST_SEC_SLOTS, b));
+
+    TEST_ASSERT_TRUE(gHist.bucketAt(AltitudeHistory::Resolution::SEC_10, 0, b));
+    TEST_ASSERT_EQUAL_UINT32(18, b.idx);           // 180..189 (190..199 aún acumulando)
+    TEST_ASSERT_EQUAL_UINT16(10, b.secs);
+}
+
+// rebase desplaza todo: anillos, acumuladores y el segundo en curso.
+void test_rebase_shifts_every_level() {
+    feed(0, 200500);
+    gHist.rebase(-50.0f);
+    feed(200500, 201000, 1.0f, -50.0f);
+    gHist.push(201000, 0.0f, 0.0f);
+
+    AltitudeHistory::Window w;
+    TEST_ASSERT_TRUE(gHist.window(201000, 10, w));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 191.0f - 50.0f, w.altMin);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 200.9f - 50.0f, w.altMax);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, meanAlt(191, 201) - 50.0f, w.altMean);
+
+    TEST_ASSERT_TRUE(gHist.window(201000, 150, w));   // 10 s: 60..199 + acumulador
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 60.0f - 50.0f, w.altMin);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_window_covers_closed_seconds_only);
+    RUN_TEST(test_gap_reduces_seconds);
+    RUN_TEST(test_vs_sample_and_mean_extremes);
+    RUN_TEST(test_ten_second_resolution);
+    RUN_TEST(test_minute_resolution);
+    RUN_TEST(test_rings_keep_latest_buckets);
+    RUN_TEST(test_rebase_shifts_every_level);
+    return UNITY_END();
+}
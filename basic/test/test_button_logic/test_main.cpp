@@ -0,0 +1,186 @@
+// ButtonLogic con secuencias sintéticas de flancos. replay() entrega los
+// flancos como ButtonsDriver::poll(): antes de cada uno vacía los eventos
+// temporizados anteriores al flanco, y al final los que venzan hasta endMs.
+#include <unity.h>
+#include <vector>
+
+#include "util/ButtonLogic.h"
+
+namespace {
+
+constexpr uint8_t UP   = 0;
+constexpr uint8_t MID  = 1;
+constexpr uint8_t DOWN = 2;
+
+struct Edge {
+    uint8_t  btn;
+    bool     high;
+    uint32_t tMs;
+};
+
+using Events = std::vector<ButtonEvent>;
+
+// pollEveryMs > 0: además hay un "loop" que consulta nextTimed() con ese
+// periodo (0 = sólo en los flancos y al final, p.ej. un loop muy retrasado).
+Events replay(const std::vector<Edge>& edges, uint32_t endMs, uint32_t pollEveryMs = 0) {
+    ButtonLogic bl;
+    const bool none[ButtonLogic::COUNT] = {false, false, false};
+    bl.reset(none, 0);
+    Events out;
+    ButtonEvent ev;
+    auto drain = [&](uint32_t now) { while (bl.nextTimed(now, ev)) out.push_back(ev); };
+
+    uint32_t nextPoll = pollEveryMs;
+    for (const Edge& e : edges) {
+        while (pollEveryMs && nextPoll < e.tMs) { drain(nextPoll); nextPoll += pollEveryMs; }
+        drain(e.tMs - 1);
+        if (bl.onEdge(e.btn, e.high, e.tMs, ev)) out.push_back(ev);
+    }
+    while (pollEveryMs && nextPoll < endMs) { drain(nextPoll); nextPoll += pollEveryMs; }
+    drain(endMs);
+    return out;
+}
+
+void expectEvent(const ButtonEvent& ev, uint8_t btn, ButtonEventType type, uint32_t tMs) {
+    TEST_ASSERT_EQUAL_INT((int)btn, (int)ev.id);
+    TEST_ASSERT_EQUAL_INT((int)type, (int)ev.type);
+    TEST_ASSERT_EQUAL_UINT32(tMs, ev.timestampMs);
+}
+
+size_t countType(const Events& evs, ButtonEventType t) {
+    size_t n = 0;
+    for (const ButtonEvent& e : evs) if (e.type == t) n++;
+    return n;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_short_press_is_press_and_release() {
+    Events evs = replay({{MID, true, 1000}, {MID, false, 1200}}, 3000);
+    TEST_ASSERT_EQUAL_UINT32(2, evs.size());
+    expectEvent(evs[0], MID, ButtonEventType::PRESS,   1000);
+    expectEvent(evs[1], MID, ButtonEventType::RELEASE, 1200);
+}
+
+void test_bounces_are_suppressed() {
+    // Rebotes de contacto al pulsar y al soltar, todos < 30 ms del evento.
+    Events evs = replay({
+        {UP, true, 1000}, {UP, false, 1004}, {UP, true, 1009}, {UP, false, 1020}, {UP, true, 1025},
+        {UP, false, 1400}, {UP, true, 1403}, {UP, false, 1410},
+    }, 3000);
+    TEST_ASSERT_EQUAL_UINT32(2, evs.size());
+    expectEvent(evs[0], UP, ButtonEventType::PRESS,   1000);
+    expectEvent(evs[1], UP, ButtonEventType::RELEASE, 1400);
+}
+
+void test_bounce_keeps_press_start_for_repeat() {
+    // Un rebote tras el PRESS no reinicia la cuenta de repetición.
+    Events evs = replay({{DOWN, true, 1000}, {DOWN, false, 1010}, {DOWN, true, 1015},
+                         {DOWN, false, 1700}}, 2000);
+    TEST_ASSERT_EQUAL_UINT32(3, evs.size());
+    expectEvent(evs[1], DOWN, ButtonEventType::REPEAT, 1000 + 500 + 120);
+}
+
+void test_repeat_schedule() {
+    Events evs = replay({{UP, true, 1000}, {UP, false, 2000}}, 3000);
+    // REPEAT_DELAY + k·REPEAT_INTERVAL (k >= 1): 1620, 1740, 1860, 1980.
+    TEST_ASSERT_EQUAL_UINT32(6, evs.size());
+    expectEvent(evs[0], UP, ButtonEventType::PRESS, 1000);
+    for (uint32_t k = 1; k <= 4; ++k) {
+        expectEvent(evs[k], UP, ButtonEventType::REPEAT,
+                    1000 + ButtonLogic::REPEAT_DELAY_MS + k * ButtonLogic::REPEAT_INTERVAL_MS);
+    }
+    expectEvent(evs[5], UP, ButtonEventType::RELEASE, 2000);
+}
+
+void test_long_presses_once_and_in_order() {
+    Events evs = replay({{MID, true, 1000}, {MID, false, 8000}}, 9000);
+    TEST_ASSERT_EQUAL_UINT32(1, countType(evs, ButtonEventType::LONG_PRESS_3S));
+    TEST_ASSERT_EQUAL_UINT32(1, countType(evs, ButtonEventType::LONG_PRESS_6S));
+    // 1000 + 500 + 120k <= 8000 -> k <= 54
+    TEST_ASSERT_EQUAL_UINT32(54, countType(evs, ButtonEventType::REPEAT));
+
+    uint32_t prev = 0;
+    for (const ButtonEvent& e : evs) {
+        TEST_ASSERT_GREATER_OR_EQUAL(prev, e.timestampMs);
+        prev = e.timestampMs;
+        if (e.type == ButtonEventType::LONG_PRESS_3S) TEST_ASSERT_EQUAL_UINT32(4000, e.timestampMs);
+        if (e.type == ButtonEventType::LONG_PRESS_6S) TEST_ASSERT_EQUAL_UINT32(7000, e.timestampMs);
+    }
+    expectEvent(evs.back(), MID, ButtonEventType::RELEASE, 8000);
+}
+
+void test_late_loop_gets_same_events() {
+    // Mismo gesto consultado cada 1 ms o sólo en los flancos (loop atascado):
+    // mismos eventos, mismo orden, mismas marcas de tiempo.
+    std::vector<Edge> edges = {
+        {UP, true, 1000}, {DOWN, true, 1050}, {UP, false, 4500}, {DOWN, false, 7200},
+    };
+    Events fine = replay(edges, 8000, 1);
+    Events late = replay(edges, 8000, 0);
+    TEST_ASSERT_EQUAL_UINT32(fine.size(), late.size());
+    for (size_t i = 0; i < fine.size(); ++i) {
+        expectEvent(late[i], (uint8_t)fine[i].id, fine[i].type, fine[i].timestampMs);
+    }
+}
+
+void test_two_buttons_interleave_by_timestamp() {
+    Events evs = replay({{UP, true, 1000}, {DOWN, true, 1050}, {UP, false, 1800},
+                         {DOWN, false, 1800}}, 2000);
+    // UP: 1620, 1740; DOWN: 1670, 1790
+    const uint8_t  ids[] = {UP, DOWN, UP, DOWN, UP, DOWN, UP, DOWN};
+    const uint32_t ts[]  = {1000, 1050, 1620, 1670, 1740, 1790, 1800, 1800};
+    TEST_ASSERT_EQUAL_UINT32(8, evs.size());
+    for (int i = 0; i < 8; ++i) {
+        TEST_ASSERT_EQUAL_INT(ids[i], (int)evs[i].id);
+        TEST_ASSERT_EQUAL_UINT32(ts[i], evs[i].timestampMs);
+    }
+}
+
+void test_next_deadline() {
+    ButtonLogic bl;
+    const bool none[ButtonLogic::COUNT] = {false, false, false};
+    bl.reset(none, 0);
+    uint32_t t = 0;
+    TEST_ASSERT_FALSE(bl.nextDeadline(t));
+
+    ButtonEvent ev;
+    TEST_ASSERT_TRUE(bl.onEdge(MID, true, 1000, ev));
+    TEST_ASSERT_TRUE(bl.nextDeadline(t));
+    TEST_ASSERT_EQUAL_UINT32(1620, t);
+    TEST_ASSERT_FALSE(bl.nextTimed(1619, ev));
+    TEST_ASSERT_TRUE(bl.nextTimed(1620, ev));
+    TEST_ASSERT_TRUE(bl.nextDeadline(t));
+    TEST_ASSERT_EQUAL_UINT32(1740, t);
+
+    TEST_ASSERT_TRUE(bl.onEdge(MID, false, 1700, ev));
+    TEST_ASSERT_FALSE(bl.nextDeadline(t));
+}
+
+void test_held_at_reset_needs_new_press() {
+    // Botón ya pulsado al arrancar: no genera repeticiones ni long-press.
+    ButtonLogic bl;
+    const bool held[ButtonLogic::COUNT] = {false, true, false};
+    bl.reset(held, 0);
+    ButtonEvent ev;
+    TEST_ASSERT_FALSE(bl.nextTimed(10000, ev));
+    uint32_t t;
+    TEST_ASSERT_FALSE(bl.nextDeadline(t));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_short_press_is_press_and_release);
+    RUN_TEST(test_bounces_are_suppressed);
+    RUN_TEST(test_bounce_keeps_press_start_for_repeat);
+    RUN_TEST(test_repeat_schedule);
+    RUN_TEST(test_long_presses_once_and_in_order);
+    RUN_TEST(test_late_loop_gets_same_events);
+    RUN_TEST(test_two_buttons_interleave_by_timestamp);
+    RUN_TEST(test_next_deadline);
+    RUN_TEST(test_held_at_reset_needs_new_press);
+    return UNITY_END();
+}
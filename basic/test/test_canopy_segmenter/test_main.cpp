@@ -0,0 +1,185 @@
+// Reproducción de trazas de vela sintéticas en CanopySegmenter.
+//
+// Cada traza es una tabla de tramos de VS (interpolación lineal) que se
+// integra a CANOPY_HZ para obtener la altitud, con ruido determinista
+// opcional sobre la VS. Los límites esperados de cada picado se derivan de
+// la propia tabla (instante del giro, altitud en el pico y en el plane-out).
+#include <unity.h>
+#include <vector>
+
+#include "core/CanopySegmenter.h"
+
+namespace {
+
+constexpr uint32_t CANOPY_HZ = 25;
+constexpr uint32_t DT_MS     = 1000 / CANOPY_HZ;
+
+struct Knot {
+    uint32_t tMs;
+    float    vs;    // m/s, negativo = descenso
+};
+
+struct Sample {
+    uint32_t tMs;
+    float    altM;
+    float    vs;
+};
+
+float vsAt(const std::vector<Knot>& k, uint32_t tMs) {
+    if (tMs <= k.front().tMs) return k.front().vs;
+    for (size_t i = 1; i < k.size(); ++i) {
+        if (tMs <= k[i].tMs) {
+            float f = (float)(tMs - k[i-1].tMs) / (float)(k[i].tMs - k[i-1].tMs);
+            return k[i-1].vs + f * (k[i].vs - k[i-1].vs);
+        }
+    }
+    return k.back().vs;
+}
+
+// Genera la traza hasta el último nodo o hasta el suelo.
+std::vector<Sample> render(const std::vector<Knot>& k, float alt0, float noise = 0.0f) {
+    std::vector<Sample> out;
+    uint32_t lcg = 12345;
+    float alt = alt0;
+    for (uint32_t t = k.front().tMs; t <= k.back().tMs && alt > 0.0f; t += DT_MS) {
+        float vs = vsAt(k, t);
+        alt += vs * (DT_MS / 1000.0f);
+        lcg = lcg * 1103515245u + 12345u;
+        float n = noise * (((lcg >> 16) & 0x7fff) / 16383.5f - 1.0f);
+        out.push_back({t, alt, vs + n});
+    }
+    return out;
+}
+
+// Altitud de la traza en t (sin ruido: la altitud se integra de la VS limpia).
+float altAt(const std::vector<Sample>& s, uint32_t tMs) {
+    for (const Sample& x : s) if (x.tMs >= tMs) return x.altM;
+    return s.back().altM;
+}
+
+void replay(CanopySegmenter& seg, const std::vector<Sample>& s) {
+    seg.reset();
+    for (const Sample& x : s) seg.addSample(x.tMs, x.altM, x.vs);
+    seg.finish(s.back().tMs + DT_MS);
+}
+
+// Crucero a 5 m/s, giro a final 40 s: 5 -> 20 m/s en 3 s, 2 s a 20 m/s,
+// recuperación 20 -> 2 m/s en 3 s y planeo a 1 m/s.
+const std::vector<Knot> kSwoop = {
+    {    0, -5.0f}, {40000,  -5.0f},
+    {43000, -20.0f}, {45000, -20.0f},
+    {48000, -2.0f}, {60000,  -1.0f},
+};
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_single_swoop_boundaries() {
+    std::vector<Sample> s = render(kSwoop, 400.0f);
+    CanopySegmenter seg;
+    replay(seg, s);
+
+    TEST_ASSERT_EQUAL_UINT32(1, seg.segmentCount());
+    const CanopySegmenter::Segment& g = seg.segment(0);
+
+    // Inicio: el giro empieza a 40 s; se detecta al superar 3 m/s sobre crucero.
+    TEST_ASSERT_GREATER_OR_EQUAL(40000, g.startMs);
+    TEST_ASSERT_LESS_OR_EQUAL(41000, g.startMs);
+    TEST_ASSERT_FLOAT_WITHIN(6.0f, altAt(s, 40000), g.startAltM);
+
+    // Pico: 20 m/s en la meseta 43..45 s.
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 20.0f, g.peakDescentMps);
+    TEST_ASSERT_LESS_OR_EQUAL(altAt(s, 43000) + 0.5f, g.peakAltM);
+    TEST_ASSERT_GREATER_OR_EQUAL(altAt(s, 45000) - 0.5f, g.peakAltM);
+
+    // Plane-out: VS vuelve a crucero - 1.5 m/s (-6.5) a los 47.25 s.
+    TEST_ASSERT_TRUE(isfinite(g.planeOutAltM));
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, altAt(s, 47250), g.planeOutAltM);
+    TEST_ASSERT_FLOAT_WITHIN(600.0f, 47250.0f - g.startMs, (float)g.durationMs);
+}
+
+void test_noisy_swoop_same_segment() {
+    std::vector<Sample> s = render(kSwoop, 400.0f, 0.4f);
+    CanopySegmenter seg;
+    replay(seg, s);
+
+    TEST_ASSERT_EQUAL_UINT32(1, seg.segmentCount());
+    const CanopySegmenter::Segment& g = seg.segment(0);
+    TEST_ASSERT_GREATER_OR_EQUAL(40000, g.startMs);
+    TEST_ASSERT_LESS_OR_EQUAL(41000, g.startMs);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 20.0f, g.peakDescentMps);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, altAt(s, 47250), g.planeOutAltM);
+}
+
+void test_cruise_and_gentle_turn_ignored() {
+    // Crucero con ruido y un giro suave (5 -> 9 m/s): por debajo de MIN_SEG_DV.
+    std::vector<Knot> k = {
+        {    0, -5.0f}, {30000, -5.0f},
+        {32000, -9.0f}, {34000, -9.0f},
+        {36000, -5.0f}, {60000, -5.0f},
+    };
+    CanopySegmenter seg;
+    replay(seg, render(k, 400.0f, 0.4f));
+    TEST_ASSERT_EQUAL_UINT32(0, seg.segmentCount());
+}
+
+void test_double_dip_is_one_segment() {
+    // Recupera a medias y vuelve a picar antes del plane-out: un solo picado.
+    std::vector<Knot> k = {
+        {    0, -5.0f}, {20000, -5.0f},
+        {23000, -18.0f}, {24000, -14.0f},
+        {26000, -22.0f}, {29000, -2.0f},
+        {40000, -1.0f},
+    };
+    std::vector<Sample> s = render(k, 400.0f);
+    CanopySegmenter seg;
+    replay(seg, s);
+    TEST_ASSERT_EQUAL_UINT32(1, seg.segmentCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 22.0f, seg.segment(0).peakDescentMps);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, altAt(s, 26000), seg.segment(0).peakAltM);
+}
+
+void test_three_turns_keep_the_strongest() {
+    std::vector<Knot> k = {
+        {    0, -5.0f}, {20000, -5.0f},
+        {22000, -14.0f}, {25000, -3.0f},     // 1: 14 m/s
+        {45000, -5.0f}, {48000, -22.0f},     // 2: 22 m/s
+        {51000, -2.0f}, {70000, -5.0f},
+        {72000, -16.0f}, {75000, -3.0f},     // 3: 16 m/s
+        {90000, -1.0f},
+    };
+    CanopySegmenter seg;
+    replay(seg, render(k, 600.0f));
+    // CANOPY_SEG_MAX = 2: se quedan los dos más fuertes (2 y 3).
+    TEST_ASSERT_EQUAL_UINT32(CANOPY_SEG_MAX, seg.segmentCount());
+    float a = seg.segment(0).peakDescentMps, b = seg.segment(1).peakDescentMps;
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 22.0f, a > b ? a : b);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 16.0f, a > b ? b : a);
+}
+
+void test_landing_mid_dive_has_no_planeout() {
+    // Picado hasta el suelo: finish() lo cierra sin plane-out.
+    std::vector<Knot> k = {
+        {    0, -5.0f}, {20000, -5.0f},
+        {23000, -18.0f}, {60000, -18.0f},
+    };
+    std::vector<Sample> s = render(k, 150.0f);
+    CanopySegmenter seg;
+    replay(seg, s);
+    TEST_ASSERT_EQUAL_UINT32(1, seg.segmentCount());
+    TEST_ASSERT_FALSE(isfinite(seg.segment(0).planeOutAltM));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 18.0f, seg.segment(0).peakDescentMps);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_swoop_boundaries);
+    RUN_TEST(test_noisy_swoop_same_segment);
+    RUN_TEST(test_cruise_and_gentle_turn_ignored);
+    RUN_TEST(test_double_dip_is_one_segment);
+    RUN_TEST(test_three_turns_keep_the_strongest);
+    RUN_TEST(test_landing_mid_dive_has_no_planeout);
+    return UNITY_END();
+}
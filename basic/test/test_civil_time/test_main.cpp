@@ -0,0 +1,131 @@
+// CivilTime (util/CivilTime.h) contra gmtime_r/timegm de la libc del host:
+// todo el rango de uint32 (1970 .. 2106), con años bisiestos, los no
+// bisiestos seculares (2100) y los extremos del rango.
+#include <unity.h>
+#include <time.h>
+
+#include "util/CivilTime.h"
+
+namespace {
+
+UtcDateTime mk(uint16_t y, uint8_t mo, uint8_t d, uint8_t h = 0, uint8_t mi = 0, uint8_t s = 0) {
+    UtcDateTime dt;
+    dt.year = y; dt.month = mo; dt.day = d; dt.hour = h; dt.minute = mi; dt.second = s;
+    return dt;
+}
+
+void assertSame(const struct tm& tm, const UtcDateTime& dt, uint32_t epoch) {
+    char msg[48];
+    snprintf(msg, sizeof(msg), "epoch %lu", (unsigned long)epoch);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(tm.tm_year + 1900, dt.year, msg);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(tm.tm_mon + 1, dt.month, msg);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(tm.tm_mday, dt.day, msg);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(tm.tm_hour, dt.hour, msg);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(tm.tm_min, dt.minute, msg);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(tm.tm_sec, dt.second, msg);
+}
+
+void checkEpoch(uint32_t epoch) {
+    time_t t = (time_t)epoch;
+    struct tm tm;
+    TEST_ASSERT_NOT_NULL(gmtime_r(&t, &tm));
+    UtcDateTime dt = CivilTime::epochToUtc(epoch);
+    assertSame(tm, dt, epoch);
+    TEST_ASSERT_EQUAL_UINT32(epoch, CivilTime::utcToEpoch(dt));
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// Cada día del rango (49710 días) a una hora distinta cada vez.
+void test_every_day_matches_gmtime() {
+    for (uint64_t day = 0; day * 86400ULL <= 0xFFFFFFFFULL; ++day) {
+        uint64_t e = day * 86400ULL + (day * 7919ULL) % 86400ULL;
+        if (e > 0xFFFFFFFFULL) e = 0xFFFFFFFFULL;
+        checkEpoch((uint32_t)e);
+    }
+}
+
+// utcToEpoch contra timegm en los bordes de cada mes de 1970..2105.
+void test_month_boundaries_match_timegm() {
+    for (int y = 1970; y <= 2105; ++y) {
+        for (int m = 1; m <= 12; ++m) {
+            struct tm tm = {};
+            tm.tm_year = y - 1900;
+            tm.tm_mon  = m;            // día 0 del mes siguiente = último de éste
+            tm.tm_mday = 0;
+            tm.tm_hour = 23; tm.tm_min = 59; tm.tm_sec = 59;
+            time_t last = timegm(&tm);
+            uint32_t got = CivilTime::utcToEpoch(mk((uint16_t)tm.tm_year + 1900, (uint8_t)(tm.tm_mon + 1),
+                                                    (uint8_t)tm.tm_mday, 23, 59, 59));
+            TEST_ASSERT_EQUAL_UINT32((uint32_t)last, got);
+            checkEpoch(got + 1u);      // primer segundo del mes siguiente
+        }
+    }
+}
+
+// Bisiestos: divisible por 4 sí, por 100 no, por 400 sí.
+void test_leap_years() {
+    // 2000 (divisible por 400): 29 de febrero existe.
+    UtcDateTime d = CivilTime::epochToUtc(CivilTime::utcToEpoch(mk(2000, 2, 28)) + 86400u);
+    TEST_ASSERT_EQUAL_UINT8(2, d.month);
+    TEST_ASSERT_EQUAL_UINT8(29, d.day);
+
+    // 2024: también.
+    d = CivilTime::epochToUtc(CivilTime::utcToEpoch(mk(2024, 2, 28, 12)) + 86400u);
+    TEST_ASSERT_EQUAL_UINT8(29, d.day);
+    TEST_ASSERT_EQUAL_UINT8(12, d.hour);
+
+    // 2100 (secular, no divisible por 400): del 28 de febrero al 1 de marzo.
+    d = CivilTime::epochToUtc(CivilTime::utcToEpoch(mk(2100, 2, 28, 23, 59, 59)) + 1u);
+    TEST_ASSERT_EQUAL_UINT16(2100, d.year);
+    TEST_ASSERT_EQUAL_UINT8(3, d.month);
+    TEST_ASSERT_EQUAL_UINT8(1, d.day);
+    TEST_ASSERT_EQUAL_UINT8(0, d.hour);
+
+    // Año 2100 de 365 días, 2000 de 366.
+    TEST_ASSERT_EQUAL_UINT32(365u * 86400u,
+                             CivilTime::utcToEpoch(mk(2101, 1, 1)) - CivilTime::utcToEpoch(mk(2100, 1, 1)));
+    TEST_ASSERT_EQUAL_UINT32(366u * 86400u,
+                             CivilTime::utcToEpoch(mk(2001, 1, 1)) - CivilTime::utcToEpoch(mk(2000, 1, 1)));
+}
+
+// Extremos del rango y valores conocidos.
+void test_range_limits() {
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(1970, 1, 1)));
+    TEST_ASSERT_EQUAL_UINT32(951782400u, CivilTime::utcToEpoch(mk(2000, 2, 29)));
+    TEST_ASSERT_EQUAL_UINT32(0x7FFFFFFFu, CivilTime::utcToEpoch(mk(2038, 1, 19, 3, 14, 7)));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, CivilTime::utcToEpoch(mk(2106, 2, 7, 6, 28, 15)));
+    // Un segundo más ya no cabe en uint32.
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2106, 2, 7, 6, 28, 16)));
+
+    UtcDateTime d = CivilTime::epochToUtc(0xFFFFFFFFu);
+    TEST_ASSERT_EQUAL_UINT16(2106, d.year);
+    TEST_ASSERT_EQUAL_UINT8(2, d.month);
+    TEST_ASSERT_EQUAL_UINT8(7, d.day);
+    TEST_ASSERT_EQUAL_UINT8(15, d.second);
+}
+
+// Campos fuera de rango: 0 (fecha inválida).
+void test_invalid_fields_rejected() {
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(1969, 12, 31, 23, 59, 59)));
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2024, 0, 1)));
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2024, 13, 1)));
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2024, 1, 0)));
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2024, 1, 32)));
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2024, 1, 1, 24)));
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2024, 1, 1, 0, 60)));
+    TEST_ASSERT_EQUAL_UINT32(0, CivilTime::utcToEpoch(mk(2024, 1, 1, 0, 0, 60)));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_day_matches_gmtime);
+    RUN_TEST(test_month_boundaries_match_timegm);
+    RUN_TEST(test_leap_years);
+    RUN_TEST(test_range_limits);
+    RUN_TEST(test_invalid_fields_rejected);
+    return UNITY_END();
+}
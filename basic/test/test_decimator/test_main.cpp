@@ -0,0 +1,157 @@
+// CicDecimator (util/Decimator.h): ganancia unidad, razón de salida, retardo
+// de grupo y arranque sin transitorio, contra la definición directa del CIC
+// (media móvil de R muestras aplicada N veces y diezmada).
+#include <unity.h>
+#include <math.h>
+#include <vector>
+
+#include "util/Decimator.h"
+
+namespace {
+
+// Salidas de referencia: N medias móviles de longitud R sobre la entrada
+// cuantizada a cm, con la historia previa igual a la primera muestra
+// (equivale al prime() del decimador), tomadas cada R muestras.
+std::vector<float> reference(const std::vector<float>& in, uint8_t N, uint16_t R) {
+    std::vector<double> x;
+    size_t pre = (size_t)N * R;
+    for (size_t i = 0; i < pre; ++i) x.push_back((double)lroundf(in[0] * ALT_DECIM_SCALE));
+    for (float v : in) x.push_back((double)lroundf(v * ALT_DECIM_SCALE));
+    for (uint8_t s = 0; s < N; ++s) {
+        std::vector<double> y(x.size(), 0.0);
+        for (size_t i = R - 1; i < x.size(); ++i) {
+            double acc = 0.0;
+            for (uint16_t k = 0; k < R; ++k) acc += x[i - k];
+            y[i] = acc / R;
+        }
+        x = y;
+    }
+    std::vector<float> out;
+    for (size_t i = R - 1; i < in.size(); i += R) {
+        out.push_back((float)(x[pre + i] / ALT_DECIM_SCALE));
+    }
+    return out;
+}
+
+template <uint8_t N>
+std::vector<float> run(CicDecimator<N>& d, const std::vector<float>& in) {
+    std::vector<float> out;
+    float y;
+    for (float v : in) {
+        if (d.push(v, y)) out.push_back(y);
+    }
+    return out;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// Entrada constante: la primera salida ya vale la entrada (sin rampa de arranque).
+void test_constant_input_has_no_startup_transient() {
+    CicDecimator<2> d;
+    d.setRatio(8);
+    std::vector<float> in(64, 1234.56f);
+    std::vector<float> out = run(d, in);
+    TEST_ASSERT_EQUAL_UINT32(8, out.size());
+    for (float y : out) TEST_ASSERT_FLOAT_WITHIN(0.005f, 1234.56f, y);
+}
+
+// Una salida cada R entradas.
+void test_one_output_every_ratio_samples() {
+    CicDecimator<1> d;
+    d.setRatio(5);
+    float y;
+    int outputs = 0;
+    for (int i = 1; i <= 23; ++i) {
+        bool got = d.push(0.0f, y);
+        TEST_ASSERT_EQUAL(i % 5 == 0, got);
+        if (got) outputs++;
+    }
+    TEST_ASSERT_EQUAL(4, outputs);
+    TEST_ASSERT_EQUAL_UINT16(5, d.getRatio());
+}
+
+// Orden 1: media exacta de cada bloque (al cm).
+void test_order_one_is_block_mean() {
+    CicDecimator<1> d;
+    d.setRatio(4);
+    std::vector<float> in = {1.0f, 2.0f, 3.0f, 6.0f,   10.0f, 10.0f, 11.0f, 13.0f};
+    std::vector<float> out = run(d, in);
+    TEST_ASSERT_EQUAL_UINT32(2, out.size());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.0f, out[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 11.0f, out[1]);
+}
+
+// Rampa: la salida es la entrada retrasada groupDelaySamples().
+void test_ramp_is_delayed_by_group_delay() {
+    CicDecimator<2> d;
+    d.setRatio(6);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 5.0f, d.groupDelaySamples());
+
+    const float slope = 0.25f;          // m por muestra
+    std::vector<float> in;
+    for (int i = 0; i < 240; ++i) in.push_back(slope * i);
+    std::vector<float> out = run(d, in);
+    TEST_ASSERT_EQUAL_UINT32(40, out.size());
+    // Pasado el arranque (N·R muestras), salida k = entrada (6k+5) - retardo.
+    for (size_t k = 2; k < out.size(); ++k) {
+        float expect = slope * ((float)(6 * k + 5) - d.groupDelaySamples());
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, expect, out[k]);
+    }
+}
+
+// Señal arbitraria, órdenes 1..3: coincide con la definición directa.
+void test_matches_direct_cic_definition() {
+    std::vector<float> in;
+    for (int i = 0; i < 300; ++i) {
+        in.push_back(3000.0f - 0.4f * i + 2.0f * sinf(i * 0.37f) + ((i * 7919) % 13) * 0.05f);
+    }
+    CicDecimator<1> d1; d1.setRatio(5);
+    CicDecimator<2> d2; d2.setRatio(5);
+    CicDecimator<3> d3; d3.setRatio(3);
+    std::vector<float> o1 = run(d1, in), r1 = reference(in, 1, 5);
+    std::vector<float> o2 = run(d2, in), r2 = reference(in, 2, 5);
+    std::vector<float> o3 = run(d3, in), r3 = reference(in, 3, 3);
+    TEST_ASSERT_EQUAL_UINT32(r1.size(), o1.size());
+    TEST_ASSERT_EQUAL_UINT32(r2.size(), o2.size());
+    TEST_ASSERT_EQUAL_UINT32(r3.size(), o3.size());
+    for (size_t k = 0; k < r1.size(); ++k) TEST_ASSERT_FLOAT_WITHIN(0.001f, r1[k], o1[k]);
+    for (size_t k = 0; k < r2.size(); ++k) TEST_ASSERT_FLOAT_WITHIN(0.001f, r2[k], o2[k]);
+    for (size_t k = 0; k < r3.size(); ++k) TEST_ASSERT_FLOAT_WITHIN(0.001f, r3[k], o3[k]);
+}
+
+// Cambiar la razón reinicia: vuelve a arrancar sin transitorio en el nivel nuevo.
+void test_set_ratio_restarts_cleanly() {
+    CicDecimator<2> d;
+    d.setRatio(4);
+    float y;
+    for (int i = 0; i < 10; ++i) d.push(100.0f, y);   // fase a medias
+    d.setRatio(3);
+    int outputs = 0;
+    for (int i = 1; i <= 6; ++i) {
+        if (d.push(-20.0f, y)) {
+            outputs++;
+            TEST_ASSERT_FLOAT_WITHIN(0.005f, -20.0f, y);
+        }
+    }
+    TEST_ASSERT_EQUAL(2, outputs);
+
+    // Misma razón: no se toca el estado (la fase sigue contando).
+    TEST_ASSERT_FALSE(d.push(-20.0f, y));
+    d.setRatio(3);
+    TEST_ASSERT_FALSE(d.push(-20.0f, y));
+    TEST_ASSERT_TRUE(d.push(-20.0f, y));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_constant_input_has_no_startup_transient);
+    RUN_TEST(test_one_output_every_ratio_samples);
+    RUN_TEST(test_order_one_is_block_mean);
+    RUN_TEST(test_ramp_is_delayed_by_group_delay);
+    RUN_TEST(test_matches_direct_cic_definition);
+    RUN_TEST(test_set_ratio_restarts_cleanly);
+    return UNITY_END();
+}
@@ -0,0 +1,148 @@
+// Simulación de caída libre para DisplayPredictor.
+//
+// Un "sensor" a SENSOR_HZ aplica el mismo EMA que AltimetryService
+// (ALT_FILTER_ALPHA) y la VS como derivada de la altitud filtrada. Una "UI" a
+// UI_HZ repinta y el píxel cambia RENDER_MS + UI_PRED_EXTRA_MS_FREEFALL
+// después. Se compara el error frente a la altitud real en ese instante con
+// y sin compensación. El reloj es el virtual de host (micros()).
+#include <unity.h>
+
+#include "ui/DisplayPredictor.h"
+
+namespace {
+
+constexpr uint32_t SENSOR_HZ = 50;
+constexpr uint32_t UI_HZ     = 10;
+constexpr uint32_t UI_PHASE_MS = 7;     // desfase del frame respecto al sensor
+constexpr uint32_t RENDER_MS = 20;
+constexpr float    G  = 9.81f;
+constexpr float    VT = 55.0f;          // terminal en caída libre
+constexpr float    EXIT_ALT_M = 4000.0f;
+
+// Caída con arrastre cuadrático desde la salida (t en s).
+float truthAlt(float t) {
+    if (t <= 0.0f) return EXIT_ALT_M;
+    return EXIT_ALT_M - (VT * VT / G) * logf(coshf(G * t / VT));
+}
+
+struct Errors {
+    float rmsRaw  = 0.0f;   // mostrando la altitud filtrada tal cual
+    float rmsPred = 0.0f;   // con DisplayPredictor
+    float maxPredSteady = 0.0f;
+};
+
+// feedEverySample: el predictor ve cada muestra del sensor; si no, sólo la
+// última en cada frame, como la tarea de UI, con el periodo real del sensor
+// que publica SensorTask::Snapshot::samplePeriodUs.
+Errors simulate(bool feedEverySample, float durationS = 20.0f) {
+    DisplayPredictor pred;
+    host::setMs(1000);
+    const uint32_t t0Us = micros();
+
+    const uint32_t sensorUs = 1000000u / SENSOR_HZ;
+    const uint32_t uiUs     = 1000000u / UI_HZ;
+    float    filt = NAN, lastFilt = NAN;
+    AltitudeData alt{};
+    uint32_t sampleUs = 0;
+
+    double sumRaw = 0.0, sumPred = 0.0;
+    uint32_t n = 0;
+    Errors e;
+
+    for (uint32_t us = 0; us <= (uint32_t)(durationS * 1e6f); us += 1000) {
+        host::setMs(0);
+        host::advanceUs(t0Us + us);
+        float t = us * 1e-6f;
+
+        if (us % sensorUs == 0) {
+            float a = truthAlt(t);
+            if (!isfinite(filt)) filt = lastFilt = a;
+            filt += ALT_FILTER_ALPHA * (a - filt);
+            float vs = (filt - lastFilt) / (sensorUs * 1e-6f);
+            lastFilt = filt;
+
+            alt.rawAlt        = Meters(filt);
+            alt.altToShow     = Meters(filt);
+            alt.verticalSpeed = MetersPerSecond(vs);
+            sampleUs = micros();
+            if (feedEverySample) pred.addSample(alt, sampleUs);
+        }
+
+        if (us % uiUs == UI_PHASE_MS * 1000u) {
+            if (!feedEverySample) pred.addSample(alt, sampleUs, sensorUs);
+            float shown = pred.predict(alt, FlightPhase::FREEFALL).v;
+            pred.noteRenderUs(RENDER_MS * 1000u);
+
+            float tPix  = t + (RENDER_MS + UI_PRED_EXTRA_MS_FREEFALL) * 1e-3f;
+            float truth = truthAlt(tPix);
+            if (t < 2.0f) continue;   // arranque de los estimadores
+            float eRaw  = filt - truth;
+            float ePred = shown - truth;
+            sumRaw  += eRaw * eRaw;
+            sumPred += ePred * ePred;
+            n++;
+            if (t > 12.0f && fabsf(ePred) > e.maxPredSteady) e.maxPredSteady = fabsf(ePred);
+        }
+    }
+    e.rmsRaw  = sqrtf((float)(sumRaw / n));
+    e.rmsPred = sqrtf((float)(sumPred / n));
+    return e;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_freefall_error_drops_with_compensation() {
+    Errors e = simulate(true);
+    // Sin compensar: EMA (4 muestras) + espera al frame + render + cristal,
+    // a ~55 m/s son bastantes metros por encima de la realidad.
+    TEST_ASSERT_GREATER_THAN(6.0f, e.rmsRaw);
+    TEST_ASSERT_LESS_THAN(e.rmsRaw * 0.2f, e.rmsPred);
+    TEST_ASSERT_LESS_THAN(1.5f, e.maxPredSteady);
+}
+
+void test_fed_per_ui_frame_keeps_compensation() {
+    // Tarea de UI: un snapshot por frame. Si el predictor tomara el periodo
+    // del frame (100 ms) por el del sensor, el retardo del EMA saldría 5x y
+    // la pantalla iría ~17 m por delante.
+    Errors frame = simulate(false);
+    Errors every = simulate(true);
+    TEST_ASSERT_LESS_THAN(frame.rmsRaw * 0.2f, frame.rmsPred);
+    TEST_ASSERT_LESS_THAN(1.5f, frame.maxPredSteady);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, every.rmsPred, frame.rmsPred);
+}
+
+void test_disabled_on_ground() {
+    DisplayPredictor pred;
+    AltitudeData alt{};
+    alt.rawAlt        = Meters(120.0f);
+    alt.altToShow     = Meters(100.0f);
+    alt.verticalSpeed = MetersPerSecond(-50.0f);
+    pred.addSample(alt, 1000);
+    pred.addSample(alt, 21000);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, pred.predict(alt, FlightPhase::GROUND).v);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pred.getLastLeadMs());
+}
+
+void test_lead_is_capped() {
+    DisplayPredictor pred;
+    AltitudeData alt{};
+    alt.rawAlt        = Meters(2000.0f);
+    alt.verticalSpeed = MetersPerSecond(-50.0f);
+    host::setMs(1000);
+    pred.addSample(alt, micros());
+    host::advanceMs(5000);   // muestra muy vieja
+    pred.predict(alt, FlightPhase::FREEFALL);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, (float)UI_PRED_MAX_LEAD_MS, pred.getLastLeadMs());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_freefall_error_drops_with_compensation);
+    RUN_TEST(test_fed_per_ui_frame_keeps_compensation);
+    RUN_TEST(test_disabled_on_ground);
+    RUN_TEST(test_lead_is_capped);
+    return UNITY_END();
+}
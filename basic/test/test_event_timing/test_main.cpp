@@ -0,0 +1,138 @@
+// Fechado de salida y apertura (util/EventTiming.h) sobre lo que de verdad
+// llega al PreTriggerBuffer: presiones sintéticas de un perfil conocido que
+// pasan por el filtro de AltimetryService (Hampel + EMA + primera diferencia)
+// a las tasas del gobernador (25 / 12.5 / 6.25 Hz).
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "core/AltimetryService.h"
+#include "util/PreTriggerBuffer.h"
+#include "util/EventTiming.h"
+
+namespace {
+
+constexpr float    P0_PA      = 101325.0f;
+constexpr float    START_ALT  = 4000.0f;   // avión nivelado
+constexpr uint32_t EXIT_MS    = 10000;
+constexpr uint32_t DEPLOY_MS  = EXIT_MS + 30000;
+constexpr float    VT_MPS     = 50.0f;     // VS terminal
+constexpr float    G_MPS2     = 9.81f;
+constexpr float    DECEL_S    = 3.0f;      // apertura: de VT a 5 m/s en 3 s
+constexpr float    CANOPY_MPS = 5.0f;
+
+// Mismos parámetros que JumpRecorder.
+constexpr uint32_t LEVEL_WINDOW_MS = 2000;
+constexpr float    EXIT_RAMP_LO    = -2.0f;
+constexpr float    EXIT_RAMP_HI    = -10.0f;
+constexpr float    DEPLOY_FRAC_HI  = 0.85f;
+constexpr float    DEPLOY_FRAC_LO  = 0.40f;
+const EventTiming::Filter BARO_FILTER{ALT_FILTER_ALPHA};
+
+// VS real del perfil (m/s, negativa hacia abajo).
+float vsAt(float tS) {
+    float tExit = EXIT_MS * 1e-3f, tDep = DEPLOY_MS * 1e-3f;
+    if (tS < tExit) return 0.0f;
+    if (tS < tDep)  return -VT_MPS * tanhf(G_MPS2 * (tS - tExit) / VT_MPS);
+    float vDep = -VT_MPS * tanhf(G_MPS2 * (tDep - tExit) / VT_MPS);
+    float f = (tS - tDep) / DECEL_S;
+    if (f > 1.0f) f = 1.0f;
+    return vDep + (-CANOPY_MPS - vDep) * f;
+}
+
+float pressureAt(float altM) {
+    return P0_PA * powf(1.0f - altM / BARO_COEFF, BARO_INV_EXP);
+}
+
+struct Run {
+    PreTriggerBuffer   pre;
+    AltimetryService   alt;
+    uint32_t           periodMs = 40;
+    uint32_t           tMs      = 0;
+    double             hM       = START_ALT;   // integrada a 1 ms
+    float              altAtExitM   = 0.0f;
+    float              altAtDeployM = 0.0f;
+
+    // Cero a nivel del mar: las altitudes del buffer son absolutas.
+    explicit Run(uint32_t T) : periodMs(T) {
+        alt.begin(nullptr);
+        alt.seedReference(P0_PA);
+    }
+
+    // Avanza hasta 'untilMs' alimentando una muestra por periodo.
+    void feedUntil(uint32_t untilMs) {
+        while (tMs < untilMs) {
+            for (uint32_t k = 0; k < periodMs; ++k) {
+                hM += vsAt((tMs + k) * 1e-3f) * 1e-3;
+                if (tMs + k + 1 == EXIT_MS)   altAtExitM   = (float)hM;
+                if (tMs + k + 1 == DEPLOY_MS) altAtDeployM = (float)hM;
+            }
+            tMs += periodMs;
+            alt.processSample(pressureAt((float)hM), 15.0f, tMs, tMs * 1000u);
+            pre.push(alt.getAltitudeData(), tMs);
+        }
+    }
+};
+
+// Como JumpRecorder::markExitAndStartFF: primera muestra de la racha cayendo.
+bool exitEvent(Run& r, const EventTiming::Filter& filter, EventTiming::Event& ev) {
+    int i = r.pre.findRunStart([](const FlightSample& s) { return s.vsMps < -1.0f; },
+                               EXIT_MS - 5000);
+    return i > 0 && EventTiming::refineExit(r.pre, i, LEVEL_WINDOW_MS,
+                                            EXIT_RAMP_LO, EXIT_RAMP_HI, filter, ev);
+}
+
+// Como JumpRecorder::markDeploy: primera muestra ya desacelerando.
+bool deployEvent(Run& r, const EventTiming::Filter& filter, EventTiming::Event& ev) {
+    float vOnset = 0.9f * r.pre.minVsSince(DEPLOY_MS - 10000);
+    int i = r.pre.findRunStart([vOnset](const FlightSample& s) { return s.vsMps > vOnset; },
+                               DEPLOY_MS - 10000);
+    return i > 0 && EventTiming::refineDeploy(r.pre, i, LEVEL_WINDOW_MS,
+                                              DEPLOY_FRAC_HI, DEPLOY_FRAC_LO, filter, ev);
+}
+
+void checkRate(uint32_t periodMs) {
+    Run r(periodMs);
+
+    // Salida: se fecha 2 s después (tras la confirmación de FREEFALL).
+    r.feedUntil(EXIT_MS + 2000);
+    EventTiming::Event raw, ev;
+    TEST_ASSERT_TRUE(exitEvent(r, EventTiming::Filter{}, raw));
+    TEST_ASSERT_TRUE(exitEvent(r, BARO_FILTER, ev));
+    int32_t errRaw = (int32_t)(raw.tMs - EXIT_MS);
+    int32_t err    = (int32_t)(ev.tMs - EXIT_MS);
+    printf("T=%3lu ms  salida:   sin modelo %+5ld ms, con modelo %+4ld ms, alt %+.2f m\n",
+           (unsigned long)periodMs, (long)errRaw, (long)err, ev.altM - r.altAtExitM);
+    TEST_ASSERT_GREATER_THAN((int32_t)(3 * periodMs / 2), errRaw);   // el sesgo existe
+    TEST_ASSERT_INT_WITHIN((int32_t)(periodMs / 2 + 20), 0, err);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, r.altAtExitM, ev.altM);
+
+    // Apertura: se fecha 3 s después.
+    r.feedUntil(DEPLOY_MS + 3000);
+    TEST_ASSERT_TRUE(deployEvent(r, EventTiming::Filter{}, raw));
+    TEST_ASSERT_TRUE(deployEvent(r, BARO_FILTER, ev));
+    errRaw = (int32_t)(raw.tMs - DEPLOY_MS);
+    err    = (int32_t)(ev.tMs - DEPLOY_MS);
+    printf("T=%3lu ms  apertura: sin modelo %+5ld ms, con modelo %+4ld ms, alt %+.2f m\n",
+           (unsigned long)periodMs, (long)errRaw, (long)err, ev.altM - r.altAtDeployM);
+    TEST_ASSERT_GREATER_THAN((int32_t)(3 * periodMs / 2), errRaw);
+    TEST_ASSERT_INT_WITHIN((int32_t)(periodMs / 2 + 20), 0, err);
+    TEST_ASSERT_FLOAT_WITHIN(VT_MPS * (periodMs / 2 + 20) * 1e-3f, r.altAtDeployM, ev.altM);
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_exit_and_deploy_at_25hz()   { checkRate(40); }
+void test_exit_and_deploy_at_12_5hz() { checkRate(80); }
+void test_exit_and_deploy_at_6_25hz() { checkRate(160); }
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_exit_and_deploy_at_25hz);
+    RUN_TEST(test_exit_and_deploy_at_12_5hz);
+    RUN_TEST(test_exit_and_deploy_at_6_25hz);
+    return UNITY_END();
+}
@@ -0,0 +1,166 @@
+// HampelFilter (util/HampelFilter.h): picos aislados, escalones, rampas,
+// lecturas no finitas y una comparación muestra a muestra contra la
+// definición directa (ordenar la ventana, mediana y MAD).
+#include <unity.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include "util/HampelFilter.h"
+
+namespace {
+
+constexpr float MIN_PA = 30.0f;   // como PRESS_OUTLIER_MIN_PA
+
+// Decisión de referencia para la última muestra de 'win' (ventana llena).
+bool referenceRejects(std::vector<float> win, float minThresh, float& med) {
+    float x = win.back();
+    std::sort(win.begin(), win.end());
+    med = win[win.size() / 2];
+    std::vector<float> dev;
+    for (float v : win) dev.push_back(fabsf(v - med));
+    std::sort(dev.begin(), dev.end());
+    float thr = HAMPEL_K * 1.4826f * dev[dev.size() / 2];
+    if (thr < minThresh) thr = minThresh;
+    return fabsf(x - med) > thr;
+}
+
+// Presión con ruido determinista alrededor de 'base' (Pa).
+float noisyPa(int i, float base) {
+    return base + 4.0f * sinf(i * 1.3f) + (float)((i * 7919) % 11) - 5.0f;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// Hasta llenar la ventana todo pasa tal cual.
+void test_warmup_passes_through() {
+    HampelFilter<5> f(MIN_PA);
+    float out;
+    float in[4] = {101325.0f, 90000.0f, 101320.0f, 101330.0f};
+    for (float x : in) {
+        TEST_ASSERT_FALSE(f.filter(x, out));
+        TEST_ASSERT_EQUAL_FLOAT(x, out);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, f.getRejected());
+    TEST_ASSERT_EQUAL_UINT32(4, f.getTotal());
+}
+
+// Un pico aislado (lectura I2C corrupta) sale como la mediana.
+void test_isolated_spike_replaced_by_median() {
+    HampelFilter<5> f(MIN_PA);
+    float out;
+    for (int i = 0; i < 20; ++i) f.filter(noisyPa(i, 101325.0f), out);
+
+    std::vector<float> win;
+    for (int i = 16; i < 20; ++i) win.push_back(noisyPa(i, 101325.0f));
+    win.push_back(95000.0f);
+    float med;
+    TEST_ASSERT_TRUE(referenceRejects(win, MIN_PA, med));
+
+    TEST_ASSERT_TRUE(f.filter(95000.0f, out));
+    TEST_ASSERT_EQUAL_FLOAT(med, out);
+    TEST_ASSERT_EQUAL_UINT32(1, f.getRejected());
+
+    // La siguiente lectura buena pasa aunque el pico siga en la ventana.
+    float next = noisyPa(21, 101325.0f);
+    TEST_ASSERT_FALSE(f.filter(next, out));
+    TEST_ASSERT_EQUAL_FLOAT(next, out);
+}
+
+// Escalón sostenido: se acepta a las (N+1)/2 muestras (retardo (N-1)/2).
+void test_sustained_step_accepted_after_half_window() {
+    HampelFilter<5> f(MIN_PA);
+    float out;
+    for (int i = 0; i < 10; ++i) f.filter(101325.0f, out);
+    TEST_ASSERT_TRUE(f.filter(100000.0f, out));
+    TEST_ASSERT_EQUAL_FLOAT(101325.0f, out);
+    TEST_ASSERT_TRUE(f.filter(100000.0f, out));
+    TEST_ASSERT_FALSE(f.filter(100000.0f, out));
+    TEST_ASSERT_EQUAL_FLOAT(100000.0f, out);
+    TEST_ASSERT_EQUAL_UINT32(2, f.getRejected());
+}
+
+// Rampa rápida (caída libre a 200 Hz: ~3 Pa por muestra, ~60 Pa a 25 Hz)
+// y ruido normal: nada se rechaza.
+void test_ramp_and_noise_pass_without_delay() {
+    HampelFilter<5> f(MIN_PA);
+    float out;
+    for (int i = 0; i < 500; ++i) {
+        float x = noisyPa(i, 70000.0f) + 60.0f * i;
+        TEST_ASSERT_FALSE(f.filter(x, out));
+        TEST_ASSERT_EQUAL_FLOAT(x, out);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, f.getRejected());
+}
+
+// NaN/inf: se rechazan, salen como la mediana y no entran en la ventana.
+void test_non_finite_rejected_and_not_stored() {
+    HampelFilter<5> f(MIN_PA);
+    float out;
+    float in[5] = {100.0f, 101.0f, 102.0f, 103.0f, 104.0f};
+    for (float x : in) f.filter(x, out);
+    TEST_ASSERT_TRUE(f.filter(NAN, out));
+    TEST_ASSERT_EQUAL_FLOAT(102.0f, out);
+    TEST_ASSERT_TRUE(f.filter(INFINITY, out));
+    TEST_ASSERT_EQUAL_FLOAT(102.0f, out);
+    TEST_ASSERT_EQUAL_UINT32(2, f.getRejected());
+    TEST_ASSERT_EQUAL_UINT32(7, f.getTotal());
+
+    // La ventana sigue siendo {100..104}: 105 está dentro del umbral mínimo.
+    TEST_ASSERT_FALSE(f.filter(105.0f, out));
+}
+
+// Ventana casi constante (forced repetido): el umbral mínimo evita
+// rechazar el ruido de 1-2 Pa.
+void test_min_threshold_with_flat_window() {
+    HampelFilter<7> f(MIN_PA);
+    float out;
+    for (int i = 0; i < 7; ++i) f.filter(101325.0f, out);
+    TEST_ASSERT_FALSE(f.filter(101327.0f, out));
+    TEST_ASSERT_FALSE(f.filter(101325.0f + MIN_PA, out));
+    TEST_ASSERT_TRUE(f.filter(101325.0f + 2.0f * MIN_PA, out));
+}
+
+// Datos con picos aleatorios: mismas decisiones y salidas que la definición.
+void test_matches_reference_definition() {
+    HampelFilter<7> f(5.0f);
+    std::vector<float> hist;
+    uint32_t lcg = 7;
+    int rejected = 0;
+    for (int i = 0; i < 2000; ++i) {
+        lcg = lcg * 1664525u + 1013904223u;
+        float x = noisyPa(i, 85000.0f) - 2.0f * i;
+        if ((lcg >> 24) < 12) x += ((lcg >> 8) & 1) ? 400.0f : -400.0f;   // ~5 % picos
+        hist.push_back(x);
+
+        float out;
+        bool rej = f.filter(x, out);
+        if (hist.size() < 7) {
+            TEST_ASSERT_FALSE(rej);
+            continue;
+        }
+        std::vector<float> win(hist.end() - 7, hist.end());
+        float med;
+        bool expect = referenceRejects(win, 5.0f, med);
+        TEST_ASSERT_EQUAL(expect, rej);
+        TEST_ASSERT_EQUAL_FLOAT(expect ? med : x, out);
+        if (rej) rejected++;
+    }
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)rejected, f.getRejected());
+    TEST_ASSERT_TRUE(rejected > 50);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_warmup_passes_through);
+    RUN_TEST(test_isolated_spike_replaced_by_median);
+    RUN_TEST(test_sustained_step_accepted_after_half_window);
+    RUN_TEST(test_ramp_and_noise_pass_without_delay);
+    RUN_TEST(test_non_finite_rejected_and_not_stored);
+    RUN_TEST(test_min_threshold_with_flat_window);
+    RUN_TEST(test_matches_reference_definition);
+    return UNITY_END();
+}
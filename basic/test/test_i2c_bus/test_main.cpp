@@ -0,0 +1,257 @@
+// I2cBus contra el Wire simulado de test/host/Wire.h: lotes por reloj,
+// fusión de lecturas, fallo rápido y back-off de un dispositivo caído, y
+// reencolado delante cuando el sensor interrumpe un lote.
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "drivers/I2cBus.h"
+
+namespace {
+
+constexpr uint8_t ADDR_FAST = 0x77;   // sólo 400 kHz
+constexpr uint8_t ADDR_SLOW = 0x68;   // sólo 100 kHz
+constexpr uint8_t ADDR_SENS = 0x76;   // SENSOR, 100..400 kHz
+
+struct Done {
+    std::vector<uint8_t> regs;   // primer byte leído (reg + fill) por callback
+    std::vector<bool>    ok;
+};
+
+void onRead(void* user, bool ok, const uint8_t* data, uint8_t len) {
+    Done* d = static_cast<Done*>(user);
+    d->regs.push_back(len ? data[0] : 0);
+    d->ok.push_back(ok);
+}
+
+size_t xfersTo(uint8_t addr) {
+    size_t n = 0;
+    for (const HostI2cXfer& x : Wire.log) if (x.addr == addr) n++;
+    return n;
+}
+
+} // namespace
+
+void setUp() {
+    Wire.reset();
+    host::setMs(1000);
+}
+
+void tearDown() {}
+
+void test_batch_groups_by_clock() {
+    I2cBus bus;
+    TEST_ASSERT_TRUE(bus.begin());
+    I2cBus::DeviceId fast = bus.addDevice(ADDR_FAST, 400000, 400000, 400000, I2cBus::Priority::BACKGROUND);
+    I2cBus::DeviceId slow = bus.addDevice(ADDR_SLOW, 100000, 100000, 100000, I2cBus::Priority::BACKGROUND);
+    Wire.log.clear();
+    Done done;
+
+    // Intercaladas: rápido, lento, rápido, lento.
+    TEST_ASSERT_TRUE(bus.submitRead(fast, 0x10, 2, onRead, &done));
+    TEST_ASSERT_TRUE(bus.submitRead(slow, 0x20, 2, onRead, &done));
+    TEST_ASSERT_TRUE(bus.submitRead(fast, 0x11, 2, onRead, &done));
+    TEST_ASSERT_TRUE(bus.submitRead(slow, 0x21, 2, onRead, &done));
+    uint32_t sets0 = Wire.clockSets;
+
+    TEST_ASSERT_EQUAL_UINT32(4, bus.service());
+
+    // El bus está a 100 kHz: primero los lentos, un solo cambio, luego los rápidos.
+    TEST_ASSERT_EQUAL_UINT32(4, Wire.log.size());
+    const uint8_t  regs[4] = {0x20, 0x21, 0x10, 0x11};
+    const uint32_t hz[4]   = {100000, 100000, 400000, 400000};
+    for (int i = 0; i < 4; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(regs[i], Wire.log[i].reg);
+        TEST_ASSERT_EQUAL_UINT32(hz[i], Wire.log[i].hz);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getStats().clockSwitches);
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.clockSets - sets0);
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getStats().batches);
+
+    // Callbacks en el mismo orden que el bus, con sus datos.
+    TEST_ASSERT_EQUAL_UINT32(4, done.regs.size());
+    for (int i = 0; i < 4; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(regs[i], done.regs[i]);
+        TEST_ASSERT_TRUE(done.ok[i]);
+    }
+
+    // Siguiente lote con el bus ya a 400 kHz: ahora van primero los rápidos.
+    TEST_ASSERT_TRUE(bus.submitRead(slow, 0x22, 1, onRead, &done));
+    TEST_ASSERT_TRUE(bus.submitRead(fast, 0x12, 1, onRead, &done));
+    TEST_ASSERT_EQUAL_UINT32(2, bus.service());
+    TEST_ASSERT_EQUAL_UINT32(0x12, Wire.log[4].reg);
+    TEST_ASSERT_EQUAL_UINT32(0x22, Wire.log[5].reg);
+    TEST_ASSERT_EQUAL_UINT32(2, bus.getStats().clockSwitches);
+}
+
+void test_identical_reads_are_merged() {
+    I2cBus bus;
+    bus.begin();
+    I2cBus::DeviceId slow = bus.addDevice(ADDR_SLOW, 100000, 100000, 400000, I2cBus::Priority::BACKGROUND);
+    Wire.log.clear();
+    Done done;
+
+    TEST_ASSERT_TRUE(bus.submitRead(slow, 0x00, 7, onRead, &done));
+    TEST_ASSERT_TRUE(bus.submitRead(slow, 0x00, 7, onRead, &done));
+    TEST_ASSERT_TRUE(bus.submitRead(slow, 0x0F, 1, onRead, &done));
+    TEST_ASSERT_EQUAL_UINT32(2, bus.pending());
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getStats().merged);
+
+    TEST_ASSERT_EQUAL_UINT32(2, bus.service());
+    TEST_ASSERT_EQUAL_UINT32(2, Wire.log.size());
+    TEST_ASSERT_EQUAL_UINT32(2, done.regs.size());
+}
+
+void test_down_device_fails_fast() {
+    I2cBus bus;
+    bus.begin();
+    I2cBus::DeviceId id = bus.addDevice(ADDR_SLOW, 100000, 100000, 400000, I2cBus::Priority::BACKGROUND);
+    Wire.dev[ADDR_SLOW].present = false;
+    Wire.log.clear();
+    uint8_t buf[2];
+
+    for (int i = 0; i < I2C_FAILS_BEFORE_RECOVERY; ++i) {
+        TEST_ASSERT_FALSE(bus.isDeviceDown(id));
+        TEST_ASSERT_FALSE(bus.readReg(id, 0x00, buf, 2));
+    }
+    TEST_ASSERT_TRUE(bus.isDeviceDown(id));
+    TEST_ASSERT_EQUAL_UINT32(I2C_FAILS_BEFORE_RECOVERY, xfersTo(ADDR_SLOW));
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getStats().recoveries);
+    TEST_ASSERT_EQUAL_UINT32(2, Wire.begins);   // begin() + recuperación
+
+    // Caído: ni lecturas ni escrituras ni probe tocan el bus.
+    TEST_ASSERT_FALSE(bus.readReg(id, 0x00, buf, 2));
+    TEST_ASSERT_FALSE(bus.writeReg(id, 0x0E, buf, 1));
+    TEST_ASSERT_FALSE(bus.probe(id));
+    TEST_ASSERT_EQUAL_UINT32(I2C_FAILS_BEFORE_RECOVERY, xfersTo(ADDR_SLOW));
+    TEST_ASSERT_EQUAL_UINT32(3, bus.getStats().fastFails);
+    TEST_ASSERT_EQUAL_UINT32(I2C_FAILS_BEFORE_RECOVERY + 3, bus.getStats().errors);
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getStats().recoveries);
+}
+
+void test_backoff_grows_and_clamps() {
+    I2cBus bus;
+    bus.begin();
+    I2cBus::DeviceId id = bus.addDevice(ADDR_SLOW, 100000, 100000, 400000, I2cBus::Priority::BACKGROUND);
+    Wire.dev[ADDR_SLOW].present = false;
+    uint8_t b;
+    uint32_t t0 = millis();
+    for (int i = 0; i < I2C_FAILS_BEFORE_RECOVERY; ++i) bus.readReg(id, 0, &b, 1);
+
+    // I2C_DOWN_RETRY_MIN_MS << k, con tope I2C_DOWN_RETRY_MS.
+    std::vector<uint32_t> expect;
+    for (uint32_t k = 0; k < 8; ++k) {
+        uint32_t r = I2C_DOWN_RETRY_MIN_MS << k;
+        expect.push_back(r > I2C_DOWN_RETRY_MS ? I2C_DOWN_RETRY_MS : r);
+    }
+    TEST_ASSERT_EQUAL_UINT32(10, expect[0]);
+    TEST_ASSERT_EQUAL_UINT32(160, expect[4]);
+    TEST_ASSERT_EQUAL_UINT32(200, expect[5]);
+
+    for (uint32_t wait : expect) {
+        size_t before = xfersTo(ADDR_SLOW);
+        host::advanceMs(wait - 1);
+        TEST_ASSERT_FALSE(bus.readReg(id, 0, &b, 1));
+        TEST_ASSERT_EQUAL_UINT32(before, xfersTo(ADDR_SLOW));       // aún en back-off
+        host::advanceMs(1);
+        TEST_ASSERT_FALSE(bus.readReg(id, 0, &b, 1));
+        TEST_ASSERT_EQUAL_UINT32(before + 1, xfersTo(ADDR_SLOW));   // reintento real
+    }
+    TEST_ASSERT_EQUAL_UINT32(1 + expect.size(), bus.getStats().recoveries);
+
+    // Vuelve: el siguiente reintento sale bien y se registra el corte.
+    Wire.dev[ADDR_SLOW].present = true;
+    host::advanceMs(I2C_DOWN_RETRY_MS);
+    TEST_ASSERT_TRUE(bus.readReg(id, 0, &b, 1));
+    TEST_ASSERT_FALSE(bus.isDeviceDown(id));
+    TEST_ASSERT_EQUAL_UINT32(millis() - t0, bus.getStats().worstOutageMs);
+    TEST_ASSERT_TRUE(bus.readReg(id, 0, &b, 1));
+}
+
+void test_transient_failure_does_not_take_device_down() {
+    I2cBus bus;
+    bus.begin();
+    I2cBus::DeviceId id = bus.addDevice(ADDR_SLOW, 100000, 100000, 400000, I2cBus::Priority::BACKGROUND);
+    Wire.dev[ADDR_SLOW].failCode = 5;   // timeout
+    Wire.dev[ADDR_SLOW].failNext = I2C_FAILS_BEFORE_RECOVERY - 1;
+    uint8_t b;
+    for (int i = 0; i < I2C_FAILS_BEFORE_RECOVERY - 1; ++i) TEST_ASSERT_FALSE(bus.readReg(id, 0, &b, 1));
+    TEST_ASSERT_TRUE(bus.readReg(id, 0, &b, 1));
+    TEST_ASSERT_FALSE(bus.isDeviceDown(id));
+    TEST_ASSERT_EQUAL_UINT32(0, bus.getStats().recoveries);
+    TEST_ASSERT_EQUAL_UINT32(I2C_FAILS_BEFORE_RECOVERY - 1, bus.getStats().timeouts);
+}
+
+void test_sensor_preempts_batch_and_rest_requeued_in_front() {
+    I2cBus bus;
+    bus.begin();
+    I2cBus::DeviceId bg   = bus.addDevice(ADDR_SLOW, 100000, 100000, 400000, I2cBus::Priority::BACKGROUND);
+    I2cBus::DeviceId sens = bus.addDevice(ADDR_SENS, 400000, 100000, 400000, I2cBus::Priority::SENSOR);
+    Wire.log.clear();
+    Done done;
+
+    for (uint8_t r = 1; r <= 4; ++r) TEST_ASSERT_TRUE(bus.submitRead(bg, r, 1, onRead, &done));
+
+    // Durante la primera transacción del lote: llega el sensor (se queda
+    // esperando el mutex) y entran 6 lecturas nuevas en la cola.
+    std::thread sensor;
+    std::atomic<bool> sensorOk{false};
+    bool fired = false;
+    Wire.onXfer = [&](const HostI2cXfer&) {
+        if (fired) return;
+        fired = true;
+        for (uint8_t r = 10; r < 16; ++r) bus.submitRead(bg, r, 1, onRead, &done);
+        sensor = std::thread([&] {
+            uint8_t b;
+            sensorOk = bus.readReg(sens, 0x04, &b, 1);
+        });
+        while (host::blockedTakes.load() == 0) std::this_thread::yield();
+    };
+
+    TEST_ASSERT_EQUAL_UINT32(1, bus.service());   // suelta el bus tras una
+    sensor.join();
+    Wire.onXfer = nullptr;
+    TEST_ASSERT_TRUE(sensorOk.load());
+
+    // Bus: lectura 1 del lote y después el sensor.
+    TEST_ASSERT_EQUAL_UINT32(2, Wire.log.size());
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.log[0].reg);
+    TEST_ASSERT_EQUAL_UINT32(ADDR_SENS, Wire.log[1].addr);
+    TEST_ASSERT_EQUAL_UINT32(1, done.regs.size());
+
+    // Cola: 2,3,4 delante (conservan su orden) y detrás las nuevas; no caben
+    // las 9, se pierde la más reciente.
+    TEST_ASSERT_EQUAL_UINT32(I2C_BUS_QUEUE_LEN, bus.pending());
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getStats().dropped);
+
+    TEST_ASSERT_EQUAL_UINT32(I2C_BUS_QUEUE_LEN, bus.service());
+    const uint8_t expect[I2C_BUS_QUEUE_LEN] = {2, 3, 4, 10, 11, 12, 13, 14};
+    for (int i = 0; i < I2C_BUS_QUEUE_LEN; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(expect[i], Wire.log[2 + i].reg);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1 + I2C_BUS_QUEUE_LEN, done.regs.size());
+    TEST_ASSERT_EQUAL_UINT32(0, bus.pending());
+}
+
+void test_full_queue_drops_submit() {
+    I2cBus bus;
+    bus.begin();
+    I2cBus::DeviceId bg = bus.addDevice(ADDR_SLOW, 100000, 100000, 400000, I2cBus::Priority::BACKGROUND);
+    for (uint8_t r = 0; r < I2C_BUS_QUEUE_LEN; ++r) TEST_ASSERT_TRUE(bus.submitRead(bg, r, 1, nullptr, nullptr));
+    TEST_ASSERT_FALSE(bus.submitRead(bg, 0x40, 1, nullptr, nullptr));
+    TEST_ASSERT_EQUAL_UINT32(1, bus.getStats().dropped);
+    TEST_ASSERT_EQUAL_UINT32(I2C_BUS_QUEUE_LEN, bus.pending());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_batch_groups_by_clock);
+    RUN_TEST(test_identical_reads_are_merged);
+    RUN_TEST(test_down_device_fails_fast);
+    RUN_TEST(test_backoff_grows_and_clamps);
+    RUN_TEST(test_transient_failure_does_not_take_device_down);
+    RUN_TEST(test_sensor_preempts_batch_and_rest_requeued_in_front);
+    RUN_TEST(test_full_queue_drops_submit);
+    return UNITY_END();
+}
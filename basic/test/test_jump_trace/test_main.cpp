@@ -0,0 +1,263 @@
+// Salto completo en host: JumpRecorder + FlightTraceRecorder + StorageService
+// reales sobre HOST_FS_ROOT. Las fases se imponen desde el guion (no se
+// ejercita FlightPhaseService); la tarea de storage es un std::thread.
+#include <unity.h>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "core/JumpRecorder.h"
+#include "core/FlightTraceRecorder.h"
+
+namespace {
+
+constexpr uint32_t DT_MS = 100;   // 10 Hz
+
+struct Rig {
+    LogbookService      logbook;
+    TraceStore          traces;
+    StorageService      storage;
+    PreTriggerBuffer    pre;
+    JumpRecorder        jump;
+    FlightTraceRecorder trace;
+    FlightPhase         prev = FlightPhase::GROUND;
+    uint32_t            tMs  = 1000;
+    float               altM = 0.0f;
+
+    bool begin() {
+        if (!storage.begin(&logbook, &traces)) return false;
+        jump.begin(&storage, nullptr, &pre);
+        trace.begin(&storage, &jump, &pre);
+        return true;
+    }
+
+    void step(FlightPhase phase, float vs, bool stable = false) {
+        altM += vs * (DT_MS / 1000.0f);
+        if (altM < 0.0f) altM = 0.0f;
+        AltitudeData a{};
+        a.rawAlt         = Meters{altM};
+        a.altToShow      = Meters{altM};
+        a.verticalSpeed  = MetersPerSecond{vs};
+        a.isGroundStable = stable;
+        a.temperatureC   = 15.0f;
+        a.pressure       = Pascals{101325.0f - 12.0f * altM};
+        pre.push(a, tMs);
+        jump.update(a, phase, prev, tMs);
+        trace.update(a, phase, prev, tMs);
+        prev = phase;
+        tMs += DT_MS;
+    }
+
+    void run(FlightPhase phase, float vs, uint32_t durMs, bool stable = false) {
+        for (uint32_t t = 0; t < durMs; t += DT_MS) step(phase, vs, stable);
+    }
+
+    // Suelo 5 s, subida a ~1200 m, 25 s de caída libre, campana y suelo estable.
+    void jumpProfile() {
+        run(FlightPhase::GROUND,   0.0f,  5000, true);
+        run(FlightPhase::CLIMB,    6.0f,  200000);
+        run(FlightPhase::FREEFALL, -5.0f, 1000);
+        run(FlightPhase::FREEFALL, -25.0f, 2000);
+        run(FlightPhase::FREEFALL, -50.0f, 22000);
+        run(FlightPhase::CANOPY,   -15.0f, 2000);
+        while (altM > 0.5f) step(FlightPhase::CANOPY, -5.0f);
+        run(FlightPhase::GROUND,   0.0f,  3000, true);
+    }
+
+    // Sigue en suelo (tiempo real) hasta que ambos grabadores quedan libres.
+    bool settle(uint32_t timeoutMs = 5000) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (;;) {
+            step(FlightPhase::GROUND, 0.0f, true);
+            if (!trace.isBusy() && !jump.hasPendingAppend() && !storage.isBusy()) return true;
+            if (std::chrono::steady_clock::now() - t0 > std::chrono::milliseconds(timeoutMs)) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+};
+
+// Bloque 'pos' del anillo, leído del archivo.
+TraceBlock readBlock(uint32_t pos) {
+    TraceBlock b{};
+    int fd = ::open(TRACE_POSIX_PATH, O_RDONLY);
+    if (fd < 0) return b;
+    ssize_t r = ::pread(fd, &b, sizeof(b), (off_t)TRACE_BLOCK_SIZE * (1u + pos));
+    ::close(fd);
+    if (r != (ssize_t)sizeof(b)) b.hdr.jumpId = 0;
+    return b;
+}
+
+uint32_t blockJumpId(uint32_t pos) { return readBlock(pos).hdr.jumpId; }
+
+} // namespace
+
+void setUp() {
+    LittleFS.wipe();
+    LittleFS.failMount = false;
+}
+
+void tearDown() {}
+
+void test_logged_jump_closes_and_links_trace() {
+    Rig* rig = new Rig();   // la tarea de storage no termina: no se libera
+    TEST_ASSERT_TRUE(rig->begin());
+
+    rig->jumpProfile();
+    TEST_ASSERT_EQUAL_UINT32(1, rig->jump.getClosedCount());
+    TEST_ASSERT_TRUE(rig->jump.lastJumpLogged());
+    TEST_ASSERT_FALSE(rig->jump.isJumping());
+
+    TEST_ASSERT_TRUE(rig->settle());
+    TEST_ASSERT_TRUE(rig->jump.lastAppendResolved());
+    TEST_ASSERT_TRUE(rig->jump.lastAppendOk());
+    TEST_ASSERT_EQUAL_UINT32(1, rig->jump.getLastJumpId());
+
+    LogbookService::Record r{};
+    TEST_ASSERT_TRUE(rig->storage.getByIndex(0, r));
+    TEST_ASSERT_EQUAL_UINT32(1, r.id);
+    TEST_ASSERT_FLOAT_WITHIN(30.0f, 1200.0f, r.exitAltM);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 25.0f, r.freefallTimeS);
+
+    // Traza volcada y etiquetada con el id real.
+    uint32_t n = rig->trace.getBlocksWritten();
+    TEST_ASSERT_GREATER_THAN(0, n);
+    TEST_ASSERT_EQUAL_UINT32(n, rig->traces.blockCount());
+    for (uint32_t i = 0; i < n; ++i) TEST_ASSERT_EQUAL_UINT32(1, blockJumpId(i));
+
+    // Segundo salto: id 2, sin arrastrar nada del primero.
+    rig->jumpProfile();
+    TEST_ASSERT_EQUAL_UINT32(2, rig->jump.getClosedCount());
+    TEST_ASSERT_TRUE(rig->settle());
+    TEST_ASSERT_EQUAL_UINT32(2, rig->jump.getLastJumpId());
+    uint32_t n2 = rig->trace.getBlocksWritten() - n;   // acumulado
+    TEST_ASSERT_GREATER_THAN(0, n2);
+    TEST_ASSERT_EQUAL_UINT32(n + n2, rig->traces.blockCount());
+    TEST_ASSERT_EQUAL_UINT32(2, blockJumpId(n));
+    TEST_ASSERT_EQUAL_UINT32(2, blockJumpId(n + n2 - 1));
+}
+
+void test_ride_down_is_discarded_with_its_trace() {
+    Rig* rig = new Rig();
+    TEST_ASSERT_TRUE(rig->begin());
+
+    rig->run(FlightPhase::GROUND, 0.0f, 5000, true);
+    rig->run(FlightPhase::CLIMB,  6.0f, 60000);
+    rig->run(FlightPhase::CANOPY, -5.0f, 10000);   // sin FREEFALL
+    while (rig->altM > 0.5f) rig->step(FlightPhase::CANOPY, -5.0f);
+    rig->run(FlightPhase::GROUND, 0.0f, 3000, true);
+
+    TEST_ASSERT_EQUAL_UINT32(1, rig->jump.getClosedCount());
+    TEST_ASSERT_FALSE(rig->jump.lastJumpLogged());
+    TEST_ASSERT_TRUE(rig->settle());
+    TEST_ASSERT_EQUAL_UINT32(0, rig->trace.getBlocksWritten());
+    TEST_ASSERT_EQUAL_UINT32(0, rig->storage.snapshot().stats.totalIds);
+}
+
+void test_failed_append_drops_trace_and_frees_recorder() {
+    LittleFS.failMount = true;   // el append termina con ok=false
+    Rig* rig = new Rig();
+    TEST_ASSERT_TRUE(rig->begin());
+
+    rig->jumpProfile();
+    TEST_ASSERT_TRUE(rig->jump.lastJumpLogged());
+    TEST_ASSERT_TRUE(rig->settle());
+    TEST_ASSERT_TRUE(rig->jump.lastAppendResolved());
+    TEST_ASSERT_FALSE(rig->jump.lastAppendOk());
+    TEST_ASSERT_EQUAL_UINT32(0, rig->jump.getLastJumpId());
+    TEST_ASSERT_EQUAL_UINT32(0, rig->trace.getBlocksWritten());
+}
+
+void test_analytics_available_after_logged_jump() {
+    Rig* rig = new Rig();
+    TEST_ASSERT_TRUE(rig->begin());
+
+    LogbookService::Ext ext{};
+    TEST_ASSERT_FALSE(rig->jump.getLastAnalytics(ext));
+
+    // Salida a ~1500 m, 23 s de caída (pico 50 m/s a los 3 s), apertura a
+    // ~445 m y vela a 5 m/s hasta el suelo.
+    rig->run(FlightPhase::GROUND,   0.0f,  5000, true);
+    rig->run(FlightPhase::CLIMB,    6.0f,  250000);
+    rig->run(FlightPhase::FREEFALL, -5.0f, 1000);
+    rig->run(FlightPhase::FREEFALL, -25.0f, 2000);
+    rig->run(FlightPhase::FREEFALL, -50.0f, 20000);
+    rig->run(FlightPhase::CANOPY,   -15.0f, 2000);
+    while (rig->altM > 0.5f) rig->step(FlightPhase::CANOPY, -5.0f);
+    rig->run(FlightPhase::GROUND,   0.0f,  3000, true);
+
+    TEST_ASSERT_TRUE(rig->jump.getLastAnalytics(ext));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 50.0f, ext.peakFFmps);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 46.0f, ext.avgFFmps);
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 3.0f, ext.t90s);
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, 85.0f, ext.canopyTimeS);
+    TEST_ASSERT_FLOAT_WITHIN(0.8f, 5.2f, ext.avgCanopyMps);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 5.0f, ext.finalApproachMps);
+
+    // Lo mismo que quedó escrito en la extensión de la bitácora.
+    TEST_ASSERT_TRUE(rig->settle());
+    LogbookService::Ext stored{};
+    TEST_ASSERT_TRUE(rig->storage.getExtByIndex(0, stored));
+    TEST_ASSERT_EQUAL_UINT32(rig->jump.getLastJumpId(), stored.id);
+    TEST_ASSERT_EQUAL_FLOAT(ext.peakFFmps, stored.peakFFmps);
+    TEST_ASSERT_EQUAL_FLOAT(ext.t90s, stored.t90s);
+    TEST_ASSERT_EQUAL_FLOAT(ext.canopyTimeS, stored.canopyTimeS);
+
+    // Un ride-down posterior invalida la analítica del último salto.
+    rig->run(FlightPhase::CLIMB,  6.0f, 60000);
+    rig->run(FlightPhase::CANOPY, -5.0f, 10000);
+    while (rig->altM > 0.5f) rig->step(FlightPhase::CANOPY, -5.0f);
+    rig->run(FlightPhase::GROUND, 0.0f, 3000, true);
+    TEST_ASSERT_FALSE(rig->jump.lastJumpLogged());
+    TEST_ASSERT_FALSE(rig->jump.getLastAnalytics(ext));
+}
+
+void test_long_flight_is_truncated_not_wrapped() {
+    Rig* rig = new Rig();
+    TEST_ASSERT_TRUE(rig->begin());
+    TEST_ASSERT_TRUE(rig->trace.arenaBlocks() <= TRACE_CAPACITY_BLOCKS);
+
+    // Subida de una hora: bastante más de lo que cabe en el arena.
+    rig->run(FlightPhase::GROUND,   0.0f,  5000, true);
+    rig->run(FlightPhase::CLIMB,    1.0f,  3600000);
+    rig->run(FlightPhase::FREEFALL, -50.0f, 20000);
+    while (rig->altM > 0.5f) rig->step(FlightPhase::CANOPY, -5.0f);
+    rig->run(FlightPhase::GROUND,   0.0f,  3000, true);
+    TEST_ASSERT_TRUE(rig->settle());
+    TEST_ASSERT_GREATER_THAN(0, rig->trace.getDroppedSamples());
+
+    // Todo el arena llegó a flash, en orden y sin pisarse: el primer bloque
+    // sigue siendo el primero y el último lleva la marca de truncado.
+    uint32_t n = rig->trace.getBlocksWritten();
+    TEST_ASSERT_EQUAL_UINT32(rig->trace.arenaBlocks(), n);
+    TEST_ASSERT_EQUAL_UINT32(n, rig->traces.blockCount());
+    TraceBlock first = readBlock(0);
+    TraceBlock last  = readBlock(n - 1);
+    TEST_ASSERT_EQUAL_UINT32(1, first.hdr.jumpId);
+    TEST_ASSERT_EQUAL_UINT32(0, first.hdr.seq);
+    TEST_ASSERT_TRUE(first.hdr.flags & TRACE_FLAG_FIRST);
+    TEST_ASSERT_EQUAL_UINT32(n - 1, last.hdr.seq);
+    TEST_ASSERT_TRUE(last.hdr.flags & TRACE_FLAG_LAST);
+    TEST_ASSERT_TRUE(last.hdr.flags & TRACE_FLAG_TRUNCATED);
+}
+
+void test_store_rejects_more_than_the_ring() {
+    TraceStore store;
+    TEST_ASSERT_TRUE(store.begin());
+    static TraceBlock blks[TRACE_CAPACITY_BLOCKS + 1];
+    TEST_ASSERT_FALSE(store.appendBlocks(blks, TRACE_CAPACITY_BLOCKS + 1));
+    TEST_ASSERT_EQUAL_UINT32(0, store.blockCount());
+    TEST_ASSERT_TRUE(store.appendBlocks(blks, 2));
+    TEST_ASSERT_EQUAL_UINT32(2, store.blockCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_logged_jump_closes_and_links_trace);
+    RUN_TEST(test_ride_down_is_discarded_with_its_trace);
+    RUN_TEST(test_failed_append_drops_trace_and_frees_recorder);
+    RUN_TEST(test_analytics_available_after_logged_jump);
+    RUN_TEST(test_long_flight_is_truncated_not_wrapped);
+    RUN_TEST(test_store_rejects_more_than_the_ring);
+    return UNITY_END();
+}
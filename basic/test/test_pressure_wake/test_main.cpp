@@ -0,0 +1,128 @@
+// pwm_step (util/PressureWakeModel.h), el modelo de despertar por subida
+// durante deep sleep: subida confirmada, falsas alarmas, bajadas, deriva
+// meteorológica y lecturas inválidas, con la configuración de
+// PressureWakeService (1500 Pa, 2 confirmaciones, seguimiento 1/8).
+#include <unity.h>
+
+#include "util/PressureWakeModel.h"
+
+namespace {
+
+constexpr int32_t GROUND_PA = 101325;
+
+pwm_cfg_t   gCfg;
+pwm_state_t gState;
+
+} // namespace
+
+void setUp() {
+    gCfg.climbPa    = 1500;
+    gCfg.confirmN   = 2;
+    gCfg.trackShift = 3;
+    pwm_arm(&gState, GROUND_PA);
+}
+void tearDown() {}
+
+// Sin armar (o con estado basura de RTC tras un arranque en frío) no despierta.
+void test_unarmed_never_wakes() {
+    pwm_state_t s = {};
+    TEST_ASSERT_FALSE(pwm_is_armed(&s));
+    TEST_ASSERT_EQUAL(PWM_SLEEP, pwm_step(&s, &gCfg, 50000));
+
+    pwm_disarm(&gState);
+    TEST_ASSERT_EQUAL(PWM_SLEEP, pwm_step(&gState, &gCfg, 50000));
+    TEST_ASSERT_EQUAL_UINT16(0, gState.samples);
+
+    pwm_arm(&s, 20000);                  // presión de suelo absurda: no se arma
+    TEST_ASSERT_FALSE(pwm_is_armed(&s));
+}
+
+// Subida: una caída grande pide confirmación y la segunda despierta.
+void test_climb_confirmed_then_wakes() {
+    TEST_ASSERT_EQUAL(PWM_CONFIRM, pwm_step(&gState, &gCfg, GROUND_PA - 1600));
+    TEST_ASSERT_EQUAL_UINT8(1, gState.hits);
+    TEST_ASSERT_EQUAL(GROUND_PA, gState.refPa);          // la referencia no se mueve
+    TEST_ASSERT_EQUAL(PWM_WAKE, pwm_step(&gState, &gCfg, GROUND_PA - 2400));
+    TEST_ASSERT_EQUAL_UINT16(2, gState.samples);
+    TEST_ASSERT_EQUAL(GROUND_PA - 2400, gState.lastPa);
+}
+
+// Justo en el umbral cuenta; un pelo por debajo no.
+void test_threshold_is_inclusive() {
+    TEST_ASSERT_EQUAL(PWM_SLEEP,   pwm_step(&gState, &gCfg, GROUND_PA - 1499));
+    pwm_arm(&gState, GROUND_PA);
+    TEST_ASSERT_EQUAL(PWM_CONFIRM, pwm_step(&gState, &gCfg, GROUND_PA - 1500));
+}
+
+// Falsa alarma (ráfaga, puerta): una muestra baja de vuelta reinicia la cuenta.
+void test_false_alarm_resets_hits() {
+    TEST_ASSERT_EQUAL(PWM_CONFIRM, pwm_step(&gState, &gCfg, GROUND_PA - 2000));
+    TEST_ASSERT_EQUAL(PWM_SLEEP,   pwm_step(&gState, &gCfg, GROUND_PA - 10));
+    TEST_ASSERT_EQUAL_UINT8(0, gState.hits);
+    TEST_ASSERT_EQUAL(PWM_CONFIRM, pwm_step(&gState, &gCfg, GROUND_PA - 2000));
+    TEST_ASSERT_EQUAL(PWM_WAKE,    pwm_step(&gState, &gCfg, GROUND_PA - 2000));
+}
+
+// Bajada (presión que sube): el suelo nuevo es la lectura, y la subida se
+// mide desde ahí.
+void test_descent_moves_reference_down_at_once() {
+    TEST_ASSERT_EQUAL(PWM_SLEEP, pwm_step(&gState, &gCfg, GROUND_PA + 3000));
+    TEST_ASSERT_EQUAL(GROUND_PA + 3000, gState.refPa);
+    // 1600 Pa por debajo del suelo nuevo: ya es subida aunque esté por
+    // encima del suelo original.
+    TEST_ASSERT_EQUAL(PWM_CONFIRM, pwm_step(&gState, &gCfg, GROUND_PA + 1400));
+}
+
+// Deriva meteorológica lenta (-3 hPa en 3 h, muestra por minuto): la
+// referencia la sigue y nunca despierta.
+void test_slow_weather_drift_never_wakes() {
+    int32_t pa = GROUND_PA;
+    for (int i = 1; i <= 180; ++i) {
+        pa = GROUND_PA - (300 * i) / 180;
+        TEST_ASSERT_EQUAL(PWM_SLEEP, pwm_step(&gState, &gCfg, pa));
+    }
+    TEST_ASSERT_EQUAL(GROUND_PA - 300, pa);
+    // Ref a menos de 2^trackShift·pendiente de la presión.
+    TEST_ASSERT_TRUE(gState.refPa - pa < 16);
+    TEST_ASSERT_TRUE(gState.refPa >= pa);
+}
+
+// Una subida real tras horas de deriva sigue despertando.
+void test_climb_after_drift_still_wakes() {
+    int32_t pa = GROUND_PA;
+    for (int i = 0; i < 600; ++i) {
+        pa -= 1;
+        pwm_step(&gState, &gCfg, pa);
+    }
+    // Avión a ~5 m/s: ~3600 Pa por minuto.
+    TEST_ASSERT_EQUAL(PWM_CONFIRM, pwm_step(&gState, &gCfg, pa - 3600));
+    TEST_ASSERT_EQUAL(PWM_WAKE,    pwm_step(&gState, &gCfg, pa - 4400));
+}
+
+// Lecturas fuera de rango: se ignoran sin tocar el estado.
+void test_invalid_reading_leaves_state_untouched() {
+    pwm_step(&gState, &gCfg, GROUND_PA - 2000);          // hits = 1
+    pwm_state_t before = gState;
+    TEST_ASSERT_EQUAL(PWM_SLEEP, pwm_step(&gState, &gCfg, 0));
+    TEST_ASSERT_EQUAL(PWM_SLEEP, pwm_step(&gState, &gCfg, PWM_MAX_PA + 1));
+    TEST_ASSERT_EQUAL(PWM_SLEEP, pwm_step(&gState, &gCfg, PWM_MIN_PA - 1));
+    TEST_ASSERT_EQUAL(before.refPa, gState.refPa);
+    TEST_ASSERT_EQUAL(before.lastPa, gState.lastPa);
+    TEST_ASSERT_EQUAL_UINT8(before.hits, gState.hits);
+    TEST_ASSERT_EQUAL_UINT16(before.samples, gState.samples);
+    // Y la confirmación sigue pendiente.
+    TEST_ASSERT_EQUAL(PWM_WAKE, pwm_step(&gState, &gCfg, GROUND_PA - 2000));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unarmed_never_wakes);
+    RUN_TEST(test_climb_confirmed_then_wakes);
+    RUN_TEST(test_threshold_is_inclusive);
+    RUN_TEST(test_false_alarm_resets_hits);
+    RUN_TEST(test_descent_moves_reference_down_at_once);
+    RUN_TEST(test_slow_weather_drift_never_wakes);
+    RUN_TEST(test_climb_after_drift_still_wakes);
+    RUN_TEST(test_invalid_reading_leaves_state_untouched);
+    return UNITY_END();
+}
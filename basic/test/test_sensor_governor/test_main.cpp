@@ -0,0 +1,267 @@
+// Simulación en host de SensorGovernor sobre un salto completo: suelo, subida,
+// caída libre y vela.
+//
+// Un BMP390 simulado convierte a su ODR: altitud real en el centro de la
+// conversión + ruido blanco σ1/√osr, IIR del sensor sobre la presión. Cada
+// lectura pasa por la cadena real de AltimetryService (Hampel + EMA) y el
+// gobernador elige la configuración del ciclo siguiente, igual que
+// SensorTask. Una segunda cadena sin ruido con las mismas configuraciones
+// separa el ruido (ruidosa - limpia) del error por retardo (limpia - real).
+//
+// Se imprime consumo frente a error por tramo, del gobernador y de la tabla
+// fija de Bmp390Driver::configForMode, y se comprueba que la configuración
+// elegida cumple GOV_NOISE_TARGET_M, GOV_DYN_ERR_TARGET_M y
+// GOV_MAX_LATENCY_MS tanto en la predicción como medida.
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "core/AltimetryService.h"
+#include "core/SensorGovernor.h"
+
+namespace {
+
+constexpr float P0_PA    = 101325.0f;
+constexpr float SIGMA1_M = 0.20f;    // ruido x1 sin IIR del sensor simulado
+
+// Perfil: duraciones (s) y dinámica de cada tramo.
+constexpr float GROUND_S = 60.0f;
+constexpr float CLIMB_S  = 450.0f;
+constexpr float FF_S     = 60.0f;
+constexpr float CANOPY_S = 120.0f;
+constexpr float CLIMB_VS   = 8.0f;   // m/s
+constexpr float CLIMB_RAMP = 4.0f;   // s hasta CLIMB_VS
+constexpr float VT_MPS     = 50.0f;
+constexpr float G_MPS2     = 9.81f;
+constexpr float CANOPY_VS  = 5.0f;
+constexpr float DECEL_S    = 3.0f;
+
+constexpr float SETTLE_S   = 10.0f;  // se mide desde aquí dentro de cada tramo
+
+struct Segment {
+    const char* name;
+    float       t0, t1;
+    FlightPhase phase;
+    SensorMode  mode;
+    float       absVs;   // VS de régimen para la predicción
+};
+
+constexpr float T_CLIMB  = GROUND_S;
+constexpr float T_FF     = T_CLIMB + CLIMB_S;
+constexpr float T_CANOPY = T_FF + FF_S;
+constexpr float T_END    = T_CANOPY + CANOPY_S;
+
+const Segment SEGMENTS[] = {
+    {"suelo",  0.0f,     T_CLIMB,  FlightPhase::GROUND,   SensorMode::AHORRO,   0.0f},
+    {"subida", T_CLIMB,  T_FF,     FlightPhase::CLIMB,    SensorMode::PRECISO,  CLIMB_VS},
+    {"caida",  T_FF,     T_CANOPY, FlightPhase::FREEFALL, SensorMode::FREEFALL, VT_MPS},
+    {"vela",   T_CANOPY, T_END,    FlightPhase::CANOPY,   SensorMode::PRECISO,  CANOPY_VS},
+};
+constexpr int SEGMENT_COUNT = sizeof(SEGMENTS) / sizeof(SEGMENTS[0]);
+
+// Altitud real (m sobre P0_PA), analítica por tramos.
+double climbAlt(double s) {
+    if (s < CLIMB_RAMP) return CLIMB_VS * s * s / (2.0 * CLIMB_RAMP);
+    return CLIMB_VS * CLIMB_RAMP / 2.0 + CLIMB_VS * (s - CLIMB_RAMP);
+}
+double ffDrop(double s) {
+    return (double)VT_MPS * VT_MPS / G_MPS2 * log(cosh(G_MPS2 * s / VT_MPS));
+}
+double canopyDrop(double s) {
+    double vF = VT_MPS * tanh(G_MPS2 * FF_S / VT_MPS);
+    if (s < DECEL_S) return vF * s - (vF - CANOPY_VS) * s * s / (2.0 * DECEL_S);
+    return vF * DECEL_S - (vF - CANOPY_VS) * DECEL_S / 2.0 + CANOPY_VS * (s - DECEL_S);
+}
+double truthAlt(double t) {
+    if (t < T_CLIMB)  return 0.0;
+    if (t < T_FF)     return climbAlt(t - T_CLIMB);
+    double top = climbAlt(CLIMB_S);
+    if (t < T_CANOPY) return top - ffDrop(t - T_FF);
+    return top - ffDrop(FF_S) - canopyDrop(t - T_CANOPY);
+}
+
+// Inversa exacta de la conversión de AltimetryService (1/BARO_EXP).
+float pressureAt(double altM) {
+    return (float)(P0_PA * pow(1.0 - altM / BARO_COEFF, 1.0 / BARO_EXP));
+}
+
+// Ruido gaussiano determinista (LCG + Box-Muller).
+struct Rng {
+    uint32_t s = 12345;
+    float uniform() {
+        s = s * 1664525u + 1013904223u;
+        return ((s >> 8) + 0.5f) / 16777216.0f;
+    }
+    float gauss() {
+        float u1 = uniform(), u2 = uniform();
+        return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+    }
+};
+
+// Sensor simulado + AltimetryService.
+struct Chain {
+    AltimetryService alt;
+    float            iirPa = NAN;
+
+    Chain() {
+        alt.begin(nullptr);
+        alt.processSample(P0_PA, 15.0f, 0, 0);   // primera lectura: cero en P0_PA
+        alt.setLockActive(true);   // sin re-cero por traslado
+    }
+
+    void convert(double altM, const SensorConfig& c, uint32_t tUs) {
+        float p    = pressureAt(altM);
+        float coef = (float)c.iirCoef();
+        iirPa = isfinite(iirPa) ? (coef * iirPa + p) / (coef + 1.0f) : p;
+        alt.processSample(iirPa, 15.0f, tUs / 1000u, tUs);
+    }
+
+    // Altitud sobre P0_PA: los re-ceros de la lógica de suelo (cero inicial
+    // y deriva) mueven refPressurePa sólo en la cadena con ruido.
+    float altM() const {
+        float h = alt.getAltitudeData().rawAlt.v;
+        float z = BARO_COEFF * (1.0f - powf(alt.getRefPressurePa() / P0_PA, BARO_EXP));
+        return h + z - h * z / BARO_COEFF;
+    }
+};
+
+struct Stats {
+    double   sumD = 0.0, sumD2 = 0.0, energyUaS = 0.0, timeS = 0.0;
+    float    maxErr = 0.0f;
+    uint32_t n = 0;
+    SensorConfig last;
+    SensorGovernor::Prediction pred{};   // de 'last', con la VS del tramo
+
+    float noiseM() const {
+        double m = sumD / n;
+        return (float)sqrt(sumD2 / n - m * m);
+    }
+    float powerUa() const { return (float)(energyUaS / timeS); }
+};
+
+struct Result {
+    Stats        seg[SEGMENT_COUNT];
+    float        noiseX1M = NAN;
+    SensorGovernor gov;
+};
+
+// Corre el salto. Con 'governed' el gobernador elige la configuración; si no,
+// la tabla fija por modo. Cada lectura llega al ritmo de su ODR.
+void simulate(bool governed, Result& r) {
+    Chain noisy, clean;
+    Rng   rng;
+    r.gov.begin();
+
+    int seg = 0;
+    SensorConfig cfg = Bmp390Driver::configForMode(SEGMENTS[0].mode);
+    uint32_t tUs = 0;
+    while (tUs * 1e-6 < T_END) {
+        uint32_t stepUs = (uint32_t)lroundf(1e6f / cfg.odrHz());
+        tUs += stepUs;
+        double t = tUs * 1e-6;
+        while (seg + 1 < SEGMENT_COUNT && t >= SEGMENTS[seg + 1].t0) seg++;
+        const Segment& sg = SEGMENTS[seg];
+
+        // Centro de la conversión: medio periodo de ODR (lectura asíncrona)
+        // y media medida antes de la lectura.
+        double tConv = t - 0.5 / cfg.odrHz() - cfg.measTimeUs(false) * 0.5e-6;
+        double h     = truthAlt(tConv);
+        float  n     = rng.gauss() * SIGMA1_M / sqrtf((float)cfg.osrP());
+        noisy.convert(h + n, cfg, tUs);
+        clean.convert(h, cfg, tUs);
+
+        if (t >= sg.t0 + SETTLE_S) {
+            Stats& st = r.seg[seg];
+            double d  = noisy.altM() - clean.altM();
+            float  e  = fabsf((float)(clean.altM() - truthAlt(t)));
+            st.sumD  += d;
+            st.sumD2 += d * d;
+            st.n++;
+            if (e > st.maxErr) st.maxErr = e;
+            st.energyUaS += r.gov.predict(cfg, 0.0f, 0.0f).powerUa * stepUs * 1e-6;
+            st.timeS     += stepUs * 1e-6;
+            st.last       = cfg;
+            st.pred       = r.gov.predict(cfg, sg.absVs, 0.0f);
+        }
+
+        // Como SensorTask: muestra al gobernador y configuración del ciclo siguiente.
+        r.gov.addSample(noisy.alt.getPressureAltMeters(), noisy.alt.getAltitudeData().verticalSpeed.v,
+                        tUs, cfg);
+        cfg = governed ? r.gov.select(sg.mode, sg.phase, tUs / 1000u)
+                       : Bmp390Driver::configForMode(sg.mode);
+    }
+    r.noiseX1M = r.gov.getNoiseX1M();
+}
+
+Result gGov, gTable;
+bool   gSimulated = false;
+
+void runOnce() {
+    if (gSimulated) return;
+    simulate(true, gGov);
+    simulate(false, gTable);
+    gSimulated = true;
+
+    printf("sigma1 real %.3f m, estimado %.3f m (%u muestras)\n",
+           SIGMA1_M, gGov.noiseX1M, (unsigned)gGov.gov.getNoiseSamples());
+    printf("tramo   | gobernador: osr iir   odr    uA  ruido m (pred)  err m (pred) | tabla:    uA  ruido m  err m\n");
+    for (int i = 0; i < SEGMENT_COUNT; ++i) {
+        const Stats& g = gGov.seg[i];
+        const Stats& t = gTable.seg[i];
+        printf("%-7s |            x%-2u %3u %5.1f %5.0f  %6.3f %6.3f %6.2f %6.2f |     %5.0f  %6.3f %6.2f\n",
+               SEGMENTS[i].name, (unsigned)g.last.osrP(), (unsigned)g.last.iirCoef(),
+               g.last.odrHz(), g.powerUa(), g.noiseM(), g.pred.noiseM, g.maxErr, g.pred.dynErrM,
+               t.powerUa(), t.noiseM(), t.maxErr);
+    }
+}
+
+// La configuración de régimen del tramo cumple los objetivos: predicción del
+// gobernador (con la VS del tramo) y medida en la simulación.
+void checkSegment(int i) {
+    runOnce();
+    const Stats& st = gGov.seg[i];
+    TEST_ASSERT_TRUE(st.n > 100);
+
+    TEST_ASSERT_TRUE(st.pred.noiseM <= GOV_NOISE_TARGET_M);
+    TEST_ASSERT_TRUE(st.pred.dynErrM <= GOV_DYN_ERR_TARGET_M);
+
+    TEST_ASSERT_TRUE(st.noiseM() <= GOV_NOISE_TARGET_M);
+    TEST_ASSERT_TRUE(st.maxErr <= GOV_DYN_ERR_TARGET_M);
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// En suelo manda la política: el gobernador no toca la tabla pero aprende σ1.
+// (El ruido medido aquí incluye los re-ceros de deriva de AltimetryService.)
+void test_ground_defers_to_policy_and_learns_noise() {
+    checkSegment(0);
+    TEST_ASSERT_TRUE(gGov.seg[0].last == Bmp390Driver::configForMode(SensorMode::AHORRO));
+    TEST_ASSERT_FLOAT_WITHIN(0.3f * SIGMA1_M, SIGMA1_M, gGov.noiseX1M);
+}
+
+// En vuelo, además, el retardo total está acotado, la medida confirma el
+// modelo del gobernador y no gasta más que la tabla.
+void checkFlight(int i) {
+    checkSegment(i);
+    const Stats& st = gGov.seg[i];
+    TEST_ASSERT_TRUE(st.noiseM() <= 1.25f * st.pred.noiseM);
+    TEST_ASSERT_TRUE(st.maxErr <= st.pred.dynErrM + 0.05f);
+    TEST_ASSERT_TRUE(st.pred.latencyS <= GOV_MAX_LATENCY_MS * 0.001f);
+    TEST_ASSERT_TRUE(st.powerUa() <= gTable.seg[i].powerUa() + 1.0f);
+}
+
+void test_climb_meets_targets()    { checkFlight(1); }
+void test_freefall_meets_targets() { checkFlight(2); }
+void test_canopy_meets_targets()   { checkFlight(3); }
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ground_defers_to_policy_and_learns_noise);
+    RUN_TEST(test_climb_meets_targets);
+    RUN_TEST(test_freefall_meets_targets);
+    RUN_TEST(test_canopy_meets_targets);
+    return UNITY_END();
+}
@@ -0,0 +1,286 @@
+// StorageService en host: la tarea de storage es un std::thread real y la
+// bitácora escribe en HOST_FS_ROOT. Cubre orden FIFO, back-pressure con la
+// cola llena, contadores pending del snapshot, lecturas concurrentes y el
+// anillo de extensiones de la bitácora.
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+#include "core/StorageService.h"
+
+namespace {
+
+// Puerta que bloquea la tarea de storage dentro de un callback.
+struct Gate {
+    std::mutex              m;
+    std::condition_variable cv;
+    bool entered = false;
+    bool open    = false;
+
+    void waitEntered() {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [this] { return entered; });
+    }
+    void release() {
+        std::lock_guard<std::mutex> lk(m);
+        open = true;
+        cv.notify_all();
+    }
+};
+
+void onGate(StorageService::CmdType, bool, const LogbookService::Record&, void* user) {
+    Gate* g = static_cast<Gate*>(user);
+    std::unique_lock<std::mutex> lk(g->m);
+    g->entered = true;
+    g->cv.notify_all();
+    g->cv.wait(lk, [g] { return g->open; });
+}
+
+struct Done {
+    std::mutex            m;
+    std::vector<uint32_t> ts;   // tsUtc en el orden en que se completaron
+    std::vector<uint32_t> ids;
+    std::vector<bool>     ok;
+};
+
+void onDone(StorageService::CmdType, bool ok, const LogbookService::Record& rec, void* user) {
+    Done* d = static_cast<Done*>(user);
+    std::lock_guard<std::mutex> lk(d->m);
+    d->ts.push_back(rec.tsUtc);
+    d->ids.push_back(rec.id);
+    d->ok.push_back(ok);
+}
+
+LogbookService::Record makeRec(uint32_t ts) {
+    LogbookService::Record r{};
+    r.tsUtc    = ts;
+    r.exitAltM = (float)ts;
+    return r;
+}
+
+// Espera (tiempo real) a que la cola se vacíe.
+bool drain(const StorageService& st, uint32_t timeoutMs = 5000) {
+    auto t0 = std::chrono::steady_clock::now();
+    while (st.isBusy()) {
+        if (std::chrono::steady_clock::now() - t0 > std::chrono::milliseconds(timeoutMs)) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+StorageService* newStorage(LogbookService*& lb) {
+    lb = new LogbookService();
+    StorageService* st = new StorageService();   // la tarea no termina: no se libera
+    TEST_ASSERT_TRUE(st->begin(lb));
+    // Primer comando: garantiza que la apertura diferida ya terminó.
+    TEST_ASSERT_TRUE(st->submitStats());
+    TEST_ASSERT_TRUE(drain(*st));
+    return st;
+}
+
+} // namespace
+
+void setUp() {
+    LittleFS.wipe();
+    LittleFS.extraUsedBytes = 0;
+}
+
+void tearDown() {}
+
+void test_appends_complete_in_submit_order() {
+    LogbookService* lb;
+    StorageService* st = newStorage(lb);
+    Done done;
+
+    const uint32_t N = 20;
+    for (uint32_t i = 0; i < N; ++i) {
+        while (!st->submitAppend(makeRec(1000 + i), onDone, &done)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    TEST_ASSERT_TRUE(drain(*st));
+
+    TEST_ASSERT_EQUAL_UINT32(N, done.ts.size());
+    for (uint32_t i = 0; i < N; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(1000 + i, done.ts[i]);
+        TEST_ASSERT_EQUAL_UINT32(i + 1, done.ids[i]);   // id asignado por append()
+        TEST_ASSERT_TRUE(done.ok[i]);
+    }
+
+    StorageService::Snapshot s = st->snapshot();
+    TEST_ASSERT_TRUE(s.statsValid);
+    TEST_ASSERT_EQUAL_UINT32(N, s.stats.totalIds);
+    TEST_ASSERT_EQUAL_UINT32(N, s.lastAppendId);
+    TEST_ASSERT_EQUAL_UINT32(0, s.pending);
+    TEST_ASSERT_EQUAL_UINT32(0, s.pendingAppends);
+
+    LogbookService::Record r{};
+    TEST_ASSERT_TRUE(st->getByIndex(0, r));
+    TEST_ASSERT_EQUAL_UINT32(N, r.id);
+    TEST_ASSERT_EQUAL_UINT32(1000 + N - 1, r.tsUtc);
+}
+
+void test_full_queue_rejects_and_counts_pending() {
+    LogbookService* lb;
+    StorageService* st = newStorage(lb);
+    Gate gate;
+    Done done;
+
+    // La tarea queda parada dentro del callback del primer comando.
+    TEST_ASSERT_TRUE(st->submitStats(onGate, &gate));
+    gate.waitEntered();
+
+    for (uint32_t i = 0; i < STORAGE_QUEUE_LEN; ++i) {
+        TEST_ASSERT_TRUE(st->submitAppend(makeRec(2000 + i), onDone, &done));
+    }
+    StorageService::Snapshot s = st->snapshot();
+    TEST_ASSERT_EQUAL_UINT32(STORAGE_QUEUE_LEN, s.pending);
+    TEST_ASSERT_EQUAL_UINT32(STORAGE_QUEUE_LEN, s.pendingAppends);
+    TEST_ASSERT_TRUE(st->isBusy());
+
+    // Cola llena: back-pressure sin bloquear y sin tocar los contadores.
+    TEST_ASSERT_FALSE(st->submitAppend(makeRec(9999), onDone, &done));
+    TEST_ASSERT_FALSE(st->submitReset());
+    s = st->snapshot();
+    TEST_ASSERT_EQUAL_UINT32(2, s.rejected);
+    TEST_ASSERT_EQUAL_UINT32(STORAGE_QUEUE_LEN, s.pending);
+    TEST_ASSERT_EQUAL_UINT32(STORAGE_QUEUE_LEN, s.pendingAppends);
+
+    gate.release();
+    TEST_ASSERT_TRUE(drain(*st));
+
+    s = st->snapshot();
+    TEST_ASSERT_EQUAL_UINT32(0, s.pending);
+    TEST_ASSERT_EQUAL_UINT32(0, s.pendingAppends);
+    TEST_ASSERT_EQUAL_UINT32(STORAGE_QUEUE_LEN, s.stats.totalIds);
+    TEST_ASSERT_EQUAL_UINT32(STORAGE_QUEUE_LEN, done.ts.size());
+    for (uint32_t i = 0; i < STORAGE_QUEUE_LEN; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(2000 + i, done.ts[i]);   // el rechazado nunca se escribe
+    }
+}
+
+void test_concurrent_reads_see_committed_records() {
+    LogbookService* lb;
+    StorageService* st = newStorage(lb);
+
+    const uint32_t N = 40;
+    std::atomic<bool> stop{false};
+    std::atomic<uint32_t> reads{0}, bad{0};
+
+    // Lector (p.ej. LogbookUi / BLE) en paralelo con la tarea de storage.
+    std::thread reader([&] {
+        while (!stop) {
+            LogbookService::Record r{};
+            if (st->getByIndex(0, r)) {
+                reads++;
+                // Cada Record visible está completo: id y datos casan.
+                if (r.tsUtc != 3000 + r.id - 1 || r.exitAltM != (float)r.tsUtc) bad++;
+            }
+            StorageService::Snapshot s = st->snapshot();
+            if (s.pending > N || s.pendingAppends > s.pending) bad++;
+        }
+    });
+
+    for (uint32_t i = 0; i < N; ++i) {
+        while (!st->submitAppend(makeRec(3000 + i))) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    TEST_ASSERT_TRUE(drain(*st));
+    stop = true;
+    reader.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, bad.load());
+    TEST_ASSERT_GREATER_THAN(0, reads.load());
+
+    for (uint16_t k = 0; k < N; ++k) {
+        LogbookService::Record r{};
+        TEST_ASSERT_TRUE(st->getByIndex(k, r));
+        TEST_ASSERT_EQUAL_UINT32(N - k, r.id);
+    }
+}
+
+void test_append_fails_cleanly_without_filesystem() {
+    LittleFS.failMount = true;
+    LogbookService* lb = new LogbookService();
+    StorageService* st = new StorageService();
+    TEST_ASSERT_TRUE(st->begin(lb));
+    Done done;
+    TEST_ASSERT_TRUE(st->submitAppend(makeRec(4000), onDone, &done));
+    TEST_ASSERT_TRUE(drain(*st));
+    LittleFS.failMount = false;
+
+    StorageService::Snapshot s = st->snapshot();
+    TEST_ASSERT_EQUAL_UINT32(1, done.ok.size());
+    TEST_ASSERT_FALSE(done.ok[0]);
+    TEST_ASSERT_FALSE(s.lastOk);
+    TEST_ASSERT_EQUAL_UINT32(0, s.pendingAppends);
+    TEST_ASSERT_EQUAL_UINT32(0, s.lastAppendId);
+}
+
+// Extensiones: anillo propio de los últimos LOGBOOK_EXT_CAPACITY saltos.
+void test_ext_ring_keeps_only_the_last_jumps() {
+    LogbookService lb;
+    TEST_ASSERT_TRUE(lb.begin());
+
+    const uint32_t N = LOGBOOK_EXT_CAPACITY + 10;
+    for (uint32_t i = 0; i < N; ++i) {
+        LogbookService::Ext ext{};
+        ext.peakFFmps = (float)(i + 1);
+        TEST_ASSERT_TRUE(lb.append(makeRec(5000 + i), &ext));
+    }
+
+    struct stat st{};
+    TEST_ASSERT_EQUAL_INT(0, stat(LOGBOOK_EXT_POSIX_PATH, &st));
+    TEST_ASSERT_EQUAL_UINT32(LogbookService::EXT_FILE_BYTES, (uint32_t)st.st_size);
+
+    LogbookService::Ext ext{};
+    TEST_ASSERT_TRUE(lb.getExtByIndex(0, ext));
+    TEST_ASSERT_EQUAL_UINT32(N, ext.id);
+    TEST_ASSERT_EQUAL_FLOAT((float)N, ext.peakFFmps);
+    TEST_ASSERT_TRUE(lb.getExtByIndex(LOGBOOK_EXT_CAPACITY - 1, ext));
+    TEST_ASSERT_EQUAL_UINT32(N - LOGBOOK_EXT_CAPACITY + 1, ext.id);
+
+    // Más antiguo: el Record sigue, su slot ya es de otro salto.
+    LogbookService::Record r{};
+    TEST_ASSERT_TRUE(lb.getByIndex(LOGBOOK_EXT_CAPACITY, r));
+    TEST_ASSERT_FALSE(lb.getExtByIndex(LOGBOOK_EXT_CAPACITY, ext));
+}
+
+// Partición casi llena: la extensión cede, el Record se guarda.
+void test_ext_yields_to_records_when_space_is_short() {
+    LogbookService lb;
+    TEST_ASSERT_TRUE(lb.begin());
+    LittleFS.extraUsedBytes = LittleFS.totalBytes() - LittleFS.usedBytes()
+                            - LOGBOOK_FS_RESERVE_BYTES;
+
+    LogbookService::Ext ext{};
+    ext.peakFFmps = 50.0f;
+    TEST_ASSERT_TRUE(lb.append(makeRec(6000), &ext));
+
+    LogbookService::Record r{};
+    TEST_ASSERT_TRUE(lb.getByIndex(0, r));
+    TEST_ASSERT_EQUAL_UINT32(6000, r.tsUtc);
+    TEST_ASSERT_FALSE(lb.getExtByIndex(0, ext));
+
+    LittleFS.extraUsedBytes = 0;
+    TEST_ASSERT_TRUE(lb.append(makeRec(6001), &ext));
+    TEST_ASSERT_TRUE(lb.getExtByIndex(0, ext));
+    TEST_ASSERT_EQUAL_UINT32(2, ext.id);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_appends_complete_in_submit_order);
+    RUN_TEST(test_full_queue_rejects_and_counts_pending);
+    RUN_TEST(test_concurrent_reads_see_committed_records);
+    RUN_TEST(test_append_fails_cleanly_without_filesystem);
+    RUN_TEST(test_ext_ring_keeps_only_the_last_jumps);
+    RUN_TEST(test_ext_yields_to_records_when_space_is_short);
+    return UNITY_END();
+}
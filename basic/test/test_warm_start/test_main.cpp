@@ -0,0 +1,177 @@
+// WarmStartService (core/WarmStartService.h): validación de la imagen de RTC
+// (motivo de reset, magic, versión, tamaño y CRC-32) y traslado de los
+// temporizadores al reloj nuevo con shiftMs(), también cuando millis()
+// estaba a punto de dar la vuelta al dormir.
+#include <unity.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "core/WarmStartService.h"
+
+namespace {
+
+WarmStartImage gImg;
+
+uint64_t systemUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
+}
+
+void seal(WarmStartImage& w) {
+    w.crc = WarmStartService::crc32(&w, offsetof(WarmStartImage, crc));
+}
+
+// Imagen válida como la dejaría save(): relleno a cero, guardada hace
+// sleptMs con millis() = savedMs.
+void buildImage(uint32_t savedMs, uint32_t sleptMs) {
+    memset(static_cast<void*>(&gImg), 0, sizeof(gImg));
+    gImg.magic   = WarmStartService::MAGIC;
+    gImg.version = WARM_START_VERSION;
+    gImg.size    = sizeof(WarmStartImage);
+    gImg.savedUs = systemUs() - (uint64_t)sleptMs * 1000ULL;
+    gImg.savedMs = savedMs;
+    gImg.altimetry.refPressurePa = 98765.0f;
+    gImg.settings.brilloPantalla = 3;
+    seal(gImg);
+}
+
+} // namespace
+
+void setUp() {
+    host::resetReason = ESP_RST_DEEPSLEEP;
+    host::setMs(300);
+    buildImage(123456, 60000);
+}
+void tearDown() {}
+
+// Valores de control del CRC-32 IEEE.
+void test_crc32_check_value() {
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, WarmStartService::crc32("123456789", 9));
+    TEST_ASSERT_EQUAL_HEX32(0x00000000u, WarmStartService::crc32("", 0));
+    TEST_ASSERT_EQUAL_HEX32(0xE8B7BE43u, WarmStartService::crc32("a", 1));
+}
+
+void test_valid_image_is_restored() {
+    WarmStartService ws;
+    TEST_ASSERT_TRUE(ws.begin(&gImg));
+    TEST_ASSERT_TRUE(ws.isWarm());
+    TEST_ASSERT_EQUAL_FLOAT(98765.0f, ws.image().altimetry.refPressurePa);
+    TEST_ASSERT_EQUAL_UINT8(3, ws.image().settings.brilloPantalla);
+    TEST_ASSERT_UINT32_WITHIN(50, 60000, ws.sleptMs());
+}
+
+// Cualquier byte cambiado (también en el relleno) invalida la imagen.
+void test_corrupted_byte_is_rejected() {
+    uint8_t* p = reinterpret_cast<uint8_t*>(&gImg);
+    size_t len = offsetof(WarmStartImage, crc);
+    for (size_t i = 0; i < len; i += 7) {
+        buildImage(123456, 60000);
+        p[i] ^= 0x10;
+        WarmStartService ws;
+        char msg[24];
+        snprintf(msg, sizeof(msg), "byte %u", (unsigned)i);
+        TEST_ASSERT_FALSE_MESSAGE(ws.begin(&gImg), msg);
+        TEST_ASSERT_FALSE(ws.isWarm());
+    }
+    buildImage(123456, 60000);
+    gImg.crc ^= 1u;
+    WarmStartService ws;
+    TEST_ASSERT_FALSE(ws.begin(&gImg));
+}
+
+// Cabecera incorrecta aunque el CRC cuadre: de otro firmware.
+void test_header_mismatch_is_rejected() {
+    WarmStartService ws;
+
+    gImg.version = WARM_START_VERSION + 1;
+    seal(gImg);
+    TEST_ASSERT_FALSE(ws.begin(&gImg));
+
+    buildImage(123456, 60000);
+    gImg.size = sizeof(WarmStartImage) - 4;
+    seal(gImg);
+    TEST_ASSERT_FALSE(ws.begin(&gImg));
+
+    buildImage(123456, 60000);
+    gImg.magic = WarmStartService::MAGIC ^ 1u;
+    seal(gImg);
+    TEST_ASSERT_FALSE(ws.begin(&gImg));
+
+    TEST_ASSERT_FALSE(ws.begin(nullptr));
+}
+
+// Reset que no viene de deep sleep: la imagen no vale y se borra.
+void test_cold_reset_clears_magic() {
+    host::resetReason = ESP_RST_POWERON;
+    WarmStartService ws;
+    TEST_ASSERT_FALSE(ws.begin(&gImg));
+    TEST_ASSERT_EQUAL_UINT32(0, gImg.magic);
+
+    // Ni siquiera un deep sleep posterior la resucita.
+    host::resetReason = ESP_RST_DEEPSLEEP;
+    TEST_ASSERT_FALSE(ws.begin(&gImg));
+
+    buildImage(123456, 60000);
+    host::resetReason = ESP_RST_PANIC;
+    TEST_ASSERT_FALSE(ws.begin(&gImg));
+    TEST_ASSERT_EQUAL_UINT32(0, gImg.magic);
+}
+
+// millis() a punto de dar la vuelta al dormir (0xFFFFF000), 10 s dormido,
+// 500 ms de arranque: un temporizador guardado 2 s antes de dormir tiene
+// 12 s de antigüedad en el reloj nuevo.
+void test_shift_across_millis_wrap() {
+    const uint32_t savedMs = 0xFFFFF000u;
+    buildImage(savedMs, 10000);
+    host::setMs(500);
+
+    WarmStartService ws;
+    TEST_ASSERT_TRUE(ws.begin(&gImg));
+    TEST_ASSERT_UINT32_WITHIN(50, 10000, ws.sleptMs());
+
+    uint32_t timer   = savedMs - 2000u;
+    uint32_t shifted = timer + ws.shiftMs();
+    TEST_ASSERT_UINT32_WITHIN(50, 12000, millis() - shifted);
+
+    // Un instante guardado justo al dormir: sleptMs de antigüedad.
+    TEST_ASSERT_UINT32_WITHIN(50, 10000, millis() - (savedMs + ws.shiftMs()));
+}
+
+// Sin vuelta, mismo resultado.
+void test_shift_without_wrap() {
+    buildImage(5000, 30000);
+    host::setMs(400);
+
+    WarmStartService ws;
+    TEST_ASSERT_TRUE(ws.begin(&gImg));
+    uint32_t timer = 1000;
+    TEST_ASSERT_UINT32_WITHIN(50, 34000, millis() - (timer + ws.shiftMs()));
+}
+
+// Reloj del sistema por detrás de lo guardado (no debería pasar): sin
+// tiempo dormido, pero se restaura igual.
+void test_clock_behind_saved_counts_zero_sleep() {
+    buildImage(5000, 0);
+    gImg.savedUs = systemUs() + 60ULL * 1000000ULL;
+    seal(gImg);
+    host::setMs(400);
+
+    WarmStartService ws;
+    TEST_ASSERT_TRUE(ws.begin(&gImg));
+    TEST_ASSERT_EQUAL_UINT32(0, ws.sleptMs());
+    TEST_ASSERT_EQUAL_UINT32(0, millis() - (5000u + ws.shiftMs()));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_valid_image_is_restored);
+    RUN_TEST(test_corrupted_byte_is_rejected);
+    RUN_TEST(test_header_mismatch_is_rejected);
+    RUN_TEST(test_cold_reset_clears_magic);
+    RUN_TEST(test_shift_across_millis_wrap);
+    RUN_TEST(test_shift_without_wrap);
+    RUN_TEST(test_clock_behind_saved_counts_zero_sleep);
+    return UNITY_END();
+}
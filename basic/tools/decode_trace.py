@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Decodifica el área de trazas de vuelo (trace.bin de LittleFS) a CSV.
+
+Formato (ver src/util/TraceCodec.h y src/core/TraceStore.h):
+  - Archivo: cabecera de 256 bytes + anillo de bloques de 256 bytes.
+  - Bloque: cabecera empaquetada de 32 bytes con la primera muestra
+    (t0 ms, alt0 dm, vs0 cm/s, p0 dPa, temp0 c°C) + payload de varints zigzag
+    por muestra: delta-of-delta de tiempo (ms), delta-of-delta de presión (dPa),
+    delta de temperatura (c°C), delta-of-delta de altitud (dm) y delta de VS (cm/s).
+
+Uso:
+  decode_trace.py trace.bin              -> lista saltos encontrados
+  decode_trace.py trace.bin --jump 42    -> CSV t_ms,pressure_pa,temp_c,alt_m,vs_mps del salto 42
+"""
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+BLOCK_SIZE = 256
+BLOCK_MAGIC = 0x5254
+BLOCK_VERSION = 2
+FILE_MAGIC = 0x54524342
+HDR_FMT = "<HBBIHHHHIihIh"          # TraceBlockHeader
+HDR_SIZE = struct.calcsize(HDR_FMT)
+FILE_HDR_FMT = "<IHHIIIIH"        # TraceStore::Header
+FLAG_FIRST = 0x01
+FLAG_LAST = 0x02
+FLAG_TRUNCATED = 0x04
+
+
+def crc16_ccitt(data: bytes) -> int:
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def get_varint(buf: bytes, pos: int):
+    v = 0
+    for i in range(5):
+        if pos + i >= len(buf):
+            raise ValueError("varint truncado")
+        b = buf[pos + i]
+        v |= (b & 0x7F) << (7 * i)
+        if not b & 0x80:
+            return v, pos + i + 1
+    raise ValueError("varint demasiado largo")
+
+
+def unzigzag(v: int) -> int:
+    return (v >> 1) ^ -(v & 1)
+
+
+def decode_block(raw: bytes):
+    """Devuelve (header dict, [(t_ms, p_pa, temp_c, alt_m, vs_mps), ...]) o None si no es válido."""
+    fields = struct.unpack_from(HDR_FMT, raw)
+    (magic, version, flags, jump_id, seq, count, payload_len, crc,
+     t0, alt0, vs0, p0, temp0) = fields
+    if magic != BLOCK_MAGIC or version != BLOCK_VERSION or count == 0:
+        return None
+    zeroed = raw[:14] + b"\x00\x00" + raw[16:]
+    if crc16_ccitt(zeroed) != crc:
+        return None
+
+    def sample(t, p, temp, alt, vs):
+        return (t, p / 10.0, temp / 100.0, alt / 10.0, vs / 100.0)
+
+    hdr = dict(flags=flags, jump=jump_id, seq=seq, count=count)
+    samples = [sample(t0, p0, temp0, alt0, vs0)]
+    payload = raw[HDR_SIZE:HDR_SIZE + payload_len]
+    pos = 0
+    t, p, temp, alt, vs = t0, p0, temp0, alt0, vs0
+    dt, dp, dalt = 0, 0, 0
+    for _ in range(count - 1):
+        vals = []
+        for _f in range(5):
+            v, pos = get_varint(payload, pos)
+            vals.append(unzigzag(v))
+        ddt, ddp, dtemp, ddalt, dvs = vals
+        dt += ddt
+        dp += ddp
+        dalt += ddalt
+        t = (t + dt) & 0xFFFFFFFF
+        p += dp
+        temp += dtemp
+        alt += dalt
+        vs += dvs
+        samples.append(sample(t, p, temp, alt, vs))
+    return hdr, samples
+
+
+def read_blocks(path: Path):
+    data = path.read_bytes()
+    if len(data) < BLOCK_SIZE:
+        sys.exit("archivo demasiado corto")
+    magic, _ver, bsize, capacity, head, count, _gen, _crc = struct.unpack_from(FILE_HDR_FMT, data)
+    if magic != FILE_MAGIC or bsize != BLOCK_SIZE:
+        sys.exit("cabecera de trazas inválida")
+
+    # Orden cronológico del anillo: los 'count' bloques que terminan en head.
+    first = (head - count) % capacity
+    for i in range(count):
+        pos = (first + i) % capacity
+        off = BLOCK_SIZE * (1 + pos)
+        raw = data[off:off + BLOCK_SIZE]
+        if len(raw) < BLOCK_SIZE:
+            continue
+        dec = decode_block(raw)
+        if dec:
+            yield dec
+
+
+def group_jumps(blocks):
+    """Agrupa por jumpId. Si un id se repite (salto descartado y reutilizado),
+    gana la última sesión, que empieza en un bloque con FLAG_FIRST."""
+    jumps = {}
+    for hdr, samples in blocks:
+        jid = hdr["jump"]
+        if hdr["flags"] & FLAG_FIRST or jid not in jumps:
+            jumps[jid] = []
+        jumps[jid].append((hdr, samples))
+    return jumps
+
+
+def main() -> None:
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("trace", type=Path)
+    ap.add_argument("--jump", type=int, help="id de salto a exportar como CSV")
+    args = ap.parse_args()
+
+    jumps = group_jumps(read_blocks(args.trace))
+
+    if args.jump is None:
+        for jid, blks in sorted(jumps.items()):
+            n = sum(len(s) for _, s in blks)
+            complete = bool(blks[-1][0]["flags"] & FLAG_LAST)
+            truncated = bool(blks[-1][0]["flags"] & FLAG_TRUNCATED)
+            note = "" if complete else " (incompleto)"
+            if truncated:
+                note += " (truncado: arena lleno)"
+            print(f"jump {jid}: {len(blks)} bloques, {n} muestras{note}")
+        return
+
+    blks = jumps.get(args.jump)
+    if not blks:
+        sys.exit(f"salto {args.jump} no encontrado")
+    print("t_ms,pressure_pa,temp_c,alt_m,vs_mps")
+    for _, samples in sorted(blks, key=lambda b: b[0]["seq"]):
+        for t, p, temp, alt, vs in samples:
+            print(f"{t},{p:.1f},{temp:.2f},{alt:.1f},{vs:.2f}")
+
+
+if __name__ == "__main__":
+    main()